@@ -0,0 +1,627 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/*
+ * Register sequence writer shared by the sensor drivers in this tree.
+ *
+ * All the sensors here (ov5693, ov5670, ov7251, ov8865) use 16-bit register
+ * addresses and auto-increment the address on sequential writes. So, a run
+ * of consecutive addresses in a mode table can be sent as one i2c message
+ * instead of one 3-byte message per register. This is the same idea as the
+ * old ov5693_write_reg_array(), made independent of the table format so
+ * that every driver can walk its own table and feed it here.
+ *
+ * Usage:
+ *	struct sensor_burst burst;
+ *
+ *	sensor_burst_init(&burst, client);
+ *	for each entry:
+ *		sensor_burst_write8(&burst, reg, val);
+ *		(or sensor_burst_delay(&burst, ms) for a delay entry)
+ *	sensor_burst_flush(&burst);
+ *
+ * The same walk can also be recorded into a struct sensor_prog once at
+ * probe (sensor_prog_build()) and replayed later with sensor_prog_run(),
+ * which sends every run of messages between two delays in a single
+ * i2c_transfer() without looking at the table again.
+ *
+ * With a register shadow (sensor_shadow.h), sensor_prog_load() sends only
+ * the part of a precompiled sequence that the sensor does not hold yet.
+ */
+
+#ifndef __SENSOR_BURST_H__
+#define __SENSOR_BURST_H__
+
+#include <linux/delay.h>
+#include <linux/device.h>
+#include <linux/i2c.h>
+#include <linux/seq_file.h>
+#include <linux/slab.h>
+#include <linux/string.h>
+#include <linux/types.h>
+
+#include "sensor_shadow.h"
+#include "sensor_stats.h"
+#include "sensor_trace.h"
+
+/* Max length of one message, including the 16-bit register address */
+#define SENSOR_BURST_MAX_LEN	32
+#define SENSOR_BURST_MAX_DATA	(SENSOR_BURST_MAX_LEN - sizeof(u16))
+
+/**
+ * struct sensor_prog_step - messages sent in one i2c_transfer()
+ * @nr_msgs: number of messages in this step
+ * @delay_ms: delay after the messages are sent
+ */
+struct sensor_prog_step {
+	u16 nr_msgs;
+	u16 delay_ms;
+};
+
+/**
+ * struct sensor_prog - precompiled register sequence
+ * @msgs: ready-to-send messages, pointing into @data
+ * @steps: runs of @msgs separated by delays
+ * @data: address + value bytes of all the messages
+ * @nr_msgs: number of entries in @msgs
+ * @nr_steps: number of entries in @steps
+ * @nr_bytes: size of @data, that is, total bytes on the bus
+ * @nr_regs: number of table entries the sequence was built from
+ */
+struct sensor_prog {
+	struct i2c_msg *msgs;
+	struct sensor_prog_step *steps;
+	u8 *data;
+	unsigned int nr_msgs;
+	unsigned int nr_steps;
+	unsigned int nr_bytes;
+	unsigned int nr_regs;
+};
+
+struct sensor_burst {
+	struct i2c_client *client;
+	struct sensor_prog *prog;	/* record instead of sending if set */
+	struct sensor_shadow *shadow;	/* update with sent bytes if set */
+	struct sensor_stats *stats;	/* count sent messages if set */
+	unsigned int step_msgs;		/* messages since last delay */
+	u16 addr;		/* register address of the first pending byte */
+	unsigned int len;	/* pending data bytes in buf (after address) */
+	u8 buf[SENSOR_BURST_MAX_LEN];
+
+	/* Accounting for the whole sequence since sensor_burst_init() */
+	unsigned int nr_regs;
+	unsigned int nr_msgs;
+	unsigned int nr_bytes;
+};
+
+static inline void sensor_burst_init(struct sensor_burst *burst,
+				     struct i2c_client *client)
+{
+	burst->client = client;
+	burst->prog = NULL;
+	burst->shadow = NULL;
+	burst->stats = NULL;
+	burst->step_msgs = 0;
+	burst->addr = 0;
+	burst->len = 0;
+	burst->nr_regs = 0;
+	burst->nr_msgs = 0;
+	burst->nr_bytes = 0;
+}
+
+/*
+ * Record one message into burst->prog. While prog->msgs is not allocated
+ * yet, only count it (first pass of sensor_prog_build()).
+ */
+static inline void __sensor_prog_add_msg(struct sensor_burst *burst,
+					 unsigned int size)
+{
+	struct sensor_prog *prog = burst->prog;
+	struct i2c_msg *msg;
+
+	if (prog->msgs) {
+		msg = &prog->msgs[prog->nr_msgs];
+		msg->addr = burst->client->addr;
+		msg->flags = burst->client->flags & I2C_M_TEN;
+		msg->len = size;
+		msg->buf = &prog->data[prog->nr_bytes];
+		memcpy(msg->buf, burst->buf, size);
+		prog->steps[prog->nr_steps].nr_msgs++;
+	}
+
+	burst->step_msgs++;
+	prog->nr_msgs++;
+	prog->nr_bytes += size;
+}
+
+/* Close the current step of burst->prog with a delay of @ms */
+static inline void __sensor_prog_add_delay(struct sensor_burst *burst,
+					   unsigned int ms)
+{
+	struct sensor_prog *prog = burst->prog;
+
+	if (prog->msgs)
+		prog->steps[prog->nr_steps].delay_ms = ms;
+
+	burst->step_msgs = 0;
+	prog->nr_steps++;
+}
+
+/**
+ * sensor_burst_flush - send the pending run of registers, if any
+ * @burst: burst writer
+ *
+ * Return 0 on success or when nothing is pending, negative errno otherwise.
+ */
+static inline int sensor_burst_flush(struct sensor_burst *burst)
+{
+	struct i2c_client *client = burst->client;
+	ktime_t start;
+	int size;
+	int ret;
+
+	if (!burst->len)
+		return 0;
+
+	size = sizeof(u16) + burst->len;
+	burst->buf[0] = burst->addr >> 8;
+	burst->buf[1] = burst->addr & 0xff;
+	burst->len = 0;
+
+	if (burst->prog) {
+		__sensor_prog_add_msg(burst, size);
+		burst->nr_msgs++;
+		burst->nr_bytes += size;
+		return 0;
+	}
+
+	start = ktime_get();
+	ret = i2c_master_send(client, burst->buf, size);
+	sensor_stats_account(burst->stats, start, size, ret == size ? 0 : -EIO);
+	if (ret != size) {
+		if (ret >= 0)
+			ret = -EIO;
+		dev_err(&client->dev, "%s: error %d: reg=%x, len=%d\n",
+			__func__, ret, burst->addr, size);
+		if (burst->shadow)
+			sensor_shadow_invalidate(burst->shadow);
+		return ret;
+	}
+
+	if (burst->shadow)
+		sensor_shadow_set(burst->shadow, burst->addr,
+				  &burst->buf[sizeof(u16)], size - sizeof(u16));
+
+	burst->nr_msgs++;
+	burst->nr_bytes += size;
+
+	return 0;
+}
+
+/**
+ * sensor_burst_write - queue @n bytes starting at register @reg
+ * @burst: burst writer
+ * @reg: 16-bit register address
+ * @val: register value(s), MSB first for multi-byte registers
+ * @n: number of bytes in @val
+ *
+ * The bytes are appended to the pending run if @reg directly follows it
+ * and the run still fits in one message. Otherwise the pending run is
+ * flushed first.
+ */
+static inline int sensor_burst_write(struct sensor_burst *burst, u16 reg,
+				     const u8 *val, unsigned int n)
+{
+	int ret;
+
+	if (WARN_ON(n > SENSOR_BURST_MAX_DATA))
+		return -EINVAL;
+
+	if (burst->len && (reg != burst->addr + burst->len ||
+			   burst->len + n > SENSOR_BURST_MAX_DATA)) {
+		ret = sensor_burst_flush(burst);
+		if (ret)
+			return ret;
+	}
+
+	if (!burst->len)
+		burst->addr = reg;
+
+	memcpy(&burst->buf[sizeof(u16) + burst->len], val, n);
+	burst->len += n;
+	burst->nr_regs++;
+
+	return 0;
+}
+
+static inline int sensor_burst_write8(struct sensor_burst *burst, u16 reg,
+				      u8 val)
+{
+	return sensor_burst_write(burst, reg, &val, 1);
+}
+
+/**
+ * sensor_burst_delay - flush the pending run, then sleep for @ms
+ * @burst: burst writer
+ * @ms: delay in milliseconds, 0 only flushes
+ */
+static inline int sensor_burst_delay(struct sensor_burst *burst,
+				     unsigned int ms)
+{
+	int ret;
+
+	ret = sensor_burst_flush(burst);
+	if (ret)
+		return ret;
+
+	if (burst->prog)
+		__sensor_prog_add_delay(burst, ms);
+	else if (ms)
+		usleep_range(1000 * ms, 1000 * ms + 100);
+
+	return 0;
+}
+
+/*
+ * Callback walking one register table into @burst with
+ * sensor_burst_write*() / sensor_burst_delay(). It must not flush at the
+ * end, sensor_prog_build() takes care of that.
+ */
+typedef int (*sensor_prog_walk_t)(struct sensor_burst *burst,
+				  const void *table);
+
+/**
+ * sensor_prog_build - precompile a register table
+ * @client: i2c client the sequence will be sent to
+ * @prog: sequence to fill, memory is device-managed by @client
+ * @walk: callback walking the table
+ * @table: table passed to @walk
+ *
+ * The table is walked twice: once to size the buffers and once to fill
+ * them, so that the result uses exactly the memory it needs.
+ */
+static inline int sensor_prog_build(struct i2c_client *client,
+				    struct sensor_prog *prog,
+				    sensor_prog_walk_t walk, const void *table)
+{
+	struct device *dev = &client->dev;
+	struct sensor_burst burst;
+	unsigned int nr_msgs, nr_steps, nr_bytes;
+	int pass;
+	int ret;
+
+	memset(prog, 0, sizeof(*prog));
+
+	for (pass = 0; pass < 2; pass++) {
+		sensor_burst_init(&burst, client);
+		burst.prog = prog;
+
+		ret = walk(&burst, table);
+		if (ret)
+			return ret;
+
+		ret = sensor_burst_flush(&burst);
+		if (ret)
+			return ret;
+
+		/* Close the last step if messages follow the last delay */
+		if (burst.step_msgs)
+			__sensor_prog_add_delay(&burst, 0);
+
+		prog->nr_regs = burst.nr_regs;
+		if (pass)
+			break;
+
+		nr_msgs = prog->nr_msgs;
+		nr_steps = prog->nr_steps;
+		nr_bytes = prog->nr_bytes;
+
+		prog->msgs = devm_kcalloc(dev, max(nr_msgs, 1U),
+					  sizeof(*prog->msgs), GFP_KERNEL);
+		prog->steps = devm_kcalloc(dev, max(nr_steps, 1U),
+					   sizeof(*prog->steps), GFP_KERNEL);
+		prog->data = devm_kzalloc(dev, max(nr_bytes, 1U), GFP_KERNEL);
+		if (!prog->msgs || !prog->steps || !prog->data)
+			return -ENOMEM;
+
+		prog->nr_msgs = 0;
+		prog->nr_steps = 0;
+		prog->nr_bytes = 0;
+	}
+
+	return 0;
+}
+
+/**
+ * sensor_prog_run - send a precompiled register sequence
+ * @client: i2c client the sequence was built for
+ * @prog: sequence to send
+ * @stats: i2c statistics of @client, or NULL
+ */
+static inline int sensor_prog_run(struct i2c_client *client,
+				  const struct sensor_prog *prog,
+				  struct sensor_stats *stats)
+{
+	const struct i2c_adapter_quirks *quirks = client->adapter->quirks;
+	unsigned int max_msgs = quirks ? quirks->max_num_msgs : 0;
+	struct i2c_msg *msgs = prog->msgs;
+	unsigned int i, n, left;
+	int ret;
+
+	for (i = 0; i < prog->nr_steps; i++) {
+		const struct sensor_prog_step *step = &prog->steps[i];
+
+		for (left = step->nr_msgs; left; left -= n, msgs += n) {
+			n = max_msgs ? min(left, max_msgs) : left;
+
+			ret = sensor_i2c_transfer(stats, client->adapter,
+						  msgs, n);
+			if (ret != n) {
+				if (ret >= 0)
+					ret = -EIO;
+				dev_err(&client->dev,
+					"%s: error %d: reg=%02x%02x\n",
+					__func__, ret, msgs->buf[0],
+					msgs->buf[1]);
+				return ret;
+			}
+		}
+
+		if (step->delay_ms)
+			usleep_range(1000 * step->delay_ms,
+				     1000 * step->delay_ms + 100);
+	}
+
+	return 0;
+}
+
+/*
+ * Queue into @burst the bytes of @prog that differ from @shadow. The
+ * shadow is updated as the bytes are queued, so a register written twice
+ * in the table ends up with its last value, and everything following a
+ * software reset is sent. Delays are kept only after steps that still
+ * write something.
+ */
+static inline int __sensor_prog_diff(struct sensor_burst *burst,
+				     const struct sensor_prog *prog,
+				     struct sensor_shadow *shadow)
+{
+	const struct i2c_msg *msg = prog->msgs;
+	unsigned int i, j, k, nr_regs;
+	u16 reg;
+	int ret;
+
+	for (i = 0; i < prog->nr_steps; i++) {
+		const struct sensor_prog_step *step = &prog->steps[i];
+
+		nr_regs = burst->nr_regs;
+
+		for (j = 0; j < step->nr_msgs; j++, msg++) {
+			reg = msg->buf[0] << 8 | msg->buf[1];
+
+			for (k = sizeof(u16); k < msg->len; k++, reg++) {
+				if (sensor_shadow_match(shadow, reg,
+							msg->buf[k]))
+					continue;
+
+				ret = sensor_burst_write8(burst, reg,
+							  msg->buf[k]);
+				if (ret)
+					return ret;
+
+				sensor_shadow_set8(shadow, reg, msg->buf[k]);
+			}
+		}
+
+		if (step->delay_ms && burst->nr_regs != nr_regs) {
+			ret = sensor_burst_delay(burst, step->delay_ms);
+			if (ret)
+				return ret;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * sensor_prog_load - send the part of a sequence the sensor doesn't hold
+ * @client: i2c client the sequence was built for
+ * @prog: sequence to load
+ * @shadow: register shadow of @client, updated on success
+ * @stats: i2c statistics of @client, or NULL
+ *
+ * With an empty shadow (just powered on) this sends the whole sequence,
+ * with the same batching as sensor_prog_run(). When switching modes, only
+ * the registers whose values change are sent, and nothing at all when the
+ * sensor is already set up for @prog. On error the shadow is invalidated.
+ */
+static inline int sensor_prog_load(struct i2c_client *client,
+				   const struct sensor_prog *prog,
+				   struct sensor_shadow *shadow,
+				   struct sensor_stats *stats)
+{
+	unsigned int nr_data = prog->nr_bytes - prog->nr_msgs * sizeof(u16);
+	struct sensor_prog diff = { };
+	struct sensor_burst burst;
+	int ret;
+
+	trace_sensor_stage_begin(&client->dev, "load_regs");
+
+	/*
+	 * Worst case, every other byte differs: one message per data byte,
+	 * each with its own register address.
+	 */
+	diff.msgs = kcalloc(max(nr_data, 1U), sizeof(*diff.msgs), GFP_KERNEL);
+	diff.steps = kcalloc(max(prog->nr_steps, 1U), sizeof(*diff.steps),
+			     GFP_KERNEL);
+	diff.data = kmalloc(max_t(size_t, nr_data * (1 + sizeof(u16)), 1),
+			    GFP_KERNEL);
+	if (!diff.msgs || !diff.steps || !diff.data) {
+		ret = -ENOMEM;
+		goto out;
+	}
+
+	sensor_burst_init(&burst, client);
+	burst.prog = &diff;
+
+	ret = __sensor_prog_diff(&burst, prog, shadow);
+	if (!ret)
+		ret = sensor_burst_flush(&burst);
+	if (ret)
+		goto out;
+
+	if (burst.step_msgs)
+		__sensor_prog_add_delay(&burst, 0);
+	diff.nr_regs = burst.nr_regs;
+
+	dev_dbg(&client->dev, "%s: %u of %u bytes in %u msgs\n", __func__,
+		burst.nr_regs, nr_data, diff.nr_msgs);
+
+	ret = sensor_prog_run(client, &diff, stats);
+
+out:
+	if (ret)
+		sensor_shadow_invalidate(shadow);
+
+	trace_sensor_stage_end(&client->dev, "load_regs", diff.nr_regs,
+			       diff.nr_bytes, ret);
+
+	kfree(diff.data);
+	kfree(diff.steps);
+	kfree(diff.msgs);
+
+	return ret;
+}
+
+#define SENSOR_BATCH_MAX_MSGS	8
+#define SENSOR_BATCH_MAX_BYTES	64
+
+/**
+ * struct sensor_batch - short register sequence sent in one i2c_transfer()
+ * @client: i2c client to send to
+ * @msgs: queued messages, pointing into @data
+ * @data: address + value bytes of the queued messages
+ * @nr_msgs: number of queued messages
+ * @nr_bytes: bytes used in @data
+ * @error: first error met while queueing, returned by sensor_batch_send()
+ * @stats: i2c statistics to count the transfer in, or NULL
+ *
+ * For sequences built at runtime that have to reach the sensor back to
+ * back, such as a group hold packet. Unlike with sensor_burst, every write
+ * is a message of its own, so several writes to the same register (group
+ * start, end and launch) are kept in order.
+ */
+struct sensor_batch {
+	struct i2c_client *client;
+	struct i2c_msg msgs[SENSOR_BATCH_MAX_MSGS];
+	u8 data[SENSOR_BATCH_MAX_BYTES];
+	unsigned int nr_msgs;
+	unsigned int nr_bytes;
+	int error;
+	struct sensor_stats *stats;
+};
+
+static inline void sensor_batch_init(struct sensor_batch *batch,
+				     struct i2c_client *client)
+{
+	batch->client = client;
+	batch->nr_msgs = 0;
+	batch->nr_bytes = 0;
+	batch->error = 0;
+	batch->stats = NULL;
+}
+
+/* Queue a write of @n bytes starting at register @reg */
+static inline void sensor_batch_write(struct sensor_batch *batch, u16 reg,
+				      const u8 *val, unsigned int n)
+{
+	unsigned int size = sizeof(u16) + n;
+	struct i2c_msg *msg;
+	u8 *buf;
+
+	if (batch->error)
+		return;
+
+	if (WARN_ON(batch->nr_msgs == SENSOR_BATCH_MAX_MSGS ||
+		    batch->nr_bytes + size > SENSOR_BATCH_MAX_BYTES)) {
+		batch->error = -ENOSPC;
+		return;
+	}
+
+	buf = &batch->data[batch->nr_bytes];
+	buf[0] = reg >> 8;
+	buf[1] = reg & 0xff;
+	memcpy(&buf[sizeof(u16)], val, n);
+
+	msg = &batch->msgs[batch->nr_msgs++];
+	msg->addr = batch->client->addr;
+	msg->flags = batch->client->flags & I2C_M_TEN;
+	msg->len = size;
+	msg->buf = buf;
+
+	batch->nr_bytes += size;
+}
+
+static inline void sensor_batch_write8(struct sensor_batch *batch, u16 reg,
+				       u8 val)
+{
+	sensor_batch_write(batch, reg, &val, 1);
+}
+
+static inline void sensor_batch_write16(struct sensor_batch *batch, u16 reg,
+					u16 val)
+{
+	u8 buf[2] = { val >> 8, val & 0xff };
+
+	sensor_batch_write(batch, reg, buf, sizeof(buf));
+}
+
+/**
+ * sensor_batch_send - send the queued messages
+ * @batch: batch to send
+ *
+ * All the messages go in one i2c_transfer(), or in as few as the adapter
+ * allows if it limits the number of messages per transfer.
+ */
+static inline int sensor_batch_send(struct sensor_batch *batch)
+{
+	struct i2c_client *client = batch->client;
+	const struct i2c_adapter_quirks *quirks = client->adapter->quirks;
+	unsigned int max_msgs = quirks ? quirks->max_num_msgs : 0;
+	struct i2c_msg *msgs = batch->msgs;
+	unsigned int left, n;
+	int ret;
+
+	if (batch->error)
+		return batch->error;
+
+	for (left = batch->nr_msgs; left; left -= n, msgs += n) {
+		n = max_msgs ? min(left, max_msgs) : left;
+
+		ret = sensor_i2c_transfer(batch->stats, client->adapter,
+					  msgs, n);
+		if (ret != n) {
+			if (ret >= 0)
+				ret = -EIO;
+			dev_err(&client->dev, "%s: error %d: reg=%02x%02x\n",
+				__func__, ret, msgs->buf[0], msgs->buf[1]);
+			return ret;
+		}
+	}
+
+	return 0;
+}
+
+/* One line of a debugfs "modes" file, see sensor_prog_seq_header() */
+static inline void sensor_prog_seq_show(struct seq_file *m, const char *name,
+					const struct sensor_prog *prog)
+{
+	seq_printf(m, "%-24s %6u %6u %6u %6u\n", name, prog->nr_regs,
+		   prog->nr_msgs, prog->nr_bytes, prog->nr_steps);
+}
+
+static inline void sensor_prog_seq_header(struct seq_file *m)
+{
+	seq_printf(m, "%-24s %6s %6s %6s %6s\n", "mode", "regs", "msgs",
+		   "bytes", "xfers");
+}
+
+#endif /* __SENSOR_BURST_H__ */
@@ -0,0 +1,192 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/*
+ * Calibration data of the sensor modules, exported to userspace.
+ *
+ * The OTP of a module holds its lens shading, AWB and defect data. The
+ * drivers read it once at probe straight into a page-aligned buffer,
+ * behind a small header, and the whole buffer is exported read-only as
+ *
+ *	/sys/bus/i2c/devices/<i2c device>/calibration
+ *
+ * which can be read(), or mmap()ed without a copy. Nothing goes over i2c
+ * when it is read.
+ *
+ * Usage:
+ *	data = sensor_calib_alloc(&sensor->calib, OV1234_OTP_SIZE);
+ *	... read the OTP into data ...
+ *	ret = sensor_calib_publish(&sensor->calib, dev,
+ *				   SENSOR_CALIB_FMT_RAW, OV1234_CHIP_ID,
+ *				   OV1234_OTP_START, size);
+ *	...
+ *	sensor_calib_free(&sensor->calib, dev);
+ */
+
+#ifndef __SENSOR_CALIB_H__
+#define __SENSOR_CALIB_H__
+
+#include <linux/crc32.h>
+#include <linux/device.h>
+#include <linux/gfp.h>
+#include <linux/mm.h>
+#include <linux/sysfs.h>
+#include <linux/types.h>
+#include <linux/version.h>
+
+#define SENSOR_CALIB_VERSION	1
+
+/* Layout of the data after the header */
+enum sensor_calib_format {
+	SENSOR_CALIB_FMT_RAW,		/* OTP bytes in register order */
+	SENSOR_CALIB_FMT_INTEL_OTP,	/* Intel OTP map, of ov5693 modules */
+};
+
+/* Starts the exported blob, all fields little-endian */
+struct sensor_calib_header {
+	u8 version;			/* SENSOR_CALIB_VERSION */
+	u8 format;			/* enum sensor_calib_format */
+	__le16 header_size;		/* Bytes, the data starts right
+					 * after
+					 */
+	__le32 chip_id;			/* Chip ID of the sensor */
+	__le32 data_size;		/* Bytes of calibration data */
+	__le16 otp_start;		/* First register the data was
+					 * read from, 0 if banked
+					 */
+	__le16 reserved0;
+	__le32 data_crc32;		/* crc32_le(~0, data) ^ ~0 */
+	u8 reserved[12];		/* Pads the header to 32 bytes */
+} __packed;
+
+/**
+ * struct sensor_calib - exported calibration blob
+ * @buf: header then data, page-aligned, NULL until allocated
+ * @size: bytes allocated, a multiple of PAGE_SIZE
+ * @attr: the calibration file, created by sensor_calib_publish()
+ * @published: set once @attr exists
+ */
+struct sensor_calib {
+	void *buf;
+	size_t size;
+	struct bin_attribute attr;
+	bool published;
+};
+
+static inline void *sensor_calib_data(struct sensor_calib *calib)
+{
+	return calib->buf + sizeof(struct sensor_calib_header);
+}
+
+/**
+ * sensor_calib_alloc - allocate the blob, to read the OTP into
+ * @calib: blob to allocate
+ * @max_size: largest calibration data the driver may read
+ *
+ * Returns where the data goes, zeroed, or NULL if out of memory.
+ */
+static inline void *sensor_calib_alloc(struct sensor_calib *calib,
+				       size_t max_size)
+{
+	calib->size = PAGE_ALIGN(sizeof(struct sensor_calib_header) +
+				 max_size);
+	calib->buf = alloc_pages_exact(calib->size,
+				       GFP_KERNEL | __GFP_ZERO);
+	if (!calib->buf)
+		return NULL;
+
+	return sensor_calib_data(calib);
+}
+
+static ssize_t sensor_calib_read(struct file *file, struct kobject *kobj,
+				 struct bin_attribute *attr, char *buf,
+				 loff_t off, size_t count)
+{
+	struct sensor_calib *calib = attr->private;
+
+	return memory_read_from_buffer(buf, count, &off, calib->buf,
+				       attr->size);
+}
+
+static int sensor_calib_mmap(struct file *file, struct kobject *kobj,
+			     struct bin_attribute *attr,
+			     struct vm_area_struct *vma)
+{
+	struct sensor_calib *calib = attr->private;
+	unsigned long size = vma->vm_end - vma->vm_start;
+
+	if (vma->vm_flags & VM_WRITE)
+		return -EPERM;
+	if (vma->vm_pgoff || size > calib->size)
+		return -EINVAL;
+
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(6, 3, 0)
+	vm_flags_clear(vma, VM_MAYWRITE);
+#else
+	vma->vm_flags &= ~VM_MAYWRITE;
+#endif
+
+	return remap_pfn_range(vma, vma->vm_start,
+			       virt_to_phys(calib->buf) >> PAGE_SHIFT, size,
+			       vma->vm_page_prot);
+}
+
+/**
+ * sensor_calib_publish - fill in the header and create the file
+ * @calib: blob from sensor_calib_alloc()
+ * @dev: sensor device the file is created on
+ * @format: layout of the data
+ * @chip_id: chip ID of the sensor
+ * @otp_start: first register the data was read from, 0 if banked
+ * @size: bytes of data read, at most the @max_size allocated
+ */
+static inline int sensor_calib_publish(struct sensor_calib *calib,
+				       struct device *dev,
+				       enum sensor_calib_format format,
+				       u32 chip_id, u16 otp_start, size_t size)
+{
+	struct sensor_calib_header *hdr = calib->buf;
+	int ret;
+
+	if (WARN_ON(!calib->buf ||
+		    sizeof(*hdr) + size > calib->size))
+		return -EINVAL;
+
+	hdr->version = SENSOR_CALIB_VERSION;
+	hdr->format = format;
+	hdr->header_size = cpu_to_le16(sizeof(*hdr));
+	hdr->chip_id = cpu_to_le32(chip_id);
+	hdr->data_size = cpu_to_le32(size);
+	hdr->otp_start = cpu_to_le16(otp_start);
+	hdr->data_crc32 = cpu_to_le32(crc32_le(~0, sensor_calib_data(calib),
+					       size) ^ ~0);
+
+	sysfs_bin_attr_init(&calib->attr);
+	calib->attr.attr.name = "calibration";
+	calib->attr.attr.mode = 0444;
+	calib->attr.size = sizeof(*hdr) + size;
+	calib->attr.private = calib;
+	calib->attr.read = sensor_calib_read;
+	calib->attr.mmap = sensor_calib_mmap;
+
+	ret = sysfs_create_bin_file(&dev->kobj, &calib->attr);
+	if (ret)
+		return ret;
+
+	calib->published = true;
+
+	return 0;
+}
+
+/* Remove the file and free the blob, also if it was never published */
+static inline void sensor_calib_free(struct sensor_calib *calib,
+				     struct device *dev)
+{
+	if (calib->published)
+		sysfs_remove_bin_file(&dev->kobj, &calib->attr);
+	calib->published = false;
+
+	if (calib->buf)
+		free_pages_exact(calib->buf, calib->size);
+	calib->buf = NULL;
+}
+
+#endif /* __SENSOR_CALIB_H__ */
@@ -0,0 +1,570 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Lookup of the INT3472 PMIC a sensor depends on, with the result cached
+ * per sensor ACPI device so that reprobes don't walk _DEP again. What the
+ * drivers found identifying the sensors is cached the same way.
+ *
+ * The power GPIOs in the _CRS of the PMIC and the runtime PM reference a
+ * stream holds are handled here for all drivers too.
+ *
+ * The sensors behind one PMIC device can also start streaming together,
+ * see sensor_sync_arm(). On the Surface models all cameras resolve to the
+ * same PMIC device, so the front, rear and IR sensors form one group.
+ *
+ * This module also defines the trace events of sensor_trace.h.
+ */
+
+#include <linux/acpi.h>
+#include <linux/bitmap.h>
+#include <linux/device.h>
+#include <linux/gpio/consumer.h>
+#include <linux/list.h>
+#include <linux/module.h>
+#include <linux/mutex.h>
+#include <linux/pm_runtime.h>
+#include <linux/slab.h>
+#include <linux/workqueue.h>
+#include <media/v4l2-subdev.h>
+
+#include "sensor_dep.h"
+
+#define CREATE_TRACE_POINTS
+#include "sensor_trace.h"
+
+EXPORT_TRACEPOINT_SYMBOL_GPL(sensor_stage_begin);
+EXPORT_TRACEPOINT_SYMBOL_GPL(sensor_stage_end);
+
+struct sensor_dep {
+	struct list_head list;
+	acpi_handle sensor_handle;
+	struct device *dep_dev;		/* reference held */
+};
+
+struct sensor_ident_entry {
+	struct list_head list;
+	acpi_handle sensor_handle;
+	struct sensor_ident ident;
+};
+
+/* Protects both caches */
+static LIST_HEAD(sensor_dep_cache);
+static LIST_HEAD(sensor_ident_cache);
+static DEFINE_MUTEX(sensor_dep_lock);
+
+static bool sync_start;
+module_param(sync_start, bool, 0644);
+MODULE_PARM_DESC(sync_start,
+		 "Start the sensors on one PMIC together (default: off)");
+
+static unsigned int sync_timeout_ms = 200;
+module_param(sync_timeout_ms, uint, 0644);
+MODULE_PARM_DESC(sync_timeout_ms,
+		 "Time a synchronized start waits for the other sensors");
+
+struct sensor_sync_group {
+	struct list_head list;
+	struct device *dep_dev;
+	struct list_head members;
+	/* Starts the armed members, on timeout or once all are armed */
+	struct delayed_work release_work;
+	/* A member is armed and the others were asked to prepare */
+	bool gathering;
+};
+
+/* Protects the groups and their members */
+static LIST_HEAD(sensor_sync_groups);
+static DEFINE_MUTEX(sensor_sync_lock);
+
+/* Get acpi_device of dependent INT3472 device */
+static struct acpi_device *get_dep_adev(struct device *dev,
+					acpi_handle dev_handle)
+{
+	struct acpi_handle_list dep_devices;
+	struct acpi_device *dep_adev = NULL;
+	acpi_status status;
+	const char *dep_hid = "INT3472";
+	int i;
+
+	if (!acpi_has_method(dev_handle, "_DEP")) {
+		dev_err(dev, "No _DEP entry found\n");
+		return ERR_PTR(-ENODEV);
+	}
+
+	status = acpi_evaluate_reference(dev_handle, "_DEP", NULL, &dep_devices);
+	if (ACPI_FAILURE(status)) {
+		dev_err(dev, "Failed to evaluate _DEP.\n");
+		return ERR_PTR(-ENODEV);
+	}
+
+	for (i = 0; i < dep_devices.count; i++) {
+		struct acpi_device_info *info;
+		int match;
+
+		status = acpi_get_object_info(dep_devices.handles[i], &info);
+		if (ACPI_FAILURE(status)) {
+			dev_dbg(dev,
+				"Error reading _DEP device info, continue next\n");
+			continue;
+		}
+
+		match = info->valid & ACPI_VALID_HID &&
+			!strcmp(info->hardware_id.string, dep_hid);
+
+		kfree(info);
+
+		if (!match)
+			continue;
+
+		if (acpi_bus_get_device(dep_devices.handles[i], &dep_adev)) {
+			dev_err(dev, "Error getting dependent ACPI device\n");
+			return ERR_PTR(-ENODEV);
+		}
+
+		/* found acpi_device of dependent device */
+		break;
+	}
+
+	if (!dep_adev) {
+		dev_err(dev, "Dependent ACPI device not found\n");
+		return ERR_PTR(-ENODEV);
+	}
+
+	dev_info(dev, "Dependent ACPI device found: %s\n",
+		 dev_name(&dep_adev->dev));
+
+	return dep_adev;
+}
+
+/* Get dependent INT3472 device */
+static struct device *get_dep_dev(struct device *dev, acpi_handle dev_handle)
+{
+	struct acpi_device *dep_adev;
+	struct acpi_device_physical_node *dep_phys;
+
+	dep_adev = get_dep_adev(dev, dev_handle);
+	if (IS_ERR(dep_adev)) {
+		dev_err(dev, "get_dep_adev() failed\n");
+		return ERR_CAST(dep_adev);
+	}
+
+	/*
+	 * HACK: We know that the PMIC is a "discrete" PMIC, an ACPI device
+	 * that just serves as a container to list system GPIOs.
+	 *
+	 * The ACPI device has no fwnode, nor does it have a platform device.
+	 * This prevents fetching GPIOs. It however seems to be backed by the
+	 * PCI root complex (pci0000:00/0000:00:00.0) as its physical device,
+	 * and that device has its fwnode set to \_SB.PCI0.DSC1. Whether this
+	 * is correct or not is unknown, let's just get the physical device and
+	 * move on for now.
+	 *
+	 * (@kitakar5525)This is observed on Microsoft Surface Go series
+	 * and Acer Switch Alpha 12.
+	 */
+	dep_phys = list_first_entry_or_null(&dep_adev->physical_node_list,
+					    struct acpi_device_physical_node,
+					    node);
+	if (!dep_phys) {
+		dev_info(dev,
+			 "Error getting physical node of dependent device\n");
+		return ERR_PTR(-ENODEV);
+	}
+
+	dev_info(dev, "Dependent device found: %s\n", dev_name(dep_phys->dev));
+
+	return dep_phys->dev;
+}
+
+struct device *sensor_dep_get_dev(struct device *dev, const char *hid)
+{
+	struct acpi_device *sensor_adev;
+	struct device *dep_dev;
+	struct sensor_dep *entry;
+	acpi_handle handle;
+
+	if (sensor_dep_is_mock(dev))
+		return NULL;
+
+	if (ACPI_COMPANION(dev)) {
+		handle = ACPI_HANDLE(dev);
+	} else {
+		sensor_adev = acpi_dev_get_first_match_dev(hid, NULL, -1);
+		if (!sensor_adev) {
+			dev_err(dev, "Couldn't get sensor ACPI device\n");
+			return ERR_PTR(-ENODEV);
+		}
+		handle = sensor_adev->handle;
+		acpi_dev_put(sensor_adev);
+	}
+
+	mutex_lock(&sensor_dep_lock);
+
+	list_for_each_entry(entry, &sensor_dep_cache, list) {
+		if (entry->sensor_handle == handle) {
+			dep_dev = entry->dep_dev;
+			dev_dbg(dev, "Dependent device cached: %s\n",
+				dev_name(dep_dev));
+			goto out_unlock;
+		}
+	}
+
+	/* Failures are not cached, the PMIC may show up later */
+	dep_dev = get_dep_dev(dev, handle);
+	if (IS_ERR(dep_dev))
+		goto out_unlock;
+
+	entry = kzalloc(sizeof(*entry), GFP_KERNEL);
+	if (!entry) {
+		dep_dev = ERR_PTR(-ENOMEM);
+		goto out_unlock;
+	}
+
+	entry->sensor_handle = handle;
+	entry->dep_dev = get_device(dep_dev);
+	list_add(&entry->list, &sensor_dep_cache);
+
+out_unlock:
+	mutex_unlock(&sensor_dep_lock);
+
+	return dep_dev;
+}
+EXPORT_SYMBOL_GPL(sensor_dep_get_dev);
+
+static struct sensor_ident_entry *sensor_ident_find(acpi_handle handle)
+{
+	struct sensor_ident_entry *entry;
+
+	list_for_each_entry(entry, &sensor_ident_cache, list)
+		if (entry->sensor_handle == handle)
+			return entry;
+
+	return NULL;
+}
+
+bool sensor_ident_get(struct device *dev, struct sensor_ident *ident)
+{
+	acpi_handle handle = ACPI_HANDLE(dev);
+	struct sensor_ident_entry *entry;
+
+	if (!handle)
+		return false;
+
+	mutex_lock(&sensor_dep_lock);
+	entry = sensor_ident_find(handle);
+	if (entry)
+		*ident = entry->ident;
+	mutex_unlock(&sensor_dep_lock);
+
+	return entry;
+}
+EXPORT_SYMBOL_GPL(sensor_ident_get);
+
+void sensor_ident_set(struct device *dev, const struct sensor_ident *ident)
+{
+	acpi_handle handle = ACPI_HANDLE(dev);
+	struct sensor_ident_entry *entry;
+
+	if (!handle)
+		return;
+
+	mutex_lock(&sensor_dep_lock);
+
+	entry = sensor_ident_find(handle);
+	if (!entry) {
+		/* Not cached on failure, the next probe identifies again */
+		entry = kzalloc(sizeof(*entry), GFP_KERNEL);
+		if (!entry)
+			goto out_unlock;
+
+		entry->sensor_handle = handle;
+		list_add(&entry->list, &sensor_ident_cache);
+	}
+	entry->ident = *ident;
+
+out_unlock:
+	mutex_unlock(&sensor_dep_lock);
+}
+EXPORT_SYMBOL_GPL(sensor_ident_set);
+
+int sensor_gpios_get(struct sensor_gpios *gpios, struct device *dep_dev,
+		     bool optional)
+{
+	struct gpio_descs *descs;
+
+	gpios->descs = NULL;
+	gpios->values = NULL;
+	gpios->on = -1;
+
+	/* No PMIC on the sensor_mock adapter, see sensor_dep_get_dev() */
+	if (!dep_dev)
+		return 0;
+
+	/*
+	 * Not devm: the GPIOs belong to the PMIC device, which outlives the
+	 * sensor driver binding.
+	 */
+	descs = optional ? gpiod_get_array_optional(dep_dev, NULL, GPIOD_ASIS) :
+			   gpiod_get_array(dep_dev, NULL, GPIOD_ASIS);
+	if (IS_ERR(descs)) {
+		dev_err(dep_dev, "Failed to get GPIOs\n");
+		return -ENODEV;
+	}
+	if (!descs)
+		return 0;
+
+	/* Allocated once here, not on every power up and down */
+	gpios->values = bitmap_zalloc(descs->ndescs, GFP_KERNEL);
+	if (!gpios->values) {
+		gpiod_put_array(descs);
+		return -ENOMEM;
+	}
+	gpios->descs = descs;
+
+	return 0;
+}
+EXPORT_SYMBOL_GPL(sensor_gpios_get);
+
+void sensor_gpios_put(struct sensor_gpios *gpios)
+{
+	if (!gpios->descs)
+		return;
+
+	gpiod_put_array(gpios->descs);
+	bitmap_free(gpios->values);
+	gpios->descs = NULL;
+	gpios->values = NULL;
+}
+EXPORT_SYMBOL_GPL(sensor_gpios_put);
+
+int sensor_gpios_set(struct sensor_gpios *gpios, bool on)
+{
+	struct gpio_descs *d = gpios->descs;
+	int ret;
+
+	if (!d || gpios->on == on)
+		return 0;
+
+	if (on)
+		bitmap_fill(gpios->values, d->ndescs);
+	else
+		bitmap_zero(gpios->values, d->ndescs);
+
+	ret = gpiod_set_array_value_cansleep(d->ndescs, d->desc, d->info,
+					     gpios->values);
+	gpios->on = ret ? -1 : on;
+
+	return ret;
+}
+EXPORT_SYMBOL_GPL(sensor_gpios_set);
+
+int sensor_pm_get(struct v4l2_subdev *sd)
+{
+	int ret;
+
+	if (!pm_runtime_enabled(sd->dev))
+		return v4l2_subdev_call(sd, core, s_power, 1);
+
+	ret = pm_runtime_get_sync(sd->dev);
+	if (ret < 0) {
+		pm_runtime_put_noidle(sd->dev);
+		return ret;
+	}
+
+	return 0;
+}
+EXPORT_SYMBOL_GPL(sensor_pm_get);
+
+void sensor_pm_put(struct v4l2_subdev *sd)
+{
+	if (!pm_runtime_enabled(sd->dev)) {
+		v4l2_subdev_call(sd, core, s_power, 0);
+		return;
+	}
+
+	pm_runtime_mark_last_busy(sd->dev);
+	pm_runtime_put_autosuspend(sd->dev);
+}
+EXPORT_SYMBOL_GPL(sensor_pm_put);
+
+static void sensor_sync_prepare_work(struct work_struct *work)
+{
+	struct sensor_sync *sync = container_of(work, struct sensor_sync,
+						prepare_work);
+	int ret;
+
+	ret = sync->ops->prepare(sync);
+	if (ret)
+		dev_warn(sync->dev, "sync: prepare failed: %d\n", ret);
+}
+
+static void sensor_sync_release_work(struct work_struct *work)
+{
+	struct sensor_sync_group *group =
+		container_of(work, struct sensor_sync_group, release_work.work);
+	struct sensor_sync *sync, *tmp;
+	LIST_HEAD(start);
+
+	mutex_lock(&sensor_sync_lock);
+	list_for_each_entry(sync, &group->members, list) {
+		if (!sync->armed)
+			continue;
+		sync->armed = false;
+		sync->streaming = true;
+		list_add_tail(&sync->start_list, &start);
+	}
+	group->gathering = false;
+	mutex_unlock(&sensor_sync_lock);
+
+	/*
+	 * The start callbacks take the driver locks, which are held around
+	 * sensor_sync_arm(), so call them unlocked. sensor_sync_remove()
+	 * flushes this work before a member goes away.
+	 */
+	list_for_each_entry_safe(sync, tmp, &start, start_list) {
+		list_del(&sync->start_list);
+		sync->ops->start(sync);
+	}
+}
+
+int sensor_sync_add(struct sensor_sync *sync, struct device *dep_dev)
+{
+	struct sensor_sync_group *group;
+
+	INIT_LIST_HEAD(&sync->start_list);
+	INIT_WORK(&sync->prepare_work, sensor_sync_prepare_work);
+	sync->armed = false;
+	sync->streaming = false;
+
+	mutex_lock(&sensor_sync_lock);
+
+	list_for_each_entry(group, &sensor_sync_groups, list)
+		if (group->dep_dev == dep_dev)
+			goto found;
+
+	group = kzalloc(sizeof(*group), GFP_KERNEL);
+	if (!group) {
+		mutex_unlock(&sensor_sync_lock);
+		return -ENOMEM;
+	}
+
+	group->dep_dev = dep_dev;
+	INIT_LIST_HEAD(&group->members);
+	INIT_DELAYED_WORK(&group->release_work, sensor_sync_release_work);
+	list_add(&group->list, &sensor_sync_groups);
+
+found:
+	sync->group = group;
+	list_add_tail(&sync->list, &group->members);
+	mutex_unlock(&sensor_sync_lock);
+
+	return 0;
+}
+EXPORT_SYMBOL_GPL(sensor_sync_add);
+
+void sensor_sync_remove(struct sensor_sync *sync)
+{
+	struct sensor_sync_group *group = sync->group;
+	bool empty;
+
+	if (!group)
+		return;
+
+	mutex_lock(&sensor_sync_lock);
+	list_del(&sync->list);
+	empty = list_empty(&group->members);
+	if (empty)
+		list_del(&group->list);
+	mutex_unlock(&sensor_sync_lock);
+
+	cancel_work_sync(&sync->prepare_work);
+
+	/* The worker may have picked @sync before it left the list */
+	if (empty) {
+		cancel_delayed_work_sync(&group->release_work);
+		kfree(group);
+	} else {
+		flush_delayed_work(&group->release_work);
+	}
+
+	sync->group = NULL;
+}
+EXPORT_SYMBOL_GPL(sensor_sync_remove);
+
+bool sensor_sync_arm(struct sensor_sync *sync)
+{
+	struct sensor_sync_group *group = sync->group;
+	struct sensor_sync *other;
+	bool first, ready = true;
+
+	if (!group)
+		return false;
+
+	mutex_lock(&sensor_sync_lock);
+
+	if (!sync_start || list_is_singular(&group->members)) {
+		sync->streaming = true;
+		mutex_unlock(&sensor_sync_lock);
+		return false;
+	}
+
+	first = !group->gathering;
+	group->gathering = true;
+	sync->armed = true;
+
+	/* Wait for the members that don't stream yet */
+	list_for_each_entry(other, &group->members, list) {
+		if (other->armed || other->streaming)
+			continue;
+
+		ready = false;
+		if (first && other->ops->prepare)
+			queue_work(system_unbound_wq, &other->prepare_work);
+	}
+
+	if (ready)
+		mod_delayed_work(system_highpri_wq, &group->release_work, 0);
+	else if (first)
+		queue_delayed_work(system_highpri_wq, &group->release_work,
+				   msecs_to_jiffies(sync_timeout_ms));
+
+	mutex_unlock(&sensor_sync_lock);
+
+	dev_dbg(sync->dev, "sync: stream on deferred%s\n",
+		ready ? ", group ready" : "");
+
+	return true;
+}
+EXPORT_SYMBOL_GPL(sensor_sync_arm);
+
+void sensor_sync_disarm(struct sensor_sync *sync)
+{
+	if (!sync->group)
+		return;
+
+	mutex_lock(&sensor_sync_lock);
+	sync->armed = false;
+	sync->streaming = false;
+	mutex_unlock(&sensor_sync_lock);
+}
+EXPORT_SYMBOL_GPL(sensor_sync_disarm);
+
+static void __exit sensor_dep_exit(void)
+{
+	struct sensor_ident_entry *ident, *ident_tmp;
+	struct sensor_dep *entry, *tmp;
+
+	list_for_each_entry_safe(entry, tmp, &sensor_dep_cache, list) {
+		list_del(&entry->list);
+		put_device(entry->dep_dev);
+		kfree(entry);
+	}
+
+	list_for_each_entry_safe(ident, ident_tmp, &sensor_ident_cache, list) {
+		list_del(&ident->list);
+		kfree(ident);
+	}
+}
+module_exit(sensor_dep_exit);
+
+MODULE_DESCRIPTION("INT3472 lookup, power and stream sync for IPU3 sensors");
+MODULE_LICENSE("GPL v2");
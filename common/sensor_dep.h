@@ -0,0 +1,201 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/*
+ * Lookup of the INT3472 PMIC a sensor depends on, its power GPIOs, the
+ * runtime PM of the stream, and synchronized stream start of the sensors
+ * behind the PMIC, shared by the sensor drivers in this tree. Built as the
+ * separate sensor_dep module, see common/Makefile.
+ */
+
+#ifndef __SENSOR_DEP_H__
+#define __SENSOR_DEP_H__
+
+#include <linux/gpio/consumer.h>
+#include <linux/i2c.h>
+#include <linux/list.h>
+#include <linux/string.h>
+#include <linux/workqueue.h>
+
+/* Name of the simulated adapters of the sensor_mock module */
+#define SENSOR_MOCK_ADAPTER_NAME	"sensor-mock"
+
+/* True if @dev is an i2c client on a sensor_mock adapter */
+static inline bool sensor_dep_is_mock(struct device *dev)
+{
+	struct i2c_client *client = i2c_verify_client(dev);
+
+	return client &&
+	       !strcmp(client->adapter->name, SENSOR_MOCK_ADAPTER_NAME);
+}
+
+/**
+ * sensor_dep_get_dev - get the physical device of the INT3472 PMIC
+ * @dev: sensor device
+ * @hid: ACPI HID of the sensor, used if @dev has no ACPI companion
+ *
+ * The sensor's _DEP is only walked the first time, the result is cached
+ * per sensor ACPI device until the sensor_dep module is unloaded.
+ *
+ * Returns the PMIC device or an ERR_PTR(). The cache holds a reference on
+ * the device, the caller doesn't need to put it. Sensors on a sensor_mock
+ * adapter have no PMIC, NULL is returned for them.
+ */
+struct device *sensor_dep_get_dev(struct device *dev, const char *hid);
+
+/**
+ * struct sensor_ident - what identifying a sensor found
+ * @chip_id: chip ID read from the sensor
+ * @revision: silicon revision, 0 if the driver doesn't read it
+ * @data: driver specific, e.g. the VCM found next to the sensor
+ */
+struct sensor_ident {
+	u32 chip_id;
+	u32 revision;
+	u32 data;
+};
+
+/**
+ * sensor_ident_get - look up a sensor identified since boot
+ * @dev: sensor device
+ * @ident: filled in if found
+ *
+ * The cache is kept by the sensor_dep module, per sensor ACPI device, so
+ * it outlives reprobes and reloads of the sensor driver. The power up
+ * wait still checks the chip ID, see sensor_power.h, so a different
+ * module on the same ACPI device can't be mistaken for the cached one.
+ *
+ * Returns true if @ident was filled in. Sensors without an ACPI device,
+ * such as those of sensor_mock, are never cached.
+ */
+bool sensor_ident_get(struct device *dev, struct sensor_ident *ident);
+
+/* Record what identifying @dev found, for sensor_ident_get() */
+void sensor_ident_set(struct device *dev, const struct sensor_ident *ident);
+
+/**
+ * struct sensor_gpios - power GPIOs in the _CRS of the PMIC
+ * @descs: the GPIOs, NULL if there are none
+ * @values: one bit per GPIO, the levels last set
+ * @on: state last set, -1 if not set since sensor_gpios_get()
+ */
+struct sensor_gpios {
+	struct gpio_descs *descs;
+	unsigned long *values;
+	int on;
+};
+
+/**
+ * sensor_gpios_get - get the power GPIOs of a sensor
+ * @gpios: filled in
+ * @dep_dev: PMIC device from sensor_dep_get_dev(), may be NULL
+ * @optional: a PMIC without GPIOs isn't an error
+ *
+ * The GPIOs are left as they are. A NULL @dep_dev, as for sensor_mock
+ * sensors, has no GPIOs. Release them with sensor_gpios_put().
+ */
+int sensor_gpios_get(struct sensor_gpios *gpios, struct device *dep_dev,
+		     bool optional);
+
+void sensor_gpios_put(struct sensor_gpios *gpios);
+
+/**
+ * sensor_gpios_set - drive all power GPIOs high or low
+ * @gpios: from sensor_gpios_get()
+ * @on: high if true
+ *
+ * The GPIOs are set in one call, and not at all if they are already at
+ * @on. Returns 0 or a negative error.
+ */
+int sensor_gpios_set(struct sensor_gpios *gpios, bool on);
+
+struct v4l2_subdev;
+
+/**
+ * sensor_pm_get - power the sensor up for streaming
+ * @sd: subdev of the sensor
+ *
+ * Takes a runtime PM reference on the sensor device, or without runtime
+ * PM calls the subdev s_power(1). If the sensor is still in its
+ * autosuspend delay from the last stream, it stays powered as it is.
+ */
+int sensor_pm_get(struct v4l2_subdev *sd);
+
+/*
+ * Release the power taken by sensor_pm_get(). With runtime PM the sensor
+ * stays powered, its mode loaded, for the autosuspend delay.
+ */
+void sensor_pm_put(struct v4l2_subdev *sd);
+
+struct sensor_sync;
+struct sensor_sync_group;
+
+/**
+ * struct sensor_sync_ops - driver side of a synchronized stream start
+ * @prepare: power up and load the current mode, but don't stream. Called
+ *	from a worker, in parallel for the sensors of a group, when another
+ *	sensor of the group starts streaming. Optional.
+ * @start: write the stream on register if the driver still streams. Called
+ *	from the group's worker without any driver lock held.
+ */
+struct sensor_sync_ops {
+	int (*prepare)(struct sensor_sync *sync);
+	void (*start)(struct sensor_sync *sync);
+};
+
+/**
+ * struct sensor_sync - a sensor in a group started together
+ * @dev: sensor device
+ * @ops: driver callbacks
+ * @group: sensors on the same PMIC device
+ * @list: entry in the group
+ * @start_list: entry in the sensors started by the group's worker
+ * @prepare_work: runs @ops->prepare
+ * @armed: stream on requested, waiting for the rest of the group
+ * @streaming: started, not waited for by the next stream on in the group
+ *
+ * Embedded in the driver's state, everything but @dev and @ops is set by
+ * sensor_sync_add(), and protected by the sensor_dep module.
+ */
+struct sensor_sync {
+	struct device *dev;
+	const struct sensor_sync_ops *ops;
+	struct sensor_sync_group *group;
+	struct list_head list;
+	struct list_head start_list;
+	struct work_struct prepare_work;
+	bool armed;
+	bool streaming;
+};
+
+/**
+ * sensor_sync_add - join the start group of a PMIC
+ * @sync: sensor, @dev and @ops set
+ * @dep_dev: PMIC device from sensor_dep_get_dev(), may be NULL
+ *
+ * Call before the subdev is registered, it may be streamed as soon as it
+ * is. Sensors with the same @dep_dev are in the same group. A NULL
+ * @dep_dev, as for sensor_mock sensors, is a group of its own too.
+ */
+int sensor_sync_add(struct sensor_sync *sync, struct device *dep_dev);
+
+/* Leave the group, call once streaming is stopped for good */
+void sensor_sync_remove(struct sensor_sync *sync);
+
+/**
+ * sensor_sync_arm - request stream on
+ * @sync: sensor, mode loaded and controls set
+ *
+ * With the sync_start parameter of sensor_dep set and other sensors in the
+ * group, the stream on is deferred: the first sensor of the group to arm
+ * has the others prepared in parallel, and once all of them are armed, or
+ * sync_timeout_ms after the first one, ops->start() is called for every
+ * armed sensor back to back.
+ *
+ * Returns true if the stream on was deferred, false if the driver must
+ * write it itself.
+ */
+bool sensor_sync_arm(struct sensor_sync *sync);
+
+/* Stream off: cancel a deferred stream on */
+void sensor_sync_disarm(struct sensor_sync *sync);
+
+#endif /* __SENSOR_DEP_H__ */
@@ -0,0 +1,194 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/*
+ * CSI-2 link budget of the sensor modes.
+ *
+ * A mode sends one line of active pixels per line period, so it needs
+ * width * bpp bits, plus the packet header and footer and the HS sync and
+ * trail, pixel rate / HTS times per second on the link. A link carries
+ * two bits per link frequency cycle on each data lane. The lanes are the
+ * ones wired to the receiver: the fwnode endpoint on DT, the SSDB
+ * lanes_used on the ACPI machines, where the sensor drivers probe before
+ * the bridge creates the endpoints.
+ *
+ * The link frequencies of a driver, each with its PLL setting, are the
+ * V4L2_CID_LINK_FREQ menu. For a mode, the lowest frequency that carries
+ * it is selected, the others that do are left in the menu, and those that
+ * don't are skipped. A mode no frequency carries isn't offered. Drivers
+ * with more than one frequency grab the control while streaming.
+ *
+ * Usage:
+ *	link->freqs = ov1234_link_freqs;
+ *	link->num_freqs = ARRAY_SIZE(ov1234_link_freqs);
+ *	link->lanes = sensor_link_lanes(dev, &sensor->ep, OV1234_MAX_LANES);
+ *	...
+ *	bps = sensor_link_bps(mode->width, 10, pixel_rate, mode->hts);
+ *	if (sensor_link_select(link, bps, NULL) < 0)
+ *		... skip the mode ...
+ *	...
+ *	index = sensor_link_apply(link, sensor->link_freq, bps);
+ */
+
+#ifndef __SENSOR_LINK_H__
+#define __SENSOR_LINK_H__
+
+#include <linux/acpi.h>
+#include <linux/bits.h>
+#include <linux/device.h>
+#include <linux/errno.h>
+#include <linux/math64.h>
+#include <linux/slab.h>
+#include <linux/types.h>
+#include <media/v4l2-ctrls.h>
+#include <media/v4l2-fwnode.h>
+
+/* Bits of a line besides its pixels: packet header, footer, HS sync */
+#define SENSOR_LINK_LINE_BITS		64
+
+/* Offset of lanes_used in the SSDB buffer of an IPU3 sensor */
+#define SENSOR_LINK_SSDB_LANES		29
+
+/**
+ * struct sensor_link - link frequencies a sensor can run at
+ * @freqs: link frequencies in Hz, the V4L2_CID_LINK_FREQ menu
+ * @num_freqs: entries in @freqs, at most 64
+ * @lanes: data lanes in use, from sensor_link_lanes()
+ */
+struct sensor_link {
+	const s64 *freqs;
+	unsigned int num_freqs;
+	unsigned int lanes;
+};
+
+#ifdef CONFIG_ACPI
+/* lanes_used of the SSDB of @dev, 0 if the firmware has no SSDB */
+static inline unsigned int sensor_link_acpi_lanes(struct device *dev)
+{
+	struct acpi_buffer buffer = { ACPI_ALLOCATE_BUFFER, NULL };
+	struct acpi_device *adev = ACPI_COMPANION(dev);
+	union acpi_object *obj;
+	unsigned int lanes = 0;
+	acpi_status status;
+
+	if (!adev)
+		return 0;
+
+	status = acpi_evaluate_object(adev->handle, "SSDB", NULL, &buffer);
+	if (ACPI_FAILURE(status))
+		return 0;
+
+	obj = buffer.pointer;
+	if (obj && obj->type == ACPI_TYPE_BUFFER &&
+	    obj->buffer.length > SENSOR_LINK_SSDB_LANES)
+		lanes = obj->buffer.pointer[SENSOR_LINK_SSDB_LANES];
+
+	kfree(buffer.pointer);
+
+	return lanes;
+}
+#else
+static inline unsigned int sensor_link_acpi_lanes(struct device *dev)
+{
+	return 0;
+}
+#endif
+
+/**
+ * sensor_link_lanes - data lanes wired from the sensor to the receiver
+ * @dev: sensor device
+ * @ep: parsed endpoint, or NULL if the driver didn't parse one
+ * @max: most lanes the driver drives
+ *
+ * Returns at most @max, and @max if the firmware doesn't tell, as on the
+ * sensor_mock adapters.
+ */
+static inline unsigned int sensor_link_lanes(struct device *dev,
+					     const struct v4l2_fwnode_endpoint *ep,
+					     unsigned int max)
+{
+	unsigned int lanes = 0;
+
+	if (ep && ep->bus_type == V4L2_MBUS_CSI2_DPHY)
+		lanes = ep->bus.mipi_csi2.num_data_lanes;
+	if (!lanes)
+		lanes = sensor_link_acpi_lanes(dev);
+	if (!lanes || lanes > max)
+		lanes = max;
+
+	return lanes;
+}
+
+/* Bits per second of lines of @width pixels of @bpp bits, HTS @hts */
+static inline u64 sensor_link_bps(u32 width, u32 bpp, u64 pixel_rate, u32 hts)
+{
+	return div_u64(((u64)width * bpp + SENSOR_LINK_LINE_BITS) * pixel_rate,
+		       hts);
+}
+
+/* Bits per second @link carries at frequency @index */
+static inline u64 sensor_link_capacity(const struct sensor_link *link,
+				       unsigned int index)
+{
+	return (u64)link->freqs[index] * 2 * link->lanes;
+}
+
+/**
+ * sensor_link_select - lowest link frequency that carries a mode
+ * @link: link of the sensor
+ * @bps: bits per second of the mode, from sensor_link_bps()
+ * @usable: if not NULL, set to the mask of the frequencies that carry it
+ *
+ * Returns the index in @link->freqs, -ERANGE if none carries the mode.
+ */
+static inline int sensor_link_select(const struct sensor_link *link,
+				     u64 bps, u64 *usable)
+{
+	u64 mask = 0;
+	int index = -ERANGE;
+	unsigned int i;
+
+	for (i = 0; i < link->num_freqs; i++) {
+		if (sensor_link_capacity(link, i) < bps)
+			continue;
+
+		mask |= BIT_ULL(i);
+		if (index < 0 || link->freqs[i] < link->freqs[index])
+			index = i;
+	}
+
+	if (usable)
+		*usable = mask;
+
+	return index;
+}
+
+/**
+ * sensor_link_apply - set the link frequency control for a mode
+ * @link: link of the sensor
+ * @ctrl: V4L2_CID_LINK_FREQ menu of @link->freqs
+ * @bps: bits per second of the mode
+ *
+ * Selects the lowest frequency that carries @bps, and skips those that
+ * don't in the menu. Called with the control handler lock held.
+ *
+ * Returns the index selected, or a negative error.
+ */
+static inline int sensor_link_apply(const struct sensor_link *link,
+				    struct v4l2_ctrl *ctrl, u64 bps)
+{
+	u64 usable;
+	int index;
+	int ret;
+
+	index = sensor_link_select(link, bps, &usable);
+	if (index < 0)
+		return index;
+
+	ret = __v4l2_ctrl_modify_range(ctrl, 0, link->num_freqs - 1, ~usable,
+				       index);
+	if (!ret)
+		ret = __v4l2_ctrl_s_ctrl(ctrl, index);
+
+	return ret < 0 ? ret : index;
+}
+
+#endif /* __SENSOR_LINK_H__ */
@@ -0,0 +1,298 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/*
+ * Per-frame metadata of the sensor drivers in this tree.
+ *
+ * The CSI-2 receiver on these machines (ipu3-cio2) doesn't capture
+ * embedded data lines, so the exposure, gain and VTS a frame was taken
+ * with can't be read back from the frame itself. Instead, the control
+ * writes are logged here with their CLOCK_MONOTONIC time, and take effect
+ * @delay frames after the frame they were written in, which is when the
+ * sensor latches them: at the @delay-th start of frame after the write.
+ *
+ * The sensor driver doesn't see the frames, the receiver does: ipu3-cio2
+ * sends V4L2_EVENT_FRAME_SYNC at each start of frame and timestamps the
+ * buffers with it. Userspace passes those on by writing
+ *
+ *	"<sequence> <timestamp us>"
+ *
+ * to /sys/kernel/debug/<i2c device>/frame_meta for each frame, in order.
+ * The frame is recorded under the receiver's sequence number, with the
+ * values in effect at that start of frame, and reading the file lists the
+ * last frames recorded.
+ *
+ * Usage:
+ *	sensor_meta_init(&meta, OV1234_CTRL_DELAY_FRAMES);
+ *	...
+ *	sensor_meta_start(&meta, exposure, gain, vts);
+ *	sensor_meta_queue(&meta, SENSOR_META_EXPOSURE, val);
+ *	sensor_meta_stop(&meta);
+ */
+
+#ifndef __SENSOR_META_H__
+#define __SENSOR_META_H__
+
+#include <linux/debugfs.h>
+#include <linux/kernel.h>
+#include <linux/ktime.h>
+#include <linux/seq_file.h>
+#include <linux/spinlock.h>
+#include <linux/string.h>
+#include <linux/types.h>
+#include <linux/uaccess.h>
+
+/* Control writes waiting for their frame, the oldest is applied first */
+#define SENSOR_META_PENDING	8
+/* Frames kept for debugfs */
+#define SENSOR_META_HISTORY	8
+
+enum sensor_meta_field {
+	SENSOR_META_EXPOSURE,
+	SENSOR_META_GAIN,
+	SENSOR_META_VTS,
+};
+
+struct sensor_meta_frame {
+	u32 sequence;		/* receiver's frame sequence */
+	u32 exposure;
+	u32 gain;
+	u32 vts;		/* 0 if the driver doesn't know it */
+	ktime_t timestamp;	/* receiver's start of frame */
+};
+
+struct sensor_meta_write {
+	ktime_t timestamp;	/* when the value was written */
+	unsigned int frames;	/* starts of frame still to come */
+	enum sensor_meta_field field;
+	u32 value;
+};
+
+struct sensor_meta {
+	/* Frames between a control write and the frame it applies to */
+	unsigned int delay;
+
+	/* Protects everything below */
+	spinlock_t lock;
+	bool streaming;
+	/* A frame was recorded since stream on, last at cur.sequence */
+	bool started;
+	struct sensor_meta_frame cur;
+	struct sensor_meta_write pending[SENSOR_META_PENDING];
+	unsigned int n_pending;
+	struct sensor_meta_frame history[SENSOR_META_HISTORY];
+	unsigned int n_history;
+};
+
+static inline void sensor_meta_set(struct sensor_meta *meta,
+				   enum sensor_meta_field field, u32 value)
+{
+	switch (field) {
+	case SENSOR_META_EXPOSURE:
+		meta->cur.exposure = value;
+		break;
+	case SENSOR_META_GAIN:
+		meta->cur.gain = value;
+		break;
+	case SENSOR_META_VTS:
+		meta->cur.vts = value;
+		break;
+	}
+}
+
+/* Start of frame @sequence at @timestamp, called with the lock held */
+static inline void sensor_meta_frame_start(struct sensor_meta *meta,
+					   u32 sequence, ktime_t timestamp)
+{
+	unsigned int i, n = 0, frames = 1;
+
+	/* Frames not passed on still latched the writes before them */
+	if (meta->started && (s32)(sequence - meta->cur.sequence) > 1)
+		frames = sequence - meta->cur.sequence;
+
+	for (i = 0; i < meta->n_pending; i++) {
+		struct sensor_meta_write *w = &meta->pending[i];
+
+		if (ktime_after(timestamp, w->timestamp))
+			w->frames -= min(w->frames, frames);
+
+		if (!w->frames)
+			sensor_meta_set(meta, w->field, w->value);
+		else
+			meta->pending[n++] = *w;
+	}
+	meta->n_pending = n;
+
+	meta->started = true;
+	meta->cur.sequence = sequence;
+	meta->cur.timestamp = timestamp;
+	meta->history[meta->n_history++ % SENSOR_META_HISTORY] = meta->cur;
+}
+
+/**
+ * sensor_meta_init - set up the frame tracking of a sensor
+ * @meta: metadata to initialize
+ * @delay: frames between a control write and the first frame it applies to
+ */
+static inline void sensor_meta_init(struct sensor_meta *meta,
+				    unsigned int delay)
+{
+	meta->delay = delay;
+	spin_lock_init(&meta->lock);
+}
+
+/**
+ * sensor_meta_start - values of the first frame, on stream on
+ * @meta: frame tracking
+ * @exposure: exposure in effect, in the units of V4L2_CID_EXPOSURE
+ * @gain: gain in effect
+ * @vts: frame length in lines, or 0 if the driver doesn't know it
+ */
+static inline void sensor_meta_start(struct sensor_meta *meta,
+				     u32 exposure, u32 gain, u32 vts)
+{
+	spin_lock(&meta->lock);
+	meta->n_pending = 0;
+	meta->n_history = 0;
+	meta->started = false;
+	meta->cur.exposure = exposure;
+	meta->cur.gain = gain;
+	meta->cur.vts = vts;
+	meta->streaming = true;
+	spin_unlock(&meta->lock);
+}
+
+/* Stop recording frames, on stream off. The history stays readable. */
+static inline void sensor_meta_stop(struct sensor_meta *meta)
+{
+	spin_lock(&meta->lock);
+	meta->streaming = false;
+	meta->n_pending = 0;
+	spin_unlock(&meta->lock);
+}
+
+/**
+ * sensor_meta_queue - record a control write sent to the sensor
+ * @meta: frame tracking
+ * @field: what was written
+ * @value: the value written
+ *
+ * While streaming, the value applies from the @delay-th start of frame
+ * after now. Otherwise the driver passes it to the next stream on.
+ */
+static inline void sensor_meta_queue(struct sensor_meta *meta,
+				     enum sensor_meta_field field, u32 value)
+{
+	struct sensor_meta_write *w;
+
+	spin_lock(&meta->lock);
+
+	if (!meta->streaming)
+		goto out;
+
+	if (!meta->delay) {
+		sensor_meta_set(meta, field, value);
+		goto out;
+	}
+
+	/* Full: the oldest write is due first, let it take effect now */
+	if (meta->n_pending == SENSOR_META_PENDING) {
+		w = &meta->pending[0];
+		sensor_meta_set(meta, w->field, w->value);
+		memmove(&meta->pending[0], &meta->pending[1],
+			--meta->n_pending * sizeof(*w));
+	}
+
+	w = &meta->pending[meta->n_pending++];
+	w->timestamp = ktime_get();
+	w->frames = meta->delay;
+	w->field = field;
+	w->value = value;
+
+out:
+	spin_unlock(&meta->lock);
+}
+
+static int sensor_meta_show(struct seq_file *m, void *data)
+{
+	struct sensor_meta *meta = m->private;
+	struct sensor_meta_frame history[SENSOR_META_HISTORY];
+	unsigned int i, n, first;
+	bool streaming;
+
+	spin_lock(&meta->lock);
+	memcpy(history, meta->history, sizeof(history));
+	n = meta->n_history;
+	streaming = meta->streaming;
+	spin_unlock(&meta->lock);
+
+	seq_printf(m, "delay:     %u frames\n", meta->delay);
+	seq_printf(m, "streaming: %s\n", streaming ? "yes" : "no");
+	seq_puts(m, "sequence exposure     gain      vts  timestamp\n");
+
+	first = n > SENSOR_META_HISTORY ? n - SENSOR_META_HISTORY : 0;
+	for (i = first; i < n; i++) {
+		const struct sensor_meta_frame *f =
+			&history[i % SENSOR_META_HISTORY];
+
+		seq_printf(m, "%8u %8u %8u %8u  %lld\n", f->sequence,
+			   f->exposure, f->gain, f->vts,
+			   ktime_to_us(f->timestamp));
+	}
+
+	return 0;
+}
+
+static int sensor_meta_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, sensor_meta_show, inode->i_private);
+}
+
+/* A start of frame seen by the receiver, "<sequence> <timestamp us>" */
+static ssize_t sensor_meta_write(struct file *file, const char __user *ubuf,
+				 size_t count, loff_t *ppos)
+{
+	struct seq_file *m = file->private_data;
+	struct sensor_meta *meta = m->private;
+	u32 sequence;
+	s64 sof_us;
+	char buf[48];
+	int ret = 0;
+
+	if (count >= sizeof(buf))
+		return -EINVAL;
+	if (copy_from_user(buf, ubuf, count))
+		return -EFAULT;
+	buf[count] = '\0';
+
+	if (sscanf(buf, "%u %lld", &sequence, &sof_us) != 2)
+		return -EINVAL;
+
+	spin_lock(&meta->lock);
+	if (!meta->streaming)
+		ret = -ENODATA;
+	else if (meta->started &&
+		 (s32)(sequence - meta->cur.sequence) <= 0)
+		ret = -EINVAL;
+	else
+		sensor_meta_frame_start(meta, sequence, us_to_ktime(sof_us));
+	spin_unlock(&meta->lock);
+
+	return ret ?: count;
+}
+
+static const struct file_operations sensor_meta_fops = {
+	.owner = THIS_MODULE,
+	.open = sensor_meta_open,
+	.read = seq_read,
+	.write = sensor_meta_write,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
+
+/* Create the frame_meta file in the driver's debugfs directory */
+static inline void sensor_meta_debugfs(struct sensor_meta *meta,
+				       struct dentry *dir)
+{
+	debugfs_create_file("frame_meta", 0644, dir, meta, &sensor_meta_fops);
+}
+
+#endif /* __SENSOR_META_H__ */
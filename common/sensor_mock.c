@@ -0,0 +1,384 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Simulated i2c adapters to benchmark the sensor drivers without hardware.
+ *
+ * Every sensor named in the "sensors" parameter gets an adapter of its own,
+ * emulating the sensor register file (16 bit addresses, auto-increment
+ * reads and writes, chip ID preset), and a client on it the sensor driver
+ * binds to. sensor_dep_get_dev() returns no PMIC for these clients, so the
+ * drivers skip their GPIOs. Each transfer takes xfer_latency_us plus the
+ * time its bytes need on a bus running at bus_khz.
+ *
+ * Reading /sys/kernel/debug/sensor_mock/bench replays on every bound
+ * sensor: power on, set_fmt then stream on and off for each frame size
+ * the driver enumerates, and power off. It prints the transfers, bytes and
+ * wall time of each operation.
+ *
+ * Built only by "make bench", see common/README.md.
+ */
+
+#include <linux/debugfs.h>
+#include <linux/delay.h>
+#include <linux/device.h>
+#include <linux/i2c.h>
+#include <linux/ktime.h>
+#include <linux/list.h>
+#include <linux/module.h>
+#include <linux/moduleparam.h>
+#include <linux/seq_file.h>
+#include <linux/sizes.h>
+#include <linux/slab.h>
+#include <linux/vmalloc.h>
+#include <media/v4l2-subdev.h>
+
+#include "sensor_dep.h"
+
+static char *sensors[8] = { "ov5693", "ov8865", "ov5670", "ov7251" };
+static int nr_sensors = 4;
+module_param_array(sensors, charp, &nr_sensors, 0444);
+MODULE_PARM_DESC(sensors, "Sensors to simulate, one adapter each");
+
+static uint xfer_latency_us;
+module_param(xfer_latency_us, uint, 0644);
+MODULE_PARM_DESC(xfer_latency_us, "Fixed time taken by every transfer");
+
+static uint bus_khz = 400;
+module_param(bus_khz, uint, 0644);
+MODULE_PARM_DESC(bus_khz, "Simulated bus speed, 0 for no bus time");
+
+#define SENSOR_MOCK_NR_IDS	3
+
+struct sensor_mock_type {
+	const char *name;
+	unsigned short addr;
+	/* chip ID registers and their values */
+	u16 id_regs[SENSOR_MOCK_NR_IDS];
+	u8 id_vals[SENSOR_MOCK_NR_IDS];
+	unsigned int nr_ids;
+};
+
+static const struct sensor_mock_type sensor_mock_types[] = {
+	{ "ov5693", 0x36, { 0x300a, 0x300b }, { 0x56, 0x90 }, 2 },
+	{ "ov8865", 0x10, { 0x300a, 0x300b, 0x300c }, { 0x00, 0x88, 0x65 }, 3 },
+	{ "ov5670", 0x36, { 0x300a, 0x300b, 0x300c }, { 0x00, 0x56, 0x70 }, 3 },
+	{ "ov7251", 0x60, { 0x300a, 0x300b }, { 0x77, 0x50 }, 2 },
+};
+
+struct sensor_mock {
+	struct list_head list;
+	const struct sensor_mock_type *type;
+	struct i2c_adapter adap;
+	struct i2c_client *client;
+
+	u8 *regs;		/* 64 KiB register file */
+	u16 ptr;		/* address of the next auto-increment access */
+
+	/* updated under the adapter bus lock */
+	u64 xfers;
+	u64 bytes;
+};
+
+static LIST_HEAD(sensor_mock_list);
+static struct dentry *sensor_mock_debugfs;
+
+static void sensor_mock_delay(unsigned int bytes)
+{
+	unsigned long us = xfer_latency_us;
+
+	/* 9 clocks per byte, the address byte of each message included */
+	if (bus_khz)
+		us += DIV_ROUND_UP(bytes * 9 * 1000, bus_khz);
+
+	if (us < 10)
+		udelay(us);
+	else
+		usleep_range(us, us + us / 8);
+}
+
+static int sensor_mock_xfer(struct i2c_adapter *adap, struct i2c_msg *msgs,
+			    int num)
+{
+	struct sensor_mock *mock = i2c_get_adapdata(adap);
+	unsigned int bytes = 0;
+	int i, j;
+
+	for (i = 0; i < num; i++) {
+		struct i2c_msg *msg = &msgs[i];
+
+		bytes += 1 + msg->len;
+
+		/* Other devices on the bus (VCM) ack writes and read zeroes */
+		if (msg->addr != mock->type->addr) {
+			if (msg->flags & I2C_M_RD)
+				memset(msg->buf, 0, msg->len);
+			continue;
+		}
+
+		if (msg->flags & I2C_M_RD) {
+			for (j = 0; j < msg->len; j++)
+				msg->buf[j] = mock->regs[mock->ptr++];
+			continue;
+		}
+
+		if (msg->len < 2)
+			continue;
+
+		mock->ptr = (msg->buf[0] << 8) | msg->buf[1];
+		for (j = 2; j < msg->len; j++)
+			mock->regs[mock->ptr++] = msg->buf[j];
+	}
+
+	mock->xfers++;
+	mock->bytes += bytes - num;
+
+	sensor_mock_delay(bytes);
+
+	return num;
+}
+
+static u32 sensor_mock_func(struct i2c_adapter *adap)
+{
+	return I2C_FUNC_I2C | I2C_FUNC_SMBUS_EMUL;
+}
+
+static const struct i2c_algorithm sensor_mock_algo = {
+	.master_xfer = sensor_mock_xfer,
+	.functionality = sensor_mock_func,
+};
+
+struct sensor_mock_snap {
+	u64 xfers;
+	u64 bytes;
+	ktime_t start;
+};
+
+static void sensor_mock_begin(struct sensor_mock *mock,
+			      struct sensor_mock_snap *snap)
+{
+	snap->xfers = mock->xfers;
+	snap->bytes = mock->bytes;
+	snap->start = ktime_get();
+}
+
+static void sensor_mock_end(struct seq_file *m, struct sensor_mock *mock,
+			    const struct sensor_mock_snap *snap,
+			    const char *op, int ret)
+{
+	s64 us = ktime_us_delta(ktime_get(), snap->start);
+
+	seq_printf(m, "%-8s %-20s %8llu %8llu %10lld", mock->type->name, op,
+		   mock->xfers - snap->xfers, mock->bytes - snap->bytes, us);
+	if (ret)
+		seq_printf(m, "  error %d", ret);
+	seq_putc(m, '\n');
+}
+
+static void sensor_mock_bench_one(struct seq_file *m, struct sensor_mock *mock,
+				  struct v4l2_subdev *sd)
+{
+	struct v4l2_subdev_mbus_code_enum mce = {
+		.which = V4L2_SUBDEV_FORMAT_ACTIVE,
+	};
+	struct v4l2_subdev_frame_size_enum fse = {
+		.which = V4L2_SUBDEV_FORMAT_ACTIVE,
+	};
+	struct sensor_mock_snap snap;
+	char op[32];
+	int ret;
+
+	sensor_mock_begin(mock, &snap);
+	ret = v4l2_subdev_call(sd, core, s_power, 1);
+	sensor_mock_end(m, mock, &snap, "power_on", ret);
+	if (ret && ret != -ENOIOCTLCMD)
+		return;
+
+	if (!v4l2_subdev_call(sd, pad, enum_mbus_code, NULL, &mce))
+		fse.code = mce.code;
+
+	for (fse.index = 0;
+	     !v4l2_subdev_call(sd, pad, enum_frame_size, NULL, &fse);
+	     fse.index++) {
+		struct v4l2_subdev_format fmt = {
+			.which = V4L2_SUBDEV_FORMAT_ACTIVE,
+			.format = {
+				.code = fse.code,
+				.width = fse.max_width,
+				.height = fse.max_height,
+			},
+		};
+
+		snprintf(op, sizeof(op), "%ux%u set_fmt", fse.max_width,
+			 fse.max_height);
+		sensor_mock_begin(mock, &snap);
+		ret = v4l2_subdev_call(sd, pad, set_fmt, NULL, &fmt);
+		sensor_mock_end(m, mock, &snap, op, ret);
+		if (ret)
+			continue;
+
+		sensor_mock_begin(mock, &snap);
+		ret = v4l2_subdev_call(sd, video, s_stream, 1);
+		sensor_mock_end(m, mock, &snap, "stream_on", ret);
+		if (ret)
+			continue;
+
+		sensor_mock_begin(mock, &snap);
+		ret = v4l2_subdev_call(sd, video, s_stream, 0);
+		sensor_mock_end(m, mock, &snap, "stream_off", ret);
+	}
+
+	sensor_mock_begin(mock, &snap);
+	ret = v4l2_subdev_call(sd, core, s_power, 0);
+	sensor_mock_end(m, mock, &snap, "power_off", ret);
+}
+
+static int sensor_mock_bench_show(struct seq_file *m, void *data)
+{
+	struct sensor_mock *mock;
+	struct v4l2_subdev *sd;
+	struct device *dev;
+
+	seq_printf(m, "xfer_latency_us=%u bus_khz=%u\n", xfer_latency_us,
+		   bus_khz);
+	seq_printf(m, "%-8s %-20s %8s %8s %10s\n", "sensor", "operation",
+		   "xfers", "bytes", "us");
+
+	list_for_each_entry(mock, &sensor_mock_list, list) {
+		dev = &mock->client->dev;
+
+		/* Keep the driver bound while its ops are called */
+		device_lock(dev);
+
+		sd = dev->driver ? i2c_get_clientdata(mock->client) : NULL;
+		/* Registered once the driver identified the sensor */
+		if (sd && !list_empty(&sd->async_list))
+			sensor_mock_bench_one(m, mock, sd);
+		else
+			seq_printf(m, "%-8s not bound\n", mock->type->name);
+
+		device_unlock(dev);
+	}
+
+	return 0;
+}
+DEFINE_SHOW_ATTRIBUTE(sensor_mock_bench);
+
+static const struct sensor_mock_type *sensor_mock_find_type(const char *name)
+{
+	unsigned int i;
+
+	for (i = 0; i < ARRAY_SIZE(sensor_mock_types); i++) {
+		if (!strcmp(sensor_mock_types[i].name, name))
+			return &sensor_mock_types[i];
+	}
+
+	return NULL;
+}
+
+static void sensor_mock_destroy(struct sensor_mock *mock)
+{
+	i2c_unregister_device(mock->client);
+	i2c_del_adapter(&mock->adap);
+	vfree(mock->regs);
+	kfree(mock);
+}
+
+static int sensor_mock_create(const struct sensor_mock_type *type)
+{
+	struct i2c_board_info info = { };
+	struct sensor_mock *mock;
+	unsigned int i;
+	int ret;
+
+	mock = kzalloc(sizeof(*mock), GFP_KERNEL);
+	if (!mock)
+		return -ENOMEM;
+
+	mock->type = type;
+	mock->regs = vzalloc(SZ_64K);
+	if (!mock->regs) {
+		ret = -ENOMEM;
+		goto err_free;
+	}
+
+	for (i = 0; i < type->nr_ids; i++)
+		mock->regs[type->id_regs[i]] = type->id_vals[i];
+
+	mock->adap.owner = THIS_MODULE;
+	mock->adap.algo = &sensor_mock_algo;
+	strscpy(mock->adap.name, SENSOR_MOCK_ADAPTER_NAME,
+		sizeof(mock->adap.name));
+	i2c_set_adapdata(&mock->adap, mock);
+
+	ret = i2c_add_adapter(&mock->adap);
+	if (ret)
+		goto err_free;
+
+	strscpy(info.type, type->name, sizeof(info.type));
+	info.addr = type->addr;
+
+	mock->client = i2c_new_client_device(&mock->adap, &info);
+	if (IS_ERR(mock->client)) {
+		ret = PTR_ERR(mock->client);
+		i2c_del_adapter(&mock->adap);
+		goto err_free;
+	}
+
+	list_add_tail(&mock->list, &sensor_mock_list);
+
+	return 0;
+
+err_free:
+	vfree(mock->regs);
+	kfree(mock);
+	return ret;
+}
+
+static void sensor_mock_destroy_all(void)
+{
+	struct sensor_mock *mock, *tmp;
+
+	list_for_each_entry_safe(mock, tmp, &sensor_mock_list, list) {
+		list_del(&mock->list);
+		sensor_mock_destroy(mock);
+	}
+}
+
+static int __init sensor_mock_init(void)
+{
+	const struct sensor_mock_type *type;
+	int i, ret;
+
+	for (i = 0; i < nr_sensors; i++) {
+		type = sensor_mock_find_type(sensors[i]);
+		if (!type) {
+			pr_err("sensor_mock: unknown sensor %s\n", sensors[i]);
+			ret = -EINVAL;
+			goto err_destroy;
+		}
+
+		ret = sensor_mock_create(type);
+		if (ret)
+			goto err_destroy;
+	}
+
+	sensor_mock_debugfs = debugfs_create_dir("sensor_mock", NULL);
+	debugfs_create_file("bench", 0400, sensor_mock_debugfs, NULL,
+			    &sensor_mock_bench_fops);
+
+	return 0;
+
+err_destroy:
+	sensor_mock_destroy_all();
+	return ret;
+}
+module_init(sensor_mock_init);
+
+static void __exit sensor_mock_exit(void)
+{
+	debugfs_remove_recursive(sensor_mock_debugfs);
+	sensor_mock_destroy_all();
+}
+module_exit(sensor_mock_exit);
+
+MODULE_DESCRIPTION("Simulated i2c adapters to benchmark IPU3 camera sensors");
+MODULE_LICENSE("GPL v2");
@@ -0,0 +1,143 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/*
+ * Power up wait of the sensors in this tree.
+ *
+ * Once its supplies, clock and reset are up, a sensor needs some time
+ * before the first SCCB access: 8192 or 65536 XVCLK cycles in the
+ * OmniVision datasheets. On the ACPI machines the PMIC GPIOs come up all
+ * at once and how long the supplies take to ramp isn't documented, so the
+ * drivers used to sleep for a worst case found by trial. Instead, the
+ * datasheet minimum is slept here, then the chip ID is read until the
+ * sensor answers with it.
+ *
+ * Usage:
+ *	static struct sensor_power_timing ov1234_timing = {
+ *		.settle_us = SENSOR_POWER_CYCLES_US(8192, 19200000),
+ *		.poll_us = SENSOR_POWER_POLL_US,
+ *		.timeout_us = 20000,
+ *	};
+ *	...
+ *	ret = sensor_power_wait(&sensor->i2c, &ov1234_timing,
+ *				OV1234_CHIP_ID_REG, OV1234_CHIP_ID, 3);
+ */
+
+#ifndef __SENSOR_POWER_H__
+#define __SENSOR_POWER_H__
+
+#include <linux/delay.h>
+#include <linux/errno.h>
+#include <linux/ktime.h>
+#include <linux/types.h>
+#include <linux/workqueue.h>
+
+#include "sensor_reg.h"
+#include "sensor_stats.h"
+
+/* Microseconds taken by @cycles cycles of a @hz clock, rounded up */
+#define SENSOR_POWER_CYCLES_US(cycles, hz)				\
+	DIV_ROUND_UP((cycles) * 1000ULL, (hz) / 1000)
+
+/* Default time between two chip ID reads */
+#define SENSOR_POWER_POLL_US	500
+
+/*
+ * The drivers identify the sensor from a work scheduled at probe. A failed
+ * attempt is made again this many times, this far apart, the PMIC the
+ * sensor depends on may be coming up still.
+ */
+#define SENSOR_IDENTIFY_RETRIES		3
+#define SENSOR_IDENTIFY_RETRY_MS	1000
+
+/* Schedule the next attempt of @work, false once out of them */
+static inline bool sensor_identify_retry(struct delayed_work *work,
+					 unsigned int *tries)
+{
+	if (*tries >= SENSOR_IDENTIFY_RETRIES)
+		return false;
+
+	(*tries)++;
+	schedule_delayed_work(work, msecs_to_jiffies(SENSOR_IDENTIFY_RETRY_MS));
+
+	return true;
+}
+
+/**
+ * struct sensor_power_timing - power up wait of a sensor
+ * @settle_us: slept before the first access, the datasheet minimum
+ * @poll_us: between two chip ID reads
+ * @timeout_us: longest wait for the chip ID, from the end of @settle_us
+ *
+ * The drivers expose these as module parameters.
+ */
+struct sensor_power_timing {
+	unsigned int settle_us;
+	unsigned int poll_us;
+	unsigned int timeout_us;
+};
+
+static inline void sensor_power_sleep(unsigned int us)
+{
+	if (us)
+		usleep_range(us, us + us / 8 + 10);
+}
+
+/**
+ * sensor_power_wait - wait until a sensor just powered up answers
+ * @i2c: sensor to read from
+ * @t: timing of the sensor
+ * @reg: first chip ID register
+ * @id: chip ID, big-endian in @width registers
+ * @width: chip ID registers, 1 to 4
+ *
+ * Reads that fail while the sensor comes up are counted as retries in the
+ * i2c statistics, but not logged.
+ *
+ * Returns 0 once the sensor returned @id, -ENXIO if it answered with
+ * another ID until the timeout, the i2c error of the last read if it
+ * never answered.
+ */
+static inline int sensor_power_wait(const struct sensor_i2c *i2c,
+				    const struct sensor_power_timing *t,
+				    u16 reg, u32 id, unsigned int width)
+{
+	ktime_t timeout;
+	u8 buf[4];
+	u32 val = 0;
+	unsigned int i;
+	int ret;
+
+	if (WARN_ON(!width || width > sizeof(buf)))
+		return -EINVAL;
+
+	sensor_power_sleep(t->settle_us);
+	timeout = ktime_add_us(ktime_get(), t->timeout_us);
+
+	for (;;) {
+		ret = __sensor_reg_read(i2c, reg, buf, width);
+		if (!ret) {
+			for (val = 0, i = 0; i < width; i++)
+				val = val << 8 | buf[i];
+			if (val == id)
+				return 0;
+			ret = -ENXIO;
+		}
+
+		if (ktime_after(ktime_get(), timeout))
+			break;
+
+		sensor_stats_retry(i2c->stats);
+		sensor_power_sleep(t->poll_us);
+	}
+
+	if (ret == -ENXIO)
+		dev_err(&i2c->client->dev, "chip ID 0x%x, expected 0x%x\n",
+			val, id);
+	else
+		dev_err(&i2c->client->dev,
+			"no answer %u us after power up: %d\n",
+			t->settle_us + t->timeout_us, ret);
+
+	return ret;
+}
+
+#endif /* __SENSOR_POWER_H__ */
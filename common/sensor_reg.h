@@ -0,0 +1,234 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/*
+ * Fixed-width register access for the sensors in this tree, which all use
+ * 16-bit register addresses, big-endian values and address auto-increment.
+ *
+ * A 16-bit or 24-bit register goes out in one i2c message, address and
+ * value bytes together, and is read back in one write + read transfer.
+ * The width is part of the function called, so the buffers are sized at
+ * compile time and nothing is dispatched on a length argument.
+ *
+ * Usage:
+ *	sensor_i2c_init(&sensor->i2c, client, &sensor->stats,
+ *			&sensor->shadow);
+ *	...
+ *	ret = sensor_reg_write24(&sensor->i2c, EXPOSURE_REG, exposure);
+ *	ret = sensor_reg_read16(&sensor->i2c, HTS_REG, &hts);
+ *
+ * Writes are recorded in the register shadow, if one is given. Reads are
+ * not: only the driver knows which registers change by themselves.
+ */
+
+#ifndef __SENSOR_REG_H__
+#define __SENSOR_REG_H__
+
+#include <linux/device.h>
+#include <linux/i2c.h>
+#include <linux/string.h>
+#include <linux/types.h>
+
+#include "sensor_shadow.h"
+#include "sensor_stats.h"
+
+/**
+ * struct sensor_i2c - where register accesses go and what records them
+ * @client: i2c client of the sensor
+ * @stats: i2c statistics, or NULL
+ * @shadow: register shadow updated on writes, or NULL
+ */
+struct sensor_i2c {
+	struct i2c_client *client;
+	struct sensor_stats *stats;
+	struct sensor_shadow *shadow;
+};
+
+static inline void sensor_i2c_init(struct sensor_i2c *i2c,
+				   struct i2c_client *client,
+				   struct sensor_stats *stats,
+				   struct sensor_shadow *shadow)
+{
+	i2c->client = client;
+	i2c->stats = stats;
+	i2c->shadow = shadow;
+}
+
+/* Send @buf: two address bytes, filled in here, then @n value bytes */
+static __always_inline int __sensor_reg_write(const struct sensor_i2c *i2c,
+					      u16 reg, u8 *buf,
+					      unsigned int n)
+{
+	struct i2c_client *client = i2c->client;
+	struct i2c_msg msg = {
+		.addr = client->addr,
+		.flags = client->flags & I2C_M_TEN,
+		.len = sizeof(u16) + n,
+		.buf = buf,
+	};
+	unsigned int i;
+	int ret;
+
+	buf[0] = reg >> 8;
+	buf[1] = reg & 0xff;
+
+	ret = sensor_i2c_transfer(i2c->stats, client->adapter, &msg, 1);
+	if (ret != 1) {
+		if (ret >= 0)
+			ret = -EIO;
+		dev_err(&client->dev, "%s: error %d: reg=%04x\n",
+			__func__, ret, reg);
+		if (i2c->shadow)
+			for (i = 0; i < n; i++)
+				sensor_shadow_forget(i2c->shadow, reg + i);
+		return ret;
+	}
+
+	if (i2c->shadow)
+		sensor_shadow_set(i2c->shadow, reg, &buf[sizeof(u16)], n);
+
+	return 0;
+}
+
+static inline int sensor_reg_write8(const struct sensor_i2c *i2c, u16 reg,
+				    u8 val)
+{
+	u8 buf[3];
+
+	buf[2] = val;
+
+	return __sensor_reg_write(i2c, reg, buf, 1);
+}
+
+static inline int sensor_reg_write16(const struct sensor_i2c *i2c, u16 reg,
+				     u16 val)
+{
+	u8 buf[4];
+
+	buf[2] = val >> 8;
+	buf[3] = val & 0xff;
+
+	return __sensor_reg_write(i2c, reg, buf, 2);
+}
+
+/* Write the low 24 bits of @val to @reg, @reg + 1 and @reg + 2 */
+static inline int sensor_reg_write24(const struct sensor_i2c *i2c, u16 reg,
+				     u32 val)
+{
+	u8 buf[5];
+
+	buf[2] = (val >> 16) & 0xff;
+	buf[3] = (val >> 8) & 0xff;
+	buf[4] = val & 0xff;
+
+	return __sensor_reg_write(i2c, reg, buf, 3);
+}
+
+/* Longest run of registers sensor_reg_write() sends */
+#define SENSOR_REG_MAX_BYTES	8
+
+/**
+ * sensor_reg_write - write @n consecutive registers in one message
+ * @i2c: sensor to write to
+ * @reg: first register
+ * @val: values to write, in address order
+ * @n: number of registers, at most SENSOR_REG_MAX_BYTES
+ *
+ * For groups of registers set together, such as the per-channel gains.
+ */
+static inline int sensor_reg_write(const struct sensor_i2c *i2c, u16 reg,
+				   const u8 *val, unsigned int n)
+{
+	u8 buf[sizeof(u16) + SENSOR_REG_MAX_BYTES];
+
+	if (WARN_ON(n > SENSOR_REG_MAX_BYTES))
+		return -EINVAL;
+
+	memcpy(&buf[sizeof(u16)], val, n);
+
+	return __sensor_reg_write(i2c, reg, buf, n);
+}
+
+/* Read @n consecutive registers in one transfer, errors are not logged */
+static inline int __sensor_reg_read(const struct sensor_i2c *i2c, u16 reg,
+				    u8 *val, unsigned int n)
+{
+	struct i2c_client *client = i2c->client;
+	u8 addr[2] = { reg >> 8, reg & 0xff };
+	struct i2c_msg msgs[2] = {
+		{
+			.addr = client->addr,
+			.flags = client->flags & I2C_M_TEN,
+			.len = sizeof(addr),
+			.buf = addr,
+		}, {
+			.addr = client->addr,
+			.flags = (client->flags & I2C_M_TEN) | I2C_M_RD,
+			.len = n,
+			.buf = val,
+		},
+	};
+	int ret;
+
+	ret = sensor_i2c_transfer(i2c->stats, client->adapter, msgs, 2);
+	if (ret != 2)
+		return ret < 0 ? ret : -EIO;
+
+	return 0;
+}
+
+/**
+ * sensor_reg_read - read @n consecutive registers in one transfer
+ * @i2c: sensor to read from
+ * @reg: first register
+ * @val: values read, in address order
+ * @n: number of registers
+ */
+static inline int sensor_reg_read(const struct sensor_i2c *i2c, u16 reg,
+				  u8 *val, unsigned int n)
+{
+	int ret;
+
+	ret = __sensor_reg_read(i2c, reg, val, n);
+	if (ret)
+		dev_err(&i2c->client->dev, "%s: error %d: reg=%04x\n",
+			__func__, ret, reg);
+
+	return ret;
+}
+
+static inline int sensor_reg_read8(const struct sensor_i2c *i2c, u16 reg,
+				   u8 *val)
+{
+	return sensor_reg_read(i2c, reg, val, 1);
+}
+
+static inline int sensor_reg_read16(const struct sensor_i2c *i2c, u16 reg,
+				    u16 *val)
+{
+	u8 buf[2];
+	int ret;
+
+	ret = sensor_reg_read(i2c, reg, buf, sizeof(buf));
+	if (ret)
+		return ret;
+
+	*val = ((u16)buf[0] << 8) | buf[1];
+
+	return 0;
+}
+
+static inline int sensor_reg_read24(const struct sensor_i2c *i2c, u16 reg,
+				    u32 *val)
+{
+	u8 buf[3];
+	int ret;
+
+	ret = sensor_reg_read(i2c, reg, buf, sizeof(buf));
+	if (ret)
+		return ret;
+
+	*val = ((u32)buf[0] << 16) | ((u32)buf[1] << 8) | buf[2];
+
+	return 0;
+}
+
+#endif /* __SENSOR_REG_H__ */
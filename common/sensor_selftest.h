@@ -0,0 +1,273 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/*
+ * Throughput self-test of the sensor drivers in this tree.
+ *
+ * The frames go from the sensor to the receiver (ipu3-cio2), so the sensor
+ * driver never sees them. What it knows is the other half: when the stream
+ * was started and at what timing. Each stream on records the mode, its
+ * nominal frame interval and the time of the stream on write. The capture
+ * side, misc/sensor-selftest, streams the mode, with the test pattern of
+ * the sensor if it has one, and writes what it received back to
+ *
+ *	/sys/kernel/debug/<i2c device>/selftest
+ *
+ * as "<frames> <dropped> <bytes> <first us> <last us>": the frames
+ * dequeued, the gaps in their sequence numbers, the bytes they held, and
+ * the CLOCK_MONOTONIC timestamps of the first and the last one, in
+ * microseconds. The result is checked against the nominal timing and kept
+ * per mode; reading the file lists the results, writing "clear" drops
+ * them.
+ *
+ * Usage:
+ *	sensor_selftest_init(&selftest, 10);
+ *	...
+ *	sensor_selftest_start(&selftest, mode->width, mode->height,
+ *			      &interval);
+ *	...
+ *	sensor_selftest_debugfs(&selftest, debugfs);
+ */
+
+#ifndef __SENSOR_SELFTEST_H__
+#define __SENSOR_SELFTEST_H__
+
+#include <linux/debugfs.h>
+#include <linux/kernel.h>
+#include <linux/ktime.h>
+#include <linux/math64.h>
+#include <linux/seq_file.h>
+#include <linux/spinlock.h>
+#include <linux/string.h>
+#include <linux/types.h>
+#include <linux/uaccess.h>
+#include <media/v4l2-subdev.h>
+
+/* Modes a sensor keeps results for, the oldest is dropped first */
+#define SENSOR_SELFTEST_RESULTS		16
+/* Frame rate error allowed, in 1/1000 of the nominal rate */
+#define SENSOR_SELFTEST_TOLERANCE	10
+
+/**
+ * struct sensor_selftest_result - one stream of a mode
+ * @width: frame width of the mode
+ * @height: frame height of the mode
+ * @interval: nominal frame interval at stream on
+ * @frames: frames received
+ * @dropped: frames missing from the received sequence numbers
+ * @bytes: bytes received in @frames
+ * @mfps: received frame rate, in 1/1000 fps
+ * @latency_us: stream on write to the first frame
+ */
+struct sensor_selftest_result {
+	u32 width;
+	u32 height;
+	struct v4l2_fract interval;
+	u32 frames;
+	u32 dropped;
+	u64 bytes;
+	u32 mfps;
+	s64 latency_us;
+};
+
+/**
+ * struct sensor_selftest - self-test results of a sensor
+ * @bpp: bits per pixel on the link
+ * @lock: protects everything below
+ * @cur: mode of the last stream on
+ * @stream_on: time of the last stream on, 0 if none yet
+ * @results: one per mode tested, in the order tested
+ * @n_results: entries in @results
+ */
+struct sensor_selftest {
+	unsigned int bpp;
+
+	spinlock_t lock;
+	struct sensor_selftest_result cur;
+	ktime_t stream_on;
+	struct sensor_selftest_result results[SENSOR_SELFTEST_RESULTS];
+	unsigned int n_results;
+};
+
+static inline void sensor_selftest_init(struct sensor_selftest *st,
+					unsigned int bpp)
+{
+	st->bpp = bpp;
+	spin_lock_init(&st->lock);
+}
+
+/**
+ * sensor_selftest_start - record a stream on
+ * @st: self-test of the sensor
+ * @width: frame width of the mode
+ * @height: frame height of the mode
+ * @interval: frame interval of the mode
+ *
+ * Called right after the stream on write.
+ */
+static inline void sensor_selftest_start(struct sensor_selftest *st,
+					 u32 width, u32 height,
+					 const struct v4l2_fract *interval)
+{
+	spin_lock(&st->lock);
+	st->stream_on = ktime_get();
+	st->cur.width = width;
+	st->cur.height = height;
+	st->cur.interval = *interval;
+	spin_unlock(&st->lock);
+}
+
+/* Frame rate of @interval, in 1/1000 fps */
+static inline u32 sensor_selftest_mfps(const struct v4l2_fract *interval)
+{
+	if (!interval->numerator)
+		return 0;
+
+	return div_u64((u64)interval->denominator * 1000,
+		       interval->numerator);
+}
+
+/* Bits per second of @r: nominal, or as received if @received */
+static inline u64 sensor_selftest_bps(const struct sensor_selftest *st,
+				      const struct sensor_selftest_result *r,
+				      bool received)
+{
+	if (received)
+		return r->frames ?
+		       div_u64(div_u64(r->bytes * 8, r->frames) * r->mfps,
+			       1000) : 0;
+
+	return div_u64((u64)r->width * r->height * st->bpp *
+		       sensor_selftest_mfps(&r->interval), 1000);
+}
+
+/* The frame rate is within the tolerance and no frame was dropped */
+static inline bool sensor_selftest_pass(const struct sensor_selftest_result *r)
+{
+	u32 nominal = sensor_selftest_mfps(&r->interval);
+	u32 error = abs((s32)(r->mfps - nominal));
+
+	return r->frames > 1 && !r->dropped &&
+	       (u64)error * 1000 <= (u64)nominal * SENSOR_SELFTEST_TOLERANCE;
+}
+
+/* Store the results of the last stream, replacing those of its mode */
+static void sensor_selftest_add(struct sensor_selftest *st, u32 frames,
+				u32 dropped, u64 bytes, s64 first_us,
+				s64 last_us)
+{
+	struct sensor_selftest_result *r = &st->cur;
+	unsigned int i;
+
+	r->frames = frames;
+	r->dropped = dropped;
+	r->bytes = bytes;
+	r->mfps = frames > 1 && last_us > first_us ?
+		  div64_u64((u64)(frames - 1) * USEC_PER_SEC * 1000,
+			    last_us - first_us) : 0;
+	r->latency_us = first_us - ktime_to_us(st->stream_on);
+
+	for (i = 0; i < st->n_results; i++) {
+		const struct sensor_selftest_result *o = &st->results[i];
+
+		if (o->width == r->width && o->height == r->height &&
+		    o->interval.numerator == r->interval.numerator &&
+		    o->interval.denominator == r->interval.denominator)
+			break;
+	}
+
+	if (i == SENSOR_SELFTEST_RESULTS)
+		memmove(&st->results[0], &st->results[1], --i * sizeof(*r));
+	else if (i == st->n_results)
+		st->n_results++;
+	st->results[i] = *r;
+}
+
+static int sensor_selftest_show(struct seq_file *m, void *data)
+{
+	struct sensor_selftest *st = m->private;
+	struct sensor_selftest_result results[SENSOR_SELFTEST_RESULTS];
+	unsigned int i, n;
+
+	spin_lock(&st->lock);
+	memcpy(results, st->results, sizeof(results));
+	n = st->n_results;
+	spin_unlock(&st->lock);
+
+	seq_puts(m, "     mode      fps  received  frames dropped");
+	seq_puts(m, "   Mbit/s received  latency us  result\n");
+
+	for (i = 0; i < n; i++) {
+		const struct sensor_selftest_result *r = &results[i];
+		u32 nominal = sensor_selftest_mfps(&r->interval);
+
+		seq_printf(m, "%4ux%-4u %4u.%03u  %4u.%03u %7u %7u",
+			   r->width, r->height, nominal / 1000,
+			   nominal % 1000, r->mfps / 1000, r->mfps % 1000,
+			   r->frames, r->dropped);
+		seq_printf(m, " %8llu %8llu %11lld  %s\n",
+			   div_u64(sensor_selftest_bps(st, r, false),
+				   1000000),
+			   div_u64(sensor_selftest_bps(st, r, true),
+				   1000000),
+			   r->latency_us,
+			   sensor_selftest_pass(r) ? "pass" : "FAIL");
+	}
+
+	return 0;
+}
+
+static int sensor_selftest_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, sensor_selftest_show, inode->i_private);
+}
+
+static ssize_t sensor_selftest_write(struct file *file,
+				     const char __user *ubuf, size_t count,
+				     loff_t *ppos)
+{
+	struct seq_file *m = file->private_data;
+	struct sensor_selftest *st = m->private;
+	s64 first_us, last_us;
+	u32 frames, dropped;
+	char buf[96];
+	u64 bytes;
+	int ret = 0;
+
+	if (count >= sizeof(buf))
+		return -EINVAL;
+	if (copy_from_user(buf, ubuf, count))
+		return -EFAULT;
+	buf[count] = '\0';
+
+	spin_lock(&st->lock);
+	if (sysfs_streq(buf, "clear"))
+		st->n_results = 0;
+	else if (!st->stream_on)
+		ret = -ENODATA;
+	else if (sscanf(buf, "%u %u %llu %lld %lld", &frames, &dropped,
+			&bytes, &first_us, &last_us) != 5)
+		ret = -EINVAL;
+	else
+		sensor_selftest_add(st, frames, dropped, bytes, first_us,
+				    last_us);
+	spin_unlock(&st->lock);
+
+	return ret ?: count;
+}
+
+static const struct file_operations sensor_selftest_fops = {
+	.owner = THIS_MODULE,
+	.open = sensor_selftest_open,
+	.read = seq_read,
+	.write = sensor_selftest_write,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
+
+/* Create the selftest file in the driver's debugfs directory */
+static inline void sensor_selftest_debugfs(struct sensor_selftest *st,
+					   struct dentry *dir)
+{
+	debugfs_create_file("selftest", 0644, dir, st, &sensor_selftest_fops);
+}
+
+#endif /* __SENSOR_SELFTEST_H__ */
@@ -0,0 +1,235 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/*
+ * Packed register tables for the sensor drivers in this tree.
+ *
+ * A mode table as an array of { u16 reg; u8 val; } takes 4 bytes per
+ * register, 8 or 12 with a delay or a type field, and the modes of a sensor
+ * repeat the same few hundred registers with only a handful of values
+ * changed. Here a table is a byte stream of runs of consecutive registers,
+ * the address stored once per run:
+ *
+ *	n, reg >> 8, reg & 0xff, val[0], ..., val[n - 1]	(n = 1..255)
+ *	0, ms							(delay)
+ *
+ * and a mode can be given as the table of another mode plus a patch: the
+ * registers whose values differ, or that it doesn't write at all.
+ *
+ * Usage:
+ *	static const u8 ov1234_base_regs[] = {
+ *		SENSOR_SEQ_REGS(0x0103, 0x01),
+ *		SENSOR_SEQ_DELAY(5),
+ *		SENSOR_SEQ_REGS(0x3000, 0x20, 0x00, 0x1f),
+ *	};
+ *
+ *	static const struct sensor_seq_patch ov1234_mode_b_patch[] = {
+ *		SENSOR_SEQ_SET(0x3001, 0x10),
+ *		SENSOR_SEQ_OMIT(0x3002),
+ *	};
+ *
+ *	static const struct sensor_seq ov1234_mode_a =
+ *		SENSOR_SEQ(ov1234_base_regs);
+ *	static const struct sensor_seq ov1234_mode_b =
+ *		SENSOR_SEQ_PATCHED(ov1234_base_regs, ov1234_mode_b_patch);
+ *	...
+ *	sensor_prog_build(client, &prog, sensor_seq_walk, &ov1234_mode_b);
+ *
+ * sensor_seq_walk() decodes a table straight into a struct sensor_burst,
+ * which packs the runs into i2c messages again, so nothing is unpacked
+ * into memory on the way.
+ */
+
+#ifndef __SENSOR_SEQ_H__
+#define __SENSOR_SEQ_H__
+
+#include <linux/bug.h>
+#include <linux/build_bug.h>
+#include <linux/errno.h>
+#include <linux/kernel.h>
+#include <linux/types.h>
+
+#include "sensor_burst.h"
+
+/* Number of values in a SENSOR_SEQ_REGS() run, at most 255 */
+#define SENSOR_SEQ_NR(...)						\
+	(sizeof((const u8[]){ __VA_ARGS__ }) +				\
+	 BUILD_BUG_ON_ZERO(sizeof((const u8[]){ __VA_ARGS__ }) > 0xff))
+
+/* Write the values to @reg, @reg + 1, ... */
+#define SENSOR_SEQ_REGS(reg, ...)					\
+	SENSOR_SEQ_NR(__VA_ARGS__), (reg) >> 8, (reg) & 0xff, __VA_ARGS__
+
+/* Sleep for @ms milliseconds, at most 255 */
+#define SENSOR_SEQ_DELAY(ms)	0, (ms)
+
+#define SENSOR_SEQ_PATCH_OMIT	BIT(0)
+
+/**
+ * struct sensor_seq_patch - register changed by a patch
+ * @reg: register address
+ * @val: value written instead of the one in the table
+ * @flags: SENSOR_SEQ_PATCH_OMIT to skip @reg altogether
+ *
+ * A patch applies to every write to @reg in the table.
+ */
+struct sensor_seq_patch {
+	u16 reg;
+	u8 val;
+	u8 flags;
+};
+
+#define SENSOR_SEQ_SET(_reg, _val)	{ .reg = (_reg), .val = (_val) }
+#define SENSOR_SEQ_OMIT(_reg)						\
+	{ .reg = (_reg), .flags = SENSOR_SEQ_PATCH_OMIT }
+
+/**
+ * struct sensor_seq - packed register table
+ * @data: runs and delays, see the top of this file
+ * @patch: registers changed from @data, or NULL
+ * @size: bytes in @data
+ * @nr_patch: entries in @patch
+ */
+struct sensor_seq {
+	const u8 *data;
+	const struct sensor_seq_patch *patch;
+	u16 size;
+	u16 nr_patch;
+};
+
+#define SENSOR_SEQ(_data)						\
+	{ .data = (_data), .size = sizeof(_data) }
+#define SENSOR_SEQ_PATCHED(_data, _patch)				\
+	{ .data = (_data), .size = sizeof(_data),			\
+	  .patch = (_patch), .nr_patch = ARRAY_SIZE(_patch) }
+
+static inline const struct sensor_seq_patch *
+sensor_seq_find_patch(const struct sensor_seq *seq, u16 reg)
+{
+	unsigned int i;
+
+	for (i = 0; i < seq->nr_patch; i++)
+		if (seq->patch[i].reg == reg)
+			return &seq->patch[i];
+
+	return NULL;
+}
+
+/**
+ * sensor_seq_walk - decode a packed table into a burst writer
+ * @burst: burst writer to queue the registers and delays in
+ * @table: the struct sensor_seq to decode
+ *
+ * A sensor_prog_walk_t, so packed tables can be passed to
+ * sensor_prog_build() as they are. Like all walk callbacks, it doesn't
+ * flush the last run.
+ */
+static inline int sensor_seq_walk(struct sensor_burst *burst,
+				  const void *table)
+{
+	const struct sensor_seq *seq = table;
+	const struct sensor_seq_patch *patch;
+	const u8 *p = seq->data, *end = seq->data + seq->size;
+	unsigned int n, i;
+	u16 reg;
+	int ret;
+
+	while (p < end) {
+		n = *p++;
+
+		if (!n) {
+			if (WARN_ON(p == end))
+				return -EINVAL;
+			ret = sensor_burst_delay(burst, *p++);
+			if (ret)
+				return ret;
+			continue;
+		}
+
+		if (WARN_ON(end - p < sizeof(u16) + n))
+			return -EINVAL;
+
+		reg = p[0] << 8 | p[1];
+		p += sizeof(u16);
+
+		for (i = 0; i < n; i++, reg++, p++) {
+			patch = sensor_seq_find_patch(seq, reg);
+			if (patch && (patch->flags & SENSOR_SEQ_PATCH_OMIT))
+				continue;
+
+			ret = sensor_burst_write8(burst, reg,
+						  patch ? patch->val : *p);
+			if (ret)
+				return ret;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * sensor_seq_read - value a packed table leaves in a register
+ * @seq: the table
+ * @reg: register address
+ * @val: set to the value of the last write to @reg, patch applied
+ *
+ * For what a mode programs, the crop window of its table for instance,
+ * without keeping a copy of it in the mode description.
+ *
+ * Returns 0, -ENOENT if @seq doesn't write @reg.
+ */
+static inline int sensor_seq_read(const struct sensor_seq *seq, u16 reg,
+				  u8 *val)
+{
+	const struct sensor_seq_patch *patch = sensor_seq_find_patch(seq, reg);
+	const u8 *p = seq->data, *end = seq->data + seq->size;
+	unsigned int n;
+	int ret = -ENOENT;
+	u16 first;
+
+	while (p < end) {
+		n = *p++;
+
+		if (!n) {
+			p++;
+			continue;
+		}
+
+		if (WARN_ON(end - p < sizeof(u16) + n))
+			return -EINVAL;
+
+		first = p[0] << 8 | p[1];
+		p += sizeof(u16);
+
+		if (reg >= first && reg < first + n) {
+			*val = p[reg - first];
+			ret = 0;
+		}
+		p += n;
+	}
+
+	/* A patch only changes the registers the table writes */
+	if (!ret && patch) {
+		if (patch->flags & SENSOR_SEQ_PATCH_OMIT)
+			return -ENOENT;
+		*val = patch->val;
+	}
+
+	return ret;
+}
+
+/* 16-bit big-endian register pair at @reg, see sensor_seq_read() */
+static inline int sensor_seq_read16(const struct sensor_seq *seq, u16 reg,
+				    u16 *val)
+{
+	u8 hi, lo;
+	int ret;
+
+	ret = sensor_seq_read(seq, reg, &hi);
+	if (!ret)
+		ret = sensor_seq_read(seq, reg + 1, &lo);
+	if (!ret)
+		*val = hi << 8 | lo;
+
+	return ret;
+}
+
+#endif /* __SENSOR_SEQ_H__ */
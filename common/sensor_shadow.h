@@ -0,0 +1,134 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/*
+ * Register shadow shared by the sensor drivers in this tree.
+ *
+ * The shadow remembers the last value written to every register of the
+ * sensor since it was powered on. sensor_prog_load() (see sensor_burst.h)
+ * uses it to send only the registers of a mode table whose value differs
+ * from what the sensor already holds, so that switching between two modes
+ * does not rewrite the PLL and ISP setup they have in common.
+ *
+ * The driver must:
+ *	- record every other register write with sensor_shadow_set*(),
+ *	- call sensor_shadow_invalidate() when the sensor loses power.
+ *
+ * It can then also serve register reads from the shadow with
+ * sensor_shadow_get(), except for the registers the sensor changes by
+ * itself, and record the values it reads from the bus.
+ *
+ * A write to the software reset register @reset_reg given at
+ * sensor_shadow_init() invalidates the whole shadow, as the sensor goes
+ * back to its default values.
+ */
+
+#ifndef __SENSOR_SHADOW_H__
+#define __SENSOR_SHADOW_H__
+
+#include <linux/bitmap.h>
+#include <linux/device.h>
+#include <linux/mm.h>
+#include <linux/slab.h>
+#include <linux/types.h>
+
+/* 16-bit register address space */
+#define SENSOR_SHADOW_SIZE	(U16_MAX + 1)
+
+struct sensor_shadow {
+	u8 *val;
+	unsigned long *valid;	/* bit set if val[reg] is known */
+	int reset_reg;		/* software reset register, -1 if none */
+};
+
+static void __sensor_shadow_free(void *data)
+{
+	struct sensor_shadow *shadow = data;
+
+	bitmap_free(shadow->valid);
+	kvfree(shadow->val);
+}
+
+/**
+ * sensor_shadow_init - allocate a register shadow, all registers unknown
+ * @dev: device the memory is managed by
+ * @shadow: shadow to initialize
+ * @reset_reg: software reset register, or -1
+ */
+static inline int sensor_shadow_init(struct device *dev,
+				     struct sensor_shadow *shadow,
+				     int reset_reg)
+{
+	shadow->reset_reg = reset_reg;
+	shadow->val = kvzalloc(SENSOR_SHADOW_SIZE, GFP_KERNEL);
+	shadow->valid = bitmap_zalloc(SENSOR_SHADOW_SIZE, GFP_KERNEL);
+	if (!shadow->val || !shadow->valid) {
+		__sensor_shadow_free(shadow);
+		return -ENOMEM;
+	}
+
+	return devm_add_action_or_reset(dev, __sensor_shadow_free, shadow);
+}
+
+/* Forget everything, e.g. when the sensor is powered off */
+static inline void sensor_shadow_invalidate(struct sensor_shadow *shadow)
+{
+	bitmap_zero(shadow->valid, SENSOR_SHADOW_SIZE);
+}
+
+/* Forget one register, e.g. after a failed write */
+static inline void sensor_shadow_forget(struct sensor_shadow *shadow, u16 reg)
+{
+	clear_bit(reg, shadow->valid);
+}
+
+static inline bool sensor_shadow_match(const struct sensor_shadow *shadow,
+				       u16 reg, u8 val)
+{
+	return test_bit(reg, shadow->valid) && shadow->val[reg] == val;
+}
+
+/* Get the cached value of @reg, false if it is not known */
+static inline bool sensor_shadow_get(const struct sensor_shadow *shadow,
+				     u16 reg, u8 *val)
+{
+	if (!test_bit(reg, shadow->valid))
+		return false;
+
+	*val = shadow->val[reg];
+
+	return true;
+}
+
+/**
+ * sensor_shadow_set - record @n bytes written starting at register @reg
+ * @shadow: register shadow
+ * @reg: 16-bit register address
+ * @val: bytes written, in address order
+ * @n: number of bytes in @val
+ */
+static inline void sensor_shadow_set(struct sensor_shadow *shadow, u16 reg,
+				     const u8 *val, unsigned int n)
+{
+	unsigned int i, r;
+
+	for (i = 0; i < n; i++) {
+		r = reg + i;
+		if (r >= SENSOR_SHADOW_SIZE)
+			break;
+
+		if (r == shadow->reset_reg) {
+			sensor_shadow_invalidate(shadow);
+			continue;
+		}
+
+		shadow->val[r] = val[i];
+		set_bit(r, shadow->valid);
+	}
+}
+
+static inline void sensor_shadow_set8(struct sensor_shadow *shadow, u16 reg,
+				      u8 val)
+{
+	sensor_shadow_set(shadow, reg, &val, 1);
+}
+
+#endif /* __SENSOR_SHADOW_H__ */
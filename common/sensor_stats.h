@@ -0,0 +1,224 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/*
+ * I2C traffic statistics shared by the sensor drivers in this tree.
+ *
+ * Every i2c_transfer() (or i2c_master_send()/recv()) a driver makes for
+ * its sensor is counted in per-CPU counters, so that accounting never
+ * takes a lock on the register access paths. The counters are summed up
+ * when read through debugfs:
+ *
+ *	/sys/kernel/debug/<i2c device>/i2c_stats
+ *
+ * Writing anything to that file resets the counters.
+ *
+ * Usage:
+ *	sensor_stats_init(dev, &stats);
+ *	...
+ *	ret = sensor_i2c_transfer(&stats, client->adapter, msgs, n);
+ *
+ * or, around other i2c calls:
+ *	ktime_t start = ktime_get();
+ *	ret = i2c_master_send(client, buf, len);
+ *	sensor_stats_account(&stats, start, len, ret == len ? 0 : -EIO);
+ *
+ * A NULL stats pointer is accepted everywhere and counts nothing.
+ */
+
+#ifndef __SENSOR_STATS_H__
+#define __SENSOR_STATS_H__
+
+#include <linux/debugfs.h>
+#include <linux/device.h>
+#include <linux/i2c.h>
+#include <linux/ktime.h>
+#include <linux/log2.h>
+#include <linux/percpu.h>
+#include <linux/seq_file.h>
+#include <linux/string.h>
+#include <linux/types.h>
+
+/* Latency buckets: [0, 2) us, [2, 4) us, ..., [2^15, inf) us */
+#define SENSOR_STATS_NR_BUCKETS	16
+
+struct sensor_stats_cpu {
+	u64 xfers;		/* i2c_transfer() calls */
+	u64 msgs;
+	u64 bytes;		/* payload bytes, register addresses included */
+	u64 errors;
+	u64 retries;		/* attempts repeated after a failure */
+	u64 latency[SENSOR_STATS_NR_BUCKETS];
+};
+
+struct sensor_stats {
+	struct sensor_stats_cpu __percpu *cpu;
+};
+
+/**
+ * sensor_stats_init - allocate the per-CPU counters, all zero
+ * @dev: device the memory is managed by
+ * @stats: statistics to initialize
+ */
+static inline int sensor_stats_init(struct device *dev,
+				    struct sensor_stats *stats)
+{
+	stats->cpu = devm_alloc_percpu(dev, struct sensor_stats_cpu);
+
+	return stats->cpu ? 0 : -ENOMEM;
+}
+
+/**
+ * sensor_stats_account_msgs - count one transfer
+ * @stats: statistics, may be NULL
+ * @start: ktime_get() taken before the transfer
+ * @msgs: number of messages in the transfer
+ * @bytes: bytes in all the messages
+ * @err: 0 if the transfer went through, negative errno otherwise
+ */
+static inline void sensor_stats_account_msgs(struct sensor_stats *stats,
+					     ktime_t start, unsigned int msgs,
+					     unsigned int bytes, int err)
+{
+	s64 us;
+	unsigned int bucket = 0;
+
+	if (!stats || !stats->cpu)
+		return;
+
+	us = ktime_us_delta(ktime_get(), start);
+	if (us > 1)
+		bucket = min_t(unsigned int, ilog2(us),
+			       SENSOR_STATS_NR_BUCKETS - 1);
+
+	this_cpu_inc(stats->cpu->xfers);
+	this_cpu_add(stats->cpu->msgs, msgs);
+	this_cpu_add(stats->cpu->bytes, bytes);
+	this_cpu_inc(stats->cpu->latency[bucket]);
+	if (err)
+		this_cpu_inc(stats->cpu->errors);
+}
+
+/* Count a transfer of a single message, e.g. i2c_master_send() */
+static inline void sensor_stats_account(struct sensor_stats *stats,
+					ktime_t start, unsigned int bytes,
+					int err)
+{
+	sensor_stats_account_msgs(stats, start, 1, bytes, err);
+}
+
+static inline void sensor_stats_retry(struct sensor_stats *stats)
+{
+	if (stats && stats->cpu)
+		this_cpu_inc(stats->cpu->retries);
+}
+
+/**
+ * sensor_i2c_transfer - i2c_transfer() counted in @stats
+ * @stats: statistics, may be NULL
+ * @adap: adapter to send on
+ * @msgs: messages to send
+ * @num: number of messages
+ *
+ * Returns like i2c_transfer().
+ */
+static inline int sensor_i2c_transfer(struct sensor_stats *stats,
+				      struct i2c_adapter *adap,
+				      struct i2c_msg *msgs, int num)
+{
+	unsigned int bytes = 0;
+	ktime_t start;
+	int i, ret;
+
+	for (i = 0; i < num; i++)
+		bytes += msgs[i].len;
+
+	start = ktime_get();
+	ret = i2c_transfer(adap, msgs, num);
+	sensor_stats_account_msgs(stats, start, num, bytes,
+				  ret == num ? 0 : -EIO);
+
+	return ret;
+}
+
+static inline void sensor_stats_sum(struct sensor_stats *stats,
+				    struct sensor_stats_cpu *sum)
+{
+	int cpu, i;
+
+	memset(sum, 0, sizeof(*sum));
+
+	for_each_possible_cpu(cpu) {
+		const struct sensor_stats_cpu *c = per_cpu_ptr(stats->cpu, cpu);
+
+		sum->xfers += c->xfers;
+		sum->msgs += c->msgs;
+		sum->bytes += c->bytes;
+		sum->errors += c->errors;
+		sum->retries += c->retries;
+		for (i = 0; i < SENSOR_STATS_NR_BUCKETS; i++)
+			sum->latency[i] += c->latency[i];
+	}
+}
+
+static inline void sensor_stats_reset(struct sensor_stats *stats)
+{
+	int cpu;
+
+	for_each_possible_cpu(cpu)
+		memset(per_cpu_ptr(stats->cpu, cpu), 0,
+		       sizeof(struct sensor_stats_cpu));
+}
+
+static int sensor_stats_show(struct seq_file *m, void *data)
+{
+	struct sensor_stats *stats = m->private;
+	struct sensor_stats_cpu sum;
+	int i;
+
+	sensor_stats_sum(stats, &sum);
+
+	seq_printf(m, "transfers: %llu\n", sum.xfers);
+	seq_printf(m, "messages:  %llu\n", sum.msgs);
+	seq_printf(m, "bytes:     %llu\n", sum.bytes);
+	seq_printf(m, "errors:    %llu\n", sum.errors);
+	seq_printf(m, "retries:   %llu\n", sum.retries);
+	seq_puts(m, "latency:\n");
+	for (i = 0; i < SENSOR_STATS_NR_BUCKETS - 1; i++)
+		seq_printf(m, "  < %6u us: %llu\n", 2U << i, sum.latency[i]);
+	seq_printf(m, "  >= %5u us: %llu\n", 1U << i, sum.latency[i]);
+
+	return 0;
+}
+
+static int sensor_stats_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, sensor_stats_show, inode->i_private);
+}
+
+static ssize_t sensor_stats_write(struct file *file, const char __user *buf,
+				  size_t count, loff_t *ppos)
+{
+	struct seq_file *m = file->private_data;
+
+	sensor_stats_reset(m->private);
+
+	return count;
+}
+
+static const struct file_operations sensor_stats_fops = {
+	.owner = THIS_MODULE,
+	.open = sensor_stats_open,
+	.read = seq_read,
+	.write = sensor_stats_write,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
+
+/* Create the i2c_stats file in the driver's debugfs directory */
+static inline void sensor_stats_debugfs(struct sensor_stats *stats,
+					struct dentry *dir)
+{
+	debugfs_create_file("i2c_stats", 0644, dir, stats,
+			    &sensor_stats_fops);
+}
+
+#endif /* __SENSOR_STATS_H__ */
@@ -0,0 +1,74 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/*
+ * Trace events marking the stages of sensor power up and stream start.
+ *
+ * Every stage is bracketed by sensor_stage_begin and sensor_stage_end on
+ * the same device, the time between the two is the latency of the stage.
+ * sensor_stage_end also reports how many registers and i2c bytes the
+ * stage wrote, 0 for stages that don't touch the bus.
+ *
+ * Stages used by the drivers:
+ *	gpio		gpio_crs_ctrl() (or regulators/clock on DT systems)
+ *	power_delay	sleep after power up, before the first i2c access
+ *	load_regs	register table load
+ *	ctrl_setup	v4l2_ctrl_handler_setup()
+ *	stream_on	register writes starting the stream
+ *	stream_off	register writes stopping the stream
+ *
+ * The events are defined in the sensor_dep module.
+ */
+
+#undef TRACE_SYSTEM
+#define TRACE_SYSTEM sensor
+
+#if !defined(__SENSOR_TRACE_H__) || defined(TRACE_HEADER_MULTI_READ)
+#define __SENSOR_TRACE_H__
+
+#include <linux/device.h>
+#include <linux/tracepoint.h>
+
+TRACE_EVENT(sensor_stage_begin,
+	TP_PROTO(struct device *dev, const char *stage),
+	TP_ARGS(dev, stage),
+	TP_STRUCT__entry(
+		__string(dev, dev_name(dev))
+		__string(stage, stage)
+	),
+	TP_fast_assign(
+		__assign_str(dev, dev_name(dev));
+		__assign_str(stage, stage);
+	),
+	TP_printk("%s %s", __get_str(dev), __get_str(stage))
+);
+
+TRACE_EVENT(sensor_stage_end,
+	TP_PROTO(struct device *dev, const char *stage, unsigned int regs,
+		 unsigned int bytes, int ret),
+	TP_ARGS(dev, stage, regs, bytes, ret),
+	TP_STRUCT__entry(
+		__string(dev, dev_name(dev))
+		__string(stage, stage)
+		__field(unsigned int, regs)
+		__field(unsigned int, bytes)
+		__field(int, ret)
+	),
+	TP_fast_assign(
+		__assign_str(dev, dev_name(dev));
+		__assign_str(stage, stage);
+		__entry->regs = regs;
+		__entry->bytes = bytes;
+		__entry->ret = ret;
+	),
+	TP_printk("%s %s regs=%u bytes=%u ret=%d", __get_str(dev),
+		  __get_str(stage), __entry->regs, __entry->bytes,
+		  __entry->ret)
+);
+
+#endif /* __SENSOR_TRACE_H__ */
+
+/* This part must be outside protection */
+#undef TRACE_INCLUDE_PATH
+#define TRACE_INCLUDE_PATH .
+#undef TRACE_INCLUDE_FILE
+#define TRACE_INCLUDE_FILE sensor_trace
+#include <trace/define_trace.h>
@@ -1,12 +1,18 @@
 // SPDX-License-Identifier: GPL-2.0
 
 #include <linux/acpi.h>
+#include <linux/async.h>
+#include <linux/debugfs.h>
+#include <linux/dmi.h>
 #include <linux/i2c.h>
+#include <linux/list.h>
+#include <linux/seq_file.h>
+#include <linux/slab.h>
 
 #include "dump_intel_ipu_data.h"
 
 #define DRV_NAME	"dump_intel_ipu_data"
-#define DRV_VERSION	"1.1"
+#define DRV_VERSION	"1.2"
 
 /**
  * get_acpi_buf - wrapper for acpi_evaluate_object()
@@ -774,6 +780,543 @@ static int acpi_dev_match_cb(struct device *dev, void *data)
 	return 0;
 }
 
+/*
+ * debugfs output (output=debugfs)
+ *
+ * Only the devices with one of the HIDs below are looked at, and only
+ * their status read at enumeration is used, instead of evaluating _STA
+ * on every ACPI device. Each of them is read once at module load, in
+ * parallel, and kept. Reading the file then prints one line of JSON per
+ * device, preceded by one for the machine, and doesn't evaluate anything.
+ */
+static const struct acpi_device_id sensor_hids[] = {
+	{ "INT33BE" },	/* ov5693 */
+	{ "INT3479" },	/* ov5670 */
+	{ "INT347A" },	/* ov8865 */
+	{ "INT347E" },	/* ov7251 */
+	{ "OVTI01A0" },
+	{ "OVTI9734" },	/* ov9734 */
+	{ }
+};
+
+static const struct acpi_device_id pmic_hids[] = {
+	{ "INT3472" },
+	{ "INT346F" },
+	{ }
+};
+
+static char *output = "dmesg";
+module_param(output, charp, 0444);
+MODULE_PARM_DESC(output,
+		 "Where to dump to: dmesg (default), or debugfs (JSON)");
+
+static LIST_HEAD(ipu_records);
+static ASYNC_DOMAIN_EXCLUSIVE(ipu_records_domain);
+static struct dentry *ipu_records_dir;
+
+/* Same as print_acpi_entry() for a string, but into @out and quiet */
+static void get_acpi_string(struct acpi_device *adev, const char *path,
+			    char *out, size_t size)
+{
+	struct acpi_buffer buffer = { ACPI_ALLOCATE_BUFFER, NULL };
+	union acpi_object *obj;
+	acpi_status status;
+
+	if (!acpi_has_method(adev->handle, (acpi_string)path))
+		return;
+
+	status = acpi_evaluate_object_typed(adev->handle, (acpi_string)path,
+					    NULL, &buffer, ACPI_TYPE_STRING);
+	if (ACPI_FAILURE(status))
+		return;
+
+	obj = buffer.pointer;
+	strlcpy(out, obj->string.pointer, size);
+	kfree(buffer.pointer);
+}
+
+/* Copy of the buffer returned by @path, NULL if there is none */
+static u8 *get_acpi_buf_dup(struct acpi_device *adev, const char *path,
+			    u32 *len)
+{
+	struct acpi_buffer buffer = { ACPI_ALLOCATE_BUFFER, NULL };
+	union acpi_object *obj;
+	acpi_status status;
+	u8 *out;
+
+	if (!acpi_has_method(adev->handle, (acpi_string)path))
+		return NULL;
+
+	status = acpi_evaluate_object_typed(adev->handle, (acpi_string)path,
+					    NULL, &buffer, ACPI_TYPE_BUFFER);
+	if (ACPI_FAILURE(status))
+		return NULL;
+
+	obj = buffer.pointer;
+	out = kmemdup(obj->buffer.pointer, obj->buffer.length, GFP_KERNEL);
+	if (out)
+		*len = obj->buffer.length;
+	kfree(buffer.pointer);
+
+	return out;
+}
+
+static void read_record_deps(struct ipu_record *rec)
+{
+	struct acpi_handle_list dep_devices;
+	acpi_status status;
+	int i;
+
+	if (!acpi_has_method(rec->adev->handle, "_DEP"))
+		return;
+
+	status = acpi_evaluate_reference(rec->adev->handle, "_DEP", NULL,
+					 &dep_devices);
+	if (ACPI_FAILURE(status))
+		return;
+
+	for (i = 0; i < dep_devices.count; i++) {
+		struct acpi_buffer buffer = { RECORD_STR_SIZE, rec->deps[i] };
+
+		acpi_get_name(dep_devices.handles[i], ACPI_FULL_PATHNAME,
+			      &buffer);
+	}
+	rec->dep_count = dep_devices.count;
+}
+
+/* Reads the entries of a _DSM that returns a count, then one per func */
+static u64 read_record_dsm_list(struct acpi_device *adev, const guid_t *guid,
+				int dsm_rev, int dsm_func, u64 *out)
+{
+	u64 amount;
+	int i;
+
+	if (get_dsm_data_integer(adev, guid, dsm_rev, dsm_func, &amount))
+		return 0;
+
+	for (i = 0; i < amount && i < RECORD_MAX_DSM_ENTRIES; i++)
+		if (get_dsm_data_integer(adev, guid, dsm_rev,
+					 dsm_func + 1 + i, &out[i]))
+			break;
+
+	return amount;
+}
+
+static void read_record_dsm(struct ipu_record *rec)
+{
+	struct acpi_device *adev = rec->adev;
+	union acpi_object *obj;
+
+	get_dsm_data_string(adev, &subsys_id_dsm_guid, SUBSYS_ID_DSM_REV,
+			    SUBSYS_ID_DSM_RETURN_ID_FUNC, rec->subsys_id,
+			    sizeof(rec->subsys_id));
+
+	rec->i2c_dev_amount =
+		read_record_dsm_list(adev, &i2c_dev_dsm_guid, I2C_DEV_DSM_REV,
+				     I2C_DEV_DSM_DEV_AMOUNT_FUNC,
+				     rec->i2c_devs);
+	rec->gpio_pin_amount =
+		read_record_dsm_list(adev, &pmic_dsm_guid,
+				     DISCRETE_PMIC_DSM_REV,
+				     DISCRETE_PMIC_DSM_GPIO_AMOUNT_FUNC,
+				     rec->gpio_pins);
+
+	obj = acpi_evaluate_dsm_typed(adev->handle, &dsmb_dsm_guid,
+				      DSMB_DSM_REV, DSMB_DSM_RETURN_BUF_FUNC,
+				      NULL, ACPI_TYPE_BUFFER);
+	if (obj) {
+		rec->dsmb = kmemdup(obj->buffer.pointer, obj->buffer.length,
+				    GFP_KERNEL);
+		if (rec->dsmb)
+			rec->dsmb_len = obj->buffer.length;
+		ACPI_FREE(obj);
+	}
+}
+
+static void read_record(void *data, async_cookie_t cookie)
+{
+	struct ipu_record *rec = data;
+	struct acpi_device *adev = rec->adev;
+	struct acpi_buffer buffer = { sizeof(rec->path), rec->path };
+	struct acpi_pld_info *pld;
+	struct device *i2c_dev;
+
+	if (rec->type == RECORD_SENSOR)
+		rec->ret = is_supported_sensor(adev) ?
+			   get_acpi_buf(adev, "SSDB", &rec->ssdb,
+					sizeof(rec->ssdb)) : -ENODEV;
+	else
+		rec->ret = is_supported_pmic(adev) ?
+			   get_acpi_buf(adev, "CLDB", &rec->cldb,
+					sizeof(rec->cldb)) : -ENODEV;
+	if (rec->ret < 0)
+		return;
+
+	rec->data_len = rec->ret;
+	rec->ret = 0;
+
+	acpi_get_name(adev->handle, ACPI_FULL_PATHNAME, &buffer);
+	get_acpi_string(adev, "_DDN", rec->ddn, sizeof(rec->ddn));
+	get_acpi_string(adev, "_SUB", rec->sub, sizeof(rec->sub));
+
+	i2c_dev = bus_find_device_by_acpi_dev(&i2c_bus_type, adev);
+	if (i2c_dev) {
+		strlcpy(rec->i2c_dev, dev_name(i2c_dev), sizeof(rec->i2c_dev));
+		put_device(i2c_dev);
+	}
+
+	read_record_deps(rec);
+
+	if (acpi_has_method(adev->handle, "_PLD") &&
+	    ACPI_SUCCESS(acpi_get_physical_device_location(adev->handle,
+							    &pld))) {
+		rec->pld = *pld;
+		rec->has_pld = true;
+		ACPI_FREE(pld);
+	}
+
+	rec->crs = get_acpi_buf_dup(adev, "_CRS", &rec->crs_len);
+
+	read_record_dsm(rec);
+}
+
+static int acpi_dev_record_cb(struct device *dev, void *data)
+{
+	struct acpi_device *adev = to_acpi_device(dev);
+	struct ipu_record *rec;
+	enum record_type type;
+
+	/* Also false if the device wasn't present at enumeration */
+	if (!acpi_match_device_ids(adev, sensor_hids))
+		type = RECORD_SENSOR;
+	else if (!acpi_match_device_ids(adev, pmic_hids))
+		type = RECORD_PMIC;
+	else
+		return 0;
+
+	rec = kzalloc(sizeof(*rec), GFP_KERNEL);
+	if (!rec)
+		return -ENOMEM;
+
+	rec->adev = adev;
+	rec->type = type;
+	get_device(dev);
+	list_add_tail(&rec->list, &ipu_records);
+
+	async_schedule_domain(read_record, rec, &ipu_records_domain);
+
+	return 0;
+}
+
+static void free_records(void)
+{
+	struct ipu_record *rec, *tmp;
+
+	list_for_each_entry_safe(rec, tmp, &ipu_records, list) {
+		list_del(&rec->list);
+		kfree(rec->crs);
+		kfree(rec->dsmb);
+		put_device(&rec->adev->dev);
+		kfree(rec);
+	}
+}
+
+/* Print @s as a JSON string, or null if NULL or empty */
+static void seq_json_str(struct seq_file *m, const char *key, const char *s)
+{
+	seq_printf(m, ",\"%s\":", key);
+
+	if (!s || !*s) {
+		seq_puts(m, "null");
+		return;
+	}
+
+	seq_putc(m, '"');
+	for (; *s; s++) {
+		if (*s == '"' || *s == '\\')
+			seq_printf(m, "\\%c", *s);
+		else if ((u8)*s < 0x20 || (u8)*s >= 0x7f)
+			seq_printf(m, "\\u%04x", (u8)*s);
+		else
+			seq_putc(m, *s);
+	}
+	seq_putc(m, '"');
+}
+
+/* Print @buf as a string of hex digits, or null if NULL */
+static void seq_json_hex(struct seq_file *m, const char *key,
+			 const u8 *buf, size_t len)
+{
+	size_t i;
+
+	seq_printf(m, ",\"%s\":", key);
+
+	if (!buf) {
+		seq_puts(m, "null");
+		return;
+	}
+
+	seq_putc(m, '"');
+	for (i = 0; i < len; i++)
+		seq_printf(m, "%02x", buf[i]);
+	seq_putc(m, '"');
+}
+
+#define seq_json_u(m, s, field)						\
+	seq_printf(m, ",\"" #field "\":%u", (unsigned int)(s)->field)
+
+static const char *list_str(const char * const *list, size_t n,
+			   unsigned int i)
+{
+	return i < n && list[i] ? list[i] : "UNKNOWN";
+}
+
+static void show_record_pld(struct seq_file *m, struct acpi_pld_info *pld)
+{
+	seq_puts(m, ",\"pld\":{");
+	seq_printf(m, "\"revision\":%u", pld->revision);
+	seq_json_u(m, pld, user_visible);
+	seq_json_u(m, pld, dock);
+	seq_json_u(m, pld, lid);
+	seq_json_u(m, pld, panel);
+	seq_json_u(m, pld, vertical_position);
+	seq_json_u(m, pld, horizontal_position);
+	seq_json_u(m, pld, shape);
+	seq_json_u(m, pld, group_orientation);
+	seq_json_u(m, pld, group_token);
+	seq_json_u(m, pld, group_position);
+	seq_json_u(m, pld, bay);
+	seq_json_u(m, pld, ejectable);
+	seq_json_u(m, pld, cabinet_number);
+	seq_json_u(m, pld, card_cage_number);
+	seq_json_u(m, pld, reference);
+	seq_json_u(m, pld, rotation);
+	seq_json_u(m, pld, order);
+	seq_json_u(m, pld, vertical_offset);
+	seq_json_u(m, pld, horizontal_offset);
+	seq_json_str(m, "panel_str",
+		     list_str(pld_panel_list, ARRAY_SIZE(pld_panel_list),
+			     pld->panel));
+	seq_json_str(m, "vertical_position_str",
+		     list_str(pld_vertical_position_list,
+			     ARRAY_SIZE(pld_vertical_position_list),
+			     pld->vertical_position));
+	seq_json_str(m, "horizontal_position_str",
+		     list_str(pld_horizontal_position_list,
+			     ARRAY_SIZE(pld_horizontal_position_list),
+			     pld->horizontal_position));
+	seq_json_str(m, "shape_str",
+		     list_str(pld_shape_list, ARRAY_SIZE(pld_shape_list),
+			     pld->shape));
+	seq_putc(m, '}');
+}
+
+static void show_record_ssdb(struct seq_file *m, struct intel_ssdb *ssdb)
+{
+	seq_puts(m, ",\"ssdb\":{");
+	seq_printf(m, "\"version\":%u", ssdb->version);
+	seq_json_u(m, ssdb, sensor_card_sku);
+	seq_json_hex(m, "csi2_data_stream_interface",
+		     ssdb->csi2_data_stream_interface,
+		     sizeof(ssdb->csi2_data_stream_interface));
+	seq_json_u(m, ssdb, bdf_value);
+	seq_json_u(m, ssdb, dphy_link_en_fuses);
+	seq_json_u(m, ssdb, lanes_clock_division);
+	seq_json_u(m, ssdb, link_used);
+	seq_json_u(m, ssdb, lanes_used);
+	seq_json_u(m, ssdb, csi_rx_dly_cnt_termen_clane);
+	seq_json_u(m, ssdb, csi_rx_dly_cnt_settle_clane);
+	seq_json_u(m, ssdb, csi_rx_dly_cnt_termen_dlane0);
+	seq_json_u(m, ssdb, csi_rx_dly_cnt_settle_dlane0);
+	seq_json_u(m, ssdb, csi_rx_dly_cnt_termen_dlane1);
+	seq_json_u(m, ssdb, csi_rx_dly_cnt_settle_dlane1);
+	seq_json_u(m, ssdb, csi_rx_dly_cnt_termen_dlane2);
+	seq_json_u(m, ssdb, csi_rx_dly_cnt_settle_dlane2);
+	seq_json_u(m, ssdb, csi_rx_dly_cnt_termen_dlane3);
+	seq_json_u(m, ssdb, csi_rx_dly_cnt_settle_dlane3);
+	seq_json_u(m, ssdb, max_lane_speed);
+	seq_json_u(m, ssdb, sensor_cal_file_idx);
+	seq_json_u(m, ssdb, rom_type);
+	seq_json_u(m, ssdb, vcm_type);
+	seq_json_u(m, ssdb, platform);
+	seq_json_u(m, ssdb, platform_sub);
+	seq_json_u(m, ssdb, flash_support);
+	seq_json_u(m, ssdb, privacy_led);
+	seq_json_u(m, ssdb, degree);
+	seq_json_u(m, ssdb, mipi_define);
+	seq_json_u(m, ssdb, mclk_speed);
+	seq_json_u(m, ssdb, control_logic_id);
+	seq_json_u(m, ssdb, mipi_data_format);
+	seq_json_u(m, ssdb, silicon_version);
+	seq_json_u(m, ssdb, customer_id);
+	seq_json_u(m, ssdb, mclk_port);
+	seq_putc(m, '}');
+}
+
+static void show_record_cldb(struct seq_file *m, struct intel_cldb *cldb)
+{
+	unsigned int type = cldb->control_logic_type;
+
+	seq_puts(m, ",\"cldb\":{");
+	seq_printf(m, "\"version\":%u", cldb->version);
+	seq_json_u(m, cldb, control_logic_type);
+	seq_json_str(m, "control_logic_type_str",
+		     list_str(control_logic_type_list,
+			     ARRAY_SIZE(control_logic_type_list), type));
+	seq_json_u(m, cldb, control_logic_id);
+	seq_json_u(m, cldb, sensor_card_sku);
+	seq_putc(m, '}');
+}
+
+static void show_record_dsm(struct seq_file *m, struct ipu_record *rec)
+{
+	u64 n, v;
+	int i;
+
+	n = min_t(u64, rec->i2c_dev_amount, RECORD_MAX_DSM_ENTRIES);
+	seq_printf(m, ",\"dsm\":{\"i2c_dev_amount\":%llu,\"i2c_devs\":[",
+		   rec->i2c_dev_amount);
+	for (i = 0; i < n; i++) {
+		v = rec->i2c_devs[i];
+		seq_printf(m, "%s{\"raw\":%llu,\"bus\":%llu,\"second_byte\":%llu,\"addr\":%llu,\"dev_type\":%llu}",
+			   i ? "," : "", v, (v >> 24) & 0xff,
+			   (v >> 16) & 0xff, (v >> 8) & 0xff, v & 0xff);
+	}
+	seq_putc(m, ']');
+
+	n = min_t(u64, rec->gpio_pin_amount, RECORD_MAX_DSM_ENTRIES);
+	seq_printf(m, ",\"gpio_pin_amount\":%llu,\"gpio_pins\":[",
+		   rec->gpio_pin_amount);
+	for (i = 0; i < n; i++) {
+		v = rec->gpio_pins[i];
+		seq_printf(m, "%s{\"raw\":%llu,\"first_byte\":%llu,\"second_byte\":%llu,\"pin_num\":%llu,\"last_byte\":%llu}",
+			   i ? "," : "", v, (v >> 24) & 0xff,
+			   (v >> 16) & 0xff, (v >> 8) & 0xff, v & 0xff);
+	}
+	seq_putc(m, ']');
+
+	seq_json_str(m, "subsys_id", rec->subsys_id);
+	seq_json_hex(m, "dsmb", rec->dsmb, rec->dsmb_len);
+	seq_putc(m, '}');
+}
+
+static void show_system(struct seq_file *m)
+{
+	struct ipu_record *rec;
+	int sensors = 0, pmics = 0;
+
+	list_for_each_entry(rec, &ipu_records, list) {
+		if (rec->ret)
+			continue;
+		if (rec->type == RECORD_SENSOR)
+			sensors++;
+		else
+			pmics++;
+	}
+
+	seq_printf(m, "{\"version\":\"%s\"", DRV_VERSION);
+	seq_json_str(m, "sys_vendor", dmi_get_system_info(DMI_SYS_VENDOR));
+	seq_json_str(m, "product_name",
+		     dmi_get_system_info(DMI_PRODUCT_NAME));
+	seq_json_str(m, "product_sku", dmi_get_system_info(DMI_PRODUCT_SKU));
+	seq_json_str(m, "bios_version",
+		     dmi_get_system_info(DMI_BIOS_VERSION));
+	seq_printf(m, ",\"sensors\":%d,\"pmics\":%d}\n", sensors, pmics);
+}
+
+static int ipu_records_show(struct seq_file *m, void *v)
+{
+	struct ipu_record *rec;
+	int i;
+
+	if (v == &ipu_records) {
+		show_system(m);
+		return 0;
+	}
+
+	rec = list_entry(v, struct ipu_record, list);
+
+	seq_printf(m, "{\"device\":\"%s\"", dev_name(&rec->adev->dev));
+	seq_json_str(m, "type",
+		     rec->type == RECORD_SENSOR ? "sensor" : "pmic");
+	seq_json_str(m, "hid", acpi_device_hid(rec->adev));
+	seq_json_str(m, "uid", rec->adev->pnp.unique_id);
+	if (rec->ret) {
+		seq_printf(m, ",\"error\":%d}\n", rec->ret);
+		return 0;
+	}
+
+	seq_json_str(m, "path", rec->path);
+	seq_json_str(m, "ddn", rec->ddn);
+	seq_json_str(m, "sub", rec->sub);
+	seq_json_str(m, "i2c_dev", rec->i2c_dev);
+
+	seq_puts(m, ",\"dep\":[");
+	for (i = 0; i < rec->dep_count; i++)
+		seq_printf(m, "%s\"%s\"", i ? "," : "", rec->deps[i]);
+	seq_putc(m, ']');
+
+	if (rec->has_pld)
+		show_record_pld(m, &rec->pld);
+	else
+		seq_puts(m, ",\"pld\":null");
+	seq_json_hex(m, "crs", rec->crs, rec->crs_len);
+
+	if (rec->type == RECORD_SENSOR) {
+		show_record_ssdb(m, &rec->ssdb);
+		seq_json_hex(m, "ssdb_raw", (u8 *)&rec->ssdb, rec->data_len);
+	} else {
+		show_record_cldb(m, &rec->cldb);
+		seq_json_hex(m, "cldb_raw", (u8 *)&rec->cldb, rec->data_len);
+	}
+
+	show_record_dsm(m, rec);
+	seq_puts(m, "}\n");
+
+	return 0;
+}
+
+static void *ipu_records_start(struct seq_file *m, loff_t *pos)
+{
+	return seq_list_start_head(&ipu_records, *pos);
+}
+
+static void *ipu_records_next(struct seq_file *m, void *v, loff_t *pos)
+{
+	return seq_list_next(v, &ipu_records, pos);
+}
+
+static void ipu_records_stop(struct seq_file *m, void *v)
+{
+}
+
+static const struct seq_operations ipu_records_sops = {
+	.start = ipu_records_start,
+	.next = ipu_records_next,
+	.stop = ipu_records_stop,
+	.show = ipu_records_show,
+};
+DEFINE_SEQ_ATTRIBUTE(ipu_records);
+
+static int dump_to_debugfs(void)
+{
+	int ret;
+
+	ret = bus_for_each_dev(dump_intel_ipu_data_driver.drv.bus, NULL, NULL,
+			       acpi_dev_record_cb);
+	async_synchronize_full_domain(&ipu_records_domain);
+	if (ret) {
+		free_records();
+		return ret;
+	}
+
+	ipu_records_dir = debugfs_create_dir(DRV_NAME, NULL);
+	debugfs_create_file("devices", 0444, ipu_records_dir, NULL,
+			    &ipu_records_fops);
+
+	return 0;
+}
+
 static int __init dump_intel_ipu_data_init(void)
 {
 	struct device_count dev_cnt = { 0 };
@@ -787,6 +1330,21 @@ static int __init dump_intel_ipu_data_init(void)
 		return ret;
 	}
 
+	if (!strcmp(output, "debugfs")) {
+		ret = dump_to_debugfs();
+		if (ret) {
+			pr_err(DRV_NAME ": Failed reading devices: %d\n", ret);
+			acpi_bus_unregister_driver(&dump_intel_ipu_data_driver);
+		}
+		return ret;
+	}
+
+	if (strcmp(output, "dmesg")) {
+		pr_err(DRV_NAME ": Unknown output %s\n", output);
+		acpi_bus_unregister_driver(&dump_intel_ipu_data_driver);
+		return -EINVAL;
+	}
+
 	/* iterate over all ACPI devices */
 	bus_for_each_dev(dump_intel_ipu_data_driver.drv.bus, NULL, &dev_cnt,
 			 acpi_dev_match_cb);
@@ -799,6 +1357,8 @@ static int __init dump_intel_ipu_data_init(void)
 
 static void __exit dump_intel_ipu_data_exit(void)
 {
+	debugfs_remove_recursive(ipu_records_dir);
+	free_records();
 	acpi_bus_unregister_driver(&dump_intel_ipu_data_driver);
 }
 
@@ -198,3 +198,46 @@ static const guid_t pmic_dsm_guid =
 static const guid_t dsmb_dsm_guid =
 	GUID_INIT(0x5815c5c8, 0xc47d, 0x477b,
 		  0x9a, 0x8d, 0x76, 0x17, 0x31, 0x76, 0x41, 0x4b);
+
+/* Entries kept of each _DSM that returns a list */
+#define RECORD_MAX_DSM_ENTRIES	16
+#define RECORD_STR_SIZE		64
+
+enum record_type {
+	RECORD_SENSOR,
+	RECORD_PMIC,
+};
+
+/* Everything dumped about one device, for the debugfs output */
+struct ipu_record {
+	struct list_head list;
+	struct acpi_device *adev;
+	enum record_type type;
+	int ret;				/* Reading SSDB/CLDB failed */
+
+	char path[RECORD_STR_SIZE];
+	char ddn[RECORD_STR_SIZE];
+	char sub[RECORD_STR_SIZE];
+	char i2c_dev[RECORD_STR_SIZE];
+	char deps[ACPI_MAX_HANDLES][RECORD_STR_SIZE];
+	u32 dep_count;
+
+	bool has_pld;
+	struct acpi_pld_info pld;
+	u8 *crs;
+	u32 crs_len;
+
+	union {
+		struct intel_ssdb ssdb;
+		struct intel_cldb cldb;
+	};
+	int data_len;				/* Bytes of SSDB or CLDB */
+
+	char subsys_id[DSM_STR_BUF_SIZE];
+	u64 i2c_dev_amount;
+	u64 i2c_devs[RECORD_MAX_DSM_ENTRIES];
+	u64 gpio_pin_amount;
+	u64 gpio_pins[RECORD_MAX_DSM_ENTRIES];
+	u8 *dsmb;
+	u32 dsmb_len;
+};
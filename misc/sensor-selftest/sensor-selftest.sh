@@ -0,0 +1,138 @@
+#!/bin/bash
+
+# Stream every mode of each sensor, with its test pattern if it has one,
+# and hand what was received to the driver, which checks it against the
+# mode timing (see common/sensor_selftest.h).
+#
+# Usage: sudo bash sensor-selftest.sh [frames per mode]
+
+frames=${1:-120}
+here=$(dirname "$0")
+debugfs=/sys/kernel/debug
+
+# IPU3 packed pixel format of a media bus code
+pixfmt ()
+{
+    case $1 in
+        SBGGR10*) echo ip3b ;;
+        SGBRG10*) echo ip3g ;;
+        SGRBG10*) echo ip3G ;;
+        SRGGB10*) echo ip3r ;;
+        Y10*)     echo ip3y ;;
+    esac
+}
+
+# Entity the first link of entity $2 on media device $1 goes to
+link_sink ()
+{
+    media-ctl -d "$1" -p | awk -v e="$2" '
+        /^- entity/ {
+            sub(/^- entity [0-9]+: /, ""); sub(/ \([0-9]+ pads?.*/, "")
+            cur = $0
+        }
+        cur == e && /->/ { split($0, f, "\""); print f[2]; exit }'
+}
+
+# Capture from video node $1, print "frames dropped bytes first_us last_us"
+capture ()
+{
+    v4l2-ctl -d "$1" --stream-mmap=4 --stream-count="$frames" \
+        --stream-to=/dev/null --verbose 2>&1 | awk '
+        / seq: / {
+            for (i = 1; i < NF; i++) {
+                if ($i == "seq:")       seq = $(i + 1)
+                if ($i == "bytesused:") bytes += $(i + 1)
+                if ($i == "ts:")        ts = $(i + 1)
+            }
+            if (!n++) { first_seq = seq; first = ts }
+            last_seq = seq; last = ts
+        }
+        END {
+            printf "%d %d %.0f %.0f %.0f\n", n,
+                   n ? last_seq - first_seq + 1 - n : 0, bytes,
+                   first * 1000000, last * 1000000
+        }'
+}
+
+# Stream each frame size and rate of the sensor with debugfs dir $1
+selftest ()
+{
+    local i2c name subdev media csi2 cio2 video code mcode pix pattern
+    local size w h rates fps
+
+    i2c=$(basename "$1")
+    subdev=$(ls /sys/bus/i2c/devices/"$i2c"/video4linux 2>/dev/null |
+             grep v4l-subdev | head -n 1)
+    [ -n "$subdev" ] || return
+    name=$(cat /sys/class/video4linux/"$subdev"/name)
+    subdev=/dev/$subdev
+
+    for media in /dev/media*; do
+        media-ctl -d "$media" -e "$name" >/dev/null 2>&1 && break
+    done
+    csi2=$(link_sink "$media" "$name")
+    cio2=$(link_sink "$media" "$csi2")
+    video=$(media-ctl -d "$media" -e "$cio2")
+    if [ -z "$csi2" ] || [ -z "$video" ]; then
+        echo "$name: no capture pipeline found"
+        return
+    fi
+
+    code=$(media-ctl -d "$media" --get-v4l2 "\"$name\":0" |
+           sed -n 's/.*fmt:\([^/]*\)\/.*/\1/p')
+    mcode=$(v4l2-ctl -d "$subdev" --list-subdev-mbus-codes pad=0 |
+            grep -o '0x[0-9a-f]*' | head -n 1)
+    pix=$(pixfmt "$code")
+
+    echo "$name: $subdev -> $csi2 -> $video ($code)"
+    media-ctl -d "$media" -l "\"$name\":0 -> \"$csi2\":0[1]"
+
+    pattern=0
+    if v4l2-ctl -d "$subdev" -C test_pattern >/dev/null 2>&1; then
+        pattern=1
+        v4l2-ctl -d "$subdev" -c test_pattern=1
+    else
+        echo "$name: no test pattern, streaming the image"
+    fi
+
+    echo clear > "$1/selftest"
+
+    for size in $(v4l2-ctl -d "$subdev" --list-subdev-framesizes \
+                  pad=0,code="$mcode" | grep -o '[0-9]*x[0-9]*' | sort -u); do
+        w=${size%x*}
+        h=${size#*x}
+
+        media-ctl -d "$media" -V "\"$name\":0 [fmt:$code/$size]"
+        media-ctl -d "$media" -V "\"$csi2\":0 [fmt:$code/$size]"
+        v4l2-ctl -d "$video" \
+            --set-fmt-video=width="$w",height="$h",pixelformat="$pix"
+
+        rates=$(v4l2-ctl -d "$subdev" --list-subdev-frameintervals \
+                pad=0,width="$w",height="$h",code="$mcode" |
+                sed -n 's/.*(\([0-9.]*\) fps).*/\1/p')
+        if [ -z "$rates" ]; then
+            # No frame intervals listed, the default rate of the size
+            capture "$video" > "$1/selftest"
+            continue
+        fi
+
+        for fps in $rates; do
+            v4l2-ctl -d "$subdev" --set-subdev-fps pad=0,fps="$fps"
+            capture "$video" > "$1/selftest"
+        done
+    done
+
+    [ $pattern = 1 ] && v4l2-ctl -d "$subdev" -c test_pattern=0
+
+    echo "$name:"
+    cat "$1/selftest"
+    echo ""
+}
+
+# Media graph, as libcamera-info prints it
+bash "$here/../libcamera-info/libcamera-info.sh"
+echo ""
+
+for dir in "$debugfs"/*; do
+    [ -e "$dir/selftest" ] && selftest "$dir"
+done
@@ -1,84 +1,550 @@
 /**
- * This tool parses the SSDB fields and dumps many of the fields.
+ * This tool decodes SSDB/CLDB buffers in batch and prints one row per
+ * camera, as CSV or as JSON lines.
+ *
+ * Input files are memory-mapped and decoded in place. A file is either:
+ * - one raw SSDB or CLDB buffer, told apart by its size, or a run of
+ *   them of the type given with -t
+ * - a dump_intel_ipu_data result (the dmesg log, markdown or not). Each
+ *   sensor is joined with the PMIC it depends on, through its _DEP, or
+ *   its SSDB control_logic_id if that isn't in the log.
+ * Without files, the buffers in ssdb_dump.h are decoded.
+ *
+ * Nothing is allocated per file or per record: the names point into the
+ * mapped file and the devices of a file are kept in a fixed array.
  */
 
-#include <stdio.h>
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
 #include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "ssdb_dump.h"
 
-void dump_ssdb(uint8_t *data) {
-	struct intel_ssdb *d =
-		(struct intel_ssdb *)data;
-
-	printf("========== %s() ==========\n", __func__);
-
-	printf("lanes_clock_division: %d\n", d->lanes_clock_division);
-	printf("link_used: %d\n", d->link_used);
-	printf("lanes_used: %d\n", d->lanes_used);
-	printf("vcm_type: %d\n", d->vcm_type);
-	printf("flash_support: %d\n", d->flash_support);
-	printf("degree: %d\n", d->degree);
-	printf("mclk_port: %d\n", d->mclk_port);
-	printf("mclk_speed: %d\n", d->mclk_speed);
-
-	printf("/* Additional data */\n");
-	printf("lanes_clock_division: %d\n", d->lanes_clock_division);
-	printf("rom_type: %d\n", d->rom_type);
-	printf("privacy_led: %d\n", d->privacy_led);
-	printf("mipi_define: %d\n", d->mipi_define);
-	printf("control_logic_id: %d\n", d->control_logic_id);
-
-	printf("\n");
-}
-
-void dump_cldb(uint8_t *data) {
-	struct intel_cldb *d =
-		(struct intel_cldb *)data;
-
-	printf("========== %s() ==========\n", __func__);
-
-	printf("version: %d\n", d->version);
-	printf("control_logic_type: %d\n", d->control_logic_type);
-	printf("control_logic_id: %d\n", d->control_logic_id);
-	printf("sensor_card_sku: %d\n", d->sensor_card_sku);
-
-	printf("\n");
-}
-
-int main() {
-	/* SB2 */
-	printf("-------------------- SB2 CAMR --------------------\n");
-	dump_ssdb(sb2_camr_ssdb);
-	dump_cldb(sb2_camr_skc0_cldb);
-	printf("-------------------- SB2 CAMF --------------------\n");
-	dump_ssdb(sb2_camf_ssdb);
-	dump_cldb(sb2_camf_skc1_cldb);
-	printf("-------------------- SB2 CAM3 --------------------\n");
-	dump_ssdb(sb2_cam3_ssdb);
-	dump_cldb(sb2_cam3_skc2_cldb);
-
-	/* SB1 */
-	printf("-------------------- SB1 CAMR --------------------\n");
-	dump_ssdb(sb1_camr_ssdb);
-	dump_cldb(sb1_camr_skc0_cldb);
-	printf("-------------------- SB1 CAMF --------------------\n");
-	dump_ssdb(sb1_camf_ssdb);
-	dump_cldb(sb1_camf_skc1_cldb);
-	printf("-------------------- SB1 CAM3 --------------------\n");
-	dump_ssdb(sb1_cam3_ssdb);
-	dump_cldb(sb1_cam3_skc2_cldb);
-
-	/* SGO2 */
-	printf("-------------------- SGO2 LNK0 --------------------\n");
-	dump_ssdb(sgo2_lnk0_ssdb);
-	printf("-------------------- SGO2 LNK1 --------------------\n");
-	dump_ssdb(sgo2_lnk1_ssdb);
-	printf("-------------------- SGO2 LNK2 --------------------\n");
-	dump_ssdb(sgo2_lnk2_ssdb);
-	printf("-------------------- SGO2 LNK0/LNK2 CLDB --------------------\n");
-	dump_cldb(sgo2_lnk0_lnk2_clp0_cldb);
-	printf("-------------------- SGO2 LNK1 CLDB --------------------\n");
-	dump_cldb(sgo2_lnk1_dsc1_cldb);
+#define ARRAY_SIZE(a)	(sizeof(a) / sizeof((a)[0]))
+
+/* Devices kept of one result file */
+#define MAX_DEVS	32
+
+struct slice {
+	const char *p;
+	size_t len;
+};
+
+#define SLICE(s)	((struct slice){ (s), sizeof(s) - 1 })
+
+struct dev {
+	struct slice name;
+	struct slice hid;
+	struct slice path;
+	struct slice dep;		/* First _DEP, the PMIC of a sensor */
+	int is_pmic;
+	size_t len;			/* Bytes of SSDB or CLDB read */
+	union {
+		uint8_t raw[sizeof(struct intel_ssdb)];
+		struct intel_ssdb ssdb;
+		struct intel_cldb cldb;
+	};
+};
+
+struct machine {
+	struct slice source;		/* File name, or the built-in table */
+	struct slice product_name;
+	struct slice product_sku;
+};
+
+enum format {
+	FMT_CSV,
+	FMT_JSON,
+};
+
+static enum format fmt = FMT_CSV;
+static int header;		/* Print the keys instead of the values */
+static int first;		/* No separator before the next field */
+
+static const char *control_logic_type_list[] = {
+	"UNKNOWN",
+	"DISCRETE",
+	"TPS68470",
+	"UP6641",
+};
+
+static struct dev devs[MAX_DEVS];
+
+static void put_key(const char *key)
+{
+	if (!first)
+		putchar(',');
+	first = 0;
+
+	if (header)
+		fputs(key, stdout);
+	else if (fmt == FMT_JSON)
+		printf("\"%s\":", key);
+}
+
+static void put_str(const char *key, struct slice s)
+{
+	size_t i;
+
+	put_key(key);
+	if (header)
+		return;
+
+	if (!s.p || !s.len) {
+		if (fmt == FMT_JSON)
+			fputs("null", stdout);
+		return;
+	}
+
+	if (fmt == FMT_CSV && !memchr(s.p, ',', s.len) &&
+	    !memchr(s.p, '"', s.len)) {
+		fwrite(s.p, 1, s.len, stdout);
+		return;
+	}
+
+	putchar('"');
+	for (i = 0; i < s.len; i++) {
+		unsigned char c = s.p[i];
+
+		if (fmt == FMT_CSV) {
+			if (c == '"')
+				putchar('"');
+			putchar(c);
+		} else if (c == '"' || c == '\\') {
+			printf("\\%c", c);
+		} else if (c < 0x20 || c >= 0x7f) {
+			printf("\\u%04x", c);
+		} else {
+			putchar(c);
+		}
+	}
+	putchar('"');
+}
+
+/* An empty CSV field, or null, if !@valid */
+static void put_u(const char *key, unsigned long v, int valid)
+{
+	put_key(key);
+	if (header)
+		return;
+
+	if (valid)
+		printf("%lu", v);
+	else if (fmt == FMT_JSON)
+		fputs("null", stdout);
+}
+
+static void begin_row(void)
+{
+	first = 1;
+	if (!header && fmt == FMT_JSON)
+		putchar('{');
+}
+
+static void end_row(void)
+{
+	if (!header && fmt == FMT_JSON)
+		putchar('}');
+	putchar('\n');
+}
+
+#define put_ssdb(field)	put_u(#field, s ? s->ssdb.field : 0, s != NULL)
+#define put_cldb(field)	put_u(#field, p ? p->cldb.field : 0, p != NULL)
+
+/* One camera: sensor @s and its PMIC @p, either may be NULL */
+static void put_row(const struct machine *m, const struct dev *s,
+		    const struct dev *p)
+{
+	static const struct slice none;
+	unsigned int type = p ? p->cldb.control_logic_type : 0;
+
+	begin_row();
+
+	put_str("source", m->source);
+	put_str("product_name", m->product_name);
+	put_str("product_sku", m->product_sku);
+
+	put_str("device", s ? s->name : none);
+	put_str("hid", s ? s->hid : none);
+	put_str("path", s ? s->path : none);
+	put_u("ssdb_len", s ? s->len : 0, s != NULL);
+	put_ssdb(version);
+	put_ssdb(sensor_card_sku);
+	put_ssdb(link_used);
+	put_ssdb(lanes_used);
+	put_ssdb(lanes_clock_division);
+	put_ssdb(max_lane_speed);
+	put_ssdb(mclk_speed);
+	put_ssdb(mclk_port);
+	put_ssdb(degree);
+	put_ssdb(rom_type);
+	put_ssdb(vcm_type);
+	put_ssdb(flash_support);
+	put_ssdb(privacy_led);
+	put_ssdb(mipi_define);
+	put_ssdb(mipi_data_format);
+	put_ssdb(platform);
+	put_ssdb(platform_sub);
+	put_ssdb(silicon_version);
+	put_ssdb(customer_id);
+	put_ssdb(control_logic_id);
+
+	put_str("pmic_device", p ? p->name : none);
+	put_str("pmic_hid", p ? p->hid : none);
+	put_str("pmic_path", p ? p->path : none);
+	put_u("pmic_control_logic_id", p ? p->cldb.control_logic_id : 0,
+	      p != NULL);
+	put_cldb(control_logic_type);
+	put_str("control_logic_type_str",
+		p && type < ARRAY_SIZE(control_logic_type_list) ?
+		(struct slice){ control_logic_type_list[type],
+				strlen(control_logic_type_list[type]) } :
+		none);
+
+	end_row();
+}
+
+static void put_header(void)
+{
+	static const struct machine m;
+
+	if (fmt == FMT_JSON)
+		return;
+
+	header = 1;
+	put_row(&m, NULL, NULL);
+	header = 0;
+}
+
+static int slice_eq(struct slice a, struct slice b)
+{
+	return a.len && a.len == b.len && !memcmp(a.p, b.p, a.len);
+}
+
+/* Rest of @line after @key, if @key is in it */
+static int find(struct slice line, const char *key, struct slice *rest)
+{
+	size_t n = strlen(key);
+	const char *p = memmem(line.p, line.len, key, n);
+
+	if (!p)
+		return 0;
+
+	if (rest) {
+		rest->p = p + n;
+		rest->len = line.p + line.len - rest->p;
+	}
+
+	return 1;
+}
+
+static int hexval(char c)
+{
+	if (c >= '0' && c <= '9')
+		return c - '0';
+	if (c >= 'a' && c <= 'f')
+		return c - 'a' + 10;
+	if (c >= 'A' && c <= 'F')
+		return c - 'A' + 10;
+	return -1;
+}
+
+/*
+ * Append one print_hex_dump() line, "00000010: 00 01 ...  ascii", to @d.
+ * Returns 0 if @line isn't the next line of the dump of @d.
+ */
+static int parse_hex_line(struct slice line, struct dev *d)
+{
+	const char *q = line.p, *end = line.p + line.len;
+	struct slice rest;
+	size_t off = 0;
+	int i;
+
+	/* Skip the dmesg prefix and timestamp, if any */
+	if (find(line, "] ", &rest))
+		q = rest.p;
+
+	if (end - q < 9 || q[8] != ':')
+		return 0;
+
+	for (i = 0; i < 8; i++) {
+		if (hexval(q[i]) < 0)
+			return 0;
+		off = off << 4 | hexval(q[i]);
+	}
+	if (off != d->len)
+		return 0;
+
+	for (q += 9; end - q >= 3 && q[0] == ' ' &&
+	     hexval(q[1]) >= 0 && hexval(q[2]) >= 0; q += 3) {
+		if (d->len == sizeof(d->raw))
+			break;
+		d->raw[d->len++] = hexval(q[1]) << 4 | hexval(q[2]);
+	}
+
+	return 1;
+}
+
+static const struct dev *find_pmic(int ndevs, const struct dev *s)
+{
+	int i;
+
+	for (i = 0; i < ndevs; i++)
+		if (devs[i].is_pmic && devs[i].len &&
+		    slice_eq(devs[i].path, s->dep))
+			return &devs[i];
+
+	for (i = 0; i < ndevs; i++)
+		if (devs[i].is_pmic && devs[i].len &&
+		    devs[i].cldb.control_logic_id == s->ssdb.control_logic_id)
+			return &devs[i];
+
+	return NULL;
+}
+
+static void decode_result(struct machine *m, const char *buf, size_t size)
+{
+	const char *p = buf, *end = buf + size, *eol, *sp;
+	struct slice line, rest;
+	struct dev *cur = NULL;
+	int ndevs = 0, in_hex = 0;
+	int i;
+
+	for (; p < end; p = eol + 1) {
+		eol = memchr(p, '\n', end - p);
+		if (!eol)
+			eol = end;
+		line.p = p;
+		line.len = eol - p;
+		if (line.len && p[line.len - 1] == '\r')
+			line.len--;
+
+		if (in_hex) {
+			in_hex = parse_hex_line(line, cur);
+			if (in_hex)
+				continue;
+		}
+
+		if (find(line, "==================== ", &rest)) {
+			if (ndevs == MAX_DEVS) {
+				fprintf(stderr, "%.*s: more than %d devices\n",
+					(int)m->source.len, m->source.p,
+					MAX_DEVS);
+				cur = NULL;
+				continue;
+			}
+			cur = &devs[ndevs++];
+			memset(cur, 0, sizeof(*cur));
+			cur->name.p = rest.p;
+			sp = memchr(rest.p, ' ', rest.len);
+			cur->name.len = sp ? (size_t)(sp - rest.p) : rest.len;
+			cur->is_pmic = find(line, "(PMIC)", NULL);
+		} else if (find(line, "/sys/class/dmi/id/product_name:",
+				&rest)) {
+			m->product_name = rest;
+		} else if (find(line, "/sys/class/dmi/id/product_sku:",
+				&rest)) {
+			m->product_sku = rest;
+		} else if (!cur) {
+			continue;
+		} else if (find(line, "ACPI _HID: ", &rest)) {
+			cur->hid = rest;
+		} else if (find(line, "ACPI path: ", &rest)) {
+			cur->path = rest;
+		} else if (find(line, "ACPI _DEP (1 of ", NULL) &&
+			   find(line, "): ", &rest)) {
+			cur->dep = rest;
+		} else if (find(line, cur->is_pmic ?
+				"ACPI CLDB: Full raw output:" :
+				"ACPI SSDB: Full raw output:", NULL)) {
+			cur->len = 0;
+			in_hex = 1;
+		}
+	}
+
+	for (i = 0; i < ndevs; i++)
+		if (!devs[i].is_pmic && devs[i].len)
+			put_row(m, &devs[i], find_pmic(ndevs, &devs[i]));
+}
+
+enum raw_type {
+	RAW_AUTO,
+	RAW_SSDB,
+	RAW_CLDB,
+};
+
+static void decode_raw(struct machine *m, const uint8_t *buf, size_t size,
+		       enum raw_type type)
+{
+	size_t n = type == RAW_SSDB ? sizeof(struct intel_ssdb) :
+				      sizeof(struct intel_cldb);
+	struct dev *d = &devs[0];
+	size_t off;
+
+	for (off = 0; off + n <= size; off += n) {
+		memset(d, 0, sizeof(*d));
+		memcpy(d->raw, buf + off, n);
+		d->len = n;
+
+		if (type == RAW_SSDB)
+			put_row(m, d, NULL);
+		else
+			put_row(m, NULL, d);
+	}
+
+	if (off != size)
+		fprintf(stderr, "%.*s: %zu trailing bytes ignored\n",
+			(int)m->source.len, m->source.p, size - off);
+}
+
+static int decode_file(const char *path, enum raw_type type)
+{
+	struct machine m = { .source = { path, strlen(path) } };
+	struct stat st;
+	void *buf;
+	int fd;
+
+	fd = open(path, O_RDONLY);
+	if (fd < 0 || fstat(fd, &st)) {
+		fprintf(stderr, "%s: %s\n", path, strerror(errno));
+		if (fd >= 0)
+			close(fd);
+		return -1;
+	}
+
+	if (!st.st_size) {
+		close(fd);
+		return 0;
+	}
+
+	buf = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (buf == MAP_FAILED) {
+		fprintf(stderr, "%s: %s\n", path, strerror(errno));
+		return -1;
+	}
+	madvise(buf, st.st_size, MADV_SEQUENTIAL);
+
+	if (type == RAW_AUTO && st.st_size == sizeof(struct intel_ssdb))
+		type = RAW_SSDB;
+	else if (type == RAW_AUTO && st.st_size == sizeof(struct intel_cldb))
+		type = RAW_CLDB;
+
+	if (type == RAW_AUTO)
+		decode_result(&m, buf, st.st_size);
+	else
+		decode_raw(&m, buf, st.st_size, type);
+
+	munmap(buf, st.st_size);
 
 	return 0;
 }
+
+/* The buffers of ssdb_dump.h, sensor and PMIC */
+#define BUILTIN(_machine, _name, _ssdb, _cldb)				\
+	{ SLICE(_machine), SLICE(_name), _ssdb, sizeof(_ssdb),		\
+	  _cldb, sizeof(_cldb) }
+
+static const struct builtin {
+	struct slice machine;
+	struct slice name;
+	const uint8_t *ssdb;
+	size_t ssdb_len;
+	const uint8_t *cldb;
+	size_t cldb_len;
+} builtins[] = {
+	BUILTIN("SB2", "CAMR", sb2_camr_ssdb, sb2_camr_skc0_cldb),
+	BUILTIN("SB2", "CAMF", sb2_camf_ssdb, sb2_camf_skc1_cldb),
+	BUILTIN("SB2", "CAM3", sb2_cam3_ssdb, sb2_cam3_skc2_cldb),
+	BUILTIN("SB1", "CAMR", sb1_camr_ssdb, sb1_camr_skc0_cldb),
+	BUILTIN("SB1", "CAMF", sb1_camf_ssdb, sb1_camf_skc1_cldb),
+	BUILTIN("SB1", "CAM3", sb1_cam3_ssdb, sb1_cam3_skc2_cldb),
+	BUILTIN("SGO2", "LNK0", sgo2_lnk0_ssdb, sgo2_lnk0_lnk2_clp0_cldb),
+	BUILTIN("SGO2", "LNK1", sgo2_lnk1_ssdb, sgo2_lnk1_dsc1_cldb),
+	BUILTIN("SGO2", "LNK2", sgo2_lnk2_ssdb, sgo2_lnk0_lnk2_clp0_cldb),
+};
+
+static void decode_builtins(void)
+{
+	struct dev *s = &devs[0], *p = &devs[1];
+	size_t i;
+
+	for (i = 0; i < ARRAY_SIZE(builtins); i++) {
+		const struct builtin *b = &builtins[i];
+		struct machine m = {
+			.source = SLICE("ssdb_dump.h"),
+			.product_name = b->machine,
+		};
+
+		memset(s, 0, sizeof(*s));
+		memset(p, 0, sizeof(*p));
+		s->name = b->name;
+		s->len = b->ssdb_len < sizeof(s->raw) ? b->ssdb_len :
+							sizeof(s->raw);
+		memcpy(s->raw, b->ssdb, s->len);
+		p->len = b->cldb_len < sizeof(p->cldb) ? b->cldb_len :
+							 sizeof(p->cldb);
+		memcpy(p->raw, b->cldb, p->len);
+
+		put_row(&m, s, p);
+	}
+}
+
+static void usage(const char *prog)
+{
+	fprintf(stderr,
+		"usage: %s [-c | -j] [-t ssdb|cldb] [file...]\n"
+		"  -c  CSV with a header line (default)\n"
+		"  -j  JSON, one object per line\n"
+		"  -t  files are raw SSDBs or CLDBs, back to back\n"
+		"Files of the size of one SSDB or CLDB are raw buffers, other\n"
+		"files dump_intel_ipu_data results. Without files, the tables\n"
+		"built in are decoded.\n", prog);
+}
+
+int main(int argc, char **argv)
+{
+	enum raw_type type = RAW_AUTO;
+	int opt, ret = 0;
+
+	while ((opt = getopt(argc, argv, "cjt:h")) != -1) {
+		switch (opt) {
+		case 'c':
+			fmt = FMT_CSV;
+			break;
+		case 'j':
+			fmt = FMT_JSON;
+			break;
+		case 't':
+			if (!strcmp(optarg, "ssdb")) {
+				type = RAW_SSDB;
+			} else if (!strcmp(optarg, "cldb")) {
+				type = RAW_CLDB;
+			} else {
+				usage(argv[0]);
+				return 1;
+			}
+			break;
+		default:
+			usage(argv[0]);
+			return opt == 'h' ? 0 : 1;
+		}
+	}
+
+	put_header();
+
+	if (optind == argc)
+		decode_builtins();
+
+	for (; optind < argc; optind++)
+		if (decode_file(argv[optind], type))
+			ret = 1;
+
+	return ret;
+}
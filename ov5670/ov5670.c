@@ -2,14 +2,26 @@
 // Copyright (c) 2017 Intel Corporation.
 
 #include <linux/acpi.h>
+#include <linux/debugfs.h>
 #include <linux/delay.h>
 #include <linux/i2c.h>
 #include <linux/module.h>
 #include <linux/pm_runtime.h>
+#include <linux/workqueue.h>
 #include <media/v4l2-ctrls.h>
 #include <media/v4l2-device.h>
+#include <media/v4l2-event.h>
 #include <media/v4l2-fwnode.h>
 
+#include "sensor_burst.h"
+#include "sensor_dep.h"
+#include "sensor_link.h"
+#include "sensor_meta.h"
+#include "sensor_power.h"
+#include "sensor_reg.h"
+#include "sensor_selftest.h"
+#include "sensor_seq.h"
+
 #define OV5670_HID "INT3479"
 
 #define OV5670_REG_CHIP_ID		0x300a
@@ -30,6 +42,30 @@
 /* horizontal-timings from sensor */
 #define OV5670_REG_HTS			0x380c
 
+/* Array window the mode tables read out, the analog crop */
+#define OV5670_REG_X_ADDR_START		0x3800
+#define OV5670_REG_Y_ADDR_START		0x3802
+#define OV5670_REG_X_ADDR_END		0x3804
+#define OV5670_REG_Y_ADDR_END		0x3806
+
+/* Output size, and the ISP window offset in the array window */
+#define OV5670_REG_X_OUTPUT_SIZE	0x3808
+#define OV5670_REG_Y_OUTPUT_SIZE	0x380a
+#define OV5670_REG_ISP_X_OFFSET		0x3811
+#define OV5670_REG_ISP_Y_OFFSET		0x3813
+
+/* Subsampling increments, odd then even */
+#define OV5670_REG_X_INC		0x3814
+#define OV5670_REG_Y_INC		0x382a
+
+/* Pixel array, and the active 2592x1944 in it */
+#define OV5670_NATIVE_WIDTH		2624
+#define OV5670_NATIVE_HEIGHT		2000
+#define OV5670_ACTIVE_LEFT		16
+#define OV5670_ACTIVE_TOP		8
+#define OV5670_ACTIVE_WIDTH		2592
+#define OV5670_ACTIVE_HEIGHT		1944
+
 /*
  * Pixels-per-line(PPL) = Time-per-line * pixel-rate
  * In OV5670, Time-per-line = HTS/SCLK.
@@ -42,6 +78,9 @@
 #define	OV5670_EXPOSURE_MIN		4
 #define	OV5670_EXPOSURE_STEP		1
 
+/* Exposure, gain and VTS writes apply from the second frame after */
+#define OV5670_CTRL_DELAY_FRAMES	2
+
 /* Analog gain controls from sensor */
 #define OV5670_REG_ANALOG_GAIN		0x3508
 #define	ANALOG_GAIN_MIN			0
@@ -63,26 +102,12 @@
 #define OV5670_TEST_PATTERN_ENABLE	BIT(3)
 #define OV5670_REG_TEST_PATTERN_CTRL	0x4320
 
-#define OV5670_REG_VALUE_08BIT		1
-#define OV5670_REG_VALUE_16BIT		2
-#define OV5670_REG_VALUE_24BIT		3
-
 /* Initial number of frames to skip to avoid possible garbage */
 #define OV5670_NUM_OF_SKIP_FRAMES	2
 
-struct ov5670_reg {
-	u16 address;
-	u8 val;
-};
-
-struct ov5670_reg_list {
-	u32 num_of_regs;
-	const struct ov5670_reg *regs;
-};
-
 struct ov5670_link_freq_config {
 	u32 pixel_rate;
-	const struct ov5670_reg_list reg_list;
+	const struct sensor_seq *reg_list;
 };
 
 struct ov5670_mode {
@@ -98,1642 +123,271 @@ struct ov5670_mode {
 	/* Min vertical timining size */
 	u32 vts_min;
 
-	/* Link frequency needed for this resolution */
-	u32 link_freq_index;
-
 	/* Sensor register settings for this resolution */
-	const struct ov5670_reg_list reg_list;
+	const struct sensor_seq *reg_list;
 };
 
-static const struct ov5670_reg mipi_data_rate_840mbps[] = {
-	{0x0300, 0x04},
-	{0x0301, 0x00},
-	{0x0302, 0x84},
-	{0x0303, 0x00},
-	{0x0304, 0x03},
-	{0x0305, 0x01},
-	{0x0306, 0x01},
-	{0x030a, 0x00},
-	{0x030b, 0x00},
-	{0x030c, 0x00},
-	{0x030d, 0x26},
-	{0x030e, 0x00},
-	{0x030f, 0x06},
-	{0x0312, 0x01},
-	{0x3031, 0x0a},
+static const u8 mipi_data_rate_840mbps_data[] = {
+	SENSOR_SEQ_REGS(0x0300, 0x04, 0x00, 0x84, 0x00, 0x03, 0x01, 0x01),
+	SENSOR_SEQ_REGS(0x030a, 0x00, 0x00, 0x00, 0x26, 0x00, 0x06),
+	SENSOR_SEQ_REGS(0x0312, 0x01),
+	SENSOR_SEQ_REGS(0x3031, 0x0a),
 };
 
-static const struct ov5670_reg mode_2592x1944_regs[] = {
-	{0x3000, 0x00},
-	{0x3002, 0x21},
-	{0x3005, 0xf0},
-	{0x3007, 0x00},
-	{0x3015, 0x0f},
-	{0x3018, 0x32},
-	{0x301a, 0xf0},
-	{0x301b, 0xf0},
-	{0x301c, 0xf0},
-	{0x301d, 0xf0},
-	{0x301e, 0xf0},
-	{0x3030, 0x00},
-	{0x3031, 0x0a},
-	{0x303c, 0xff},
-	{0x303e, 0xff},
-	{0x3040, 0xf0},
-	{0x3041, 0x00},
-	{0x3042, 0xf0},
-	{0x3106, 0x11},
-	{0x3500, 0x00},
-	{0x3501, 0x80},
-	{0x3502, 0x00},
-	{0x3503, 0x04},
-	{0x3504, 0x03},
-	{0x3505, 0x83},
-	{0x3508, 0x04},
-	{0x3509, 0x00},
-	{0x350e, 0x04},
-	{0x350f, 0x00},
-	{0x3510, 0x00},
-	{0x3511, 0x02},
-	{0x3512, 0x00},
-	{0x3601, 0xc8},
-	{0x3610, 0x88},
-	{0x3612, 0x48},
-	{0x3614, 0x5b},
-	{0x3615, 0x96},
-	{0x3621, 0xd0},
-	{0x3622, 0x00},
-	{0x3623, 0x00},
-	{0x3633, 0x13},
-	{0x3634, 0x13},
-	{0x3635, 0x13},
-	{0x3636, 0x13},
-	{0x3645, 0x13},
-	{0x3646, 0x82},
-	{0x3650, 0x00},
-	{0x3652, 0xff},
-	{0x3655, 0x20},
-	{0x3656, 0xff},
-	{0x365a, 0xff},
-	{0x365e, 0xff},
-	{0x3668, 0x00},
-	{0x366a, 0x07},
-	{0x366e, 0x10},
-	{0x366d, 0x00},
-	{0x366f, 0x80},
-	{0x3700, 0x28},
-	{0x3701, 0x10},
-	{0x3702, 0x3a},
-	{0x3703, 0x19},
-	{0x3704, 0x10},
-	{0x3705, 0x00},
-	{0x3706, 0x66},
-	{0x3707, 0x08},
-	{0x3708, 0x34},
-	{0x3709, 0x40},
-	{0x370a, 0x01},
-	{0x370b, 0x1b},
-	{0x3714, 0x24},
-	{0x371a, 0x3e},
-	{0x3733, 0x00},
-	{0x3734, 0x00},
-	{0x373a, 0x05},
-	{0x373b, 0x06},
-	{0x373c, 0x0a},
-	{0x373f, 0xa0},
-	{0x3755, 0x00},
-	{0x3758, 0x00},
-	{0x375b, 0x0e},
-	{0x3766, 0x5f},
-	{0x3768, 0x00},
-	{0x3769, 0x22},
-	{0x3773, 0x08},
-	{0x3774, 0x1f},
-	{0x3776, 0x06},
-	{0x37a0, 0x88},
-	{0x37a1, 0x5c},
-	{0x37a7, 0x88},
-	{0x37a8, 0x70},
-	{0x37aa, 0x88},
-	{0x37ab, 0x48},
-	{0x37b3, 0x66},
-	{0x37c2, 0x04},
-	{0x37c5, 0x00},
-	{0x37c8, 0x00},
-	{0x3800, 0x00},
-	{0x3801, 0x0c},
-	{0x3802, 0x00},
-	{0x3803, 0x04},
-	{0x3804, 0x0a},
-	{0x3805, 0x33},
-	{0x3806, 0x07},
-	{0x3807, 0xa3},
-	{0x3808, 0x0a},
-	{0x3809, 0x20},
-	{0x380a, 0x07},
-	{0x380b, 0x98},
-	{0x380c, 0x06},
-	{0x380d, 0x90},
-	{0x380e, 0x08},
-	{0x380f, 0x08},
-	{0x3811, 0x04},
-	{0x3813, 0x02},
-	{0x3814, 0x01},
-	{0x3815, 0x01},
-	{0x3816, 0x00},
-	{0x3817, 0x00},
-	{0x3818, 0x00},
-	{0x3819, 0x00},
-	{0x3820, 0x84},
-	{0x3821, 0x46},
-	{0x3822, 0x48},
-	{0x3826, 0x00},
-	{0x3827, 0x08},
-	{0x382a, 0x01},
-	{0x382b, 0x01},
-	{0x3830, 0x08},
-	{0x3836, 0x02},
-	{0x3837, 0x00},
-	{0x3838, 0x10},
-	{0x3841, 0xff},
-	{0x3846, 0x48},
-	{0x3861, 0x00},
-	{0x3862, 0x04},
-	{0x3863, 0x06},
-	{0x3a11, 0x01},
-	{0x3a12, 0x78},
-	{0x3b00, 0x00},
-	{0x3b02, 0x00},
-	{0x3b03, 0x00},
-	{0x3b04, 0x00},
-	{0x3b05, 0x00},
-	{0x3c00, 0x89},
-	{0x3c01, 0xab},
-	{0x3c02, 0x01},
-	{0x3c03, 0x00},
-	{0x3c04, 0x00},
-	{0x3c05, 0x03},
-	{0x3c06, 0x00},
-	{0x3c07, 0x05},
-	{0x3c0c, 0x00},
-	{0x3c0d, 0x00},
-	{0x3c0e, 0x00},
-	{0x3c0f, 0x00},
-	{0x3c40, 0x00},
-	{0x3c41, 0xa3},
-	{0x3c43, 0x7d},
-	{0x3c45, 0xd7},
-	{0x3c47, 0xfc},
-	{0x3c50, 0x05},
-	{0x3c52, 0xaa},
-	{0x3c54, 0x71},
-	{0x3c56, 0x80},
-	{0x3d85, 0x17},
-	{0x3f03, 0x00},
-	{0x3f0a, 0x00},
-	{0x3f0b, 0x00},
-	{0x4001, 0x60},
-	{0x4009, 0x0d},
-	{0x4020, 0x00},
-	{0x4021, 0x00},
-	{0x4022, 0x00},
-	{0x4023, 0x00},
-	{0x4024, 0x00},
-	{0x4025, 0x00},
-	{0x4026, 0x00},
-	{0x4027, 0x00},
-	{0x4028, 0x00},
-	{0x4029, 0x00},
-	{0x402a, 0x00},
-	{0x402b, 0x00},
-	{0x402c, 0x00},
-	{0x402d, 0x00},
-	{0x402e, 0x00},
-	{0x402f, 0x00},
-	{0x4040, 0x00},
-	{0x4041, 0x03},
-	{0x4042, 0x00},
-	{0x4043, 0x7A},
-	{0x4044, 0x00},
-	{0x4045, 0x7A},
-	{0x4046, 0x00},
-	{0x4047, 0x7A},
-	{0x4048, 0x00},
-	{0x4049, 0x7A},
-	{0x4307, 0x30},
-	{0x4500, 0x58},
-	{0x4501, 0x04},
-	{0x4502, 0x40},
-	{0x4503, 0x10},
-	{0x4508, 0xaa},
-	{0x4509, 0xaa},
-	{0x450a, 0x00},
-	{0x450b, 0x00},
-	{0x4600, 0x01},
-	{0x4601, 0x03},
-	{0x4700, 0xa4},
-	{0x4800, 0x4c},
-	{0x4816, 0x53},
-	{0x481f, 0x40},
-	{0x4837, 0x13},
-	{0x5000, 0x56},
-	{0x5001, 0x01},
-	{0x5002, 0x28},
-	{0x5004, 0x0c},
-	{0x5006, 0x0c},
-	{0x5007, 0xe0},
-	{0x5008, 0x01},
-	{0x5009, 0xb0},
-	{0x5901, 0x00},
-	{0x5a01, 0x00},
-	{0x5a03, 0x00},
-	{0x5a04, 0x0c},
-	{0x5a05, 0xe0},
-	{0x5a06, 0x09},
-	{0x5a07, 0xb0},
-	{0x5a08, 0x06},
-	{0x5e00, 0x00},
-	{0x3734, 0x40},
-	{0x5b00, 0x01},
-	{0x5b01, 0x10},
-	{0x5b02, 0x01},
-	{0x5b03, 0xdb},
-	{0x3d8c, 0x71},
-	{0x3d8d, 0xea},
-	{0x4017, 0x08},
-	{0x3618, 0x2a},
-	{0x5780, 0x3e},
-	{0x5781, 0x0f},
-	{0x5782, 0x44},
-	{0x5783, 0x02},
-	{0x5784, 0x01},
-	{0x5785, 0x01},
-	{0x5786, 0x00},
-	{0x5787, 0x04},
-	{0x5788, 0x02},
-	{0x5789, 0x0f},
-	{0x578a, 0xfd},
-	{0x578b, 0xf5},
-	{0x578c, 0xf5},
-	{0x578d, 0x03},
-	{0x578e, 0x08},
-	{0x578f, 0x0c},
-	{0x5790, 0x08},
-	{0x5791, 0x06},
-	{0x5792, 0x00},
-	{0x5793, 0x52},
-	{0x5794, 0xa3},
-	{0x3503, 0x00},
-	{0x5045, 0x05},
-	{0x4003, 0x40},
-	{0x5048, 0x40}
+static const struct sensor_seq mipi_data_rate_840mbps =
+	SENSOR_SEQ(mipi_data_rate_840mbps_data);
+
+static const u8 mode_2592x1944_regs_data[] = {
+	SENSOR_SEQ_REGS(0x3000, 0x00),
+	SENSOR_SEQ_REGS(0x3002, 0x21),
+	SENSOR_SEQ_REGS(0x3005, 0xf0),
+	SENSOR_SEQ_REGS(0x3007, 0x00),
+	SENSOR_SEQ_REGS(0x3015, 0x0f),
+	SENSOR_SEQ_REGS(0x3018, 0x32),
+	SENSOR_SEQ_REGS(0x301a, 0xf0, 0xf0, 0xf0, 0xf0, 0xf0),
+	SENSOR_SEQ_REGS(0x3030, 0x00, 0x0a),
+	SENSOR_SEQ_REGS(0x303c, 0xff),
+	SENSOR_SEQ_REGS(0x303e, 0xff),
+	SENSOR_SEQ_REGS(0x3040, 0xf0, 0x00, 0xf0),
+	SENSOR_SEQ_REGS(0x3106, 0x11),
+	SENSOR_SEQ_REGS(0x3500, 0x00, 0x80, 0x00, 0x04, 0x03, 0x83),
+	SENSOR_SEQ_REGS(0x3508, 0x04, 0x00),
+	SENSOR_SEQ_REGS(0x350e, 0x04, 0x00, 0x00, 0x02, 0x00),
+	SENSOR_SEQ_REGS(0x3601, 0xc8),
+	SENSOR_SEQ_REGS(0x3610, 0x88),
+	SENSOR_SEQ_REGS(0x3612, 0x48),
+	SENSOR_SEQ_REGS(0x3614, 0x5b, 0x96),
+	SENSOR_SEQ_REGS(0x3621, 0xd0, 0x00, 0x00),
+	SENSOR_SEQ_REGS(0x3633, 0x13, 0x13, 0x13, 0x13),
+	SENSOR_SEQ_REGS(0x3645, 0x13, 0x82),
+	SENSOR_SEQ_REGS(0x3650, 0x00),
+	SENSOR_SEQ_REGS(0x3652, 0xff),
+	SENSOR_SEQ_REGS(0x3655, 0x20, 0xff),
+	SENSOR_SEQ_REGS(0x365a, 0xff),
+	SENSOR_SEQ_REGS(0x365e, 0xff),
+	SENSOR_SEQ_REGS(0x3668, 0x00),
+	SENSOR_SEQ_REGS(0x366a, 0x07),
+	SENSOR_SEQ_REGS(0x366e, 0x10),
+	SENSOR_SEQ_REGS(0x366d, 0x00),
+	SENSOR_SEQ_REGS(0x366f, 0x80),
+	SENSOR_SEQ_REGS(0x3700,
+			0x28, 0x10, 0x3a, 0x19, 0x10, 0x00, 0x66, 0x08,
+			0x34, 0x40, 0x01, 0x1b),
+	SENSOR_SEQ_REGS(0x3714, 0x24),
+	SENSOR_SEQ_REGS(0x371a, 0x3e),
+	SENSOR_SEQ_REGS(0x3733, 0x00, 0x00),
+	SENSOR_SEQ_REGS(0x373a, 0x05, 0x06, 0x0a),
+	SENSOR_SEQ_REGS(0x373f, 0xa0),
+	SENSOR_SEQ_REGS(0x3755, 0x00),
+	SENSOR_SEQ_REGS(0x3758, 0x00),
+	SENSOR_SEQ_REGS(0x375b, 0x0e),
+	SENSOR_SEQ_REGS(0x3766, 0x5f),
+	SENSOR_SEQ_REGS(0x3768, 0x00, 0x22),
+	SENSOR_SEQ_REGS(0x3773, 0x08, 0x1f),
+	SENSOR_SEQ_REGS(0x3776, 0x06),
+	SENSOR_SEQ_REGS(0x37a0, 0x88, 0x5c),
+	SENSOR_SEQ_REGS(0x37a7, 0x88, 0x70),
+	SENSOR_SEQ_REGS(0x37aa, 0x88, 0x48),
+	SENSOR_SEQ_REGS(0x37b3, 0x66),
+	SENSOR_SEQ_REGS(0x37c2, 0x04),
+	SENSOR_SEQ_REGS(0x37c5, 0x00),
+	SENSOR_SEQ_REGS(0x37c8, 0x00),
+	SENSOR_SEQ_REGS(0x3800,
+			0x00, 0x0c, 0x00, 0x04, 0x0a, 0x33, 0x07, 0xa3,
+			0x0a, 0x20, 0x07, 0x98, 0x06, 0x90, 0x08, 0x08),
+	SENSOR_SEQ_REGS(0x3811, 0x04),
+	SENSOR_SEQ_REGS(0x3813, 0x02, 0x01, 0x01, 0x00, 0x00, 0x00, 0x00),
+	SENSOR_SEQ_REGS(0x3820, 0x84, 0x46, 0x48),
+	SENSOR_SEQ_REGS(0x3826, 0x00, 0x08),
+	SENSOR_SEQ_REGS(0x382a, 0x01, 0x01),
+	SENSOR_SEQ_REGS(0x3830, 0x08),
+	SENSOR_SEQ_REGS(0x3836, 0x02, 0x00, 0x10),
+	SENSOR_SEQ_REGS(0x3841, 0xff),
+	SENSOR_SEQ_REGS(0x3846, 0x48),
+	SENSOR_SEQ_REGS(0x3861, 0x00, 0x04, 0x06),
+	SENSOR_SEQ_REGS(0x3a11, 0x01, 0x78),
+	SENSOR_SEQ_REGS(0x3b00, 0x00),
+	SENSOR_SEQ_REGS(0x3b02, 0x00, 0x00, 0x00, 0x00),
+	SENSOR_SEQ_REGS(0x3c00, 0x89, 0xab, 0x01, 0x00, 0x00, 0x03, 0x00, 0x05),
+	SENSOR_SEQ_REGS(0x3c0c, 0x00, 0x00, 0x00, 0x00),
+	SENSOR_SEQ_REGS(0x3c40, 0x00, 0xa3),
+	SENSOR_SEQ_REGS(0x3c43, 0x7d),
+	SENSOR_SEQ_REGS(0x3c45, 0xd7),
+	SENSOR_SEQ_REGS(0x3c47, 0xfc),
+	SENSOR_SEQ_REGS(0x3c50, 0x05),
+	SENSOR_SEQ_REGS(0x3c52, 0xaa),
+	SENSOR_SEQ_REGS(0x3c54, 0x71),
+	SENSOR_SEQ_REGS(0x3c56, 0x80),
+	SENSOR_SEQ_REGS(0x3d85, 0x17),
+	SENSOR_SEQ_REGS(0x3f03, 0x00),
+	SENSOR_SEQ_REGS(0x3f0a, 0x00, 0x00),
+	SENSOR_SEQ_REGS(0x4001, 0x60),
+	SENSOR_SEQ_REGS(0x4009, 0x0d),
+	SENSOR_SEQ_REGS(0x4020,
+			0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+			0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00),
+	SENSOR_SEQ_REGS(0x4040,
+			0x00, 0x03, 0x00, 0x7a, 0x00, 0x7a, 0x00, 0x7a,
+			0x00, 0x7a),
+	SENSOR_SEQ_REGS(0x4307, 0x30),
+	SENSOR_SEQ_REGS(0x4500, 0x58, 0x04, 0x40, 0x10),
+	SENSOR_SEQ_REGS(0x4508, 0xaa, 0xaa, 0x00, 0x00),
+	SENSOR_SEQ_REGS(0x4600, 0x01, 0x03),
+	SENSOR_SEQ_REGS(0x4700, 0xa4),
+	SENSOR_SEQ_REGS(0x4800, 0x4c),
+	SENSOR_SEQ_REGS(0x4816, 0x53),
+	SENSOR_SEQ_REGS(0x481f, 0x40),
+	SENSOR_SEQ_REGS(0x4837, 0x13),
+	SENSOR_SEQ_REGS(0x5000, 0x56, 0x01, 0x28),
+	SENSOR_SEQ_REGS(0x5004, 0x0c),
+	SENSOR_SEQ_REGS(0x5006, 0x0c, 0xe0, 0x01, 0xb0),
+	SENSOR_SEQ_REGS(0x5901, 0x00),
+	SENSOR_SEQ_REGS(0x5a01, 0x00),
+	SENSOR_SEQ_REGS(0x5a03, 0x00, 0x0c, 0xe0, 0x09, 0xb0, 0x06),
+	SENSOR_SEQ_REGS(0x5e00, 0x00),
+	SENSOR_SEQ_REGS(0x3734, 0x40),
+	SENSOR_SEQ_REGS(0x5b00, 0x01, 0x10, 0x01, 0xdb),
+	SENSOR_SEQ_REGS(0x3d8c, 0x71, 0xea),
+	SENSOR_SEQ_REGS(0x4017, 0x08),
+	SENSOR_SEQ_REGS(0x3618, 0x2a),
+	SENSOR_SEQ_REGS(0x5780,
+			0x3e, 0x0f, 0x44, 0x02, 0x01, 0x01, 0x00, 0x04,
+			0x02, 0x0f, 0xfd, 0xf5, 0xf5, 0x03, 0x08, 0x0c,
+			0x08, 0x06, 0x00, 0x52, 0xa3),
+	SENSOR_SEQ_REGS(0x3503, 0x00),
+	SENSOR_SEQ_REGS(0x5045, 0x05),
+	SENSOR_SEQ_REGS(0x4003, 0x40),
+	SENSOR_SEQ_REGS(0x5048, 0x40),
 };
 
-static const struct ov5670_reg mode_1296x972_regs[] = {
-	{0x3000, 0x00},
-	{0x3002, 0x21},
-	{0x3005, 0xf0},
-	{0x3007, 0x00},
-	{0x3015, 0x0f},
-	{0x3018, 0x32},
-	{0x301a, 0xf0},
-	{0x301b, 0xf0},
-	{0x301c, 0xf0},
-	{0x301d, 0xf0},
-	{0x301e, 0xf0},
-	{0x3030, 0x00},
-	{0x3031, 0x0a},
-	{0x303c, 0xff},
-	{0x303e, 0xff},
-	{0x3040, 0xf0},
-	{0x3041, 0x00},
-	{0x3042, 0xf0},
-	{0x3106, 0x11},
-	{0x3500, 0x00},
-	{0x3501, 0x80},
-	{0x3502, 0x00},
-	{0x3503, 0x04},
-	{0x3504, 0x03},
-	{0x3505, 0x83},
-	{0x3508, 0x07},
-	{0x3509, 0x80},
-	{0x350e, 0x04},
-	{0x350f, 0x00},
-	{0x3510, 0x00},
-	{0x3511, 0x02},
-	{0x3512, 0x00},
-	{0x3601, 0xc8},
-	{0x3610, 0x88},
-	{0x3612, 0x48},
-	{0x3614, 0x5b},
-	{0x3615, 0x96},
-	{0x3621, 0xd0},
-	{0x3622, 0x00},
-	{0x3623, 0x00},
-	{0x3633, 0x13},
-	{0x3634, 0x13},
-	{0x3635, 0x13},
-	{0x3636, 0x13},
-	{0x3645, 0x13},
-	{0x3646, 0x82},
-	{0x3650, 0x00},
-	{0x3652, 0xff},
-	{0x3655, 0x20},
-	{0x3656, 0xff},
-	{0x365a, 0xff},
-	{0x365e, 0xff},
-	{0x3668, 0x00},
-	{0x366a, 0x07},
-	{0x366e, 0x08},
-	{0x366d, 0x00},
-	{0x366f, 0x80},
-	{0x3700, 0x28},
-	{0x3701, 0x10},
-	{0x3702, 0x3a},
-	{0x3703, 0x19},
-	{0x3704, 0x10},
-	{0x3705, 0x00},
-	{0x3706, 0x66},
-	{0x3707, 0x08},
-	{0x3708, 0x34},
-	{0x3709, 0x40},
-	{0x370a, 0x01},
-	{0x370b, 0x1b},
-	{0x3714, 0x24},
-	{0x371a, 0x3e},
-	{0x3733, 0x00},
-	{0x3734, 0x00},
-	{0x373a, 0x05},
-	{0x373b, 0x06},
-	{0x373c, 0x0a},
-	{0x373f, 0xa0},
-	{0x3755, 0x00},
-	{0x3758, 0x00},
-	{0x375b, 0x0e},
-	{0x3766, 0x5f},
-	{0x3768, 0x00},
-	{0x3769, 0x22},
-	{0x3773, 0x08},
-	{0x3774, 0x1f},
-	{0x3776, 0x06},
-	{0x37a0, 0x88},
-	{0x37a1, 0x5c},
-	{0x37a7, 0x88},
-	{0x37a8, 0x70},
-	{0x37aa, 0x88},
-	{0x37ab, 0x48},
-	{0x37b3, 0x66},
-	{0x37c2, 0x04},
-	{0x37c5, 0x00},
-	{0x37c8, 0x00},
-	{0x3800, 0x00},
-	{0x3801, 0x0c},
-	{0x3802, 0x00},
-	{0x3803, 0x04},
-	{0x3804, 0x0a},
-	{0x3805, 0x33},
-	{0x3806, 0x07},
-	{0x3807, 0xa3},
-	{0x3808, 0x05},
-	{0x3809, 0x10},
-	{0x380a, 0x03},
-	{0x380b, 0xcc},
-	{0x380c, 0x06},
-	{0x380d, 0x90},
-	{0x380e, 0x08},
-	{0x380f, 0x08},
-	{0x3811, 0x04},
-	{0x3813, 0x04},
-	{0x3814, 0x03},
-	{0x3815, 0x01},
-	{0x3816, 0x00},
-	{0x3817, 0x00},
-	{0x3818, 0x00},
-	{0x3819, 0x00},
-	{0x3820, 0x94},
-	{0x3821, 0x47},
-	{0x3822, 0x48},
-	{0x3826, 0x00},
-	{0x3827, 0x08},
-	{0x382a, 0x03},
-	{0x382b, 0x01},
-	{0x3830, 0x08},
-	{0x3836, 0x02},
-	{0x3837, 0x00},
-	{0x3838, 0x10},
-	{0x3841, 0xff},
-	{0x3846, 0x48},
-	{0x3861, 0x00},
-	{0x3862, 0x04},
-	{0x3863, 0x06},
-	{0x3a11, 0x01},
-	{0x3a12, 0x78},
-	{0x3b00, 0x00},
-	{0x3b02, 0x00},
-	{0x3b03, 0x00},
-	{0x3b04, 0x00},
-	{0x3b05, 0x00},
-	{0x3c00, 0x89},
-	{0x3c01, 0xab},
-	{0x3c02, 0x01},
-	{0x3c03, 0x00},
-	{0x3c04, 0x00},
-	{0x3c05, 0x03},
-	{0x3c06, 0x00},
-	{0x3c07, 0x05},
-	{0x3c0c, 0x00},
-	{0x3c0d, 0x00},
-	{0x3c0e, 0x00},
-	{0x3c0f, 0x00},
-	{0x3c40, 0x00},
-	{0x3c41, 0xa3},
-	{0x3c43, 0x7d},
-	{0x3c45, 0xd7},
-	{0x3c47, 0xfc},
-	{0x3c50, 0x05},
-	{0x3c52, 0xaa},
-	{0x3c54, 0x71},
-	{0x3c56, 0x80},
-	{0x3d85, 0x17},
-	{0x3f03, 0x00},
-	{0x3f0a, 0x00},
-	{0x3f0b, 0x00},
-	{0x4001, 0x60},
-	{0x4009, 0x05},
-	{0x4020, 0x00},
-	{0x4021, 0x00},
-	{0x4022, 0x00},
-	{0x4023, 0x00},
-	{0x4024, 0x00},
-	{0x4025, 0x00},
-	{0x4026, 0x00},
-	{0x4027, 0x00},
-	{0x4028, 0x00},
-	{0x4029, 0x00},
-	{0x402a, 0x00},
-	{0x402b, 0x00},
-	{0x402c, 0x00},
-	{0x402d, 0x00},
-	{0x402e, 0x00},
-	{0x402f, 0x00},
-	{0x4040, 0x00},
-	{0x4041, 0x03},
-	{0x4042, 0x00},
-	{0x4043, 0x7A},
-	{0x4044, 0x00},
-	{0x4045, 0x7A},
-	{0x4046, 0x00},
-	{0x4047, 0x7A},
-	{0x4048, 0x00},
-	{0x4049, 0x7A},
-	{0x4307, 0x30},
-	{0x4500, 0x58},
-	{0x4501, 0x04},
-	{0x4502, 0x48},
-	{0x4503, 0x10},
-	{0x4508, 0x55},
-	{0x4509, 0x55},
-	{0x450a, 0x00},
-	{0x450b, 0x00},
-	{0x4600, 0x00},
-	{0x4601, 0x81},
-	{0x4700, 0xa4},
-	{0x4800, 0x4c},
-	{0x4816, 0x53},
-	{0x481f, 0x40},
-	{0x4837, 0x13},
-	{0x5000, 0x56},
-	{0x5001, 0x01},
-	{0x5002, 0x28},
-	{0x5004, 0x0c},
-	{0x5006, 0x0c},
-	{0x5007, 0xe0},
-	{0x5008, 0x01},
-	{0x5009, 0xb0},
-	{0x5901, 0x00},
-	{0x5a01, 0x00},
-	{0x5a03, 0x00},
-	{0x5a04, 0x0c},
-	{0x5a05, 0xe0},
-	{0x5a06, 0x09},
-	{0x5a07, 0xb0},
-	{0x5a08, 0x06},
-	{0x5e00, 0x00},
-	{0x3734, 0x40},
-	{0x5b00, 0x01},
-	{0x5b01, 0x10},
-	{0x5b02, 0x01},
-	{0x5b03, 0xdb},
-	{0x3d8c, 0x71},
-	{0x3d8d, 0xea},
-	{0x4017, 0x10},
-	{0x3618, 0x2a},
-	{0x5780, 0x3e},
-	{0x5781, 0x0f},
-	{0x5782, 0x44},
-	{0x5783, 0x02},
-	{0x5784, 0x01},
-	{0x5785, 0x01},
-	{0x5786, 0x00},
-	{0x5787, 0x04},
-	{0x5788, 0x02},
-	{0x5789, 0x0f},
-	{0x578a, 0xfd},
-	{0x578b, 0xf5},
-	{0x578c, 0xf5},
-	{0x578d, 0x03},
-	{0x578e, 0x08},
-	{0x578f, 0x0c},
-	{0x5790, 0x08},
-	{0x5791, 0x04},
-	{0x5792, 0x00},
-	{0x5793, 0x52},
-	{0x5794, 0xa3},
-	{0x3503, 0x00},
-	{0x5045, 0x05},
-	{0x4003, 0x40},
-	{0x5048, 0x40}
+static const struct sensor_seq mode_2592x1944_regs =
+	SENSOR_SEQ(mode_2592x1944_regs_data);
+
+static const struct sensor_seq_patch mode_1296x972_regs_patch[] = {
+	SENSOR_SEQ_SET(0x3508, 0x07),
+	SENSOR_SEQ_SET(0x3509, 0x80),
+	SENSOR_SEQ_SET(0x366e, 0x08),
+	SENSOR_SEQ_SET(0x3808, 0x05),
+	SENSOR_SEQ_SET(0x3809, 0x10),
+	SENSOR_SEQ_SET(0x380a, 0x03),
+	SENSOR_SEQ_SET(0x380b, 0xcc),
+	SENSOR_SEQ_SET(0x3813, 0x04),
+	SENSOR_SEQ_SET(0x3814, 0x03),
+	SENSOR_SEQ_SET(0x3820, 0x94),
+	SENSOR_SEQ_SET(0x3821, 0x47),
+	SENSOR_SEQ_SET(0x382a, 0x03),
+	SENSOR_SEQ_SET(0x4009, 0x05),
+	SENSOR_SEQ_SET(0x4502, 0x48),
+	SENSOR_SEQ_SET(0x4508, 0x55),
+	SENSOR_SEQ_SET(0x4509, 0x55),
+	SENSOR_SEQ_SET(0x4600, 0x00),
+	SENSOR_SEQ_SET(0x4601, 0x81),
+	SENSOR_SEQ_SET(0x4017, 0x10),
+	SENSOR_SEQ_SET(0x5791, 0x04),
 };
 
-static const struct ov5670_reg mode_648x486_regs[] = {
-	{0x3000, 0x00},
-	{0x3002, 0x21},
-	{0x3005, 0xf0},
-	{0x3007, 0x00},
-	{0x3015, 0x0f},
-	{0x3018, 0x32},
-	{0x301a, 0xf0},
-	{0x301b, 0xf0},
-	{0x301c, 0xf0},
-	{0x301d, 0xf0},
-	{0x301e, 0xf0},
-	{0x3030, 0x00},
-	{0x3031, 0x0a},
-	{0x303c, 0xff},
-	{0x303e, 0xff},
-	{0x3040, 0xf0},
-	{0x3041, 0x00},
-	{0x3042, 0xf0},
-	{0x3106, 0x11},
-	{0x3500, 0x00},
-	{0x3501, 0x80},
-	{0x3502, 0x00},
-	{0x3503, 0x04},
-	{0x3504, 0x03},
-	{0x3505, 0x83},
-	{0x3508, 0x04},
-	{0x3509, 0x00},
-	{0x350e, 0x04},
-	{0x350f, 0x00},
-	{0x3510, 0x00},
-	{0x3511, 0x02},
-	{0x3512, 0x00},
-	{0x3601, 0xc8},
-	{0x3610, 0x88},
-	{0x3612, 0x48},
-	{0x3614, 0x5b},
-	{0x3615, 0x96},
-	{0x3621, 0xd0},
-	{0x3622, 0x00},
-	{0x3623, 0x04},
-	{0x3633, 0x13},
-	{0x3634, 0x13},
-	{0x3635, 0x13},
-	{0x3636, 0x13},
-	{0x3645, 0x13},
-	{0x3646, 0x82},
-	{0x3650, 0x00},
-	{0x3652, 0xff},
-	{0x3655, 0x20},
-	{0x3656, 0xff},
-	{0x365a, 0xff},
-	{0x365e, 0xff},
-	{0x3668, 0x00},
-	{0x366a, 0x07},
-	{0x366e, 0x08},
-	{0x366d, 0x00},
-	{0x366f, 0x80},
-	{0x3700, 0x28},
-	{0x3701, 0x10},
-	{0x3702, 0x3a},
-	{0x3703, 0x19},
-	{0x3704, 0x10},
-	{0x3705, 0x00},
-	{0x3706, 0x66},
-	{0x3707, 0x08},
-	{0x3708, 0x34},
-	{0x3709, 0x40},
-	{0x370a, 0x01},
-	{0x370b, 0x1b},
-	{0x3714, 0x24},
-	{0x371a, 0x3e},
-	{0x3733, 0x00},
-	{0x3734, 0x00},
-	{0x373a, 0x05},
-	{0x373b, 0x06},
-	{0x373c, 0x0a},
-	{0x373f, 0xa0},
-	{0x3755, 0x00},
-	{0x3758, 0x00},
-	{0x375b, 0x0e},
-	{0x3766, 0x5f},
-	{0x3768, 0x00},
-	{0x3769, 0x22},
-	{0x3773, 0x08},
-	{0x3774, 0x1f},
-	{0x3776, 0x06},
-	{0x37a0, 0x88},
-	{0x37a1, 0x5c},
-	{0x37a7, 0x88},
-	{0x37a8, 0x70},
-	{0x37aa, 0x88},
-	{0x37ab, 0x48},
-	{0x37b3, 0x66},
-	{0x37c2, 0x04},
-	{0x37c5, 0x00},
-	{0x37c8, 0x00},
-	{0x3800, 0x00},
-	{0x3801, 0x0c},
-	{0x3802, 0x00},
-	{0x3803, 0x04},
-	{0x3804, 0x0a},
-	{0x3805, 0x33},
-	{0x3806, 0x07},
-	{0x3807, 0xa3},
-	{0x3808, 0x02},
-	{0x3809, 0x88},
-	{0x380a, 0x01},
-	{0x380b, 0xe6},
-	{0x380c, 0x06},
-	{0x380d, 0x90},
-	{0x380e, 0x08},
-	{0x380f, 0x08},
-	{0x3811, 0x04},
-	{0x3813, 0x02},
-	{0x3814, 0x07},
-	{0x3815, 0x01},
-	{0x3816, 0x00},
-	{0x3817, 0x00},
-	{0x3818, 0x00},
-	{0x3819, 0x00},
-	{0x3820, 0x94},
-	{0x3821, 0xc6},
-	{0x3822, 0x48},
-	{0x3826, 0x00},
-	{0x3827, 0x08},
-	{0x382a, 0x07},
-	{0x382b, 0x01},
-	{0x3830, 0x08},
-	{0x3836, 0x02},
-	{0x3837, 0x00},
-	{0x3838, 0x10},
-	{0x3841, 0xff},
-	{0x3846, 0x48},
-	{0x3861, 0x00},
-	{0x3862, 0x04},
-	{0x3863, 0x06},
-	{0x3a11, 0x01},
-	{0x3a12, 0x78},
-	{0x3b00, 0x00},
-	{0x3b02, 0x00},
-	{0x3b03, 0x00},
-	{0x3b04, 0x00},
-	{0x3b05, 0x00},
-	{0x3c00, 0x89},
-	{0x3c01, 0xab},
-	{0x3c02, 0x01},
-	{0x3c03, 0x00},
-	{0x3c04, 0x00},
-	{0x3c05, 0x03},
-	{0x3c06, 0x00},
-	{0x3c07, 0x05},
-	{0x3c0c, 0x00},
-	{0x3c0d, 0x00},
-	{0x3c0e, 0x00},
-	{0x3c0f, 0x00},
-	{0x3c40, 0x00},
-	{0x3c41, 0xa3},
-	{0x3c43, 0x7d},
-	{0x3c45, 0xd7},
-	{0x3c47, 0xfc},
-	{0x3c50, 0x05},
-	{0x3c52, 0xaa},
-	{0x3c54, 0x71},
-	{0x3c56, 0x80},
-	{0x3d85, 0x17},
-	{0x3f03, 0x00},
-	{0x3f0a, 0x00},
-	{0x3f0b, 0x00},
-	{0x4001, 0x60},
-	{0x4009, 0x05},
-	{0x4020, 0x00},
-	{0x4021, 0x00},
-	{0x4022, 0x00},
-	{0x4023, 0x00},
-	{0x4024, 0x00},
-	{0x4025, 0x00},
-	{0x4026, 0x00},
-	{0x4027, 0x00},
-	{0x4028, 0x00},
-	{0x4029, 0x00},
-	{0x402a, 0x00},
-	{0x402b, 0x00},
-	{0x402c, 0x00},
-	{0x402d, 0x00},
-	{0x402e, 0x00},
-	{0x402f, 0x00},
-	{0x4040, 0x00},
-	{0x4041, 0x03},
-	{0x4042, 0x00},
-	{0x4043, 0x7A},
-	{0x4044, 0x00},
-	{0x4045, 0x7A},
-	{0x4046, 0x00},
-	{0x4047, 0x7A},
-	{0x4048, 0x00},
-	{0x4049, 0x7A},
-	{0x4307, 0x30},
-	{0x4500, 0x58},
-	{0x4501, 0x04},
-	{0x4502, 0x40},
-	{0x4503, 0x10},
-	{0x4508, 0x55},
-	{0x4509, 0x55},
-	{0x450a, 0x02},
-	{0x450b, 0x00},
-	{0x4600, 0x00},
-	{0x4601, 0x40},
-	{0x4700, 0xa4},
-	{0x4800, 0x4c},
-	{0x4816, 0x53},
-	{0x481f, 0x40},
-	{0x4837, 0x13},
-	{0x5000, 0x56},
-	{0x5001, 0x01},
-	{0x5002, 0x28},
-	{0x5004, 0x0c},
-	{0x5006, 0x0c},
-	{0x5007, 0xe0},
-	{0x5008, 0x01},
-	{0x5009, 0xb0},
-	{0x5901, 0x00},
-	{0x5a01, 0x00},
-	{0x5a03, 0x00},
-	{0x5a04, 0x0c},
-	{0x5a05, 0xe0},
-	{0x5a06, 0x09},
-	{0x5a07, 0xb0},
-	{0x5a08, 0x06},
-	{0x5e00, 0x00},
-	{0x3734, 0x40},
-	{0x5b00, 0x01},
-	{0x5b01, 0x10},
-	{0x5b02, 0x01},
-	{0x5b03, 0xdb},
-	{0x3d8c, 0x71},
-	{0x3d8d, 0xea},
-	{0x4017, 0x10},
-	{0x3618, 0x2a},
-	{0x5780, 0x3e},
-	{0x5781, 0x0f},
-	{0x5782, 0x44},
-	{0x5783, 0x02},
-	{0x5784, 0x01},
-	{0x5785, 0x01},
-	{0x5786, 0x00},
-	{0x5787, 0x04},
-	{0x5788, 0x02},
-	{0x5789, 0x0f},
-	{0x578a, 0xfd},
-	{0x578b, 0xf5},
-	{0x578c, 0xf5},
-	{0x578d, 0x03},
-	{0x578e, 0x08},
-	{0x578f, 0x0c},
-	{0x5790, 0x08},
-	{0x5791, 0x06},
-	{0x5792, 0x00},
-	{0x5793, 0x52},
-	{0x5794, 0xa3},
-	{0x3503, 0x00},
-	{0x5045, 0x05},
-	{0x4003, 0x40},
-	{0x5048, 0x40}
+static const struct sensor_seq mode_1296x972_regs =
+	SENSOR_SEQ_PATCHED(mode_2592x1944_regs_data, mode_1296x972_regs_patch);
+
+static const struct sensor_seq_patch mode_648x486_regs_patch[] = {
+	SENSOR_SEQ_SET(0x3623, 0x04),
+	SENSOR_SEQ_SET(0x366e, 0x08),
+	SENSOR_SEQ_SET(0x3808, 0x02),
+	SENSOR_SEQ_SET(0x3809, 0x88),
+	SENSOR_SEQ_SET(0x380a, 0x01),
+	SENSOR_SEQ_SET(0x380b, 0xe6),
+	SENSOR_SEQ_SET(0x3814, 0x07),
+	SENSOR_SEQ_SET(0x3820, 0x94),
+	SENSOR_SEQ_SET(0x3821, 0xc6),
+	SENSOR_SEQ_SET(0x382a, 0x07),
+	SENSOR_SEQ_SET(0x4009, 0x05),
+	SENSOR_SEQ_SET(0x4508, 0x55),
+	SENSOR_SEQ_SET(0x4509, 0x55),
+	SENSOR_SEQ_SET(0x450a, 0x02),
+	SENSOR_SEQ_SET(0x4600, 0x00),
+	SENSOR_SEQ_SET(0x4601, 0x40),
+	SENSOR_SEQ_SET(0x4017, 0x10),
 };
 
-static const struct ov5670_reg mode_2560x1440_regs[] = {
-	{0x3000, 0x00},
-	{0x3002, 0x21},
-	{0x3005, 0xf0},
-	{0x3007, 0x00},
-	{0x3015, 0x0f},
-	{0x3018, 0x32},
-	{0x301a, 0xf0},
-	{0x301b, 0xf0},
-	{0x301c, 0xf0},
-	{0x301d, 0xf0},
-	{0x301e, 0xf0},
-	{0x3030, 0x00},
-	{0x3031, 0x0a},
-	{0x303c, 0xff},
-	{0x303e, 0xff},
-	{0x3040, 0xf0},
-	{0x3041, 0x00},
-	{0x3042, 0xf0},
-	{0x3106, 0x11},
-	{0x3500, 0x00},
-	{0x3501, 0x80},
-	{0x3502, 0x00},
-	{0x3503, 0x04},
-	{0x3504, 0x03},
-	{0x3505, 0x83},
-	{0x3508, 0x04},
-	{0x3509, 0x00},
-	{0x350e, 0x04},
-	{0x350f, 0x00},
-	{0x3510, 0x00},
-	{0x3511, 0x02},
-	{0x3512, 0x00},
-	{0x3601, 0xc8},
-	{0x3610, 0x88},
-	{0x3612, 0x48},
-	{0x3614, 0x5b},
-	{0x3615, 0x96},
-	{0x3621, 0xd0},
-	{0x3622, 0x00},
-	{0x3623, 0x00},
-	{0x3633, 0x13},
-	{0x3634, 0x13},
-	{0x3635, 0x13},
-	{0x3636, 0x13},
-	{0x3645, 0x13},
-	{0x3646, 0x82},
-	{0x3650, 0x00},
-	{0x3652, 0xff},
-	{0x3655, 0x20},
-	{0x3656, 0xff},
-	{0x365a, 0xff},
-	{0x365e, 0xff},
-	{0x3668, 0x00},
-	{0x366a, 0x07},
-	{0x366e, 0x10},
-	{0x366d, 0x00},
-	{0x366f, 0x80},
-	{0x3700, 0x28},
-	{0x3701, 0x10},
-	{0x3702, 0x3a},
-	{0x3703, 0x19},
-	{0x3704, 0x10},
-	{0x3705, 0x00},
-	{0x3706, 0x66},
-	{0x3707, 0x08},
-	{0x3708, 0x34},
-	{0x3709, 0x40},
-	{0x370a, 0x01},
-	{0x370b, 0x1b},
-	{0x3714, 0x24},
-	{0x371a, 0x3e},
-	{0x3733, 0x00},
-	{0x3734, 0x00},
-	{0x373a, 0x05},
-	{0x373b, 0x06},
-	{0x373c, 0x0a},
-	{0x373f, 0xa0},
-	{0x3755, 0x00},
-	{0x3758, 0x00},
-	{0x375b, 0x0e},
-	{0x3766, 0x5f},
-	{0x3768, 0x00},
-	{0x3769, 0x22},
-	{0x3773, 0x08},
-	{0x3774, 0x1f},
-	{0x3776, 0x06},
-	{0x37a0, 0x88},
-	{0x37a1, 0x5c},
-	{0x37a7, 0x88},
-	{0x37a8, 0x70},
-	{0x37aa, 0x88},
-	{0x37ab, 0x48},
-	{0x37b3, 0x66},
-	{0x37c2, 0x04},
-	{0x37c5, 0x00},
-	{0x37c8, 0x00},
-	{0x3800, 0x00},
-	{0x3801, 0x0c},
-	{0x3802, 0x00},
-	{0x3803, 0x04},
-	{0x3804, 0x0a},
-	{0x3805, 0x33},
-	{0x3806, 0x07},
-	{0x3807, 0xa3},
-	{0x3808, 0x0a},
-	{0x3809, 0x00},
-	{0x380a, 0x05},
-	{0x380b, 0xa0},
-	{0x380c, 0x06},
-	{0x380d, 0x90},
-	{0x380e, 0x08},
-	{0x380f, 0x08},
-	{0x3811, 0x04},
-	{0x3813, 0x02},
-	{0x3814, 0x01},
-	{0x3815, 0x01},
-	{0x3816, 0x00},
-	{0x3817, 0x00},
-	{0x3818, 0x00},
-	{0x3819, 0x00},
-	{0x3820, 0x84},
-	{0x3821, 0x46},
-	{0x3822, 0x48},
-	{0x3826, 0x00},
-	{0x3827, 0x08},
-	{0x382a, 0x01},
-	{0x382b, 0x01},
-	{0x3830, 0x08},
-	{0x3836, 0x02},
-	{0x3837, 0x00},
-	{0x3838, 0x10},
-	{0x3841, 0xff},
-	{0x3846, 0x48},
-	{0x3861, 0x00},
-	{0x3862, 0x04},
-	{0x3863, 0x06},
-	{0x3a11, 0x01},
-	{0x3a12, 0x78},
-	{0x3b00, 0x00},
-	{0x3b02, 0x00},
-	{0x3b03, 0x00},
-	{0x3b04, 0x00},
-	{0x3b05, 0x00},
-	{0x3c00, 0x89},
-	{0x3c01, 0xab},
-	{0x3c02, 0x01},
-	{0x3c03, 0x00},
-	{0x3c04, 0x00},
-	{0x3c05, 0x03},
-	{0x3c06, 0x00},
-	{0x3c07, 0x05},
-	{0x3c0c, 0x00},
-	{0x3c0d, 0x00},
-	{0x3c0e, 0x00},
-	{0x3c0f, 0x00},
-	{0x3c40, 0x00},
-	{0x3c41, 0xa3},
-	{0x3c43, 0x7d},
-	{0x3c45, 0xd7},
-	{0x3c47, 0xfc},
-	{0x3c50, 0x05},
-	{0x3c52, 0xaa},
-	{0x3c54, 0x71},
-	{0x3c56, 0x80},
-	{0x3d85, 0x17},
-	{0x3f03, 0x00},
-	{0x3f0a, 0x00},
-	{0x3f0b, 0x00},
-	{0x4001, 0x60},
-	{0x4009, 0x0d},
-	{0x4020, 0x00},
-	{0x4021, 0x00},
-	{0x4022, 0x00},
-	{0x4023, 0x00},
-	{0x4024, 0x00},
-	{0x4025, 0x00},
-	{0x4026, 0x00},
-	{0x4027, 0x00},
-	{0x4028, 0x00},
-	{0x4029, 0x00},
-	{0x402a, 0x00},
-	{0x402b, 0x00},
-	{0x402c, 0x00},
-	{0x402d, 0x00},
-	{0x402e, 0x00},
-	{0x402f, 0x00},
-	{0x4040, 0x00},
-	{0x4041, 0x03},
-	{0x4042, 0x00},
-	{0x4043, 0x7A},
-	{0x4044, 0x00},
-	{0x4045, 0x7A},
-	{0x4046, 0x00},
-	{0x4047, 0x7A},
-	{0x4048, 0x00},
-	{0x4049, 0x7A},
-	{0x4307, 0x30},
-	{0x4500, 0x58},
-	{0x4501, 0x04},
-	{0x4502, 0x40},
-	{0x4503, 0x10},
-	{0x4508, 0xaa},
-	{0x4509, 0xaa},
-	{0x450a, 0x00},
-	{0x450b, 0x00},
-	{0x4600, 0x01},
-	{0x4601, 0x00},
-	{0x4700, 0xa4},
-	{0x4800, 0x4c},
-	{0x4816, 0x53},
-	{0x481f, 0x40},
-	{0x4837, 0x13},
-	{0x5000, 0x56},
-	{0x5001, 0x01},
-	{0x5002, 0x28},
-	{0x5004, 0x0c},
-	{0x5006, 0x0c},
-	{0x5007, 0xe0},
-	{0x5008, 0x01},
-	{0x5009, 0xb0},
-	{0x5901, 0x00},
-	{0x5a01, 0x00},
-	{0x5a03, 0x00},
-	{0x5a04, 0x0c},
-	{0x5a05, 0xe0},
-	{0x5a06, 0x09},
-	{0x5a07, 0xb0},
-	{0x5a08, 0x06},
-	{0x5e00, 0x00},
-	{0x3734, 0x40},
-	{0x5b00, 0x01},
-	{0x5b01, 0x10},
-	{0x5b02, 0x01},
-	{0x5b03, 0xdb},
-	{0x3d8c, 0x71},
-	{0x3d8d, 0xea},
-	{0x4017, 0x08},
-	{0x3618, 0x2a},
-	{0x5780, 0x3e},
-	{0x5781, 0x0f},
-	{0x5782, 0x44},
-	{0x5783, 0x02},
-	{0x5784, 0x01},
-	{0x5785, 0x01},
-	{0x5786, 0x00},
-	{0x5787, 0x04},
-	{0x5788, 0x02},
-	{0x5789, 0x0f},
-	{0x578a, 0xfd},
-	{0x578b, 0xf5},
-	{0x578c, 0xf5},
-	{0x578d, 0x03},
-	{0x578e, 0x08},
-	{0x578f, 0x0c},
-	{0x5790, 0x08},
-	{0x5791, 0x06},
-	{0x5792, 0x00},
-	{0x5793, 0x52},
-	{0x5794, 0xa3},
-	{0x5045, 0x05},
-	{0x4003, 0x40},
-	{0x5048, 0x40}
+static const struct sensor_seq mode_648x486_regs =
+	SENSOR_SEQ_PATCHED(mode_2592x1944_regs_data, mode_648x486_regs_patch);
+
+static const struct sensor_seq_patch mode_2560x1440_regs_patch[] = {
+	SENSOR_SEQ_SET(0x3809, 0x00),
+	SENSOR_SEQ_SET(0x380a, 0x05),
+	SENSOR_SEQ_SET(0x380b, 0xa0),
+	SENSOR_SEQ_SET(0x4601, 0x00),
+	/* Not cleared at the end of the table as in the other modes */
+	SENSOR_SEQ_SET(0x3503, 0x04),
 };
 
-static const struct ov5670_reg mode_1280x720_regs[] = {
-	{0x3000, 0x00},
-	{0x3002, 0x21},
-	{0x3005, 0xf0},
-	{0x3007, 0x00},
-	{0x3015, 0x0f},
-	{0x3018, 0x32},
-	{0x301a, 0xf0},
-	{0x301b, 0xf0},
-	{0x301c, 0xf0},
-	{0x301d, 0xf0},
-	{0x301e, 0xf0},
-	{0x3030, 0x00},
-	{0x3031, 0x0a},
-	{0x303c, 0xff},
-	{0x303e, 0xff},
-	{0x3040, 0xf0},
-	{0x3041, 0x00},
-	{0x3042, 0xf0},
-	{0x3106, 0x11},
-	{0x3500, 0x00},
-	{0x3501, 0x80},
-	{0x3502, 0x00},
-	{0x3503, 0x04},
-	{0x3504, 0x03},
-	{0x3505, 0x83},
-	{0x3508, 0x04},
-	{0x3509, 0x00},
-	{0x350e, 0x04},
-	{0x350f, 0x00},
-	{0x3510, 0x00},
-	{0x3511, 0x02},
-	{0x3512, 0x00},
-	{0x3601, 0xc8},
-	{0x3610, 0x88},
-	{0x3612, 0x48},
-	{0x3614, 0x5b},
-	{0x3615, 0x96},
-	{0x3621, 0xd0},
-	{0x3622, 0x00},
-	{0x3623, 0x00},
-	{0x3633, 0x13},
-	{0x3634, 0x13},
-	{0x3635, 0x13},
-	{0x3636, 0x13},
-	{0x3645, 0x13},
-	{0x3646, 0x82},
-	{0x3650, 0x00},
-	{0x3652, 0xff},
-	{0x3655, 0x20},
-	{0x3656, 0xff},
-	{0x365a, 0xff},
-	{0x365e, 0xff},
-	{0x3668, 0x00},
-	{0x366a, 0x07},
-	{0x366e, 0x08},
-	{0x366d, 0x00},
-	{0x366f, 0x80},
-	{0x3700, 0x28},
-	{0x3701, 0x10},
-	{0x3702, 0x3a},
-	{0x3703, 0x19},
-	{0x3704, 0x10},
-	{0x3705, 0x00},
-	{0x3706, 0x66},
-	{0x3707, 0x08},
-	{0x3708, 0x34},
-	{0x3709, 0x40},
-	{0x370a, 0x01},
-	{0x370b, 0x1b},
-	{0x3714, 0x24},
-	{0x371a, 0x3e},
-	{0x3733, 0x00},
-	{0x3734, 0x00},
-	{0x373a, 0x05},
-	{0x373b, 0x06},
-	{0x373c, 0x0a},
-	{0x373f, 0xa0},
-	{0x3755, 0x00},
-	{0x3758, 0x00},
-	{0x375b, 0x0e},
-	{0x3766, 0x5f},
-	{0x3768, 0x00},
-	{0x3769, 0x22},
-	{0x3773, 0x08},
-	{0x3774, 0x1f},
-	{0x3776, 0x06},
-	{0x37a0, 0x88},
-	{0x37a1, 0x5c},
-	{0x37a7, 0x88},
-	{0x37a8, 0x70},
-	{0x37aa, 0x88},
-	{0x37ab, 0x48},
-	{0x37b3, 0x66},
-	{0x37c2, 0x04},
-	{0x37c5, 0x00},
-	{0x37c8, 0x00},
-	{0x3800, 0x00},
-	{0x3801, 0x0c},
-	{0x3802, 0x00},
-	{0x3803, 0x04},
-	{0x3804, 0x0a},
-	{0x3805, 0x33},
-	{0x3806, 0x07},
-	{0x3807, 0xa3},
-	{0x3808, 0x05},
-	{0x3809, 0x00},
-	{0x380a, 0x02},
-	{0x380b, 0xd0},
-	{0x380c, 0x06},
-	{0x380d, 0x90},
-	{0x380e, 0x08},
-	{0x380f, 0x08},
-	{0x3811, 0x04},
-	{0x3813, 0x02},
-	{0x3814, 0x03},
-	{0x3815, 0x01},
-	{0x3816, 0x00},
-	{0x3817, 0x00},
-	{0x3818, 0x00},
-	{0x3819, 0x00},
-	{0x3820, 0x94},
-	{0x3821, 0x47},
-	{0x3822, 0x48},
-	{0x3826, 0x00},
-	{0x3827, 0x08},
-	{0x382a, 0x03},
-	{0x382b, 0x01},
-	{0x3830, 0x08},
-	{0x3836, 0x02},
-	{0x3837, 0x00},
-	{0x3838, 0x10},
-	{0x3841, 0xff},
-	{0x3846, 0x48},
-	{0x3861, 0x00},
-	{0x3862, 0x04},
-	{0x3863, 0x06},
-	{0x3a11, 0x01},
-	{0x3a12, 0x78},
-	{0x3b00, 0x00},
-	{0x3b02, 0x00},
-	{0x3b03, 0x00},
-	{0x3b04, 0x00},
-	{0x3b05, 0x00},
-	{0x3c00, 0x89},
-	{0x3c01, 0xab},
-	{0x3c02, 0x01},
-	{0x3c03, 0x00},
-	{0x3c04, 0x00},
-	{0x3c05, 0x03},
-	{0x3c06, 0x00},
-	{0x3c07, 0x05},
-	{0x3c0c, 0x00},
-	{0x3c0d, 0x00},
-	{0x3c0e, 0x00},
-	{0x3c0f, 0x00},
-	{0x3c40, 0x00},
-	{0x3c41, 0xa3},
-	{0x3c43, 0x7d},
-	{0x3c45, 0xd7},
-	{0x3c47, 0xfc},
-	{0x3c50, 0x05},
-	{0x3c52, 0xaa},
-	{0x3c54, 0x71},
-	{0x3c56, 0x80},
-	{0x3d85, 0x17},
-	{0x3f03, 0x00},
-	{0x3f0a, 0x00},
-	{0x3f0b, 0x00},
-	{0x4001, 0x60},
-	{0x4009, 0x05},
-	{0x4020, 0x00},
-	{0x4021, 0x00},
-	{0x4022, 0x00},
-	{0x4023, 0x00},
-	{0x4024, 0x00},
-	{0x4025, 0x00},
-	{0x4026, 0x00},
-	{0x4027, 0x00},
-	{0x4028, 0x00},
-	{0x4029, 0x00},
-	{0x402a, 0x00},
-	{0x402b, 0x00},
-	{0x402c, 0x00},
-	{0x402d, 0x00},
-	{0x402e, 0x00},
-	{0x402f, 0x00},
-	{0x4040, 0x00},
-	{0x4041, 0x03},
-	{0x4042, 0x00},
-	{0x4043, 0x7A},
-	{0x4044, 0x00},
-	{0x4045, 0x7A},
-	{0x4046, 0x00},
-	{0x4047, 0x7A},
-	{0x4048, 0x00},
-	{0x4049, 0x7A},
-	{0x4307, 0x30},
-	{0x4500, 0x58},
-	{0x4501, 0x04},
-	{0x4502, 0x48},
-	{0x4503, 0x10},
-	{0x4508, 0x55},
-	{0x4509, 0x55},
-	{0x450a, 0x00},
-	{0x450b, 0x00},
-	{0x4600, 0x00},
-	{0x4601, 0x80},
-	{0x4700, 0xa4},
-	{0x4800, 0x4c},
-	{0x4816, 0x53},
-	{0x481f, 0x40},
-	{0x4837, 0x13},
-	{0x5000, 0x56},
-	{0x5001, 0x01},
-	{0x5002, 0x28},
-	{0x5004, 0x0c},
-	{0x5006, 0x0c},
-	{0x5007, 0xe0},
-	{0x5008, 0x01},
-	{0x5009, 0xb0},
-	{0x5901, 0x00},
-	{0x5a01, 0x00},
-	{0x5a03, 0x00},
-	{0x5a04, 0x0c},
-	{0x5a05, 0xe0},
-	{0x5a06, 0x09},
-	{0x5a07, 0xb0},
-	{0x5a08, 0x06},
-	{0x5e00, 0x00},
-	{0x3734, 0x40},
-	{0x5b00, 0x01},
-	{0x5b01, 0x10},
-	{0x5b02, 0x01},
-	{0x5b03, 0xdb},
-	{0x3d8c, 0x71},
-	{0x3d8d, 0xea},
-	{0x4017, 0x10},
-	{0x3618, 0x2a},
-	{0x5780, 0x3e},
-	{0x5781, 0x0f},
-	{0x5782, 0x44},
-	{0x5783, 0x02},
-	{0x5784, 0x01},
-	{0x5785, 0x01},
-	{0x5786, 0x00},
-	{0x5787, 0x04},
-	{0x5788, 0x02},
-	{0x5789, 0x0f},
-	{0x578a, 0xfd},
-	{0x578b, 0xf5},
-	{0x578c, 0xf5},
-	{0x578d, 0x03},
-	{0x578e, 0x08},
-	{0x578f, 0x0c},
-	{0x5790, 0x08},
-	{0x5791, 0x06},
-	{0x5792, 0x00},
-	{0x5793, 0x52},
-	{0x5794, 0xa3},
-	{0x3503, 0x00},
-	{0x5045, 0x05},
-	{0x4003, 0x40},
-	{0x5048, 0x40}
+static const struct sensor_seq mode_2560x1440_regs =
+	SENSOR_SEQ_PATCHED(mode_2592x1944_regs_data, mode_2560x1440_regs_patch);
+
+static const struct sensor_seq_patch mode_1280x720_regs_patch[] = {
+	SENSOR_SEQ_SET(0x366e, 0x08),
+	SENSOR_SEQ_SET(0x3808, 0x05),
+	SENSOR_SEQ_SET(0x3809, 0x00),
+	SENSOR_SEQ_SET(0x380a, 0x02),
+	SENSOR_SEQ_SET(0x380b, 0xd0),
+	SENSOR_SEQ_SET(0x3814, 0x03),
+	SENSOR_SEQ_SET(0x3820, 0x94),
+	SENSOR_SEQ_SET(0x3821, 0x47),
+	SENSOR_SEQ_SET(0x382a, 0x03),
+	SENSOR_SEQ_SET(0x4009, 0x05),
+	SENSOR_SEQ_SET(0x4502, 0x48),
+	SENSOR_SEQ_SET(0x4508, 0x55),
+	SENSOR_SEQ_SET(0x4509, 0x55),
+	SENSOR_SEQ_SET(0x4600, 0x00),
+	SENSOR_SEQ_SET(0x4601, 0x80),
+	SENSOR_SEQ_SET(0x4017, 0x10),
 };
 
-static const struct ov5670_reg mode_640x360_regs[] = {
-	{0x3000, 0x00},
-	{0x3002, 0x21},
-	{0x3005, 0xf0},
-	{0x3007, 0x00},
-	{0x3015, 0x0f},
-	{0x3018, 0x32},
-	{0x301a, 0xf0},
-	{0x301b, 0xf0},
-	{0x301c, 0xf0},
-	{0x301d, 0xf0},
-	{0x301e, 0xf0},
-	{0x3030, 0x00},
-	{0x3031, 0x0a},
-	{0x303c, 0xff},
-	{0x303e, 0xff},
-	{0x3040, 0xf0},
-	{0x3041, 0x00},
-	{0x3042, 0xf0},
-	{0x3106, 0x11},
-	{0x3500, 0x00},
-	{0x3501, 0x80},
-	{0x3502, 0x00},
-	{0x3503, 0x04},
-	{0x3504, 0x03},
-	{0x3505, 0x83},
-	{0x3508, 0x04},
-	{0x3509, 0x00},
-	{0x350e, 0x04},
-	{0x350f, 0x00},
-	{0x3510, 0x00},
-	{0x3511, 0x02},
-	{0x3512, 0x00},
-	{0x3601, 0xc8},
-	{0x3610, 0x88},
-	{0x3612, 0x48},
-	{0x3614, 0x5b},
-	{0x3615, 0x96},
-	{0x3621, 0xd0},
-	{0x3622, 0x00},
-	{0x3623, 0x04},
-	{0x3633, 0x13},
-	{0x3634, 0x13},
-	{0x3635, 0x13},
-	{0x3636, 0x13},
-	{0x3645, 0x13},
-	{0x3646, 0x82},
-	{0x3650, 0x00},
-	{0x3652, 0xff},
-	{0x3655, 0x20},
-	{0x3656, 0xff},
-	{0x365a, 0xff},
-	{0x365e, 0xff},
-	{0x3668, 0x00},
-	{0x366a, 0x07},
-	{0x366e, 0x08},
-	{0x366d, 0x00},
-	{0x366f, 0x80},
-	{0x3700, 0x28},
-	{0x3701, 0x10},
-	{0x3702, 0x3a},
-	{0x3703, 0x19},
-	{0x3704, 0x10},
-	{0x3705, 0x00},
-	{0x3706, 0x66},
-	{0x3707, 0x08},
-	{0x3708, 0x34},
-	{0x3709, 0x40},
-	{0x370a, 0x01},
-	{0x370b, 0x1b},
-	{0x3714, 0x24},
-	{0x371a, 0x3e},
-	{0x3733, 0x00},
-	{0x3734, 0x00},
-	{0x373a, 0x05},
-	{0x373b, 0x06},
-	{0x373c, 0x0a},
-	{0x373f, 0xa0},
-	{0x3755, 0x00},
-	{0x3758, 0x00},
-	{0x375b, 0x0e},
-	{0x3766, 0x5f},
-	{0x3768, 0x00},
-	{0x3769, 0x22},
-	{0x3773, 0x08},
-	{0x3774, 0x1f},
-	{0x3776, 0x06},
-	{0x37a0, 0x88},
-	{0x37a1, 0x5c},
-	{0x37a7, 0x88},
-	{0x37a8, 0x70},
-	{0x37aa, 0x88},
-	{0x37ab, 0x48},
-	{0x37b3, 0x66},
-	{0x37c2, 0x04},
-	{0x37c5, 0x00},
-	{0x37c8, 0x00},
-	{0x3800, 0x00},
-	{0x3801, 0x0c},
-	{0x3802, 0x00},
-	{0x3803, 0x04},
-	{0x3804, 0x0a},
-	{0x3805, 0x33},
-	{0x3806, 0x07},
-	{0x3807, 0xa3},
-	{0x3808, 0x02},
-	{0x3809, 0x80},
-	{0x380a, 0x01},
-	{0x380b, 0x68},
-	{0x380c, 0x06},
-	{0x380d, 0x90},
-	{0x380e, 0x08},
-	{0x380f, 0x08},
-	{0x3811, 0x04},
-	{0x3813, 0x02},
-	{0x3814, 0x07},
-	{0x3815, 0x01},
-	{0x3816, 0x00},
-	{0x3817, 0x00},
-	{0x3818, 0x00},
-	{0x3819, 0x00},
-	{0x3820, 0x94},
-	{0x3821, 0xc6},
-	{0x3822, 0x48},
-	{0x3826, 0x00},
-	{0x3827, 0x08},
-	{0x382a, 0x07},
-	{0x382b, 0x01},
-	{0x3830, 0x08},
-	{0x3836, 0x02},
-	{0x3837, 0x00},
-	{0x3838, 0x10},
-	{0x3841, 0xff},
-	{0x3846, 0x48},
-	{0x3861, 0x00},
-	{0x3862, 0x04},
-	{0x3863, 0x06},
-	{0x3a11, 0x01},
-	{0x3a12, 0x78},
-	{0x3b00, 0x00},
-	{0x3b02, 0x00},
-	{0x3b03, 0x00},
-	{0x3b04, 0x00},
-	{0x3b05, 0x00},
-	{0x3c00, 0x89},
-	{0x3c01, 0xab},
-	{0x3c02, 0x01},
-	{0x3c03, 0x00},
-	{0x3c04, 0x00},
-	{0x3c05, 0x03},
-	{0x3c06, 0x00},
-	{0x3c07, 0x05},
-	{0x3c0c, 0x00},
-	{0x3c0d, 0x00},
-	{0x3c0e, 0x00},
-	{0x3c0f, 0x00},
-	{0x3c40, 0x00},
-	{0x3c41, 0xa3},
-	{0x3c43, 0x7d},
-	{0x3c45, 0xd7},
-	{0x3c47, 0xfc},
-	{0x3c50, 0x05},
-	{0x3c52, 0xaa},
-	{0x3c54, 0x71},
-	{0x3c56, 0x80},
-	{0x3d85, 0x17},
-	{0x3f03, 0x00},
-	{0x3f0a, 0x00},
-	{0x3f0b, 0x00},
-	{0x4001, 0x60},
-	{0x4009, 0x05},
-	{0x4020, 0x00},
-	{0x4021, 0x00},
-	{0x4022, 0x00},
-	{0x4023, 0x00},
-	{0x4024, 0x00},
-	{0x4025, 0x00},
-	{0x4026, 0x00},
-	{0x4027, 0x00},
-	{0x4028, 0x00},
-	{0x4029, 0x00},
-	{0x402a, 0x00},
-	{0x402b, 0x00},
-	{0x402c, 0x00},
-	{0x402d, 0x00},
-	{0x402e, 0x00},
-	{0x402f, 0x00},
-	{0x4040, 0x00},
-	{0x4041, 0x03},
-	{0x4042, 0x00},
-	{0x4043, 0x7A},
-	{0x4044, 0x00},
-	{0x4045, 0x7A},
-	{0x4046, 0x00},
-	{0x4047, 0x7A},
-	{0x4048, 0x00},
-	{0x4049, 0x7A},
-	{0x4307, 0x30},
-	{0x4500, 0x58},
-	{0x4501, 0x04},
-	{0x4502, 0x40},
-	{0x4503, 0x10},
-	{0x4508, 0x55},
-	{0x4509, 0x55},
-	{0x450a, 0x02},
-	{0x450b, 0x00},
-	{0x4600, 0x00},
-	{0x4601, 0x40},
-	{0x4700, 0xa4},
-	{0x4800, 0x4c},
-	{0x4816, 0x53},
-	{0x481f, 0x40},
-	{0x4837, 0x13},
-	{0x5000, 0x56},
-	{0x5001, 0x01},
-	{0x5002, 0x28},
-	{0x5004, 0x0c},
-	{0x5006, 0x0c},
-	{0x5007, 0xe0},
-	{0x5008, 0x01},
-	{0x5009, 0xb0},
-	{0x5901, 0x00},
-	{0x5a01, 0x00},
-	{0x5a03, 0x00},
-	{0x5a04, 0x0c},
-	{0x5a05, 0xe0},
-	{0x5a06, 0x09},
-	{0x5a07, 0xb0},
-	{0x5a08, 0x06},
-	{0x5e00, 0x00},
-	{0x3734, 0x40},
-	{0x5b00, 0x01},
-	{0x5b01, 0x10},
-	{0x5b02, 0x01},
-	{0x5b03, 0xdb},
-	{0x3d8c, 0x71},
-	{0x3d8d, 0xea},
-	{0x4017, 0x10},
-	{0x3618, 0x2a},
-	{0x5780, 0x3e},
-	{0x5781, 0x0f},
-	{0x5782, 0x44},
-	{0x5783, 0x02},
-	{0x5784, 0x01},
-	{0x5785, 0x01},
-	{0x5786, 0x00},
-	{0x5787, 0x04},
-	{0x5788, 0x02},
-	{0x5789, 0x0f},
-	{0x578a, 0xfd},
-	{0x578b, 0xf5},
-	{0x578c, 0xf5},
-	{0x578d, 0x03},
-	{0x578e, 0x08},
-	{0x578f, 0x0c},
-	{0x5790, 0x08},
-	{0x5791, 0x06},
-	{0x5792, 0x00},
-	{0x5793, 0x52},
-	{0x5794, 0xa3},
-	{0x3503, 0x00},
-	{0x5045, 0x05},
-	{0x4003, 0x40},
-	{0x5048, 0x40}
+static const struct sensor_seq mode_1280x720_regs =
+	SENSOR_SEQ_PATCHED(mode_2592x1944_regs_data, mode_1280x720_regs_patch);
+
+static const struct sensor_seq_patch mode_640x360_regs_patch[] = {
+	SENSOR_SEQ_SET(0x3623, 0x04),
+	SENSOR_SEQ_SET(0x366e, 0x08),
+	SENSOR_SEQ_SET(0x3808, 0x02),
+	SENSOR_SEQ_SET(0x3809, 0x80),
+	SENSOR_SEQ_SET(0x380a, 0x01),
+	SENSOR_SEQ_SET(0x380b, 0x68),
+	SENSOR_SEQ_SET(0x3814, 0x07),
+	SENSOR_SEQ_SET(0x3820, 0x94),
+	SENSOR_SEQ_SET(0x3821, 0xc6),
+	SENSOR_SEQ_SET(0x382a, 0x07),
+	SENSOR_SEQ_SET(0x4009, 0x05),
+	SENSOR_SEQ_SET(0x4508, 0x55),
+	SENSOR_SEQ_SET(0x4509, 0x55),
+	SENSOR_SEQ_SET(0x450a, 0x02),
+	SENSOR_SEQ_SET(0x4600, 0x00),
+	SENSOR_SEQ_SET(0x4601, 0x40),
+	SENSOR_SEQ_SET(0x4017, 0x10),
 };
 
+static const struct sensor_seq mode_640x360_regs =
+	SENSOR_SEQ_PATCHED(mode_2592x1944_regs_data, mode_640x360_regs_patch);
+
 static const char * const ov5670_test_pattern_menu[] = {
 	"Disabled",
 	"Vertical Color Bar Type 1",
 };
 
-/* Supported link frequencies */
+/* Data lanes the mode tables drive, see 0x3018 */
+#define OV5670_DATA_LANES		2
+
+/*
+ * Supported link frequencies, from the lowest. The lowest one that carries
+ * a mode is selected for it.
+ */
 #define OV5670_LINK_FREQ_422MHZ		422400000
-#define OV5670_LINK_FREQ_422MHZ_INDEX	0
 static const struct ov5670_link_freq_config link_freq_configs[] = {
 	{
 		/* pixel_rate = link_freq * 2 * nr_of_lanes / bits_per_sample */
-		.pixel_rate = (OV5670_LINK_FREQ_422MHZ * 2 * 2) / 10,
-		.reg_list = {
-			.num_of_regs = ARRAY_SIZE(mipi_data_rate_840mbps),
-			.regs = mipi_data_rate_840mbps,
-		}
+		.pixel_rate = (OV5670_LINK_FREQ_422MHZ * 2 *
+			       OV5670_DATA_LANES) / 10,
+		.reg_list = &mipi_data_rate_840mbps
 	}
 };
 
@@ -1745,6 +399,10 @@ static const s64 link_freq_menu_items[] = {
  * OV5670 sensor supports following resolutions with full FOV:
  * 4:3  ==> {2592x1944, 1296x972, 648x486}
  * 16:9 ==> {2560x1440, 1280x720, 640x360}
+ *
+ * The 1296 and 1280 wide modes are read 2x2 binned, the 648 and 640 wide
+ * ones binned and sub-sampled down to a quarter of the lines. Shortening
+ * VTS down to vts_min, they run at up to 60 and 120 fps.
  */
 static const struct ov5670_mode supported_modes[] = {
 	{
@@ -1752,69 +410,48 @@ static const struct ov5670_mode supported_modes[] = {
 		.height = 1944,
 		.vts_def = OV5670_VTS_30FPS,
 		.vts_min = OV5670_VTS_30FPS,
-		.reg_list = {
-			.num_of_regs = ARRAY_SIZE(mode_2592x1944_regs),
-			.regs = mode_2592x1944_regs,
-		},
-		.link_freq_index = OV5670_LINK_FREQ_422MHZ_INDEX,
+		.reg_list = &mode_2592x1944_regs,
 	},
 	{
 		.width = 1296,
 		.height = 972,
 		.vts_def = OV5670_VTS_30FPS,
 		.vts_min = 996,
-		.reg_list = {
-			.num_of_regs = ARRAY_SIZE(mode_1296x972_regs),
-			.regs = mode_1296x972_regs,
-		},
-		.link_freq_index = OV5670_LINK_FREQ_422MHZ_INDEX,
+		.reg_list = &mode_1296x972_regs,
 	},
 	{
 		.width = 648,
 		.height = 486,
 		.vts_def = OV5670_VTS_30FPS,
 		.vts_min = 516,
-		.reg_list = {
-			.num_of_regs = ARRAY_SIZE(mode_648x486_regs),
-			.regs = mode_648x486_regs,
-		},
-		.link_freq_index = OV5670_LINK_FREQ_422MHZ_INDEX,
+		.reg_list = &mode_648x486_regs,
 	},
 	{
 		.width = 2560,
 		.height = 1440,
 		.vts_def = OV5670_VTS_30FPS,
 		.vts_min = OV5670_VTS_30FPS,
-		.reg_list = {
-			.num_of_regs = ARRAY_SIZE(mode_2560x1440_regs),
-			.regs = mode_2560x1440_regs,
-		},
-		.link_freq_index = OV5670_LINK_FREQ_422MHZ_INDEX,
+		.reg_list = &mode_2560x1440_regs,
 	},
 	{
 		.width = 1280,
 		.height = 720,
 		.vts_def = OV5670_VTS_30FPS,
 		.vts_min = 1020,
-		.reg_list = {
-			.num_of_regs = ARRAY_SIZE(mode_1280x720_regs),
-			.regs = mode_1280x720_regs,
-		},
-		.link_freq_index = OV5670_LINK_FREQ_422MHZ_INDEX,
+		.reg_list = &mode_1280x720_regs,
 	},
 	{
 		.width = 640,
 		.height = 360,
 		.vts_def = OV5670_VTS_30FPS,
 		.vts_min = 510,
-		.reg_list = {
-			.num_of_regs = ARRAY_SIZE(mode_640x360_regs),
-			.regs = mode_640x360_regs,
-		},
-		.link_freq_index = OV5670_LINK_FREQ_422MHZ_INDEX,
+		.reg_list = &mode_640x360_regs,
 	}
 };
 
+/* Frame rates offered through the frame interval, where vts_min allows */
+static const u32 ov5670_frame_rates[] = { 30, 60, 90, 120 };
+
 struct ov5670 {
 	struct v4l2_subdev sd;
 	struct media_pad pad;
@@ -1826,6 +463,7 @@ struct ov5670 {
 	struct v4l2_ctrl *vblank;
 	struct v4l2_ctrl *hblank;
 	struct v4l2_ctrl *exposure;
+	struct v4l2_ctrl *analogue_gain;
 
 	/* Current mode */
 	const struct ov5670_mode *cur_mode;
@@ -1840,108 +478,155 @@ struct ov5670 {
 	struct device *dep_dev;
 
 	/* GPIOs defined in dep_dev _CRS */
-	struct gpio_descs *dep_gpios;
+	struct sensor_gpios dep_gpios;
 
 	bool is_rpm_supported;
+
+	/* Register lists precompiled at probe, see ov5670_build_progs() */
+	struct sensor_prog link_freq_progs[ARRAY_SIZE(link_freq_configs)];
+	struct sensor_prog mode_progs[ARRAY_SIZE(supported_modes)];
+
+	/* Register values written since power on */
+	struct sensor_shadow shadow;
+	/* i2c traffic counters, see sensor_stats.h */
+	struct sensor_stats stats;
+	/* Register access through the above, see sensor_reg.h */
+	struct sensor_i2c i2c;
+	/* Frame sync events and per-frame values, see sensor_meta.h */
+	struct sensor_meta meta;
+	/* Stream timing the capture side checks, see sensor_selftest.h */
+	struct sensor_selftest selftest;
+	/* Mode loaded in the sensor, NULL if none */
+	const struct ov5670_mode *loaded_mode;
+	/* Index in link_freq_configs[] of the PLL table loaded with it */
+	s32 loaded_link_freq;
+	/* Link frequencies and data lanes, see sensor_link.h */
+	struct sensor_link link;
+
+	struct dentry *debugfs;
+
+	/* Identifies the sensor and registers the subdev after probe */
+	struct delayed_work identify_work;
+	unsigned int identify_tries;
+	/* Set once identify_work has registered the subdev */
+	bool registered;
 };
 
 #define to_ov5670(_sd)	container_of(_sd, struct ov5670, sd)
 
-/* Read registers up to 4 at a time */
-static int ov5670_read_reg(struct ov5670 *ov5670, u16 reg, unsigned int len,
-			   u32 *val)
+/* Write a list of registers */
+static int ov5670_write_regs(struct ov5670 *ov5670,
+			     const struct sensor_seq *regs)
 {
 	struct i2c_client *client = v4l2_get_subdevdata(&ov5670->sd);
-	struct i2c_msg msgs[2];
-	u8 *data_be_p;
-	__be32 data_be = 0;
-	__be16 reg_addr_be = cpu_to_be16(reg);
+	struct sensor_burst burst;
 	int ret;
 
-	if (len > 4)
-		return -EINVAL;
-
-	data_be_p = (u8 *)&data_be;
-	/* Write register address */
-	msgs[0].addr = client->addr;
-	msgs[0].flags = 0;
-	msgs[0].len = 2;
-	msgs[0].buf = (u8 *)&reg_addr_be;
+	trace_sensor_stage_begin(&client->dev, "load_regs");
 
-	/* Read data from register */
-	msgs[1].addr = client->addr;
-	msgs[1].flags = I2C_M_RD;
-	msgs[1].len = len;
-	msgs[1].buf = &data_be_p[4 - len];
+	sensor_burst_init(&burst, client);
+	burst.shadow = &ov5670->shadow;
+	burst.stats = &ov5670->stats;
+	ret = sensor_seq_walk(&burst, regs);
+	if (ret)
+		goto err;
 
-	ret = i2c_transfer(client->adapter, msgs, ARRAY_SIZE(msgs));
-	if (ret != ARRAY_SIZE(msgs))
-		return -EIO;
+	ret = sensor_burst_flush(&burst);
+	if (ret)
+		goto err;
 
-	*val = be32_to_cpu(data_be);
+	trace_sensor_stage_end(&client->dev, "load_regs", burst.nr_regs,
+			       burst.nr_bytes, 0);
 
 	return 0;
+
+err:
+	trace_sensor_stage_end(&client->dev, "load_regs", burst.nr_regs,
+			       burst.nr_bytes, ret);
+	dev_err_ratelimited(&client->dev,
+			    "Failed to write reg 0x%4.4x. error = %d\n",
+			    burst.addr, ret);
+	return ret;
 }
 
-/* Write registers up to 4 at a time */
-static int ov5670_write_reg(struct ov5670 *ov5670, u16 reg, unsigned int len,
-			    u32 val)
+static const struct sensor_prog *
+ov5670_reg_list_prog(struct ov5670 *ov5670, const struct sensor_seq *r_list)
 {
-	struct i2c_client *client = v4l2_get_subdevdata(&ov5670->sd);
-	int buf_i;
-	int val_i;
-	u8 buf[6];
-	u8 *val_p;
-	__be32 tmp;
+	unsigned int i;
 
-	if (len > 4)
-		return -EINVAL;
+	for (i = 0; i < ARRAY_SIZE(link_freq_configs); i++)
+		if (r_list == link_freq_configs[i].reg_list)
+			return &ov5670->link_freq_progs[i];
 
-	buf[0] = reg >> 8;
-	buf[1] = reg & 0xff;
+	for (i = 0; i < ARRAY_SIZE(supported_modes); i++)
+		if (r_list == supported_modes[i].reg_list)
+			return &ov5670->mode_progs[i];
 
-	tmp = cpu_to_be32(val);
-	val_p = (u8 *)&tmp;
-	buf_i = 2;
-	val_i = 4 - len;
+	return NULL;
+}
 
-	while (val_i < 4)
-		buf[buf_i++] = val_p[val_i++];
+static int ov5670_write_reg_list(struct ov5670 *ov5670,
+				 const struct sensor_seq *r_list)
+{
+	struct i2c_client *client = v4l2_get_subdevdata(&ov5670->sd);
+	const struct sensor_prog *prog = ov5670_reg_list_prog(ov5670, r_list);
 
-	if (i2c_master_send(client, buf, len + 2) != len + 2)
-		return -EIO;
+	if (prog && prog->msgs)
+		return sensor_prog_load(client, prog, &ov5670->shadow,
+					&ov5670->stats);
 
-	return 0;
+	return ov5670_write_regs(ov5670, r_list);
 }
 
-/* Write a list of registers */
-static int ov5670_write_regs(struct ov5670 *ov5670,
-			     const struct ov5670_reg *regs, unsigned int len)
+/*
+ * Precompile the PLL and mode register lists so that starting a stream
+ * is just a few i2c_transfer() calls.
+ */
+static int ov5670_build_progs(struct ov5670 *ov5670)
 {
 	struct i2c_client *client = v4l2_get_subdevdata(&ov5670->sd);
 	unsigned int i;
 	int ret;
 
-	for (i = 0; i < len; i++) {
-		ret = ov5670_write_reg(ov5670, regs[i].address, 1, regs[i].val);
-		if (ret) {
-			dev_err_ratelimited(
-				&client->dev,
-				"Failed to write reg 0x%4.4x. error = %d\n",
-				regs[i].address, ret);
+	for (i = 0; i < ARRAY_SIZE(link_freq_configs); i++) {
+		ret = sensor_prog_build(client, &ov5670->link_freq_progs[i],
+					sensor_seq_walk,
+					link_freq_configs[i].reg_list);
+		if (ret)
+			return ret;
+	}
 
+	for (i = 0; i < ARRAY_SIZE(supported_modes); i++) {
+		ret = sensor_prog_build(client, &ov5670->mode_progs[i],
+					sensor_seq_walk,
+					supported_modes[i].reg_list);
+		if (ret)
 			return ret;
-		}
 	}
 
 	return 0;
 }
 
-static int ov5670_write_reg_list(struct ov5670 *ov5670,
-				 const struct ov5670_reg_list *r_list)
+static int ov5670_modes_show(struct seq_file *m, void *data)
 {
-	return ov5670_write_regs(ov5670, r_list->regs, r_list->num_of_regs);
+	struct ov5670 *ov5670 = m->private;
+	char name[24];
+	unsigned int i;
+
+	sensor_prog_seq_header(m);
+	for (i = 0; i < ARRAY_SIZE(link_freq_configs); i++) {
+		snprintf(name, sizeof(name), "pll%u", i);
+		sensor_prog_seq_show(m, name, &ov5670->link_freq_progs[i]);
+	}
+	for (i = 0; i < ARRAY_SIZE(supported_modes); i++) {
+		snprintf(name, sizeof(name), "%ux%u", supported_modes[i].width,
+			 supported_modes[i].height);
+		sensor_prog_seq_show(m, name, &ov5670->mode_progs[i]);
+	}
+
+	return 0;
 }
+DEFINE_SHOW_ATTRIBUTE(ov5670_modes);
 
 /* Open sub-device */
 static int ov5670_open(struct v4l2_subdev *sd, struct v4l2_subdev_fh *fh)
@@ -1966,35 +651,30 @@ static int ov5670_open(struct v4l2_subdev *sd, struct v4l2_subdev_fh *fh)
 
 static int ov5670_update_digital_gain(struct ov5670 *ov5670, u32 d_gain)
 {
-	int ret;
-
-	ret = ov5670_write_reg(ov5670, OV5670_REG_R_DGTL_GAIN,
-			       OV5670_REG_VALUE_16BIT, d_gain);
-	if (ret)
-		return ret;
+	u8 buf[6];
+	int i;
 
-	ret = ov5670_write_reg(ov5670, OV5670_REG_G_DGTL_GAIN,
-			       OV5670_REG_VALUE_16BIT, d_gain);
-	if (ret)
-		return ret;
+	/* R, G and B gains are consecutive, write them in one message */
+	for (i = 0; i < ARRAY_SIZE(buf); i += 2) {
+		buf[i] = d_gain >> 8;
+		buf[i + 1] = d_gain & 0xff;
+	}
 
-	return ov5670_write_reg(ov5670, OV5670_REG_B_DGTL_GAIN,
-				OV5670_REG_VALUE_16BIT, d_gain);
+	return sensor_reg_write(&ov5670->i2c, OV5670_REG_R_DGTL_GAIN, buf,
+				ARRAY_SIZE(buf));
 }
 
 static int ov5670_enable_test_pattern(struct ov5670 *ov5670, u32 pattern)
 {
-	u32 val;
+	u8 val;
 	int ret;
 
 	/* Set the bayer order that we support */
-	ret = ov5670_write_reg(ov5670, OV5670_REG_TEST_PATTERN_CTRL,
-			       OV5670_REG_VALUE_08BIT, 0);
+	ret = sensor_reg_write8(&ov5670->i2c, OV5670_REG_TEST_PATTERN_CTRL, 0);
 	if (ret)
 		return ret;
 
-	ret = ov5670_read_reg(ov5670, OV5670_REG_TEST_PATTERN,
-			      OV5670_REG_VALUE_08BIT, &val);
+	ret = sensor_reg_read8(&ov5670->i2c, OV5670_REG_TEST_PATTERN, &val);
 	if (ret)
 		return ret;
 
@@ -2003,8 +683,7 @@ static int ov5670_enable_test_pattern(struct ov5670 *ov5670, u32 pattern)
 	else
 		val &= ~OV5670_TEST_PATTERN_ENABLE;
 
-	return ov5670_write_reg(ov5670, OV5670_REG_TEST_PATTERN,
-				OV5670_REG_VALUE_08BIT, val);
+	return sensor_reg_write8(&ov5670->i2c, OV5670_REG_TEST_PATTERN, val);
 }
 
 /* Initialize control handlers */
@@ -2025,6 +704,11 @@ static int ov5670_set_ctrl(struct v4l2_ctrl *ctrl)
 					 ov5670->exposure->minimum, max,
 					 ov5670->exposure->step, max);
 		break;
+	case V4L2_CID_LINK_FREQ:
+		__v4l2_ctrl_s_ctrl_int64(
+			ov5670->pixel_rate,
+			link_freq_configs[ctrl->val].pixel_rate);
+		break;
 	}
 
 	/* V4L2 controls values will be applied only when power is already up */
@@ -2033,26 +717,37 @@ static int ov5670_set_ctrl(struct v4l2_ctrl *ctrl)
 
 	switch (ctrl->id) {
 	case V4L2_CID_ANALOGUE_GAIN:
-		ret = ov5670_write_reg(ov5670, OV5670_REG_ANALOG_GAIN,
-				       OV5670_REG_VALUE_16BIT, ctrl->val);
+		ret = sensor_reg_write16(&ov5670->i2c, OV5670_REG_ANALOG_GAIN,
+					 ctrl->val);
+		if (!ret)
+			sensor_meta_queue(&ov5670->meta, SENSOR_META_GAIN,
+					  ctrl->val);
 		break;
 	case V4L2_CID_DIGITAL_GAIN:
 		ret = ov5670_update_digital_gain(ov5670, ctrl->val);
 		break;
 	case V4L2_CID_EXPOSURE:
 		/* 4 least significant bits of expsoure are fractional part */
-		ret = ov5670_write_reg(ov5670, OV5670_REG_EXPOSURE,
-				       OV5670_REG_VALUE_24BIT, ctrl->val << 4);
+		ret = sensor_reg_write24(&ov5670->i2c, OV5670_REG_EXPOSURE,
+					 ctrl->val << 4);
+		if (!ret)
+			sensor_meta_queue(&ov5670->meta, SENSOR_META_EXPOSURE,
+					  ctrl->val);
 		break;
 	case V4L2_CID_VBLANK:
 		/* Update VTS that meets expected vertical blanking */
-		ret = ov5670_write_reg(ov5670, OV5670_REG_VTS,
-				       OV5670_REG_VALUE_16BIT,
-				       ov5670->cur_mode->height + ctrl->val);
+		ret = sensor_reg_write16(&ov5670->i2c, OV5670_REG_VTS,
+					 ov5670->cur_mode->height + ctrl->val);
+		if (!ret)
+			sensor_meta_queue(&ov5670->meta, SENSOR_META_VTS,
+					  ov5670->cur_mode->height + ctrl->val);
 		break;
 	case V4L2_CID_TEST_PATTERN:
 		ret = ov5670_enable_test_pattern(ov5670, ctrl->val);
 		break;
+	case V4L2_CID_LINK_FREQ:
+		/* The PLL table is written at stream on */
+		break;
 	default:
 		dev_info(&client->dev, "%s Unhandled id:0x%x, val:0x%x\n",
 			 __func__, ctrl->id, ctrl->val);
@@ -2068,72 +763,68 @@ static const struct v4l2_ctrl_ops ov5670_ctrl_ops = {
 	.s_ctrl = ov5670_set_ctrl,
 };
 
-/* Get GPIOs defined in dep_dev _CRS */
-static int gpio_crs_get(struct ov5670 *sensor, struct device *dep_dev)
+/* The sensor registers went back to their power-on defaults */
+static void ov5670_regs_lost(struct ov5670 *ov5670)
 {
-	sensor->dep_gpios = devm_gpiod_get_array(dep_dev, NULL, GPIOD_ASIS);
-	if (IS_ERR(sensor->dep_gpios)) {
-		dev_err(dep_dev, "Failed to get GPIOs\n");
-		return -ENODEV;
-	}
-
-	return 0;
-}
-
-/* Put GPIOs defined in dep_dev _CRS */
-static void gpio_crs_put(struct ov5670 *sensor)
-{
-	gpiod_put_array(sensor->dep_gpios);
-}
-
-/* Control GPIOs defined in dep_dev _CRS */
-static int gpio_crs_ctrl(struct ov5670 *sensor, bool flag)
-{
-	struct gpio_descs *d = sensor->dep_gpios;
-	unsigned long *values;
-
-	values = bitmap_alloc(d->ndescs, GFP_KERNEL);
-	if (!values)
-		return -ENOMEM;
-
-	if (flag)
-		bitmap_fill(values, d->ndescs);
-	else
-		bitmap_zero(values, d->ndescs);
-
-	gpiod_set_array_value_cansleep(d->ndescs, d->desc,
-				       d->info, values);
-
-	return 0;
+	sensor_shadow_invalidate(&ov5670->shadow);
+	ov5670->loaded_mode = NULL;
 }
 
 static int __power_off(struct ov5670 *sensor)
 {
+	struct i2c_client *client = v4l2_get_subdevdata(&sensor->sd);
 	int ret = 0;
 
-	ret = gpio_crs_ctrl(sensor, false);
+	ov5670_regs_lost(sensor);
+
+	trace_sensor_stage_begin(&client->dev, "gpio");
+	ret = sensor_gpios_set(&sensor->dep_gpios, false);
+	trace_sensor_stage_end(&client->dev, "gpio", 0, 0, ret);
 
 	return ret;
 }
 
+/*
+ * The sensor answers on SCCB 8192 XVCLK cycles after power up. The
+ * supplies behind the PMIC GPIOs may take longer to come up, the chip ID
+ * is polled for that.
+ */
+static struct sensor_power_timing ov5670_power_timing = {
+	.settle_us = SENSOR_POWER_CYCLES_US(8192, 19200000),
+	.poll_us = SENSOR_POWER_POLL_US,
+	.timeout_us = 20000,
+};
+module_param_named(power_settle_us, ov5670_power_timing.settle_us, uint,
+		   0644);
+MODULE_PARM_DESC(power_settle_us, "Wait before the first access at power on");
+module_param_named(power_poll_us, ov5670_power_timing.poll_us, uint, 0644);
+MODULE_PARM_DESC(power_poll_us, "Interval of the chip ID reads at power on");
+module_param_named(power_timeout_us, ov5670_power_timing.timeout_us, uint,
+		   0644);
+MODULE_PARM_DESC(power_timeout_us, "Longest chip ID poll at power on");
+
 static int __power_on(struct ov5670 *sensor)
 {
 	struct i2c_client *client = v4l2_get_subdevdata(&sensor->sd);
 	int ret;
 
-	ret = gpio_crs_ctrl(sensor, true);
+	trace_sensor_stage_begin(&client->dev, "gpio");
+	ret = sensor_gpios_set(&sensor->dep_gpios, true);
+	trace_sensor_stage_end(&client->dev, "gpio", 0, 0, ret);
 	if (ret)
 		goto fail_power;
 
-	/* Add some delay (10~11ms).
-	 * This is required or identify_module() will fail.
-	 */
-	usleep_range(10000, 11000);
+	trace_sensor_stage_begin(&client->dev, "power_delay");
+	ret = sensor_power_wait(&sensor->i2c, &ov5670_power_timing,
+				OV5670_REG_CHIP_ID, OV5670_CHIP_ID, 3);
+	trace_sensor_stage_end(&client->dev, "power_delay", 0, 0, ret);
+	if (ret)
+		goto fail_power;
 
 	return 0;
 
 fail_power:
-	gpio_crs_ctrl(sensor, false);
+	sensor_gpios_set(&sensor->dep_gpios, false);
 	dev_err(&client->dev, "sensor power-up failed\n");
 
 	return ret;
@@ -2150,12 +841,128 @@ static int ov5670_s_power(struct v4l2_subdev *sd, int on)
 	return __power_on(ov5670);
 }
 
+/*
+ * Bits per second of @mode on the link. The PLL tables clock the pixel
+ * array from the MIPI clock, so a mode takes the same share of the link
+ * at every link frequency. It is checked at the lowest one, the first of
+ * link_freq_configs[].
+ */
+static u64 ov5670_mode_bps(const struct ov5670_mode *mode)
+{
+	return sensor_link_bps(mode->width, 10, link_freq_configs[0].pixel_rate,
+			       OV5670_FIXED_PPL);
+}
+
+static bool ov5670_mode_fits(struct ov5670 *ov5670,
+			     const struct ov5670_mode *mode)
+{
+	return sensor_link_select(&ov5670->link, ov5670_mode_bps(mode),
+				  NULL) >= 0;
+}
+
+/* Mode nearest to @width x @height that the link carries, NULL if none */
+static const struct ov5670_mode *ov5670_find_mode(struct ov5670 *ov5670,
+						  u32 width, u32 height)
+{
+	const struct ov5670_mode *mode = NULL;
+	u32 dist, min_dist = U32_MAX;
+	unsigned int i;
+
+	for (i = 0; i < ARRAY_SIZE(supported_modes); i++) {
+		if (!ov5670_mode_fits(ov5670, &supported_modes[i]))
+			continue;
+
+		dist = abs((int)supported_modes[i].width - (int)width) +
+		       abs((int)supported_modes[i].height - (int)height);
+		if (dist < min_dist) {
+			mode = &supported_modes[i];
+			min_dist = dist;
+		}
+	}
+
+	return mode;
+}
+
+/* Pixel rate of @mode, at the link frequency selected for it */
+static u64 ov5670_mode_pixel_rate(struct ov5670 *ov5670,
+				  const struct ov5670_mode *mode)
+{
+	int index = sensor_link_select(&ov5670->link, ov5670_mode_bps(mode),
+				       NULL);
+
+	return link_freq_configs[index < 0 ? 0 : index].pixel_rate;
+}
+
+/* VTS of @mode at @fps, 0 if shorter than the mode reads out */
+static u32 ov5670_mode_vts(struct ov5670 *ov5670,
+			   const struct ov5670_mode *mode, u32 fps)
+{
+	u64 vts = div_u64(ov5670_mode_pixel_rate(ov5670, mode),
+			  OV5670_FIXED_PPL * fps);
+
+	return vts < mode->vts_min || vts > OV5670_VTS_MAX ? 0 : vts;
+}
+
+/* Frame interval of the current mode and VBLANK */
+static void ov5670_frame_interval(struct ov5670 *ov5670,
+				  struct v4l2_fract *interval)
+{
+	interval->numerator = OV5670_FIXED_PPL *
+			      (ov5670->cur_mode->height + ov5670->vblank->val);
+	interval->denominator =
+		link_freq_configs[ov5670->link_freq->val].pixel_rate;
+}
+
+/* Skipping/binning factor of the odd/even increments at @reg */
+static unsigned int ov5670_mode_scale(const struct ov5670_mode *mode, u16 reg)
+{
+	u8 odd = 1, even = 1;
+
+	sensor_seq_read(mode->reg_list, reg, &odd);
+	sensor_seq_read(mode->reg_list, reg + 1, &even);
+
+	return max((odd + even) / 2, 1);
+}
+
+/*
+ * Array area read out for @mode, from its register table: the ISP window
+ * at its offset in the analog window, its output size scaled back by the
+ * binning or skipping.
+ */
+static void ov5670_mode_crop(const struct ov5670_mode *mode,
+			     struct v4l2_rect *crop)
+{
+	u16 x0 = 0, y0 = 0;
+	u16 x1 = OV5670_NATIVE_WIDTH - 1, y1 = OV5670_NATIVE_HEIGHT - 1;
+	u16 width = mode->width, height = mode->height;
+	u8 x_off = 0, y_off = 0;
+
+	sensor_seq_read16(mode->reg_list, OV5670_REG_X_ADDR_START, &x0);
+	sensor_seq_read16(mode->reg_list, OV5670_REG_Y_ADDR_START, &y0);
+	sensor_seq_read16(mode->reg_list, OV5670_REG_X_ADDR_END, &x1);
+	sensor_seq_read16(mode->reg_list, OV5670_REG_Y_ADDR_END, &y1);
+	sensor_seq_read16(mode->reg_list, OV5670_REG_X_OUTPUT_SIZE, &width);
+	sensor_seq_read16(mode->reg_list, OV5670_REG_Y_OUTPUT_SIZE, &height);
+	sensor_seq_read(mode->reg_list, OV5670_REG_ISP_X_OFFSET, &x_off);
+	sensor_seq_read(mode->reg_list, OV5670_REG_ISP_Y_OFFSET, &y_off);
+
+	width *= ov5670_mode_scale(mode, OV5670_REG_X_INC);
+	height *= ov5670_mode_scale(mode, OV5670_REG_Y_INC);
+
+	crop->left = x0 + x_off;
+	crop->top = y0 + y_off;
+	crop->width = min_t(u32, width, x1 + 1 - crop->left);
+	crop->height = min_t(u32, height, y1 + 1 - crop->top);
+}
+
 /* Initialize control handlers */
 static int ov5670_init_controls(struct ov5670 *ov5670)
 {
 	struct i2c_client *client = v4l2_get_subdevdata(&ov5670->sd);
 	struct v4l2_fwnode_device_properties props;
 	struct v4l2_ctrl_handler *ctrl_hdlr;
+	u64 link_freq_usable;
+	int link_freq_index;
 	s64 vblank_max;
 	s64 vblank_def;
 	s64 vblank_min;
@@ -2168,19 +975,25 @@ static int ov5670_init_controls(struct ov5670 *ov5670)
 		return ret;
 
 	ctrl_hdlr->lock = &ov5670->mutex;
-	ov5670->link_freq = v4l2_ctrl_new_int_menu(ctrl_hdlr,
-						   &ov5670_ctrl_ops,
-						   V4L2_CID_LINK_FREQ,
-						   0, 0, link_freq_menu_items);
-	if (ov5670->link_freq)
-		ov5670->link_freq->flags |= V4L2_CTRL_FLAG_READ_ONLY;
+	link_freq_index = sensor_link_select(&ov5670->link,
+					     ov5670_mode_bps(ov5670->cur_mode),
+					     &link_freq_usable);
+	ov5670->link_freq = v4l2_ctrl_new_int_menu(
+				ctrl_hdlr, &ov5670_ctrl_ops, V4L2_CID_LINK_FREQ,
+				ARRAY_SIZE(link_freq_menu_items) - 1,
+				link_freq_index, link_freq_menu_items);
+	if (ov5670->link_freq) {
+		ov5670->link_freq->menu_skip_mask = ~link_freq_usable;
+		if (ov5670->link.num_freqs == 1)
+			ov5670->link_freq->flags |= V4L2_CTRL_FLAG_READ_ONLY;
+	}
 
 	/* By default, V4L2_CID_PIXEL_RATE is read only */
 	ov5670->pixel_rate = v4l2_ctrl_new_std(ctrl_hdlr, &ov5670_ctrl_ops,
-					       V4L2_CID_PIXEL_RATE, 0,
-					       link_freq_configs[0].pixel_rate,
-					       1,
-					       link_freq_configs[0].pixel_rate);
+				V4L2_CID_PIXEL_RATE, 0,
+				link_freq_configs[link_freq_index].pixel_rate,
+				1,
+				link_freq_configs[link_freq_index].pixel_rate);
 
 	vblank_max = OV5670_VTS_MAX - ov5670->cur_mode->height;
 	vblank_def = ov5670->cur_mode->vts_def - ov5670->cur_mode->height;
@@ -2198,9 +1011,12 @@ static int ov5670_init_controls(struct ov5670 *ov5670)
 		ov5670->hblank->flags |= V4L2_CTRL_FLAG_READ_ONLY;
 
 	/* Get min, max, step, default from sensor */
-	v4l2_ctrl_new_std(ctrl_hdlr, &ov5670_ctrl_ops, V4L2_CID_ANALOGUE_GAIN,
-			  ANALOG_GAIN_MIN, ANALOG_GAIN_MAX, ANALOG_GAIN_STEP,
-			  ANALOG_GAIN_DEFAULT);
+	ov5670->analogue_gain = v4l2_ctrl_new_std(ctrl_hdlr, &ov5670_ctrl_ops,
+						  V4L2_CID_ANALOGUE_GAIN,
+						  ANALOG_GAIN_MIN,
+						  ANALOG_GAIN_MAX,
+						  ANALOG_GAIN_STEP,
+						  ANALOG_GAIN_DEFAULT);
 
 	/* Digital gain */
 	v4l2_ctrl_new_std(ctrl_hdlr, &ov5670_ctrl_ops, V4L2_CID_DIGITAL_GAIN,
@@ -2261,15 +1077,25 @@ static int ov5670_enum_frame_size(struct v4l2_subdev *sd,
 				  struct v4l2_subdev_pad_config *cfg,
 				  struct v4l2_subdev_frame_size_enum *fse)
 {
-	if (fse->index >= ARRAY_SIZE(supported_modes))
-		return -EINVAL;
+	struct ov5670 *ov5670 = to_ov5670(sd);
+	unsigned int i, index = 0;
 
 	if (fse->code != MEDIA_BUS_FMT_SGRBG10_1X10)
 		return -EINVAL;
 
-	fse->min_width = supported_modes[fse->index].width;
+	/* Only the modes the link carries */
+	for (i = 0; i < ARRAY_SIZE(supported_modes); i++) {
+		if (!ov5670_mode_fits(ov5670, &supported_modes[i]))
+			continue;
+		if (index++ == fse->index)
+			break;
+	}
+	if (i == ARRAY_SIZE(supported_modes))
+		return -EINVAL;
+
+	fse->min_width = supported_modes[i].width;
 	fse->max_width = fse->min_width;
-	fse->min_height = supported_modes[fse->index].height;
+	fse->min_height = supported_modes[i].height;
 	fse->max_height = fse->min_height;
 
 	return 0;
@@ -2317,26 +1143,36 @@ static int ov5670_set_pad_format(struct v4l2_subdev *sd,
 {
 	struct ov5670 *ov5670 = to_ov5670(sd);
 	const struct ov5670_mode *mode;
+	int link_freq_index;
 	s32 vblank_def;
 	s32 h_blank;
+	int ret = 0;
 
 	mutex_lock(&ov5670->mutex);
 
 	fmt->format.code = MEDIA_BUS_FMT_SGRBG10_1X10;
 
-	mode = v4l2_find_nearest_size(supported_modes,
-				      ARRAY_SIZE(supported_modes),
-				      width, height,
-				      fmt->format.width, fmt->format.height);
+	/* Probe made sure the link carries cur_mode */
+	mode = ov5670_find_mode(ov5670, fmt->format.width,
+				fmt->format.height);
+	if (!mode)
+		mode = ov5670->cur_mode;
 	ov5670_update_pad_format(mode, fmt);
 	if (fmt->which == V4L2_SUBDEV_FORMAT_TRY) {
 		*v4l2_subdev_get_try_format(sd, cfg, fmt->pad) = fmt->format;
 	} else {
+		link_freq_index = sensor_link_apply(&ov5670->link,
+						    ov5670->link_freq,
+						    ov5670_mode_bps(mode));
+		if (link_freq_index < 0) {
+			ret = link_freq_index;
+			goto out;
+		}
+
 		ov5670->cur_mode = mode;
-		__v4l2_ctrl_s_ctrl(ov5670->link_freq, mode->link_freq_index);
 		__v4l2_ctrl_s_ctrl_int64(
 			ov5670->pixel_rate,
-			link_freq_configs[mode->link_freq_index].pixel_rate);
+			link_freq_configs[link_freq_index].pixel_rate);
 		/* Update limits and set FPS to default */
 		vblank_def = ov5670->cur_mode->vts_def -
 			     ov5670->cur_mode->height;
@@ -2351,11 +1187,132 @@ static int ov5670_set_pad_format(struct v4l2_subdev *sd,
 					 h_blank);
 	}
 
+out:
+	mutex_unlock(&ov5670->mutex);
+
+	return ret;
+}
+
+static int ov5670_enum_frame_interval(struct v4l2_subdev *sd,
+				      struct v4l2_subdev_pad_config *cfg,
+				      struct v4l2_subdev_frame_interval_enum
+				      *fie)
+{
+	struct ov5670 *ov5670 = to_ov5670(sd);
+	const struct ov5670_mode *mode;
+	unsigned int i, index = 0;
+
+	if (fie->pad || fie->code != MEDIA_BUS_FMT_SGRBG10_1X10)
+		return -EINVAL;
+
+	mode = ov5670_find_mode(ov5670, fie->width, fie->height);
+	if (!mode || mode->width != fie->width || mode->height != fie->height)
+		return -EINVAL;
+
+	for (i = 0; i < ARRAY_SIZE(ov5670_frame_rates); i++) {
+		if (!ov5670_mode_vts(ov5670, mode, ov5670_frame_rates[i]))
+			continue;
+		if (index++ == fie->index)
+			break;
+	}
+	if (i == ARRAY_SIZE(ov5670_frame_rates))
+		return -EINVAL;
+
+	fie->interval.numerator = 1;
+	fie->interval.denominator = ov5670_frame_rates[i];
+
+	return 0;
+}
+
+static int ov5670_g_frame_interval(struct v4l2_subdev *sd,
+				   struct v4l2_subdev_frame_interval *fi)
+{
+	struct ov5670 *ov5670 = to_ov5670(sd);
+
+	mutex_lock(&ov5670->mutex);
+	ov5670_frame_interval(ov5670, &fi->interval);
 	mutex_unlock(&ov5670->mutex);
 
 	return 0;
 }
 
+/*
+ * The interval is set through VBLANK, so it can change while streaming,
+ * and goes back to the mode's default on set_fmt. A zero interval asks
+ * for the fastest the mode runs at.
+ */
+static int ov5670_s_frame_interval(struct v4l2_subdev *sd,
+				   struct v4l2_subdev_frame_interval *fi)
+{
+	struct ov5670 *ov5670 = to_ov5670(sd);
+	const struct ov5670_mode *mode;
+	u64 vts;
+	int ret;
+
+	if (fi->pad)
+		return -EINVAL;
+
+	mutex_lock(&ov5670->mutex);
+
+	mode = ov5670->cur_mode;
+	if (fi->interval.numerator && fi->interval.denominator) {
+		vts = (u64)fi->interval.numerator *
+		      link_freq_configs[ov5670->link_freq->val].pixel_rate;
+		vts = DIV_ROUND_CLOSEST_ULL(vts, (u64)fi->interval.denominator *
+					    OV5670_FIXED_PPL);
+	} else {
+		vts = mode->vts_min;
+	}
+	vts = clamp_t(u64, vts, mode->vts_min, OV5670_VTS_MAX);
+
+	ret = __v4l2_ctrl_s_ctrl(ov5670->vblank, vts - mode->height);
+	ov5670_frame_interval(ov5670, &fi->interval);
+
+	mutex_unlock(&ov5670->mutex);
+
+	return ret;
+}
+
+static int ov5670_get_selection(struct v4l2_subdev *sd,
+				struct v4l2_subdev_pad_config *cfg,
+				struct v4l2_subdev_selection *sel)
+{
+	struct ov5670 *ov5670 = to_ov5670(sd);
+	const struct ov5670_mode *mode;
+	struct v4l2_mbus_framefmt *try_fmt;
+
+	switch (sel->target) {
+	case V4L2_SEL_TGT_CROP:
+		mutex_lock(&ov5670->mutex);
+		mode = ov5670->cur_mode;
+		if (sel->which == V4L2_SUBDEV_FORMAT_TRY) {
+			try_fmt = v4l2_subdev_get_try_format(sd, cfg, sel->pad);
+			mode = ov5670_find_mode(ov5670, try_fmt->width,
+						try_fmt->height) ?: mode;
+		}
+		ov5670_mode_crop(mode, &sel->r);
+		mutex_unlock(&ov5670->mutex);
+		return 0;
+
+	case V4L2_SEL_TGT_NATIVE_SIZE:
+	case V4L2_SEL_TGT_CROP_BOUNDS:
+		sel->r.left = 0;
+		sel->r.top = 0;
+		sel->r.width = OV5670_NATIVE_WIDTH;
+		sel->r.height = OV5670_NATIVE_HEIGHT;
+		return 0;
+
+	case V4L2_SEL_TGT_CROP_DEFAULT:
+		sel->r.left = OV5670_ACTIVE_LEFT;
+		sel->r.top = OV5670_ACTIVE_TOP;
+		sel->r.width = OV5670_ACTIVE_WIDTH;
+		sel->r.height = OV5670_ACTIVE_HEIGHT;
+		return 0;
+	}
+
+	return -EINVAL;
+}
+
 static int ov5670_get_skip_frames(struct v4l2_subdev *sd, u32 *frames)
 {
 	*frames = OV5670_NUM_OF_SKIP_FRAMES;
@@ -2367,22 +1324,37 @@ static int ov5670_get_skip_frames(struct v4l2_subdev *sd, u32 *frames)
 static int ov5670_start_streaming(struct ov5670 *ov5670)
 {
 	struct i2c_client *client = v4l2_get_subdevdata(&ov5670->sd);
-	const struct ov5670_reg_list *reg_list;
+	const struct sensor_seq *reg_list;
+	struct v4l2_fract interval;
 	int link_freq_index;
+	u32 vts;
 	int ret;
 
+	/*
+	 * If the sensor kept its registers since the last stream, skip the
+	 * software reset: the tables below then only write the registers
+	 * that differ from the previous mode, or nothing for the same mode.
+	 */
+	if (ov5670->loaded_mode == ov5670->cur_mode &&
+	    ov5670->loaded_link_freq == ov5670->link_freq->val)
+		goto setup_ctrls;
+
 	/* Get out of from software reset */
-	ret = ov5670_write_reg(ov5670, OV5670_REG_SOFTWARE_RST,
-			       OV5670_REG_VALUE_08BIT, OV5670_SOFTWARE_RST);
-	if (ret) {
-		dev_err(&client->dev, "%s failed to set powerup registers\n",
-			__func__);
-		return ret;
+	if (!ov5670->loaded_mode) {
+		ret = sensor_reg_write8(&ov5670->i2c, OV5670_REG_SOFTWARE_RST,
+					OV5670_SOFTWARE_RST);
+		if (ret) {
+			dev_err(&client->dev,
+				"%s failed to set powerup registers\n",
+				__func__);
+			return ret;
+		}
 	}
+	ov5670->loaded_mode = NULL;
 
 	/* Setup PLL */
-	link_freq_index = ov5670->cur_mode->link_freq_index;
-	reg_list = &link_freq_configs[link_freq_index].reg_list;
+	link_freq_index = ov5670->link_freq->val;
+	reg_list = link_freq_configs[link_freq_index].reg_list;
 	ret = ov5670_write_reg_list(ov5670, reg_list);
 	if (ret) {
 		dev_err(&client->dev, "%s failed to set plls\n", __func__);
@@ -2390,25 +1362,39 @@ static int ov5670_start_streaming(struct ov5670 *ov5670)
 	}
 
 	/* Apply default values of current mode */
-	reg_list = &ov5670->cur_mode->reg_list;
+	reg_list = ov5670->cur_mode->reg_list;
 	ret = ov5670_write_reg_list(ov5670, reg_list);
 	if (ret) {
 		dev_err(&client->dev, "%s failed to set mode\n", __func__);
 		return ret;
 	}
+	ov5670->loaded_mode = ov5670->cur_mode;
+	ov5670->loaded_link_freq = link_freq_index;
 
+setup_ctrls:
+	trace_sensor_stage_begin(&client->dev, "ctrl_setup");
 	ret = __v4l2_ctrl_handler_setup(ov5670->sd.ctrl_handler);
+	trace_sensor_stage_end(&client->dev, "ctrl_setup", 0, 0, ret);
 	if (ret)
 		return ret;
 
 	/* Write stream on list */
-	ret = ov5670_write_reg(ov5670, OV5670_REG_MODE_SELECT,
-			       OV5670_REG_VALUE_08BIT, OV5670_MODE_STREAMING);
+	trace_sensor_stage_begin(&client->dev, "stream_on");
+	ret = sensor_reg_write8(&ov5670->i2c, OV5670_REG_MODE_SELECT,
+				OV5670_MODE_STREAMING);
+	trace_sensor_stage_end(&client->dev, "stream_on", 1, 3, ret);
 	if (ret) {
 		dev_err(&client->dev, "%s failed to set stream\n", __func__);
 		return ret;
 	}
 
+	vts = ov5670->cur_mode->height + ov5670->vblank->val;
+	ov5670_frame_interval(ov5670, &interval);
+	sensor_meta_start(&ov5670->meta, ov5670->exposure->val,
+			  ov5670->analogue_gain->val, vts);
+	sensor_selftest_start(&ov5670->selftest, ov5670->cur_mode->width,
+			      ov5670->cur_mode->height, &interval);
+
 	return 0;
 }
 
@@ -2417,8 +1403,12 @@ static int ov5670_stop_streaming(struct ov5670 *ov5670)
 	struct i2c_client *client = v4l2_get_subdevdata(&ov5670->sd);
 	int ret;
 
-	ret = ov5670_write_reg(ov5670, OV5670_REG_MODE_SELECT,
-			       OV5670_REG_VALUE_08BIT, OV5670_MODE_STANDBY);
+	sensor_meta_stop(&ov5670->meta);
+
+	trace_sensor_stage_begin(&client->dev, "stream_off");
+	ret = sensor_reg_write8(&ov5670->i2c, OV5670_REG_MODE_SELECT,
+				OV5670_MODE_STANDBY);
+	trace_sensor_stage_end(&client->dev, "stream_off", 1, 3, ret);
 	if (ret)
 		dev_err(&client->dev, "%s failed to set stream\n", __func__);
 
@@ -2529,6 +1519,9 @@ static int __maybe_unused ov5670_suspend(struct device *dev)
 	if (ov5670->streaming)
 		ov5670_stop_streaming(ov5670);
 
+	/* The power may be cut while suspended */
+	ov5670_regs_lost(ov5670);
+
 	return 0;
 }
 
@@ -2550,36 +1543,49 @@ static int __maybe_unused ov5670_resume(struct device *dev)
 	return 0;
 }
 
-/* Verify chip ID */
-static int ov5670_identify_module(struct ov5670 *ov5670)
+static int __maybe_unused ov5670_runtime_suspend(struct device *dev)
 {
-	struct i2c_client *client = v4l2_get_subdevdata(&ov5670->sd);
-	int ret;
-	u32 val;
-
-	ret = ov5670_read_reg(ov5670, OV5670_REG_CHIP_ID,
-			      OV5670_REG_VALUE_24BIT, &val);
-	if (ret)
-		return ret;
+	struct i2c_client *client = to_i2c_client(dev);
+	struct v4l2_subdev *sd = i2c_get_clientdata(client);
 
-	if (val != OV5670_CHIP_ID) {
-		dev_err(&client->dev, "chip id mismatch: %x!=%x\n",
-			OV5670_CHIP_ID, val);
-		return -ENXIO;
-	}
+	/* The PM domain may cut the power, the registers are lost then */
+	ov5670_regs_lost(to_ov5670(sd));
 
-	dev_info(&client->dev, "OV5670 detected at address 0x%02x\n",
-			 client->addr);
+	return 0;
+}
 
+static int __maybe_unused ov5670_runtime_resume(struct device *dev)
+{
 	return 0;
 }
 
+/*
+ * The chip ID was read and checked by __power_on(), all three registers in
+ * one transfer. Only report the module the first time since boot.
+ */
+static void ov5670_identify_module(struct ov5670 *ov5670)
+{
+	struct i2c_client *client = v4l2_get_subdevdata(&ov5670->sd);
+	struct sensor_ident ident = { .chip_id = OV5670_CHIP_ID };
+
+	if (sensor_ident_get(&client->dev, &ident))
+		return;
+
+	sensor_ident_set(&client->dev, &ident);
+	dev_info(&client->dev, "OV5670 detected at address 0x%02x\n",
+		 client->addr);
+}
+
 static const struct v4l2_subdev_video_ops ov5670_video_ops = {
 	.s_stream = ov5670_set_stream,
+	.g_frame_interval = ov5670_g_frame_interval,
+	.s_frame_interval = ov5670_s_frame_interval,
 };
 
 static const struct v4l2_subdev_core_ops ov5670_core_ops = {
 	.s_power = ov5670_s_power,
+	.subscribe_event = v4l2_ctrl_subdev_subscribe_event,
+	.unsubscribe_event = v4l2_event_subdev_unsubscribe,
 };
 
 static const struct v4l2_subdev_pad_ops ov5670_pad_ops = {
@@ -2587,6 +1593,8 @@ static const struct v4l2_subdev_pad_ops ov5670_pad_ops = {
 	.get_fmt = ov5670_get_pad_format,
 	.set_fmt = ov5670_set_pad_format,
 	.enum_frame_size = ov5670_enum_frame_size,
+	.enum_frame_interval = ov5670_enum_frame_interval,
+	.get_selection = ov5670_get_selection,
 };
 
 static const struct v4l2_subdev_sensor_ops ov5670_sensor_ops = {
@@ -2607,113 +1615,106 @@ static const struct v4l2_subdev_internal_ops ov5670_internal_ops = {
 	.open = ov5670_open,
 };
 
-/* Get acpi_device of dependent INT3472 device */
-static struct acpi_device *get_dep_adev(struct device *dev)
+/*
+ * Power up and identify the sensor, then set up the controls and register
+ * the subdev. This runs from a worker so that probe does not wait for the
+ * power up delays of the sensor and of the PMIC it depends on. A failed
+ * attempt is undone and made again SENSOR_IDENTIFY_RETRIES times, then
+ * the device stays bound without a subdev.
+ */
+static void ov5670_identify_work(struct work_struct *work)
 {
-	struct acpi_handle *dev_handle;
-	struct acpi_device *sensor_adev;
-	struct acpi_handle_list dep_devices;
-	struct acpi_device *dep_adev;
-	acpi_status status;
-	const char *dep_hid = "INT3472";
-	int i;
+	struct ov5670 *ov5670 = container_of(to_delayed_work(work),
+					     struct ov5670, identify_work);
+	struct i2c_client *client = v4l2_get_subdevdata(&ov5670->sd);
+	const char *err_msg;
+	int ret;
 
-	sensor_adev = acpi_dev_get_first_match_dev(OV5670_HID, NULL, -1);
-	if (!sensor_adev) {
-		dev_err(dev, "Couldn't get sensor ACPI device\n");
-		return ERR_PTR(-ENODEV);
+	ret = __power_on(ov5670);
+	if (ret) {
+		err_msg = "ov5670 power-up error";
+		goto error_power_off;
 	}
-	dev_handle = sensor_adev->handle;
-	acpi_dev_put(sensor_adev);
 
-	if (!acpi_has_method(dev_handle, "_DEP")) {
-		dev_err(dev, "No _DEP entry found\n");
-		return ERR_PTR(-ENODEV);
-	}
+	ov5670_identify_module(ov5670);
 
-	status = acpi_evaluate_reference(dev_handle, "_DEP", NULL, &dep_devices);
-	if (ACPI_FAILURE(status)) {
-		dev_err(dev, "Failed to evaluate _DEP.\n");
-		return ERR_PTR(-ENODEV);
+	ret = ov5670_init_controls(ov5670);
+	if (ret) {
+		err_msg = "ov5670_init_controls() error";
+		goto error_power_off;
 	}
 
-	for (i = 0; i < dep_devices.count; i++) {
-		struct acpi_device_info *info;
-		int match;
-
-		status = acpi_get_object_info(dep_devices.handles[i], &info);
-		if (ACPI_FAILURE(status)) {
-			dev_dbg(dev,
-				"Error reading _DEP device info, continue next\n");
-			continue;
-		}
-
-		match = info->valid & ACPI_VALID_HID &&
-			!strcmp(info->hardware_id.string, dep_hid);
+	ov5670->sd.internal_ops = &ov5670_internal_ops;
+	ov5670->sd.flags |= V4L2_SUBDEV_FL_HAS_DEVNODE |
+			    V4L2_SUBDEV_FL_HAS_EVENTS;
+	ov5670->sd.entity.ops = &ov5670_subdev_entity_ops;
+	ov5670->sd.entity.function = MEDIA_ENT_F_CAM_SENSOR;
 
-		kfree(info);
+	/* Source pad initialization */
+	ov5670->pad.flags = MEDIA_PAD_FL_SOURCE;
+	ret = media_entity_pads_init(&ov5670->sd.entity, 1, &ov5670->pad);
+	if (ret) {
+		err_msg = "media_entity_pads_init() error";
+		goto error_handler_free;
+	}
 
-		if (!match)
-			continue;
+	/*
+	 * Device is already turned on by i2c-core with ACPI domain PM.
+	 * Enable runtime PM and turn off the device.
+	 */
+	pm_runtime_set_active(&client->dev);
+	pm_runtime_enable(&client->dev);
+	pm_runtime_idle(&client->dev);
 
-		if (acpi_bus_get_device(dep_devices.handles[i], &dep_adev)) {
-			dev_err(dev, "Error getting dependent ACPI device\n");
-			return ERR_PTR(-ENODEV);
-		}
+	/* TODO: how to determine if runtime PM is not supported? */
+	ov5670->is_rpm_supported = false;
 
-		/* found acpi_device of dependent device */
-		break;
+	/* Regular PCs designed for Windows don't support runtime PM.
+	 * In this case, do it ourselves.
+	 */
+	if (!ov5670->is_rpm_supported) {
+		dev_info(&client->dev,
+			 "Couldn't enable runtime PM, will handle it ourselves.\n");
+		__power_off(ov5670);
 	}
 
-	if (!dep_adev) {
-		dev_err(dev, "Dependent ACPI device not found\n");
-		return ERR_PTR(-ENODEV);
+	/* Async register for subdev, last: it may be streamed right away */
+	ret = v4l2_async_register_subdev_sensor_common(&ov5670->sd);
+	if (ret < 0) {
+		err_msg = "v4l2_async_register_subdev() error";
+		goto error_pm_disable;
 	}
 
-	dev_info(dev, "Dependent ACPI device found: %s\n",
-		 dev_name(&dep_adev->dev));
+	ov5670->registered = true;
 
-	return dep_adev;
-}
+	ov5670->debugfs = debugfs_create_dir(dev_name(&client->dev), NULL);
+	debugfs_create_file("modes", 0444, ov5670->debugfs, ov5670,
+			    &ov5670_modes_fops);
+	sensor_stats_debugfs(&ov5670->stats, ov5670->debugfs);
+	sensor_meta_debugfs(&ov5670->meta, ov5670->debugfs);
+	sensor_selftest_debugfs(&ov5670->selftest, ov5670->debugfs);
 
-/* Get dependent INT3472 device */
-static struct device *get_dep_dev(struct device *dev)
-{
-	struct acpi_device *dep_adev;
-	struct acpi_device_physical_node *dep_phys;
+	return;
 
-	dep_adev = get_dep_adev(dev);
-	if (!dep_adev) {
-		dev_err(dev, "get_dep_adev() failed\n");
-		return ERR_PTR(-ENODEV);
-	}
+error_pm_disable:
+	pm_runtime_disable(&client->dev);
+	pm_runtime_set_suspended(&client->dev);
+	media_entity_cleanup(&ov5670->sd.entity);
 
-	/*
-	 * HACK: We know that the PMIC is a "discrete" PMIC, an ACPI device
-	 * that just serves as a container to list system GPIOs.
-	 *
-	 * The ACPI device has no fwnode, nor does it have a platform device.
-	 * This prevents fetching GPIOs. It however seems to be backed by the
-	 * PCI root complex (pci0000:00/0000:00:00.0) as its physical device,
-	 * and that device has its fwnode set to \_SB.PCI0.DSC1. Whether this
-	 * is correct or not is unknown, let's just get the physical device and
-	 * move on for now.
-	 *
-	 * (@kitakar5525)This is observed on Microsoft Surface Go series
-	 * and Acer Switch Alpha 12.
-	 */
-	dep_phys = list_first_entry_or_null(&dep_adev->physical_node_list,
-					    struct acpi_device_physical_node,
-					    node);
-	if (!dep_phys) {
-		dev_info(dev,
-			 "Error getting physical node of dependent device\n");
-		return ERR_PTR(-ENODEV);
-	}
+error_handler_free:
+	v4l2_ctrl_handler_free(ov5670->sd.ctrl_handler);
+	ov5670->sd.ctrl_handler = NULL;
 
-	dev_info(dev, "Dependent device found: %s\n", dev_name(dep_phys->dev));
+error_power_off:
+	__power_off(ov5670);
 
-	return dep_phys->dev;
+	if (sensor_identify_retry(&ov5670->identify_work,
+				  &ov5670->identify_tries))
+		dev_warn(&client->dev, "%s: %s %d, retrying\n", __func__,
+			 err_msg, ret);
+	else
+		dev_err(&client->dev, "%s: %s %d, giving up\n", __func__,
+			err_msg, ret);
 }
 
 static int ov5670_probe(struct i2c_client *client)
@@ -2732,8 +1733,11 @@ static int ov5670_probe(struct i2c_client *client)
 
 	/* Initialize subdev */
 	v4l2_i2c_subdev_init(&ov5670->sd, client, &ov5670_subdev_ops);
+	sensor_i2c_init(&ov5670->i2c, client, &ov5670->stats, &ov5670->shadow);
+	sensor_meta_init(&ov5670->meta, OV5670_CTRL_DELAY_FRAMES);
+	sensor_selftest_init(&ov5670->selftest, 10);
 
-	ov5670->dep_dev = get_dep_dev(&client->dev);
+	ov5670->dep_dev = sensor_dep_get_dev(&client->dev, OV5670_HID);
 	if (IS_ERR(ov5670->dep_dev)) {
 		ret = PTR_ERR(ov5670->dep_dev);
 		dev_err(&client->dev, "cannot get dep_dev: ret %d\n", ret);
@@ -2741,92 +1745,65 @@ static int ov5670_probe(struct i2c_client *client)
 	}
 	dep_dev = ov5670->dep_dev;
 
-	ret = gpio_crs_get(ov5670, dep_dev);
+	ret = sensor_gpios_get(&ov5670->dep_gpios, dep_dev, false);
 	if (ret) {
 		dev_err(dep_dev, "Failed to get _CRS GPIOs\n");
 		return ret;
 	}
 
-	ret = __power_on(ov5670);
+	ret = sensor_shadow_init(&client->dev, &ov5670->shadow,
+				 OV5670_REG_SOFTWARE_RST);
 	if (ret) {
-		err_msg = "ov5670 power-up error";
-		__power_off(ov5670);
-		goto error_gpio_crs_put;
+		err_msg = "sensor_shadow_init() error";
+		goto error_gpios_put;
 	}
 
-	/* Check module identity */
-	ret = ov5670_identify_module(ov5670);
+	ret = sensor_stats_init(&client->dev, &ov5670->stats);
 	if (ret) {
-		err_msg = "ov5670_identify_module() error";
-		goto error_gpio_crs_put;
+		err_msg = "sensor_stats_init() error";
+		goto error_gpios_put;
 	}
 
-	mutex_init(&ov5670->mutex);
-
-	/* Set default mode to max resolution */
-	ov5670->cur_mode = &supported_modes[0];
+	ov5670->link.freqs = link_freq_menu_items;
+	ov5670->link.num_freqs = ARRAY_SIZE(link_freq_menu_items);
+	ov5670->link.lanes = sensor_link_lanes(&client->dev, NULL,
+					       OV5670_DATA_LANES);
+	if (ov5670->link.lanes < OV5670_DATA_LANES) {
+		ret = -EINVAL;
+		err_msg = "fewer data lanes than the mode tables drive";
+		goto error_gpios_put;
+	}
 
-	ret = ov5670_init_controls(ov5670);
-	if (ret) {
-		err_msg = "ov5670_init_controls() error";
-		goto error_mutex_destroy;
+	/* Set default mode to the largest the link carries */
+	ov5670->cur_mode = ov5670_find_mode(ov5670, supported_modes[0].width,
+					    supported_modes[0].height);
+	if (!ov5670->cur_mode) {
+		ret = -ERANGE;
+		err_msg = "no mode fits the link";
+		goto error_gpios_put;
 	}
 
-	ov5670->sd.internal_ops = &ov5670_internal_ops;
-	ov5670->sd.flags |= V4L2_SUBDEV_FL_HAS_DEVNODE;
-	ov5670->sd.entity.ops = &ov5670_subdev_entity_ops;
-	ov5670->sd.entity.function = MEDIA_ENT_F_CAM_SENSOR;
+	mutex_init(&ov5670->mutex);
 
-	/* Source pad initialization */
-	ov5670->pad.flags = MEDIA_PAD_FL_SOURCE;
-	ret = media_entity_pads_init(&ov5670->sd.entity, 1, &ov5670->pad);
+	ret = ov5670_build_progs(ov5670);
 	if (ret) {
-		err_msg = "media_entity_pads_init() error";
-		goto error_handler_free;
-	}
-
-	/* Async register for subdev */
-	ret = v4l2_async_register_subdev_sensor_common(&ov5670->sd);
-	if (ret < 0) {
-		err_msg = "v4l2_async_register_subdev() error";
-		goto error_entity_cleanup;
+		err_msg = "ov5670_build_progs() error";
+		goto error_mutex_destroy;
 	}
 
 	ov5670->streaming = false;
 
-	/*
-	 * Device is already turned on by i2c-core with ACPI domain PM.
-	 * Enable runtime PM and turn off the device.
-	 */
-	pm_runtime_set_active(&client->dev);
-	pm_runtime_enable(&client->dev);
-	pm_runtime_idle(&client->dev);
-
-	/* TODO: how to determine if runtime PM is not supported? */
-	ov5670->is_rpm_supported = false;
-
-	/* Regular PCs designed for Windows don't support runtime PM.
-	 * In this case, do it ourselves.
-	 */
-	if (!ov5670->is_rpm_supported) {
-		dev_info(&client->dev,
-			 "Couldn't enable runtime PM, will handle it ourselves.\n");
-		__power_off(ov5670);
-	}
+	/* The sensor is identified and registered by ov5670_identify_work() */
+	INIT_DELAYED_WORK(&ov5670->identify_work, ov5670_identify_work);
+	schedule_delayed_work(&ov5670->identify_work, 0);
 
 	return 0;
 
-error_entity_cleanup:
-	media_entity_cleanup(&ov5670->sd.entity);
-
-error_handler_free:
-	v4l2_ctrl_handler_free(ov5670->sd.ctrl_handler);
-
 error_mutex_destroy:
 	mutex_destroy(&ov5670->mutex);
 
-error_gpio_crs_put:
-	gpio_crs_put(ov5670);
+error_gpios_put:
+	sensor_gpios_put(&ov5670->dep_gpios);
 
 error_print:
 	dev_err(&client->dev, "%s: %s %d\n", __func__, err_msg, ret);
@@ -2839,20 +1816,34 @@ static int ov5670_remove(struct i2c_client *client)
 	struct v4l2_subdev *sd = i2c_get_clientdata(client);
 	struct ov5670 *ov5670 = to_ov5670(sd);
 
-	gpio_crs_put(ov5670);
+	cancel_delayed_work_sync(&ov5670->identify_work);
 
-	v4l2_async_unregister_subdev(sd);
-	media_entity_cleanup(&sd->entity);
-	v4l2_ctrl_handler_free(sd->ctrl_handler);
-	mutex_destroy(&ov5670->mutex);
+	debugfs_remove_recursive(ov5670->debugfs);
 
-	pm_runtime_disable(&client->dev);
+	if (ov5670->registered) {
+		v4l2_async_unregister_subdev(sd);
+		sensor_meta_stop(&ov5670->meta);
+		media_entity_cleanup(&sd->entity);
+		v4l2_ctrl_handler_free(sd->ctrl_handler);
+
+		pm_runtime_disable(&client->dev);
+		if (!pm_runtime_status_suspended(&client->dev) ||
+		    ov5670->streaming)
+			__power_off(ov5670);
+		pm_runtime_set_suspended(&client->dev);
+	}
+
+	/* After the power off above */
+	sensor_gpios_put(&ov5670->dep_gpios);
+
+	mutex_destroy(&ov5670->mutex);
 
 	return 0;
 }
 
 static const struct dev_pm_ops ov5670_pm_ops = {
 	SET_SYSTEM_SLEEP_PM_OPS(ov5670_suspend, ov5670_resume)
+	SET_RUNTIME_PM_OPS(ov5670_runtime_suspend, ov5670_runtime_resume, NULL)
 };
 
 #ifdef CONFIG_ACPI
@@ -2864,12 +1855,20 @@ static const struct acpi_device_id ov5670_acpi_ids[] = {
 MODULE_DEVICE_TABLE(acpi, ov5670_acpi_ids);
 #endif
 
+static const struct i2c_device_id ov5670_id[] = {
+	{ "ov5670", 0 },
+	{ }
+};
+MODULE_DEVICE_TABLE(i2c, ov5670_id);
+
 static struct i2c_driver ov5670_i2c_driver = {
 	.driver = {
 		.name = "ov5670",
 		.pm = &ov5670_pm_ops,
 		.acpi_match_table = ACPI_PTR(ov5670_acpi_ids),
+		.probe_type = PROBE_PREFER_ASYNCHRONOUS,
 	},
+	.id_table = ov5670_id,
 	.probe_new = ov5670_probe,
 	.remove = ov5670_remove,
 };
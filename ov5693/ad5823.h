@@ -56,6 +56,14 @@ enum ad5823_vcm_mode {
 	AD5823_DIRECT = 0x4,	/* Direct control */
 };
 
+/*
+ * In ARC mode the driver damps the lens ringing for moves of up to
+ * AD5823_ARC_MAX_STEP codes, settling within about one resonance period.
+ * Longer moves are written as several steps of that size.
+ */
+#define AD5823_ARC_MAX_STEP		128
+#define AD5823_ARC_SETTLE_US		10000
+
 #define AD5823_INVALID_CONFIG	0xffffffff
 #define AD5823_MAX_FOCUS_POS	1023
 #define DELAY_PER_STEP_NS	1000000
@@ -30,8 +30,12 @@
 #include <linux/i2c.h>
 #include <linux/moduleparam.h>
 #include <media/v4l2-device.h>
+#include <media/v4l2-event.h>
 #include <linux/io.h>
 #include <linux/acpi.h>
+#include <linux/debugfs.h>
+#include <linux/sort.h>
+#include <asm/unaligned.h>
 
 #include "ov5693.h"
 #include "ad5823.h"
@@ -45,16 +49,51 @@
 		} \
 	} while (0)
 
-/* Value 30ms reached through experimentation on byt ecs.
- * The DS specifies a much lower value but when using a smaller value
- * the I2C bus sometimes locks up permanently when starting the camera.
- * This issue could not be reproduced on cht, so we can reduce the
- * delay value to a lower value when insmod.
+/* On byt ecs, 30ms was reached through experimentation: with a smaller
+ * value the I2C bus sometimes locks up permanently when starting the
+ * camera. This issue could not be reproduced on cht nor on the Surface
+ * models, which only wait for the sensor below. Set it back to 30 when
+ * insmod on byt.
  */
-static uint up_delay = 30;
+static uint up_delay;
 module_param(up_delay, uint, 0644);
 MODULE_PARM_DESC(up_delay,
-		 "Delay prior to the first CCI transaction for ov5693");
+		 "Extra delay in ms prior to the first CCI transaction");
+
+/*
+ * The DS specifies 8192 XVCLK cycles from power up to the first SCCB
+ * access. The supplies behind the PMIC GPIOs may take longer to come up,
+ * the chip ID is polled for that.
+ */
+static struct sensor_power_timing ov5693_power_timing = {
+	.settle_us = SENSOR_POWER_CYCLES_US(8192, 19200000),
+	.poll_us = SENSOR_POWER_POLL_US,
+	.timeout_us = 20000,
+};
+module_param_named(power_settle_us, ov5693_power_timing.settle_us, uint,
+		   0644);
+MODULE_PARM_DESC(power_settle_us, "Wait before the first access at power on");
+module_param_named(power_poll_us, ov5693_power_timing.poll_us, uint, 0644);
+MODULE_PARM_DESC(power_poll_us, "Interval of the chip ID reads at power on");
+module_param_named(power_timeout_us, ov5693_power_timing.timeout_us, uint,
+		   0644);
+MODULE_PARM_DESC(power_timeout_us, "Longest chip ID poll at power on");
+
+/* i2c traffic counters of the sensor, VCM transfers included */
+static struct sensor_stats *ov5693_stats(struct i2c_client *client)
+{
+	struct v4l2_subdev *sd = i2c_get_clientdata(client);
+
+	return &to_ov5693_sensor(sd)->stats;
+}
+
+/* Sensor register access, see sensor_reg.h */
+static struct sensor_i2c *ov5693_i2c(struct i2c_client *client)
+{
+	struct v4l2_subdev *sd = i2c_get_clientdata(client);
+
+	return &to_ov5693_sensor(sd)->i2c;
+}
 
 static int vcm_ad_i2c_wr8(struct i2c_client *client, u8 reg, u8 val)
 {
@@ -70,7 +109,8 @@ static int vcm_ad_i2c_wr8(struct i2c_client *client, u8 reg, u8 val)
 	msg.len = 2;
 	msg.buf = &buf[0];
 
-	err = i2c_transfer(client->adapter, &msg, 1);
+	err = sensor_i2c_transfer(ov5693_stats(client), client->adapter,
+				  &msg, 1);
 	if (err != 1) {
 		dev_err(&client->dev, "%s: vcm i2c fail, err code = %d\n",
 			__func__, err);
@@ -91,7 +131,8 @@ static int ad5823_i2c_write(struct i2c_client *client, u8 reg, u8 val)
 	msg.len = 0x02;
 	msg.buf = &buf[0];
 
-	if (i2c_transfer(client->adapter, &msg, 1) != 1)
+	if (sensor_i2c_transfer(ov5693_stats(client), client->adapter,
+				&msg, 1) != 1)
 		return -EIO;
 	return 0;
 }
@@ -114,7 +155,8 @@ static int ad5823_i2c_read(struct i2c_client *client, u8 reg, u8 *val)
 	msg[1].len = 0x01;
 	msg[1].buf = &buf[1];
 	*val = 0;
-	if (i2c_transfer(client->adapter, msg, 2) != 2)
+	if (sensor_i2c_transfer(ov5693_stats(client), client->adapter,
+				msg, 2) != 2)
 		return -EIO;
 	*val = buf[1];
 	return 0;
@@ -123,76 +165,9 @@ static int ad5823_i2c_read(struct i2c_client *client, u8 reg, u8 *val)
 static const u32 ov5693_embedded_effective_size = 28;
 
 /* i2c read/write stuff */
-static int ov5693_read_reg(struct i2c_client *client,
-			   u16 data_length, u16 reg, u16 *val)
-{
-	int err;
-	struct i2c_msg msg[2];
-	unsigned char data[6];
-
-	if (!client->adapter) {
-		dev_err(&client->dev, "%s error, no client->adapter\n",
-			__func__);
-		return -ENODEV;
-	}
-
-	if (data_length != OV5693_8BIT && data_length != OV5693_16BIT
-	    && data_length != OV5693_32BIT) {
-		dev_err(&client->dev, "%s error, invalid data length\n",
-			__func__);
-		return -EINVAL;
-	}
-
-	memset(msg, 0, sizeof(msg));
-
-	msg[0].addr = client->addr;
-	msg[0].flags = 0;
-	msg[0].len = I2C_MSG_LENGTH;
-	msg[0].buf = data;
-
-	/* high byte goes out first */
-	data[0] = (u8)(reg >> 8);
-	data[1] = (u8)(reg & 0xff);
-
-	msg[1].addr = client->addr;
-	msg[1].len = data_length;
-	msg[1].flags = I2C_M_RD;
-	msg[1].buf = data;
-
-	err = i2c_transfer(client->adapter, msg, 2);
-	if (err != 2) {
-		if (err >= 0)
-			err = -EIO;
-		dev_err(&client->dev,
-			"read from offset 0x%x error %d", reg, err);
-		return err;
-	}
-
-	*val = 0;
-	/* high byte comes first */
-	if (data_length == OV5693_8BIT)
-		*val = (u8)data[0];
-	else if (data_length == OV5693_16BIT)
-		*val = be16_to_cpu(*(__be16 *)&data[0]);
-	else
-		*val = be32_to_cpu(*(__be32 *)&data[0]);
-
-	return 0;
-}
-
-static int ov5693_i2c_write(struct i2c_client *client, u16 len, u8 *data)
+static int ov5693_read_reg8(struct i2c_client *client, u16 reg, u8 *val)
 {
-	struct i2c_msg msg;
-	const int num_msg = 1;
-	int ret;
-
-	msg.addr = client->addr;
-	msg.flags = 0;
-	msg.len = len;
-	msg.buf = data;
-	ret = i2c_transfer(client->adapter, &msg, 1);
-
-	return ret == num_msg ? 0 : -EIO;
+	return sensor_reg_read8(ov5693_i2c(client), reg, val);
 }
 
 static int vcm_dw_i2c_write(struct i2c_client *client, u16 data)
@@ -208,7 +183,8 @@ static int vcm_dw_i2c_write(struct i2c_client *client, u16 data)
 	msg.len = OV5693_16BIT;
 	msg.buf = (void *)&val;
 
-	ret = i2c_transfer(client->adapter, &msg, 1);
+	ret = sensor_i2c_transfer(ov5693_stats(client), client->adapter,
+				  &msg, 1);
 
 	return ret == num_msg ? 0 : -EIO;
 }
@@ -238,7 +214,8 @@ static int vcm_detect(struct i2c_client *client)
 		msg.flags = I2C_M_RD;
 		msg.len = sizeof(data);
 		msg.buf = (u8 *)&data;
-		ret = i2c_transfer(client->adapter, &msg, 1);
+		ret = sensor_i2c_transfer(ov5693_stats(client),
+					  client->adapter, &msg, 1);
 
 		/*
 		 * DW9714 always fails the first read and returns
@@ -258,37 +235,20 @@ static int vcm_detect(struct i2c_client *client)
 	return ret == 1 ? VCM_DW9714 : ret;
 }
 
-static int ov5693_write_reg(struct i2c_client *client, u16 data_length,
-			    u16 reg, u16 val)
+static int ov5693_write_reg8(struct i2c_client *client, u16 reg, u8 val)
 {
-	int ret;
-	unsigned char data[4] = {0};
-	__be16 *wreg = (void *)data;
-	const u16 len = data_length + sizeof(u16); /* 16-bit address + data */
-
-	if (data_length != OV5693_8BIT && data_length != OV5693_16BIT) {
-		dev_err(&client->dev,
-			"%s error, invalid data_length\n", __func__);
-		return -EINVAL;
-	}
-
-	/* high byte goes out first */
-	*wreg = cpu_to_be16(reg);
-
-	if (data_length == OV5693_8BIT) {
-		data[2] = (u8)(val);
-	} else {
-		/* OV5693_16BIT */
-		__be16 *wdata = (void *)&data[2];
+	return sensor_reg_write8(ov5693_i2c(client), reg, val);
+}
 
-		*wdata = cpu_to_be16(val);
-	}
+static int ov5693_prog_run(struct i2c_client *client,
+			   const struct sensor_prog *prog)
+{
+	int ret;
 
-	ret = ov5693_i2c_write(client, len, data);
-	if (ret)
-		dev_err(&client->dev,
-			"write error: wrote 0x%x to offset 0x%x error %d",
-			val, reg, ret);
+	trace_sensor_stage_begin(&client->dev, "load_regs");
+	ret = sensor_prog_run(client, prog, ov5693_stats(client));
+	trace_sensor_stage_end(&client->dev, "load_regs", prog->nr_regs,
+			       prog->nr_bytes, ret);
 
 	return ret;
 }
@@ -298,133 +258,155 @@ static int ov5693_write_reg(struct i2c_client *client, u16 data_length,
  * @client: i2c driver client structure
  * @reglist: list of registers to be written
  *
- * This function initializes a list of registers. When consecutive addresses
- * are found in a row on the list, this function creates a buffer and sends
- * consecutive data in a single i2c_transfer().
- *
- * __ov5693_flush_reg_array, __ov5693_buf_reg_array() and
- * __ov5693_write_reg_is_consecutive() are internal functions to
- * ov5693_write_reg_array_fast() and should be not used anywhere else.
- *
+ * This function initializes a list of registers. Runs of consecutive
+ * addresses on the list are sent in a single i2c_transfer() through the
+ * shared burst writer (see sensor_burst.h). If the list was precompiled
+ * at probe, the precompiled messages are sent instead.
  */
-
-static int __ov5693_flush_reg_array(struct i2c_client *client,
-				    struct ov5693_write_ctrl *ctrl)
+static int ov5693_write_reg_array(struct i2c_client *client,
+				  const struct sensor_seq *reglist)
 {
-	u16 size;
-	__be16 *reg = (void *)&ctrl->buffer.addr;
+	struct v4l2_subdev *sd = i2c_get_clientdata(client);
+	struct ov5693_device *dev = to_ov5693_sensor(sd);
+	struct sensor_prog *progs = dev->res_index[dev->run_mode].progs;
+	struct sensor_burst burst;
+	unsigned int i;
+	int err;
 
-	if (ctrl->index == 0)
-		return 0;
+	if (reglist == &ov5693_global_setting && dev->global_prog.msgs)
+		return ov5693_prog_run(client, &dev->global_prog);
+
+	for (i = 0; progs && i < dev->n_res; i++) {
+		if (reglist == dev->res_list[i].regs && progs[i].msgs)
+			return ov5693_prog_run(client, &progs[i]);
+	}
+
+	trace_sensor_stage_begin(&client->dev, "load_regs");
 
-	size = sizeof(u16) + ctrl->index; /* 16-bit address + data */
+	sensor_burst_init(&burst, client);
+	burst.stats = &dev->stats;
+	err = sensor_seq_walk(&burst, reglist);
+	if (!err)
+		err = sensor_burst_flush(&burst);
 
-	*reg = cpu_to_be16(ctrl->buffer.addr);
-	ctrl->index = 0;
+	trace_sensor_stage_end(&client->dev, "load_regs", burst.nr_regs,
+			       burst.nr_bytes, err);
 
-	return ov5693_i2c_write(client, size, (u8 *)reg);
+	return err;
 }
 
-static int __ov5693_buf_reg_array(struct i2c_client *client,
-				  struct ov5693_write_ctrl *ctrl,
-				  const struct ov5693_reg *next)
+static int ov5693_res_key_cmp(const void *a, const void *b)
 {
-	int size;
-	__be16 *data16;
+	const struct ov5693_res_key *ka = a, *kb = b;
 
-	switch (next->type) {
-	case OV5693_8BIT:
-		size = 1;
-		ctrl->buffer.data[ctrl->index] = (u8)next->val;
-		break;
-	case OV5693_16BIT:
-		size = 2;
+	if (ka->ratio != kb->ratio)
+		return ka->ratio < kb->ratio ? -1 : 1;
+	if (ka->width != kb->width)
+		return ka->width < kb->width ? -1 : 1;
 
-		data16 = (void *)&ctrl->buffer.data[ctrl->index];
-		*data16 = cpu_to_be16((u16)next->val);
-		break;
-	default:
-		return -EINVAL;
-	}
+	return ka->idx - kb->idx;
+}
+
+/* Sort the resolutions of @table for ov5693_find_res() */
+static int ov5693_build_res_index(struct ov5693_device *dev,
+				  const struct ov5693_res_table *table,
+				  struct ov5693_res_index *index)
+{
+	struct i2c_client *client = v4l2_get_subdevdata(&dev->sd);
+	unsigned int i;
+	int ret;
+
+	index->keys = devm_kcalloc(&client->dev, table->n_res,
+				   sizeof(*index->keys), GFP_KERNEL);
+	index->progs = devm_kcalloc(&client->dev, table->n_res,
+				    sizeof(*index->progs), GFP_KERNEL);
+	if (!index->keys || !index->progs)
+		return -ENOMEM;
 
-	/* When first item is added, we need to store its starting address */
-	if (ctrl->index == 0)
-		ctrl->buffer.addr = next->reg;
+	for (i = 0; i < table->n_res; i++) {
+		const struct ov5693_resolution *res = &table->res[i];
 
-	ctrl->index += size;
+		index->keys[i].ratio = (res->width << 13) / res->height;
+		index->keys[i].width = res->width;
+		index->keys[i].idx = i;
 
-	/*
-	 * Buffer cannot guarantee free space for u32? Better flush it to avoid
-	 * possible lack of memory for next item.
-	 */
-	if (ctrl->index + sizeof(u16) >= OV5693_MAX_WRITE_BUF_SIZE)
-		return __ov5693_flush_reg_array(client, ctrl);
+		ret = sensor_prog_build(client, &index->progs[i],
+					sensor_seq_walk, res->regs);
+		if (ret)
+			return ret;
+	}
+
+	sort(index->keys, table->n_res, sizeof(*index->keys),
+	     ov5693_res_key_cmp, NULL);
 
 	return 0;
 }
 
-static int __ov5693_write_reg_is_consecutive(struct i2c_client *client,
-	struct ov5693_write_ctrl *ctrl,
-	const struct ov5693_reg *next)
+/*
+ * Precompile the global setting and the resolution lists so that
+ * startup() is just a few i2c_transfer() calls, and sort the resolutions.
+ */
+static int ov5693_build_progs(struct ov5693_device *dev)
 {
-	if (ctrl->index == 0)
-		return 1;
+	struct i2c_client *client = v4l2_get_subdevdata(&dev->sd);
+	unsigned int i;
+	int ret;
 
-	return ctrl->buffer.addr + ctrl->index == next->reg;
+	ret = sensor_prog_build(client, &dev->global_prog,
+				sensor_seq_walk, &ov5693_global_setting);
+	if (ret)
+		return ret;
+
+	for (i = 0; i < OV5693_NUM_RUN_MODES; i++) {
+		ret = ov5693_build_res_index(dev, &ov5693_res_tables[i],
+					     &dev->res_index[i]);
+		if (ret)
+			return ret;
+	}
+
+	return 0;
 }
 
-static int ov5693_write_reg_array(struct i2c_client *client,
-				  const struct ov5693_reg *reglist)
+static int ov5693_modes_show(struct seq_file *m, void *data)
 {
-	const struct ov5693_reg *next = reglist;
-	struct ov5693_write_ctrl ctrl;
-	int err;
+	struct ov5693_device *dev = m->private;
+	const struct ov5693_res_table *table;
+	unsigned int i, j;
 
-	ctrl.index = 0;
-	for (; next->type != OV5693_TOK_TERM; next++) {
-		switch (next->type & OV5693_TOK_MASK) {
-		case OV5693_TOK_DELAY:
-			err = __ov5693_flush_reg_array(client, &ctrl);
-			if (err)
-				return err;
-			msleep(next->val);
-			break;
-		default:
-			/*
-			 * If next address is not consecutive, data needs to be
-			 * flushed before proceed.
-			 */
-			if (!__ov5693_write_reg_is_consecutive(client, &ctrl,
-							       next)) {
-				err = __ov5693_flush_reg_array(client, &ctrl);
-				if (err)
-					return err;
-			}
-			err = __ov5693_buf_reg_array(client, &ctrl, next);
-			if (err) {
-				dev_err(&client->dev,
-					"%s: write error, aborted\n",
-					__func__);
-				return err;
-			}
-			break;
+	sensor_prog_seq_header(m);
+	sensor_prog_seq_show(m, "global", &dev->global_prog);
+	for (i = 0; i < OV5693_NUM_RUN_MODES; i++) {
+		table = &ov5693_res_tables[i];
+
+		for (j = 0; j < table->n_res; j++) {
+			const char *desc = (const char *)table->res[j].desc;
+
+			sensor_prog_seq_show(m, desc,
+					     &dev->res_index[i].progs[j]);
 		}
 	}
 
-	return __ov5693_flush_reg_array(client, &ctrl);
+	return 0;
 }
+DEFINE_SHOW_ATTRIBUTE(ov5693_modes);
 
+/*
+ * Exposure, gain and digital gain go in one group hold packet, including
+ * the launch, so that they all take effect on the same frame.
+ */
 static long __ov5693_set_exposure(struct v4l2_subdev *sd, int coarse_itg,
 				  int gain, int digitgain)
 
 {
 	struct i2c_client *client = v4l2_get_subdevdata(sd);
 	struct ov5693_device *dev = to_ov5693_sensor(sd);
+	struct sensor_batch batch;
+	u8 timing[4], exp[3], agc[2], mwb[6];
 	u16 vts, hts;
-	int ret, exp_val;
+	int ret, exp_val, i;
 
-	hts = ov5693_res[dev->fmt_idx].pixels_per_line;
-	vts = ov5693_res[dev->fmt_idx].lines_per_frame;
+	hts = dev->res_list[dev->fmt_idx].pixels_per_line;
+	vts = dev->res_list[dev->fmt_idx].lines_per_frame;
 	/*
 	 * If coarse_itg is larger than 1<<15, can not write to reg directly.
 	 * The way is to write coarse_itg/2 to the reg, meanwhile write 2*hts
@@ -434,133 +416,55 @@ static long __ov5693_set_exposure(struct v4l2_subdev *sd, int coarse_itg,
 		hts = hts * 2;
 		coarse_itg = (int)coarse_itg / 2;
 	}
-	/* group hold */
-	ret = ov5693_write_reg(client, OV5693_8BIT,
-			       OV5693_GROUP_ACCESS, 0x00);
-	if (ret) {
-		dev_err(&client->dev, "%s: write %x error, aborted\n",
-			__func__, OV5693_GROUP_ACCESS);
-		return ret;
-	}
-
-	ret = ov5693_write_reg(client, OV5693_8BIT,
-			       OV5693_TIMING_HTS_H, (hts >> 8) & 0xFF);
-	if (ret) {
-		dev_err(&client->dev, "%s: write %x error, aborted\n",
-			__func__, OV5693_TIMING_HTS_H);
-		return ret;
-	}
-
-	ret = ov5693_write_reg(client, OV5693_8BIT,
-			       OV5693_TIMING_HTS_L, hts & 0xFF);
-	if (ret) {
-		dev_err(&client->dev, "%s: write %x error, aborted\n",
-			__func__, OV5693_TIMING_HTS_L);
-		return ret;
-	}
 	/* Increase the VTS to match exposure + MARGIN */
 	if (coarse_itg > vts - OV5693_INTEGRATION_TIME_MARGIN)
 		vts = (u16)coarse_itg + OV5693_INTEGRATION_TIME_MARGIN;
 
-	ret = ov5693_write_reg(client, OV5693_8BIT,
-			       OV5693_TIMING_VTS_H, (vts >> 8) & 0xFF);
-	if (ret) {
-		dev_err(&client->dev, "%s: write %x error, aborted\n",
-			__func__, OV5693_TIMING_VTS_H);
-		return ret;
-	}
-
-	ret = ov5693_write_reg(client, OV5693_8BIT,
-			       OV5693_TIMING_VTS_L, vts & 0xFF);
-	if (ret) {
-		dev_err(&client->dev, "%s: write %x error, aborted\n",
-			__func__, OV5693_TIMING_VTS_L);
-		return ret;
-	}
-
-	/* set exposure */
+	/* HTS_H, HTS_L, VTS_H, VTS_L are consecutive */
+	timing[0] = (hts >> 8) & 0xFF;
+	timing[1] = hts & 0xFF;
+	timing[2] = (vts >> 8) & 0xFF;
+	timing[3] = vts & 0xFF;
 
 	/* Lower four bit should be 0*/
 	exp_val = coarse_itg << 4;
-	ret = ov5693_write_reg(client, OV5693_8BIT,
-			       OV5693_EXPOSURE_L, exp_val & 0xFF);
-	if (ret) {
-		dev_err(&client->dev, "%s: write %x error, aborted\n",
-			__func__, OV5693_EXPOSURE_L);
-		return ret;
-	}
-
-	ret = ov5693_write_reg(client, OV5693_8BIT,
-			       OV5693_EXPOSURE_M, (exp_val >> 8) & 0xFF);
-	if (ret) {
-		dev_err(&client->dev, "%s: write %x error, aborted\n",
-			__func__, OV5693_EXPOSURE_M);
-		return ret;
-	}
+	exp[0] = (exp_val >> 16) & 0x0F;
+	exp[1] = (exp_val >> 8) & 0xFF;
+	exp[2] = exp_val & 0xFF;
 
-	ret = ov5693_write_reg(client, OV5693_8BIT,
-			       OV5693_EXPOSURE_H, (exp_val >> 16) & 0x0F);
-	if (ret) {
-		dev_err(&client->dev, "%s: write %x error, aborted\n",
-			__func__, OV5693_EXPOSURE_H);
-		return ret;
-	}
+	agc[0] = (gain >> 8) & 0xff;
+	agc[1] = gain & 0xff;
 
-	/* Analog gain */
-	ret = ov5693_write_reg(client, OV5693_8BIT,
-			       OV5693_AGC_L, gain & 0xff);
-	if (ret) {
-		dev_err(&client->dev, "%s: write %x error, aborted\n",
-			__func__, OV5693_AGC_L);
-		return ret;
+	/* Same gain for red, green and blue */
+	for (i = 0; i < ARRAY_SIZE(mwb); i += 2) {
+		mwb[i] = (digitgain >> 8) & 0xff;
+		mwb[i + 1] = digitgain & 0xff;
 	}
 
-	ret = ov5693_write_reg(client, OV5693_8BIT,
-			       OV5693_AGC_H, (gain >> 8) & 0xff);
-	if (ret) {
-		dev_err(&client->dev, "%s: write %x error, aborted\n",
-			__func__, OV5693_AGC_H);
-		return ret;
-	}
+	sensor_batch_init(&batch, client);
+	batch.stats = &dev->stats;
 
+	/* group hold */
+	sensor_batch_write8(&batch, OV5693_GROUP_ACCESS, 0x00);
+	sensor_batch_write(&batch, OV5693_TIMING_HTS_H, timing,
+			   sizeof(timing));
+	sensor_batch_write(&batch, OV5693_EXPOSURE_H, exp, sizeof(exp));
+	/* Analog gain */
+	sensor_batch_write(&batch, OV5693_AGC_H, agc, sizeof(agc));
 	/* Digital gain */
-	if (digitgain) {
-		ret = ov5693_write_reg(client, OV5693_16BIT,
-				       OV5693_MWB_RED_GAIN_H, digitgain);
-		if (ret) {
-			dev_err(&client->dev, "%s: write %x error, aborted\n",
-				__func__, OV5693_MWB_RED_GAIN_H);
-			return ret;
-		}
-
-		ret = ov5693_write_reg(client, OV5693_16BIT,
-				       OV5693_MWB_GREEN_GAIN_H, digitgain);
-		if (ret) {
-			dev_err(&client->dev, "%s: write %x error, aborted\n",
-				__func__, OV5693_MWB_RED_GAIN_H);
-			return ret;
-		}
-
-		ret = ov5693_write_reg(client, OV5693_16BIT,
-				       OV5693_MWB_BLUE_GAIN_H, digitgain);
-		if (ret) {
-			dev_err(&client->dev, "%s: write %x error, aborted\n",
-				__func__, OV5693_MWB_RED_GAIN_H);
-			return ret;
-		}
-	}
-
+	if (digitgain)
+		sensor_batch_write(&batch, OV5693_MWB_RED_GAIN_H, mwb,
+				   sizeof(mwb));
 	/* End group */
-	ret = ov5693_write_reg(client, OV5693_8BIT,
-			       OV5693_GROUP_ACCESS, 0x10);
-	if (ret)
-		return ret;
-
+	sensor_batch_write8(&batch, OV5693_GROUP_ACCESS, 0x10);
 	/* Delay launch group */
-	ret = ov5693_write_reg(client, OV5693_8BIT,
-			       OV5693_GROUP_ACCESS, 0xa0);
+	sensor_batch_write8(&batch, OV5693_GROUP_ACCESS, 0xa0);
+
+	ret = sensor_batch_send(&batch);
 	if (ret)
-		return ret;
+		dev_err(&client->dev, "%s: group hold write error %d\n",
+			__func__, ret);
+
 	return ret;
 }
 
@@ -577,21 +481,33 @@ static int ov5693_set_exposure(struct v4l2_subdev *sd, int exposure,
 	return ret;
 }
 
+/*
+ * Read @size bytes of OTP data starting at @addr in a single transfer, the
+ * sensor auto-increments the register address.
+ */
 static int ov5693_read_otp_reg_array(struct i2c_client *client, u16 size,
 				     u16 addr, u8 *buf)
 {
-	u16 index;
+	struct i2c_msg msg[2];
+	u8 addr_buf[2];
 	int ret;
-	u16 *pVal = NULL;
 
-	for (index = 0; index <= size; index++) {
-		pVal = (u16 *)(buf + index);
-		ret =
-		    ov5693_read_reg(client, OV5693_8BIT, addr + index,
-				    pVal);
-		if (ret)
-			return ret;
-	}
+	put_unaligned_be16(addr, addr_buf);
+
+	msg[0].addr = client->addr;
+	msg[0].flags = 0;
+	msg[0].len = sizeof(addr_buf);
+	msg[0].buf = addr_buf;
+
+	msg[1].addr = client->addr;
+	msg[1].flags = I2C_M_RD;
+	msg[1].len = size;
+	msg[1].buf = buf;
+
+	ret = sensor_i2c_transfer(ov5693_stats(client), client->adapter,
+				  msg, ARRAY_SIZE(msg));
+	if (ret != ARRAY_SIZE(msg))
+		return ret < 0 ? ret : -EIO;
 
 	return 0;
 }
@@ -607,8 +523,9 @@ static int __ov5693_otp_read(struct v4l2_subdev *sd, u8 *buf)
 	dev->otp_size = 0;
 	for (i = 1; i < OV5693_OTP_BANK_MAX; i++) {
 		/*set bank NO and OTP read mode. */
-		ret = ov5693_write_reg(client, OV5693_8BIT, OV5693_OTP_BANK_REG,
-				       (i | 0xc0));	//[7:6] 2'b11 [5:0] bank no
+		//[7:6] 2'b11 [5:0] bank no
+		ret = ov5693_write_reg8(client, OV5693_OTP_BANK_REG,
+					(i | 0xc0));
 		if (ret) {
 			dev_err(&client->dev, "failed to prepare OTP page\n");
 			return ret;
@@ -616,8 +533,8 @@ static int __ov5693_otp_read(struct v4l2_subdev *sd, u8 *buf)
 		//dev_dbg(&client->dev, "write 0x%x->0x%x\n",OV5693_OTP_BANK_REG,(i|0xc0));
 
 		/*enable read */
-		ret = ov5693_write_reg(client, OV5693_8BIT, OV5693_OTP_READ_REG,
-				       OV5693_OTP_MODE_READ);	// enable :1
+		ret = ov5693_write_reg8(client, OV5693_OTP_READ_REG,
+					OV5693_OTP_MODE_READ);	// enable :1
 		if (ret) {
 			dev_err(&client->dev,
 				"failed to set OTP reading mode page");
@@ -675,40 +592,65 @@ static int __ov5693_otp_read(struct v4l2_subdev *sd, u8 *buf)
 }
 
 /*
- * Read otp data and store it into a kmalloced buffer.
- * The caller must kfree the buffer when no more needed.
- * @size: set to the size of the returned otp data.
+ * Read the OTP data into the calibration blob, see sensor_calib.h. The data
+ * does not change, so it is only read from the sensor once and cached in
+ * dev->otp_data. dev->otp_size is set to the size of the valid data.
  */
 static void *ov5693_otp_read(struct v4l2_subdev *sd)
 {
 	struct i2c_client *client = v4l2_get_subdevdata(sd);
+	struct ov5693_device *dev = to_ov5693_sensor(sd);
+	enum sensor_calib_format fmt;
 	u8 *buf;
-	int ret;
+	int ret, ret2;
+
+	if (dev->otp_data)
+		return dev->otp_data;
 
-	buf = devm_kzalloc(&client->dev, (OV5693_OTP_DATA_SIZE + 16), GFP_KERNEL);
+	/* the bank after the data is read too, to check for its end */
+	buf = sensor_calib_alloc(&dev->calib,
+				 OV5693_OTP_DATA_SIZE + OV5693_OTP_BANK_SIZE);
 	if (!buf)
 		return ERR_PTR(-ENOMEM);
 
 	//otp valid after mipi on and sw stream on
-	ret = ov5693_write_reg(client, OV5693_8BIT, OV5693_FRAME_OFF_NUM, 0x00);
-
-	ret = ov5693_write_reg(client, OV5693_8BIT,
-			       OV5693_SW_STREAM, OV5693_START_STREAMING);
-
-	ret = __ov5693_otp_read(sd, buf);
+	ret = ov5693_write_reg8(client, OV5693_FRAME_OFF_NUM, 0x00);
+	if (!ret)
+		ret = ov5693_write_reg8(client, OV5693_SW_STREAM,
+					OV5693_START_STREAMING);
+	if (!ret)
+		ret = __ov5693_otp_read(sd, buf);
 
 	//mipi off and sw stream off after otp read
-	ret = ov5693_write_reg(client, OV5693_8BIT, OV5693_FRAME_OFF_NUM, 0x0f);
-
-	ret = ov5693_write_reg(client, OV5693_8BIT,
-			       OV5693_SW_STREAM, OV5693_STOP_STREAMING);
+	ret2 = ov5693_write_reg8(client, OV5693_FRAME_OFF_NUM, 0x0f);
+	if (!ret2)
+		ret2 = ov5693_write_reg8(client, OV5693_SW_STREAM,
+					 OV5693_STOP_STREAMING);
+	if (!ret)
+		ret = ret2;
 
 	/* Driver has failed to find valid data */
 	if (ret) {
 		dev_err(&client->dev, "sensor found no valid OTP data\n");
+		sensor_calib_free(&dev->calib, &client->dev);
+		dev->otp_size = 0;
 		return ERR_PTR(ret);
 	}
 
+	dev->otp_blob.data = buf;
+	dev->otp_blob.size = dev->otp_size;
+
+	/* The 320 bytes are the Intel OTP map, shorter data is exported as is */
+	if (dev->otp_size) {
+		fmt = dev->otp_size == OV5693_OTP_DATA_SIZE ?
+		      SENSOR_CALIB_FMT_INTEL_OTP : SENSOR_CALIB_FMT_RAW;
+		ret = sensor_calib_publish(&dev->calib, &client->dev, fmt,
+					   OV5693_ID, 0, dev->otp_size);
+		if (ret)
+			dev_warn(&client->dev,
+				 "could not export OTP data: %d\n", ret);
+	}
+
 	return buf;
 }
 
@@ -719,32 +661,18 @@ static void *ov5693_otp_read(struct v4l2_subdev *sd)
 static int ov5693_q_exposure(struct v4l2_subdev *sd, s32 *value)
 {
 	struct i2c_client *client = v4l2_get_subdevdata(sd);
-	u16 reg_v, reg_v2;
+	u32 exposure;
 	int ret;
 
-	/* get exposure */
-	ret = ov5693_read_reg(client, OV5693_8BIT,
-			      OV5693_EXPOSURE_L,
-			      &reg_v);
-	if (ret)
-		goto err;
-
-	ret = ov5693_read_reg(client, OV5693_8BIT,
-			      OV5693_EXPOSURE_M,
-			      &reg_v2);
+	/* EXPOSURE_H, _M and _L in one read */
+	ret = sensor_reg_read24(ov5693_i2c(client), OV5693_EXPOSURE_H,
+				&exposure);
 	if (ret)
-		goto err;
+		return ret;
 
-	reg_v += reg_v2 << 8;
-	ret = ov5693_read_reg(client, OV5693_8BIT,
-			      OV5693_EXPOSURE_H,
-			      &reg_v2);
-	if (ret)
-		goto err;
+	*value = exposure;
 
-	*value = reg_v + (((u32)reg_v2 << 16));
-err:
-	return ret;
+	return 0;
 }
 
 static int ad5823_t_focus_vcm(struct v4l2_subdev *sd, u16 val)
@@ -807,10 +735,14 @@ static int ov5693_t_focus_abs(struct v4l2_subdev *sd, s32 value)
 		ret = vcm_dw_i2c_write(client,
 				       vcm_val(value, VCM_DEFAULT_S));
 	} else if (dev->vcm == VCM_AD5823) {
-		ad5823_t_focus_abs(sd, value);
+		ret = ad5823_t_focus_abs(sd, value);
 	}
 	if (ret == 0) {
-		dev->number_of_steps = value - dev->focus;
+		/* Where the lens came from is unknown after power up */
+		if (dev->focus == OV5693_INVALID_CONFIG)
+			dev->number_of_steps = 0;
+		else
+			dev->number_of_steps = value - dev->focus;
 		dev->focus = value;
 		dev->timestamp_t_focus_abs = ktime_get();
 	} else
@@ -820,15 +752,136 @@ static int ov5693_t_focus_abs(struct v4l2_subdev *sd, s32 value)
 	return ret;
 }
 
-static int ov5693_t_focus_rel(struct v4l2_subdev *sd, s32 value)
+/* Time the lens takes to settle after a move of @steps codes */
+static unsigned int ov5693_focus_settle_us(struct ov5693_device *dev,
+					   int steps)
 {
-	struct ov5693_device *dev = to_ov5693_sensor(sd);
+	u64 ns;
+
+	switch (dev->vcm) {
+	case VCM_AD5823:
+		return steps ? AD5823_ARC_SETTLE_US : 0;
+	case VCM_DW9714:
+		ns = min_t(u64, (u64)abs(steps) * DELAY_PER_STEP_NS,
+			   DELAY_MAX_PER_STEP_NS);
+		return div_u64(ns, NSEC_PER_USEC);
+	default:
+		return 0;
+	}
+}
+
+/*
+ * Lens position computed from the last move written and the time since,
+ * without bus access. The lens is assumed to travel at constant speed
+ * until ov5693_focus_settle_us() has passed.
+ */
+static s32 ov5693_focus_pos(struct ov5693_device *dev)
+{
+	unsigned int settle_us;
+	s64 elapsed_us;
+
+	/*
+	 * Powered off, the lens goes to the target at the next power up: the
+	 * VCM setup then queues the move to it.
+	 */
+	if (dev->focus == OV5693_INVALID_CONFIG)
+		return dev->focus_target;
+
+	settle_us = ov5693_focus_settle_us(dev, dev->number_of_steps);
+	elapsed_us = ktime_us_delta(ktime_get(), dev->timestamp_t_focus_abs);
+	if (elapsed_us >= settle_us)
+		return dev->focus;
+
+	return dev->focus - dev->number_of_steps +
+	       div_s64((s64)dev->number_of_steps * elapsed_us, settle_us);
+}
+
+/*
+ * Move the lens to dev->focus_target. Targets set while a move is in
+ * progress replace each other, only the latest one gets written. On the
+ * AD5823 long moves are split in steps the ringing compensation settles
+ * from. focus_status goes BUSY at the start and REACHED (or FAILED) once
+ * the lens settled, which sends a V4L2_EVENT_CTRL to subscribers. A move
+ * cut short by a power down stays BUSY until it is done after power up.
+ */
+static void ov5693_focus_work(struct work_struct *work)
+{
+	struct ov5693_device *dev =
+		container_of(work, struct ov5693_device, focus_work);
+	unsigned int settle_us;
+	s32 cur, next;
+	int ret = 0;
+
+	mutex_lock(&dev->input_lock);
+	__v4l2_ctrl_s_ctrl(dev->focus_status, V4L2_AUTO_FOCUS_STATUS_BUSY);
+
+	/* Stop if powered down meanwhile, the move resumes at power up */
+	while (dev->focus != OV5693_INVALID_CONFIG &&
+	       (s32)dev->focus != dev->focus_target) {
+		cur = dev->focus;
+		next = dev->focus_target;
+
+		if (dev->vcm == VCM_AD5823)
+			next = clamp(next, cur - AD5823_ARC_MAX_STEP,
+				     cur + AD5823_ARC_MAX_STEP);
+
+		ret = ov5693_t_focus_abs(&dev->sd, next);
+		if (ret)
+			break;
+
+		settle_us = ov5693_focus_settle_us(dev, dev->number_of_steps);
+
+		if (!settle_us)
+			continue;
+
+		/* New targets can be queued meanwhile */
+		mutex_unlock(&dev->input_lock);
+		usleep_range(settle_us, settle_us + settle_us / 8);
+		mutex_lock(&dev->input_lock);
+	}
+
+	/* Cut short by the power down, it stays BUSY */
+	if (ret)
+		__v4l2_ctrl_s_ctrl(dev->focus_status,
+				   V4L2_AUTO_FOCUS_STATUS_FAILED);
+	else if (dev->focus != OV5693_INVALID_CONFIG)
+		__v4l2_ctrl_s_ctrl(dev->focus_status,
+				   V4L2_AUTO_FOCUS_STATUS_REACHED);
+	mutex_unlock(&dev->input_lock);
+}
+
+/*
+ * Called with input_lock held, the move is done by ov5693_focus_work().
+ * Powered off, only the target is kept, the VCM setup after power up
+ * queues the move to it.
+ */
+static void ov5693_queue_focus(struct ov5693_device *dev, s32 value)
+{
+	dev->focus_target = clamp(value, 0, OV5693_VCM_MAX_FOCUS_POS);
+	if (dev->focus != OV5693_INVALID_CONFIG)
+		schedule_work(&dev->focus_work);
+}
+
+/* Apply the exposure/gain cluster as one group hold packet */
+static int ov5693_set_ae(struct ov5693_device *dev)
+{
+	int ret;
+
+	ret = __ov5693_set_exposure(&dev->sd, dev->exposure->val,
+				    dev->analogue_gain->val,
+				    dev->digital_gain->val);
+	if (ret)
+		return ret;
 
-	return ov5693_t_focus_abs(sd, dev->focus + value);
+	sensor_meta_queue(&dev->meta, SENSOR_META_EXPOSURE, dev->exposure->val);
+	sensor_meta_queue(&dev->meta, SENSOR_META_GAIN,
+			  dev->analogue_gain->val);
+
+	return 0;
 }
 
-#define DELAY_PER_STEP_NS	1000000
-#define DELAY_MAX_PER_STEP_NS	(1000000 * 1023)
+static int ov5693_set_run_mode(struct ov5693_device *dev, int run_mode);
+static int ov5693_load_res(struct v4l2_subdev *sd);
 
 static int ov5693_s_ctrl(struct v4l2_ctrl *ctrl)
 {
@@ -841,15 +894,27 @@ static int ov5693_s_ctrl(struct v4l2_ctrl *ctrl)
 	case V4L2_CID_FOCUS_ABSOLUTE:
 		dev_dbg(&client->dev, "%s: CID_FOCUS_ABSOLUTE:%d.\n",
 			__func__, ctrl->val);
-		ret = ov5693_t_focus_abs(&dev->sd, ctrl->val);
+		ov5693_queue_focus(dev, ctrl->val);
 		break;
 	case V4L2_CID_FOCUS_RELATIVE:
 		dev_dbg(&client->dev, "%s: CID_FOCUS_RELATIVE:%d.\n",
 			__func__, ctrl->val);
-		ret = ov5693_t_focus_rel(&dev->sd, ctrl->val);
+		ov5693_queue_focus(dev, dev->focus_target + ctrl->val);
 		break;
-	default:
-		ret = -EINVAL;
+	case V4L2_CID_EXPOSURE:
+		/* Cluster master for exposure, analogue and digital gain */
+		dev->ae_set = true;
+		if (dev->streaming)
+			ret = ov5693_set_ae(dev);
+		break;
+	case OV5693_CID_RUN_MODE:
+		ret = ov5693_set_run_mode(dev, ctrl->val);
+		/* Program the entry selected, as set_fmt does */
+		if (!ret)
+			ret = ov5693_load_res(&dev->sd);
+		break;
+	default:
+		ret = -EINVAL;
 	}
 	return ret;
 }
@@ -865,7 +930,7 @@ static int ov5693_g_volatile_ctrl(struct v4l2_ctrl *ctrl)
 		ret = ov5693_q_exposure(&dev->sd, &ctrl->val);
 		break;
 	case V4L2_CID_FOCUS_ABSOLUTE:
-		/* NOTE: there was atomisp-specific function ov5693_q_focus_abs() */
+		ctrl->val = ov5693_focus_pos(dev);
 		break;
 	default:
 		ret = -EINVAL;
@@ -900,7 +965,9 @@ static const struct v4l2_ctrl_config ov5693_controls[] = {
 		.max = OV5693_VCM_MAX_FOCUS_POS,
 		.step = 1,
 		.def = 0,
-		.flags = 0,
+		/* reads return the modelled position, writes always move */
+		.flags = V4L2_CTRL_FLAG_VOLATILE |
+			 V4L2_CTRL_FLAG_EXECUTE_ON_WRITE,
 	},
 	{
 		.ops = &ctrl_ops,
@@ -913,19 +980,24 @@ static const struct v4l2_ctrl_config ov5693_controls[] = {
 		.def = 0,
 		.flags = 0,
 	},
+	{
+		.ops = &ctrl_ops,
+		.id = OV5693_CID_RUN_MODE,
+		.type = V4L2_CTRL_TYPE_MENU,
+		.name = "resolution table",
+		.max = OV5693_NUM_RUN_MODES - 1,
+		.def = OV5693_RUN_MODE_PREVIEW,
+		.qmenu = ov5693_run_mode_menu,
+	},
 };
 
-static int ov5693_init(struct v4l2_subdev *sd)
+/* Set the VCM up after power up, with input_lock held */
+static void __ov5693_vcm_init(struct v4l2_subdev *sd)
 {
 	struct ov5693_device *dev = to_ov5693_sensor(sd);
 	struct i2c_client *client = v4l2_get_subdevdata(sd);
 	int ret;
 
-	if (!dev->has_vcm)
-		return 0;
-
-	dev_info(&client->dev, "%s\n", __func__);
-	mutex_lock(&dev->input_lock);
 	dev->vcm_update = false;
 
 	if (dev->vcm == VCM_AD5823) {
@@ -955,54 +1027,23 @@ static int ov5693_init(struct v4l2_subdev *sd)
 		ov5693_t_focus_abs(sd, 0);
 	}
 
-	mutex_unlock(&dev->input_lock);
-
-	return 0;
+	/* Then to the position set by the user, kept over power off */
+	if ((s32)dev->focus != dev->focus_target)
+		schedule_work(&dev->focus_work);
 }
 
-/* Get GPIOs defined in dep_dev _CRS */
-static int gpio_crs_get(struct ov5693_device *sensor, struct device *dep_dev)
-{
-	sensor->dep_gpios = devm_gpiod_get_array_optional(dep_dev, NULL, GPIOD_ASIS);
-	if (IS_ERR(sensor->dep_gpios)) {
-		dev_err(dep_dev, "Failed to get GPIOs\n");
-		return -ENODEV;
-	}
-
-	return 0;
-}
-
-/* Put GPIOs defined in dep_dev _CRS */
-static void gpio_crs_put(struct ov5693_device *sensor)
-{
-	struct gpio_descs *d = sensor->dep_gpios;
-
-	if (!d)
-		return;
-
-	gpiod_put_array(d);
-}
-
-/* Control GPIOs defined in dep_dev _CRS */
-static int gpio_crs_ctrl(struct ov5693_device *sensor, bool flag)
+static int ov5693_init(struct v4l2_subdev *sd)
 {
-	struct gpio_descs *d = sensor->dep_gpios;
-	unsigned long *values;
+	struct ov5693_device *dev = to_ov5693_sensor(sd);
+	struct i2c_client *client = v4l2_get_subdevdata(sd);
 
-	if (!d)
+	if (!dev->has_vcm)
 		return 0;
 
-	values = bitmap_alloc(d->ndescs, GFP_KERNEL);
-	if (!values)
-		return -ENOMEM;
-
-	if (flag)
-		bitmap_fill(values, d->ndescs);
-	else
-		bitmap_zero(values, d->ndescs);
-
-	gpiod_set_array_value_cansleep(d->ndescs, d->desc,
-				       d->info, values);
+	dev_info(&client->dev, "%s\n", __func__);
+	mutex_lock(&dev->input_lock);
+	__ov5693_vcm_init(sd);
+	mutex_unlock(&dev->input_lock);
 
 	return 0;
 }
@@ -1013,16 +1054,25 @@ static int __power_up(struct v4l2_subdev *sd)
 	struct ov5693_device *sensor = to_ov5693_sensor(sd);
 	int ret;
 
-	ret = gpio_crs_ctrl(sensor, true);
+	trace_sensor_stage_begin(&client->dev, "gpio");
+	ret = sensor_gpios_set(&sensor->dep_gpios, true);
+	trace_sensor_stage_end(&client->dev, "gpio", 0, 0, ret);
 	if (ret)
 		goto fail_power;
 
-	__cci_delay(up_delay);
+	trace_sensor_stage_begin(&client->dev, "power_delay");
+	if (up_delay)
+		__cci_delay(up_delay);
+	ret = sensor_power_wait(&sensor->i2c, &ov5693_power_timing,
+				OV5693_SC_CMMN_CHIP_ID_H, OV5693_ID, 2);
+	trace_sensor_stage_end(&client->dev, "power_delay", 0, 0, ret);
+	if (ret)
+		goto fail_power;
 
 	return 0;
 
 fail_power:
-	gpio_crs_ctrl(sensor, false);
+	sensor_gpios_set(&sensor->dep_gpios, false);
 	dev_err(&client->dev, "sensor power-up failed\n");
 
 	return ret;
@@ -1031,18 +1081,27 @@ fail_power:
 static int power_down(struct v4l2_subdev *sd)
 {
 	struct ov5693_device *dev = to_ov5693_sensor(sd);
+	int ret;
 
 	dev->focus = OV5693_INVALID_CONFIG;
 
-	return gpio_crs_ctrl(dev, false);
+	trace_sensor_stage_begin(sd->dev, "gpio");
+	ret = sensor_gpios_set(&dev->dep_gpios, false);
+	trace_sensor_stage_end(sd->dev, "gpio", 0, 0, ret);
+
+	return ret;
 }
 
 static int power_up(struct v4l2_subdev *sd)
 {
 	static const int retry_count = 4;
+	struct ov5693_device *dev = to_ov5693_sensor(sd);
 	int i, ret;
 
 	for (i = 0; i < retry_count; i++) {
+		if (i)
+			sensor_stats_retry(&dev->stats);
+
 		ret = __power_up(sd);
 		if (!ret)
 			return 0;
@@ -1064,12 +1123,8 @@ static int ov5693_s_power(struct v4l2_subdev *sd, int on)
 
 	/* on == 1 */
 	ret = power_up(sd);
-	if (!ret) {
+	if (!ret)
 		ret = ov5693_init(sd);
-		/* restore settings */
-		ov5693_res = ov5693_res_preview;
-		N_RES = N_RES_PREVIEW;
-	}
 
 	return ret;
 }
@@ -1109,52 +1164,134 @@ static int distance(struct ov5693_resolution *res, u32 w, u32 h)
 	return distance;
 }
 
-/* Return the nearest higher resolution index
+/*
+ * Return the nearest higher resolution index in dev->res_list
  * Firstly try to find the approximate aspect ratio resolution
  * If we find multiple same AR resolutions, choose the
  * minimal size.
+ *
+ * The keys are sorted by aspect ratio, a binary search finds the first
+ * one distance() could accept, and only the entries up to the largest
+ * ratio it could accept are looked at. The bounds are widened by the
+ * rounding of distance(). Returns -1 if no resolution fits.
  */
-static int nearest_resolution_index(int w, int h)
+static int ov5693_find_res(struct ov5693_device *dev, u32 w, u32 h)
 {
-	int i;
+	const struct ov5693_res_index *index = &dev->res_index[dev->run_mode];
+	const struct ov5693_res_key *key, *end;
+	unsigned int lo, hi, mid;
 	int idx = -1;
 	int dist;
 	int min_dist = INT_MAX;
 	int min_res_w = INT_MAX;
-	struct ov5693_resolution *tmp_res = NULL;
+	u32 min_ratio, max_ratio;
 
-	for (i = 0; i < N_RES; i++) {
-		tmp_res = &ov5693_res[i];
-		dist = distance(tmp_res, w, h);
+	if (w == 0 || h == 0)
+		return -1;
+
+	min_ratio = div_u64((u64)(8192 - LARGEST_ALLOWED_RATIO_MISMATCH) * w,
+			    h);
+	min_ratio = min_ratio ? min_ratio - 1 : 0;
+	max_ratio = div_u64((u64)(8192 + LARGEST_ALLOWED_RATIO_MISMATCH + 3) *
+			    w, h) + 1;
+
+	/* first key with ratio >= min_ratio */
+	lo = 0;
+	hi = dev->n_res;
+	while (lo < hi) {
+		mid = (lo + hi) / 2;
+		if (index->keys[mid].ratio < min_ratio)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	end = index->keys + dev->n_res;
+	for (key = index->keys + lo; key < end; key++) {
+		if (key->ratio > max_ratio)
+			break;
+
+		dist = distance(&dev->res_list[key->idx], w, h);
 		if (dist == -1)
 			continue;
-		if (dist < min_dist) {
+		/* the keys of a ratio are sorted by width */
+		if (dist < min_dist ||
+		    (dist == min_dist && key->width < min_res_w)) {
 			min_dist = dist;
-			idx = i;
-			min_res_w = ov5693_res[i].width;
-			continue;
+			min_res_w = key->width;
+			idx = key->idx;
 		}
-		if (dist == min_dist && ov5693_res[i].width < min_res_w)
-			idx = i;
 	}
 
 	return idx;
 }
 
-static int get_resolution_index(int w, int h)
+/*
+ * The entry of the size of res_list[@idx] whose frame rate is closest to
+ * @fps. The entries of a size differ in VTS only.
+ */
+static int ov5693_find_fps(struct ov5693_device *dev, int idx, int fps)
 {
-	int i;
+	const struct ov5693_resolution *res = &dev->res_list[idx];
+	int best = idx;
+	unsigned int i;
 
-	for (i = 0; i < N_RES; i++) {
-		if (w != ov5693_res[i].width)
-			continue;
-		if (h != ov5693_res[i].height)
+	for (i = 0; i < dev->n_res; i++) {
+		if (dev->res_list[i].width != res->width ||
+		    dev->res_list[i].height != res->height)
 			continue;
 
-		return i;
+		if (abs(dev->res_list[i].fps - fps) <
+		    abs(dev->res_list[best].fps - fps))
+			best = i;
+	}
+
+	return best;
+}
+
+/* VBLANK and HBLANK of the current entry, with input_lock held */
+static int ov5693_update_blanking(struct ov5693_device *dev)
+{
+	const struct ov5693_resolution *res = &dev->res_list[dev->fmt_idx];
+	s64 vblank = res->lines_per_frame - res->height;
+	s64 hblank = res->pixels_per_line - res->width;
+	int ret;
+
+	/* Not at probe yet, ov5693_init_controls() sets them up */
+	if (!dev->vblank)
+		return 0;
+
+	ret = __v4l2_ctrl_modify_range(dev->vblank, vblank, vblank, 1, vblank);
+	if (ret)
+		return ret;
+
+	return __v4l2_ctrl_modify_range(dev->hblank, hblank, hblank, 1, hblank);
+}
+
+/* Select the resolution table, called with input_lock held */
+static int ov5693_set_run_mode(struct ov5693_device *dev, int run_mode)
+{
+	const struct ov5693_res_table *table = &ov5693_res_tables[run_mode];
+	u32 w = 0, h = 0;
+	int idx;
+
+	if (dev->streaming)
+		return -EBUSY;
+
+	if (dev->res_list) {
+		w = dev->res_list[dev->fmt_idx].width;
+		h = dev->res_list[dev->fmt_idx].height;
 	}
 
-	return -1;
+	dev->run_mode = run_mode;
+	dev->res_list = table->res;
+	dev->n_res = table->n_res;
+
+	/* Keep the closest size, loaded by s_ctrl (at probe, by set_fmt) */
+	idx = ov5693_find_res(dev, w, h);
+	dev->fmt_idx = idx == -1 ? 0 : idx;
+
+	return ov5693_update_blanking(dev);
 }
 
 /* TODO: remove it. */
@@ -1164,20 +1301,19 @@ static int startup(struct v4l2_subdev *sd)
 	struct i2c_client *client = v4l2_get_subdevdata(sd);
 	int ret = 0;
 
-	ret = ov5693_write_reg(client, OV5693_8BIT,
-			       OV5693_SW_RESET, 0x01);
+	ret = ov5693_write_reg8(client, OV5693_SW_RESET, 0x01);
 	if (ret) {
 		dev_err(&client->dev, "ov5693 reset err.\n");
 		return ret;
 	}
 
-	ret = ov5693_write_reg_array(client, ov5693_global_setting);
+	ret = ov5693_write_reg_array(client, &ov5693_global_setting);
 	if (ret) {
 		dev_err(&client->dev, "ov5693 write register err.\n");
 		return ret;
 	}
 
-	ret = ov5693_write_reg_array(client, ov5693_res[dev->fmt_idx].regs);
+	ret = ov5693_write_reg_array(client, dev->res_list[dev->fmt_idx].regs);
 	if (ret) {
 		dev_err(&client->dev, "ov5693 write register err.\n");
 		return ret;
@@ -1186,47 +1322,14 @@ static int startup(struct v4l2_subdev *sd)
 	return ret;
 }
 
-static int ov5693_set_fmt(struct v4l2_subdev *sd,
-			  struct v4l2_subdev_pad_config *cfg,
-			  struct v4l2_subdev_format *format)
+/* Power cycle and load res_list[fmt_idx], with input_lock held */
+static int ov5693_load_res(struct v4l2_subdev *sd)
 {
-	struct v4l2_mbus_framefmt *fmt = &format->format;
 	struct ov5693_device *dev = to_ov5693_sensor(sd);
 	struct i2c_client *client = v4l2_get_subdevdata(sd);
 	int ret = 0;
-	int idx;
 	int cnt;
 
-	if (format->pad)
-		return -EINVAL;
-	if (!fmt)
-		return -EINVAL;
-
-	mutex_lock(&dev->input_lock);
-	idx = nearest_resolution_index(fmt->width, fmt->height);
-	if (idx == -1) {
-		/* return the largest resolution */
-		fmt->width = ov5693_res[N_RES - 1].width;
-		fmt->height = ov5693_res[N_RES - 1].height;
-	} else {
-		fmt->width = ov5693_res[idx].width;
-		fmt->height = ov5693_res[idx].height;
-	}
-
-	fmt->code = MEDIA_BUS_FMT_SBGGR10_1X10;
-	if (format->which == V4L2_SUBDEV_FORMAT_TRY) {
-		cfg->try_fmt = *fmt;
-		ret = 0;
-		goto mutex_unlock;
-	}
-
-	dev->fmt_idx = get_resolution_index(fmt->width, fmt->height);
-	if (dev->fmt_idx == -1) {
-		dev_err(&client->dev, "get resolution fail\n");
-		ret = -EINVAL;
-		goto mutex_unlock;
-	}
-
 	for (cnt = 0; cnt < OV5693_POWER_UP_RETRY_NUM; cnt++) {
 		power_down(sd);
 		ret = power_up(sd);
@@ -1246,7 +1349,7 @@ static int ov5693_set_fmt(struct v4l2_subdev *sd,
 	}
 	if (cnt == OV5693_POWER_UP_RETRY_NUM) {
 		dev_err(&client->dev, "power up failed, gave up\n");
-		goto mutex_unlock;
+		return ret;
 	}
 
 	/*
@@ -1254,11 +1357,52 @@ static int ov5693_set_fmt(struct v4l2_subdev *sd,
 	 * This would cause ISP timeout because ISP is not ready to receive
 	 * data yet. So add stop streaming here.
 	 */
-	ret = ov5693_write_reg(client, OV5693_8BIT, OV5693_SW_STREAM,
-			       OV5693_STOP_STREAMING);
+	ret = ov5693_write_reg8(client, OV5693_SW_STREAM,
+				OV5693_STOP_STREAMING);
 	if (ret)
 		dev_warn(&client->dev, "ov5693 stream off err\n");
 
+	return ret;
+}
+
+static int ov5693_set_fmt(struct v4l2_subdev *sd,
+			  struct v4l2_subdev_pad_config *cfg,
+			  struct v4l2_subdev_format *format)
+{
+	struct v4l2_mbus_framefmt *fmt = &format->format;
+	struct ov5693_device *dev = to_ov5693_sensor(sd);
+	int ret = 0;
+	int idx;
+
+	if (format->pad)
+		return -EINVAL;
+	if (!fmt)
+		return -EINVAL;
+
+	mutex_lock(&dev->input_lock);
+	idx = ov5693_find_res(dev, fmt->width, fmt->height);
+	/* return the largest resolution */
+	if (idx == -1)
+		idx = dev->n_res - 1;
+	/* at the frame rate set before, if the size has it */
+	idx = ov5693_find_fps(dev, idx, dev->res_list[dev->fmt_idx].fps);
+	fmt->width = dev->res_list[idx].width;
+	fmt->height = dev->res_list[idx].height;
+
+	fmt->code = MEDIA_BUS_FMT_SBGGR10_1X10;
+	if (format->which == V4L2_SUBDEV_FORMAT_TRY) {
+		cfg->try_fmt = *fmt;
+		ret = 0;
+		goto mutex_unlock;
+	}
+
+	dev->fmt_idx = idx;
+	ret = ov5693_update_blanking(dev);
+	if (ret)
+		goto mutex_unlock;
+
+	ret = ov5693_load_res(sd);
+
 mutex_unlock:
 	mutex_unlock(&dev->input_lock);
 	return ret;
@@ -1277,53 +1421,98 @@ static int ov5693_get_fmt(struct v4l2_subdev *sd,
 	if (!fmt)
 		return -EINVAL;
 
-	fmt->width = ov5693_res[dev->fmt_idx].width;
-	fmt->height = ov5693_res[dev->fmt_idx].height;
+	fmt->width = dev->res_list[dev->fmt_idx].width;
+	fmt->height = dev->res_list[dev->fmt_idx].height;
 	fmt->code = MEDIA_BUS_FMT_SBGGR10_1X10;
 
 	return 0;
 }
 
-static int ov5693_detect(struct i2c_client *client)
+/* From the chip ID to the revision, read in one transfer */
+#define OV5693_ID_REGS	(OV5693_SC_CMMN_SUB_ID - OV5693_SC_CMMN_CHIP_ID_H + 1)
+
+static int ov5693_detect(struct i2c_client *client, struct sensor_ident *ident)
 {
 	struct i2c_adapter *adapter = client->adapter;
-	u16 high, low;
+	u8 regs[OV5693_ID_REGS];
 	int ret;
-	u16 id;
-	u8 revision;
 
 	if (!i2c_check_functionality(adapter, I2C_FUNC_I2C))
 		return -ENODEV;
 
-	ret = ov5693_read_reg(client, OV5693_8BIT,
-			      OV5693_SC_CMMN_CHIP_ID_H, &high);
-	if (ret) {
-		dev_err(&client->dev, "sensor_id_high = 0x%x\n", high);
+	ret = sensor_reg_read(ov5693_i2c(client), OV5693_SC_CMMN_CHIP_ID_H,
+			      regs, sizeof(regs));
+	if (ret)
 		return -ENODEV;
-	}
-	ret = ov5693_read_reg(client, OV5693_8BIT,
-			      OV5693_SC_CMMN_CHIP_ID_L, &low);
-	id = ((((u16)high) << 8) | (u16)low);
 
-	if (id != OV5693_ID) {
-		dev_err(&client->dev, "sensor ID error 0x%x\n", id);
+	ident->chip_id = ((u16)regs[0] << 8) | regs[1];
+	if (ident->chip_id != OV5693_ID) {
+		dev_err(&client->dev, "sensor ID error 0x%x\n",
+			ident->chip_id);
 		return -ENODEV;
 	}
 
-	ret = ov5693_read_reg(client, OV5693_8BIT,
-			      OV5693_SC_CMMN_SUB_ID, &high);
-	revision = (u8)high & 0x0f;
+	ident->revision =
+		regs[OV5693_SC_CMMN_SUB_ID - OV5693_SC_CMMN_CHIP_ID_H] & 0x0f;
 
-	dev_info(&client->dev, "sensor_revision = 0x%x\n", revision);
+	dev_info(&client->dev, "sensor_revision = 0x%x\n", ident->revision);
 	dev_info(&client->dev, "sensor_address = 0x%02x\n", client->addr);
 	dev_info(&client->dev, "detect ov5693 success\n");
 	return 0;
 }
 
+static void ov5693_meta_start(struct ov5693_device *dev)
+{
+	struct ov5693_resolution *res = &dev->res_list[dev->fmt_idx];
+	struct v4l2_fract interval = { 1, res->fps };
+
+	sensor_meta_start(&dev->meta, dev->exposure->val,
+			  dev->analogue_gain->val, res->lines_per_frame);
+	sensor_selftest_start(&dev->selftest, res->width, res->height,
+			      &interval);
+}
+
+/* Deferred stream on, if the stream wasn't stopped in the meantime */
+static void ov5693_sync_start(struct sensor_sync *sync)
+{
+	struct ov5693_device *dev = container_of(sync, struct ov5693_device,
+						 sync);
+	struct i2c_client *client = v4l2_get_subdevdata(&dev->sd);
+	int ret;
+
+	mutex_lock(&dev->input_lock);
+
+	if (!dev->streaming)
+		goto out;
+
+	trace_sensor_stage_begin(&client->dev, "stream_on");
+	ret = ov5693_write_reg8(client, OV5693_SW_STREAM,
+				OV5693_START_STREAMING);
+	trace_sensor_stage_end(&client->dev, "stream_on", 1, 3, ret);
+	if (ret) {
+		dev_err(&client->dev, "stream on failed\n");
+		goto out;
+	}
+
+	ov5693_meta_start(dev);
+
+out:
+	mutex_unlock(&dev->input_lock);
+}
+
+/*
+ * No prepare: the sensor is powered up by s_stream itself and down again
+ * at stream off, so there is no standby to prepare it into.
+ */
+static const struct sensor_sync_ops ov5693_sync_ops = {
+	.start = ov5693_sync_start,
+};
+
 static int ov5693_s_stream(struct v4l2_subdev *sd, int enable)
 {
 	struct ov5693_device *dev = to_ov5693_sensor(sd);
 	struct i2c_client *client = v4l2_get_subdevdata(sd);
+	const char *stage = enable ? "stream_on" : "stream_off";
 	int ret;
 
 	mutex_lock(&dev->input_lock);
@@ -1338,13 +1527,51 @@ static int ov5693_s_stream(struct v4l2_subdev *sd, int enable)
 		}
 	}
 
-	ret = ov5693_write_reg(client, OV5693_8BIT, OV5693_SW_STREAM,
-			       enable ? OV5693_START_STREAMING :
-			       OV5693_STOP_STREAMING);
+	/*
+	 * Powered off since the last ov5693_init(), the VCM lost its setup:
+	 * redo it, which queues the move to the target set meanwhile.
+	 */
+	if (enable && dev->has_vcm && dev->focus == OV5693_INVALID_CONFIG)
+		__ov5693_vcm_init(sd);
+
+	/* Restore the exposure and gains set by the user, if any */
+	if (enable && dev->ae_set) {
+		ret = ov5693_set_ae(dev);
+		if (ret) {
+			power_down(sd);
+			goto out;
+		}
+	}
+
+	/* Streaming from here on, the group writes the stream on */
+	if (enable && sensor_sync_arm(&dev->sync)) {
+		dev->streaming = true;
+		goto out;
+	}
+
+	if (!enable) {
+		sensor_sync_disarm(&dev->sync);
+		sensor_meta_stop(&dev->meta);
+	}
+
+	trace_sensor_stage_begin(&client->dev, stage);
+	ret = ov5693_write_reg8(client, OV5693_SW_STREAM,
+				enable ? OV5693_START_STREAMING :
+				OV5693_STOP_STREAMING);
+	trace_sensor_stage_end(&client->dev, stage, 1, 3, ret);
+	if (!ret)
+		dev->streaming = enable;
+
+	if (!ret && enable)
+		ov5693_meta_start(dev);
+	else if (enable)
+		power_down(sd);
 
 	/* power_off() here after streaming for regular PCs. */
-	if (!enable)
+	if (!enable) {
+		dev->streaming = false;
 		power_down(sd);
+	}
 
 out:
 	mutex_unlock(&dev->input_lock);
@@ -1356,6 +1583,8 @@ static int ov5693_s_config(struct v4l2_subdev *sd, int irq)
 {
 	struct ov5693_device *dev = to_ov5693_sensor(sd);
 	struct i2c_client *client = v4l2_get_subdevdata(sd);
+	struct sensor_ident ident;
+	void *buf;
 	int ret = 0;
 
 	mutex_lock(&dev->input_lock);
@@ -1375,17 +1604,40 @@ static int ov5693_s_config(struct v4l2_subdev *sd, int irq)
 		goto fail_power_on;
 	}
 
-	if (!dev->vcm)
-		dev->vcm = vcm_detect(client);
+	/*
+	 * Already identified since boot: power_up() checked the chip ID, the
+	 * VCM is the one found then.
+	 */
+	if (sensor_ident_get(&client->dev, &ident)) {
+		dev->vcm = ident.data;
+	} else {
+		if (!dev->vcm)
+			dev->vcm = vcm_detect(client);
 
-	/* config & detect sensor */
-	ret = ov5693_detect(client);
-	if (ret) {
-		dev_err(&client->dev, "ov5693_detect err s_config.\n");
-		goto fail_power_on;
+		/* config & detect sensor */
+		ret = ov5693_detect(client, &ident);
+		if (ret) {
+			dev_err(&client->dev, "ov5693_detect err s_config.\n");
+			goto fail_power_on;
+		}
+
+		/* Probe the VCM again next time if that failed */
+		if ((int)dev->vcm >= 0) {
+			ident.data = dev->vcm;
+			sensor_ident_set(&client->dev, &ident);
+		}
 	}
 
-	dev->otp_data = ov5693_otp_read(sd);
+	/* TODO: read from SSDB, the VCM found on the bus until then */
+	dev->has_vcm = dev->vcm == VCM_AD5823 || dev->vcm == VCM_DW9714;
+
+	/* Where ov5693_init() leaves the lens, until the user moves it */
+	if (dev->vcm == VCM_AD5823)
+		dev->focus_target = AD5823_INIT_FOCUS_POS;
+
+	buf = ov5693_otp_read(sd);
+	if (!IS_ERR(buf))
+		dev->otp_data = buf;
 
 	/* turn off sensor, after probed */
 	ret = power_down(sd);
@@ -1411,11 +1663,50 @@ static int ov5693_g_frame_interval(struct v4l2_subdev *sd,
 	struct ov5693_device *dev = to_ov5693_sensor(sd);
 
 	interval->interval.numerator = 1;
-	interval->interval.denominator = ov5693_res[dev->fmt_idx].fps;
+	interval->interval.denominator = dev->res_list[dev->fmt_idx].fps;
 
 	return 0;
 }
 
+/* Switch to the entry of the current size closest to the interval */
+static int ov5693_s_frame_interval(struct v4l2_subdev *sd,
+				   struct v4l2_subdev_frame_interval *interval)
+{
+	struct ov5693_device *dev = to_ov5693_sensor(sd);
+	struct v4l2_fract *fi = &interval->interval;
+	int fps = INT_MAX;	/* no interval asks for the fastest */
+	int idx, ret = 0;
+
+	if (interval->pad)
+		return -EINVAL;
+
+	if (fi->numerator && fi->denominator)
+		fps = DIV_ROUND_CLOSEST(fi->denominator, fi->numerator);
+
+	mutex_lock(&dev->input_lock);
+
+	idx = ov5693_find_fps(dev, dev->fmt_idx, fps);
+	if (idx != dev->fmt_idx) {
+		/* The table of the entry is loaded powered up */
+		if (dev->streaming) {
+			ret = -EBUSY;
+			goto out;
+		}
+
+		dev->fmt_idx = idx;
+		ret = ov5693_update_blanking(dev);
+		if (!ret)
+			ret = ov5693_load_res(sd);
+	}
+
+out:
+	fi->numerator = 1;
+	fi->denominator = dev->res_list[dev->fmt_idx].fps;
+	mutex_unlock(&dev->input_lock);
+
+	return ret;
+}
+
 static int ov5693_enum_mbus_code(struct v4l2_subdev *sd,
 				 struct v4l2_subdev_pad_config *cfg,
 				 struct v4l2_subdev_mbus_code_enum *code)
@@ -1431,31 +1722,172 @@ static int ov5693_enum_frame_size(struct v4l2_subdev *sd,
 				  struct v4l2_subdev_pad_config *cfg,
 				  struct v4l2_subdev_frame_size_enum *fse)
 {
-	int index = fse->index;
+	struct ov5693_device *dev = to_ov5693_sensor(sd);
+	const struct ov5693_resolution *res;
+	unsigned int i, index = 0;
+
+	/* Each size once, the entries of a size are next to each other */
+	for (i = 0; i < dev->n_res; i++) {
+		res = &dev->res_list[i];
+		if (i && res->width == res[-1].width &&
+		    res->height == res[-1].height)
+			continue;
+		if (index++ == fse->index)
+			break;
+	}
+	if (i == dev->n_res)
+		return -EINVAL;
+
+	fse->min_width = res->width;
+	fse->min_height = res->height;
+	fse->max_width = res->width;
+	fse->max_height = res->height;
+
+	return 0;
+}
+
+static int ov5693_enum_frame_interval(struct v4l2_subdev *sd,
+				      struct v4l2_subdev_pad_config *cfg,
+				      struct v4l2_subdev_frame_interval_enum
+				      *fie)
+{
+	struct ov5693_device *dev = to_ov5693_sensor(sd);
+	const struct ov5693_resolution *res;
+	unsigned int i, index = 0;
+
+	if (fie->pad)
+		return -EINVAL;
 
-	if (index >= N_RES)
+	for (i = 0; i < dev->n_res; i++) {
+		res = &dev->res_list[i];
+		if (res->width != fie->width || res->height != fie->height)
+			continue;
+		if (index++ == fie->index)
+			break;
+	}
+	if (i == dev->n_res)
 		return -EINVAL;
 
-	fse->min_width = ov5693_res[index].width;
-	fse->min_height = ov5693_res[index].height;
-	fse->max_width = ov5693_res[index].width;
-	fse->max_height = ov5693_res[index].height;
+	fie->interval.numerator = 1;
+	fie->interval.denominator = res->fps;
 
 	return 0;
 }
 
+/* Timing register of @res, after the global table */
+static u8 ov5693_timing_reg(const struct ov5693_resolution *res, u16 reg,
+			    u8 def)
+{
+	u8 val = def;
+
+	if (sensor_seq_read(res->regs, reg, &val))
+		sensor_seq_read(&ov5693_global_setting, reg, &val);
+
+	return val;
+}
+
+/* Both bytes of a timing register pair of @res, after the global table */
+static u16 ov5693_timing_reg16(const struct ov5693_resolution *res, u16 reg)
+{
+	return ov5693_timing_reg(res, reg, 0) << 8 |
+	       ov5693_timing_reg(res, reg + 1, 0);
+}
+
+/* Skipping/binning factor of the odd/even increments at @reg */
+static unsigned int ov5693_timing_scale(const struct ov5693_resolution *res,
+					u16 reg)
+{
+	u8 inc = ov5693_timing_reg(res, reg, 0x11);
+
+	return max(((inc >> 4) + (inc & 0xf)) / 2, 1);
+}
+
+/*
+ * Array area @res reads out: the ISP window, inset in the analog window by
+ * its offset on both sides. The output is all of it, subsampled, and
+ * scaled down by the ISP in the scaling entries.
+ */
+static void ov5693_res_crop(const struct ov5693_resolution *res,
+			    struct v4l2_rect *crop)
+{
+	unsigned int xs = ov5693_timing_scale(res, OV5693_TIMING_X_INC);
+	unsigned int ys = ov5693_timing_scale(res, OV5693_TIMING_Y_INC);
+	u16 x0, y0, x1, y1, x_off, y_off;
+
+	x0 = ov5693_timing_reg16(res, OV5693_HORIZONTAL_START_H);
+	y0 = ov5693_timing_reg16(res, OV5693_VERTICAL_START_H);
+	x1 = ov5693_timing_reg16(res, OV5693_HORIZONTAL_END_H);
+	y1 = ov5693_timing_reg16(res, OV5693_VERTICAL_END_H);
+	x_off = ov5693_timing_reg16(res, OV5693_ISP_X_WIN_H) * xs;
+	y_off = ov5693_timing_reg16(res, OV5693_ISP_Y_WIN_H) * ys;
+
+	crop->left = x0 + x_off;
+	crop->top = y0 + y_off;
+	crop->width = max(x1 - x0 + 1 - 2 * x_off, 0);
+	crop->height = max(y1 - y0 + 1 - 2 * y_off, 0);
+}
+
+static int ov5693_get_selection(struct v4l2_subdev *sd,
+				struct v4l2_subdev_pad_config *cfg,
+				struct v4l2_subdev_selection *sel)
+{
+	struct ov5693_device *dev = to_ov5693_sensor(sd);
+	int idx;
+
+	if (sel->pad)
+		return -EINVAL;
+
+	switch (sel->target) {
+	case V4L2_SEL_TGT_CROP:
+		/* The array area the entry reads out, see ov5693_res_crop() */
+		mutex_lock(&dev->input_lock);
+		idx = dev->fmt_idx;
+		if (sel->which == V4L2_SUBDEV_FORMAT_TRY) {
+			idx = ov5693_find_res(dev, cfg->try_fmt.width,
+					      cfg->try_fmt.height);
+			if (idx == -1)
+				idx = dev->n_res - 1;
+		}
+		ov5693_res_crop(&dev->res_list[idx], &sel->r);
+		mutex_unlock(&dev->input_lock);
+		return 0;
+
+	case V4L2_SEL_TGT_NATIVE_SIZE:
+	case V4L2_SEL_TGT_CROP_BOUNDS:
+		sel->r.left = 0;
+		sel->r.top = 0;
+		sel->r.width = OV5693_NATIVE_WIDTH;
+		sel->r.height = OV5693_NATIVE_HEIGHT;
+		return 0;
+
+	case V4L2_SEL_TGT_CROP_DEFAULT:
+		sel->r.left = OV5693_ACTIVE_LEFT;
+		sel->r.top = OV5693_ACTIVE_TOP;
+		sel->r.width = OV5693_ACTIVE_WIDTH;
+		sel->r.height = OV5693_ACTIVE_HEIGHT;
+		return 0;
+	}
+
+	return -EINVAL;
+}
+
 static const struct v4l2_subdev_video_ops ov5693_video_ops = {
 	.s_stream = ov5693_s_stream,
 	.g_frame_interval = ov5693_g_frame_interval,
+	.s_frame_interval = ov5693_s_frame_interval,
 };
 
 static const struct v4l2_subdev_core_ops ov5693_core_ops = {
 	.s_power = ov5693_s_power,
+	.subscribe_event = v4l2_ctrl_subdev_subscribe_event,
+	.unsubscribe_event = v4l2_event_subdev_unsubscribe,
 };
 
 static const struct v4l2_subdev_pad_ops ov5693_pad_ops = {
 	.enum_mbus_code = ov5693_enum_mbus_code,
 	.enum_frame_size = ov5693_enum_frame_size,
+	.enum_frame_interval = ov5693_enum_frame_interval,
+	.get_selection = ov5693_get_selection,
 	.get_fmt = ov5693_get_fmt,
 	.set_fmt = ov5693_set_fmt,
 };
@@ -1473,12 +1905,21 @@ static int ov5693_remove(struct i2c_client *client)
 
 	dev_info(&client->dev, "%s...\n", __func__);
 
-	gpio_crs_put(ov5693);
+	debugfs_remove_recursive(ov5693->debugfs);
 
 	v4l2_async_unregister_subdev(sd);
+	sensor_sync_remove(&ov5693->sync);
+	cancel_work_sync(&ov5693->focus_work);
+	sensor_meta_stop(&ov5693->meta);
+
+	/* Nothing drives the GPIOs any more, power off and release them */
+	if (ov5693->streaming)
+		power_down(sd);
+	sensor_gpios_put(&ov5693->dep_gpios);
 
 	media_entity_cleanup(&ov5693->sd.entity);
 	v4l2_ctrl_handler_free(&ov5693->ctrl_handler);
+	sensor_calib_free(&ov5693->calib, &client->dev);
 	kfree(ov5693);
 
 	return 0;
@@ -1487,7 +1928,9 @@ static int ov5693_remove(struct i2c_client *client)
 static int ov5693_init_controls(struct ov5693_device *ov5693)
 {
 	struct i2c_client *client = v4l2_get_subdevdata(&ov5693->sd);
+	const struct ov5693_resolution *res;
 	struct v4l2_ctrl *ctrl;
+	s64 blank;
 	unsigned int i;
 	int ret;
 
@@ -1511,14 +1954,59 @@ static int ov5693_init_controls(struct ov5693_device *ov5693)
 		ctrl->flags |= V4L2_CTRL_FLAG_READ_ONLY;
 
 	/* pixel rate */
-	v4l2_ctrl_new_std(&ov5693->ctrl_handler, NULL, V4L2_CID_PIXEL_RATE,
-			  0, OV5693_PIXEL_RATE, 1, OV5693_PIXEL_RATE);
+	ctrl = v4l2_ctrl_new_std(&ov5693->ctrl_handler, NULL,
+				 V4L2_CID_PIXEL_RATE, 0, OV5693_PIXEL_RATE, 1,
+				 OV5693_PIXEL_RATE);
+	if (ctrl)
+		ctrl->flags |= V4L2_CTRL_FLAG_READ_ONLY;
+
+	/* blanking of the entry, the frame rate is set by s_frame_interval */
+	res = &ov5693->res_list[ov5693->fmt_idx];
+	blank = res->lines_per_frame - res->height;
+	ov5693->vblank = v4l2_ctrl_new_std(&ov5693->ctrl_handler, NULL,
+					   V4L2_CID_VBLANK, blank, blank, 1,
+					   blank);
+	blank = res->pixels_per_line - res->width;
+	ov5693->hblank = v4l2_ctrl_new_std(&ov5693->ctrl_handler, NULL,
+					   V4L2_CID_HBLANK, blank, blank, 1,
+					   blank);
+
+	/* Set by ov5693_focus_work(), not volatile so that it sends events */
+	ov5693->focus_status = v4l2_ctrl_new_std(&ov5693->ctrl_handler, NULL,
+						 V4L2_CID_AUTO_FOCUS_STATUS, 0,
+						 V4L2_AUTO_FOCUS_STATUS_BUSY |
+						 V4L2_AUTO_FOCUS_STATUS_REACHED |
+						 V4L2_AUTO_FOCUS_STATUS_FAILED,
+						 0, 0);
+	if (ov5693->focus_status)
+		ov5693->focus_status->flags &= ~V4L2_CTRL_FLAG_VOLATILE;
+
+	/* exposure in lines, analogue and digital gain, set together */
+	ov5693->exposure = v4l2_ctrl_new_std(&ov5693->ctrl_handler, &ctrl_ops,
+					     V4L2_CID_EXPOSURE, 1,
+					     OV5693_MAX_EXPOSURE_VALUE, 1,
+					     OV5693_EXPOSURE_DEFAULT);
+	ov5693->analogue_gain = v4l2_ctrl_new_std(&ov5693->ctrl_handler,
+						  &ctrl_ops,
+						  V4L2_CID_ANALOGUE_GAIN, 1,
+						  OV5693_MAX_GAIN_VALUE, 1,
+						  OV5693_GAIN_DEFAULT);
+	ov5693->digital_gain = v4l2_ctrl_new_std(&ov5693->ctrl_handler,
+						 &ctrl_ops,
+						 V4L2_CID_DIGITAL_GAIN, 1,
+						 OV5693_MWB_GAIN_MAX, 1,
+						 OV5693_MWB_GAIN_DEFAULT);
 
 	if (ov5693->ctrl_handler.error) {
 		ov5693_remove(client);
 		return ov5693->ctrl_handler.error;
 	}
 
+	ov5693->vblank->flags |= V4L2_CTRL_FLAG_READ_ONLY;
+	ov5693->hblank->flags |= V4L2_CTRL_FLAG_READ_ONLY;
+
+	v4l2_ctrl_cluster(3, &ov5693->exposure);
+
 	/* Use same lock for controls as for everything else. */
 	ov5693->ctrl_handler.lock = &ov5693->input_lock;
 	ov5693->sd.ctrl_handler = &ov5693->ctrl_handler;
@@ -1526,115 +2014,6 @@ static int ov5693_init_controls(struct ov5693_device *ov5693)
 	return 0;
 }
 
-/* Get acpi_device of dependent INT3472 device */
-static struct acpi_device *get_dep_adev(struct device *dev)
-{
-	struct acpi_handle *dev_handle;
-	struct acpi_device *sensor_adev;
-	struct acpi_handle_list dep_devices;
-	struct acpi_device *dep_adev;
-	acpi_status status;
-	const char *dep_hid = "INT3472";
-	int i;
-
-	sensor_adev = acpi_dev_get_first_match_dev(OV5693_HID, NULL, -1);
-	if (!sensor_adev) {
-		dev_err(dev, "Couldn't get sensor ACPI device\n");
-		return ERR_PTR(-ENODEV);
-	}
-	dev_handle = sensor_adev->handle;
-	acpi_dev_put(sensor_adev);
-
-	if (!acpi_has_method(dev_handle, "_DEP")) {
-		dev_err(dev, "No _DEP entry found\n");
-		return ERR_PTR(-ENODEV);
-	}
-
-	status = acpi_evaluate_reference(dev_handle, "_DEP", NULL, &dep_devices);
-	if (ACPI_FAILURE(status)) {
-		dev_err(dev, "Failed to evaluate _DEP.\n");
-		return ERR_PTR(-ENODEV);
-	}
-
-	for (i = 0; i < dep_devices.count; i++) {
-		struct acpi_device_info *info;
-		int match;
-
-		status = acpi_get_object_info(dep_devices.handles[i], &info);
-		if (ACPI_FAILURE(status)) {
-			dev_dbg(dev,
-				"Error reading _DEP device info, continue next\n");
-			continue;
-		}
-
-		match = info->valid & ACPI_VALID_HID &&
-			!strcmp(info->hardware_id.string, dep_hid);
-
-		kfree(info);
-
-		if (!match)
-			continue;
-
-		if (acpi_bus_get_device(dep_devices.handles[i], &dep_adev)) {
-			dev_err(dev, "Error getting dependent ACPI device\n");
-			return ERR_PTR(-ENODEV);
-		}
-
-		/* found acpi_device of dependent device */
-		break;
-	}
-
-	if (!dep_adev) {
-		dev_err(dev, "Dependent ACPI device not found\n");
-		return ERR_PTR(-ENODEV);
-	}
-
-	dev_info(dev, "Dependent ACPI device found: %s\n",
-		 dev_name(&dep_adev->dev));
-
-	return dep_adev;
-}
-
-/* Get dependent INT3472 device */
-static struct device *get_dep_dev(struct device *dev)
-{
-	struct acpi_device *dep_adev;
-	struct acpi_device_physical_node *dep_phys;
-
-	dep_adev = get_dep_adev(dev);
-	if (!dep_adev) {
-		dev_err(dev, "get_dep_adev() failed\n");
-		return ERR_PTR(-ENODEV);
-	}
-
-	/*
-	 * HACK: We know that the PMIC is a "discrete" PMIC, an ACPI device
-	 * that just serves as a container to list system GPIOs.
-	 *
-	 * The ACPI device has no fwnode, nor does it have a platform device.
-	 * This prevents fetching GPIOs. It however seems to be backed by the
-	 * PCI root complex (pci0000:00/0000:00:00.0) as its physical device,
-	 * and that device has its fwnode set to \_SB.PCI0.DSC1. Whether this
-	 * is correct or not is unknown, let's just get the physical device and
-	 * move on for now.
-	 *
-	 * (@kitakar5525)This is observed on Microsoft Surface Go series
-	 * and Acer Switch Alpha 12.
-	 */
-	dep_phys = list_first_entry_or_null(&dep_adev->physical_node_list,
-					    struct acpi_device_physical_node,
-					    node);
-	if (!dep_phys) {
-		dev_info(dev,
-			 "Error getting physical node of dependent device\n");
-		return ERR_PTR(-ENODEV);
-	}
-
-	dev_info(dev, "Dependent device found: %s\n", dev_name(dep_phys->dev));
-
-	return dep_phys->dev;
-}
-
 static int ov5693_probe(struct i2c_client *client)
 {
 	struct ov5693_device *ov5693;
@@ -1647,15 +2026,22 @@ static int ov5693_probe(struct i2c_client *client)
 	if (!ov5693)
 		return -ENOMEM;
 
-	/* check if VCM device exists */
-	/* TODO: read from SSDB */
+	/* Set once the VCM is detected, by ov5693_s_config() */
 	ov5693->has_vcm = false;
 
 	mutex_init(&ov5693->input_lock);
+	INIT_WORK(&ov5693->focus_work, ov5693_focus_work);
 
 	v4l2_i2c_subdev_init(&ov5693->sd, client, &ov5693_ops);
+	sensor_i2c_init(&ov5693->i2c, client, &ov5693->stats, NULL);
+	sensor_meta_init(&ov5693->meta, OV5693_CTRL_DELAY_FRAMES);
+	sensor_selftest_init(&ov5693->selftest, 10);
+
+	ret = sensor_stats_init(&client->dev, &ov5693->stats);
+	if (ret)
+		goto out_free;
 
-	ov5693->dep_dev = get_dep_dev(&client->dev);
+	ov5693->dep_dev = sensor_dep_get_dev(&client->dev, OV5693_HID);
 	if (IS_ERR(ov5693->dep_dev)) {
 		ret = PTR_ERR(ov5693->dep_dev);
 		dev_err(&client->dev, "cannot get dep_dev: ret %d\n", ret);
@@ -1663,17 +2049,24 @@ static int ov5693_probe(struct i2c_client *client)
 	}
 	dep_dev = ov5693->dep_dev;
 
-	ret = gpio_crs_get(ov5693, dep_dev);
+	ret = sensor_gpios_get(&ov5693->dep_gpios, dep_dev, true);
 	if (ret) {
 		dev_err(dep_dev, "Failed to get _CRS GPIOs\n");
 		return ret;
 	}
 
+	ret = ov5693_build_progs(ov5693);
+	if (ret)
+		goto out_free;
+
+	ov5693_set_run_mode(ov5693, OV5693_RUN_MODE_PREVIEW);
+
 	ret = ov5693_s_config(&ov5693->sd, client->irq);
 	if (ret)
 		goto out_free;
 
-	ov5693->sd.flags |= V4L2_SUBDEV_FL_HAS_DEVNODE;
+	ov5693->sd.flags |= V4L2_SUBDEV_FL_HAS_DEVNODE |
+			    V4L2_SUBDEV_FL_HAS_EVENTS;
 	ov5693->pad.flags = MEDIA_PAD_FL_SOURCE;
 	ov5693->format.code = MEDIA_BUS_FMT_SBGGR10_1X10;
 	ov5693->sd.entity.function = MEDIA_ENT_F_CAM_SENSOR;
@@ -1692,12 +2085,27 @@ static int ov5693_probe(struct i2c_client *client)
 		goto media_entity_cleanup;
 	}
 
+	ov5693->sync.dev = &client->dev;
+	ov5693->sync.ops = &ov5693_sync_ops;
+	if (sensor_sync_add(&ov5693->sync, ov5693->dep_dev))
+		dev_warn(&client->dev, "streams on without the other sensors\n");
+
+	ov5693->debugfs = debugfs_create_dir(dev_name(&client->dev), NULL);
+	debugfs_create_file("modes", 0444, ov5693->debugfs, ov5693,
+			    &ov5693_modes_fops);
+	debugfs_create_blob("otp", 0444, ov5693->debugfs, &ov5693->otp_blob);
+	sensor_stats_debugfs(&ov5693->stats, ov5693->debugfs);
+	sensor_meta_debugfs(&ov5693->meta, ov5693->debugfs);
+	sensor_selftest_debugfs(&ov5693->selftest, ov5693->debugfs);
+
 	return ret;
 
 media_entity_cleanup:
 	media_entity_cleanup(&ov5693->sd.entity);
 out_free:
 	v4l2_device_unregister_subdev(&ov5693->sd);
+	sensor_calib_free(&ov5693->calib, &client->dev);
+	sensor_gpios_put(&ov5693->dep_gpios);
 	kfree(ov5693);
 	return ret;
 }
@@ -1708,11 +2116,18 @@ static const struct acpi_device_id ov5693_acpi_match[] = {
 };
 MODULE_DEVICE_TABLE(acpi, ov5693_acpi_match);
 
+static const struct i2c_device_id ov5693_id[] = {
+	{ "ov5693", 0 },
+	{ },
+};
+MODULE_DEVICE_TABLE(i2c, ov5693_id);
+
 static struct i2c_driver ov5693_driver = {
 	.driver = {
 		.name = "ov5693",
 		.acpi_match_table = ov5693_acpi_match,
 	},
+	.id_table = ov5693_id,
 	.probe_new = ov5693_probe,
 	.remove = ov5693_remove,
 };
@@ -18,11 +18,13 @@
 
 #ifndef __OV5693_H__
 #define __OV5693_H__
+#include <linux/debugfs.h>
 #include <linux/kernel.h>
 #include <linux/types.h>
 #include <linux/i2c.h>
 #include <linux/delay.h>
 #include <linux/videodev2.h>
+#include <linux/workqueue.h>
 #include <linux/spinlock.h>
 #include <media/v4l2-subdev.h>
 #include <media/v4l2-device.h>
@@ -30,6 +32,15 @@
 #include <linux/v4l2-mediabus.h>
 #include <media/media-entity.h>
 
+#include "sensor_burst.h"
+#include "sensor_calib.h"
+#include "sensor_dep.h"
+#include "sensor_meta.h"
+#include "sensor_power.h"
+#include "sensor_reg.h"
+#include "sensor_selftest.h"
+#include "sensor_seq.h"
+
 #define OV5693_HID "INT33BE"
 
 /*
@@ -57,6 +68,10 @@
 
 #define OV5693_MAX_EXPOSURE_VALUE	0xFFF1
 #define OV5693_MAX_GAIN_VALUE		0xFF
+#define OV5693_EXPOSURE_DEFAULT		0x07b8	/* 1984 lines - margin */
+#define OV5693_GAIN_DEFAULT		0x10
+/* Exposure and gain writes apply from the second frame after */
+#define OV5693_CTRL_DELAY_FRAMES	2
 
 /*
  * focal length bits definition:
@@ -130,11 +145,26 @@
 #define OV5693_TIMING_VTS_H			0x380e
 /*High 8-bit, and low 8-bit HTS address is 0x380f*/
 #define OV5693_TIMING_VTS_L			0x380f
+/* ISP window offset in the array window, in subsampled pixels */
+#define OV5693_ISP_X_WIN_H			0x3810
+#define OV5693_ISP_Y_WIN_H			0x3812
+/* Subsampling increments, Bit[7:4] odd and Bit[3:0] even */
+#define OV5693_TIMING_X_INC			0x3814
+#define OV5693_TIMING_Y_INC			0x3815
+
+/* Pixel array, and the active 2592x1944 in it */
+#define OV5693_NATIVE_WIDTH			2624
+#define OV5693_NATIVE_HEIGHT			1956
+#define OV5693_ACTIVE_LEFT			16
+#define OV5693_ACTIVE_TOP			6
+#define OV5693_ACTIVE_WIDTH			2592
+#define OV5693_ACTIVE_HEIGHT			1944
 
 #define OV5693_MWB_RED_GAIN_H			0x3400
 #define OV5693_MWB_GREEN_GAIN_H			0x3402
 #define OV5693_MWB_BLUE_GAIN_H			0x3404
 #define OV5693_MWB_GAIN_MAX			0x0fff
+#define OV5693_MWB_GAIN_DEFAULT			0x0400
 
 #define OV5693_START_STREAMING			0x01
 #define OV5693_STOP_STREAMING			0x00
@@ -185,10 +215,8 @@
 
 /* link freq and pixel rate required for IPU3 */
 #define OV5693_LINK_FREQ_640MHZ		640000000
-/* pixel_rate = link_freq * 2 * nr_of_lanes / bits_per_sample
- * To avoid integer overflow, dividing by bits_per_sample first.
- */
-#define OV5693_PIXEL_RATE		(OV5693_LINK_FREQ_640MHZ / 10) * 2 * 2
+/* pix_clk_freq of all the resolutions, HTS and VTS count in it */
+#define OV5693_PIXEL_RATE		160000000
 static const s64 link_freq_menu_items[] = {
 	OV5693_LINK_FREQ_640MHZ
 };
@@ -200,7 +228,7 @@ struct regval_list {
 
 struct ov5693_resolution {
 	u8 *desc;
-	const struct ov5693_reg *regs;
+	const struct sensor_seq *regs;
 	int res;
 	int width;
 	int height;
@@ -214,6 +242,31 @@ struct ov5693_resolution {
 	bool used;
 };
 
+/* Entry of the resolution lookup index, see ov5693_find_res() */
+struct ov5693_res_key {
+	u32 ratio;		/* width / height, << 13 */
+	u16 width;
+	u8 idx;			/* in the resolution table */
+};
+
+/* Built at probe for each of ov5693_res_tables */
+struct ov5693_res_index {
+	struct ov5693_res_key *keys;	/* by ratio, then width, then idx */
+	struct sensor_prog *progs;	/* precompiled regs of each entry */
+};
+
+/* Resolution tables, selected at runtime with OV5693_CID_RUN_MODE */
+enum ov5693_run_mode {
+	OV5693_RUN_MODE_PREVIEW,
+#if ENABLE_NON_PREVIEW
+	OV5693_RUN_MODE_VIDEO,
+	OV5693_RUN_MODE_STILL,
+#endif
+	OV5693_NUM_RUN_MODES,
+};
+
+#define OV5693_CID_RUN_MODE	(V4L2_CID_USER_BASE | 0x1001)
+
 struct ov5693_format {
 	u8 *desc;
 	u32 pixelformat;
@@ -239,11 +292,25 @@ struct ov5693_device {
 	struct camera_sensor_platform_data *platform_data;
 	ktime_t timestamp_t_focus_abs;
 	int vt_pix_clk_freq_mhz;
-	int fmt_idx;
-	int run_mode;
+	int fmt_idx;		/* in res_list */
+	int run_mode;		/* enum ov5693_run_mode */
+	/* resolution table of run_mode */
+	struct ov5693_resolution *res_list;
+	unsigned int n_res;
+	struct ov5693_res_index res_index[OV5693_NUM_RUN_MODES];
 	int otp_size;
-	u8 *otp_data;
-	u32 focus;
+	u8 *otp_data;		/* read once at probe, NULL if not available */
+	struct sensor_calib calib;	/* otp_data, exported to userspace */
+	struct debugfs_blob_wrapper otp_blob;
+	struct sensor_stats stats;	/* i2c traffic, see sensor_stats.h */
+	struct sensor_i2c i2c;		/* register access, see sensor_reg.h */
+	struct sensor_meta meta;	/* per-frame values, see sensor_meta.h */
+	struct sensor_selftest selftest; /* see sensor_selftest.h */
+	struct sensor_sync sync;	/* stream on together, sensor_dep.h */
+	u32 focus;		/* OV5693_INVALID_CONFIG if unknown */
+	s32 focus_target;	/* latest position set by the user */
+	struct work_struct focus_work;	/* moves the lens to focus_target */
+	struct v4l2_ctrl *focus_status;
 	s16 number_of_steps;
 	u8 res;
 	u8 type;
@@ -254,9 +321,26 @@ struct ov5693_device {
 	struct device *dep_dev;
 
 	/* GPIOs defined in dep_dev _CRS */
-	struct gpio_descs *dep_gpios;
+	struct sensor_gpios dep_gpios;
 
 	bool has_vcm;
+
+	/* exposure, analogue_gain and digital_gain form a cluster */
+	struct v4l2_ctrl *exposure;
+	struct v4l2_ctrl *analogue_gain;
+	struct v4l2_ctrl *digital_gain;
+	bool ae_set;		/* set by the user, restore at stream on */
+	struct v4l2_ctrl *vblank;	/* of res_list[fmt_idx], read only */
+	struct v4l2_ctrl *hblank;
+	bool streaming;
+
+	/*
+	 * Register lists precompiled at probe, see ov5693_build_progs(). Those
+	 * of the resolutions are in res_index.
+	 */
+	struct sensor_prog global_prog;
+
+	struct dentry *debugfs;
 };
 
 enum ov5693_tok_type {
@@ -284,440 +368,234 @@ struct ov5693_reg {
 
 #define to_ov5693_sensor(x) container_of(x, struct ov5693_device, sd)
 
-#define OV5693_MAX_WRITE_BUF_SIZE	30
-
-struct ov5693_write_buffer {
-	u16 addr;
-	u8 data[OV5693_MAX_WRITE_BUF_SIZE];
+static const u8 ov5693_global_setting_data[] = {
+	SENSOR_SEQ_REGS(0x0103, 0x01),
+	SENSOR_SEQ_REGS(0x3001, 0x0a, 0x80),
+	SENSOR_SEQ_REGS(0x3006, 0x00),
+	SENSOR_SEQ_REGS(0x3011, 0x21, 0x09, 0x10, 0x00, 0x08, 0xf0, 0xf0, 0xf0),
+	SENSOR_SEQ_REGS(0x301b, 0xb4),
+	SENSOR_SEQ_REGS(0x301d, 0x02),
+	SENSOR_SEQ_REGS(0x3021, 0x00, 0x01),
+	SENSOR_SEQ_REGS(0x3028, 0x44),
+	SENSOR_SEQ_REGS(0x3098, 0x02, 0x19, 0x02, 0x01, 0x00),
+	SENSOR_SEQ_REGS(0x30a0, 0xd2),
+	SENSOR_SEQ_REGS(0x30a2, 0x01),
+	SENSOR_SEQ_REGS(0x30b2, 0x00, 0x7d, 0x03, 0x04, 0x01),
+	SENSOR_SEQ_REGS(0x3104, 0x21),
+	SENSOR_SEQ_REGS(0x3106, 0x00),
+	SENSOR_SEQ_REGS(0x3400, 0x04, 0x00, 0x04, 0x00, 0x04, 0x00, 0x01),
+	SENSOR_SEQ_REGS(0x3500, 0x00),
+	SENSOR_SEQ_REGS(0x3503,
+			0x07, 0x00, 0x00, 0x00, 0x02, 0x00, 0x10, 0x00,
+			0x40),
+	SENSOR_SEQ_REGS(0x3601, 0x0a, 0x38),
+	SENSOR_SEQ_REGS(0x3612, 0x80),
+	SENSOR_SEQ_REGS(0x3620, 0x54, 0xc7, 0x0f),
+	SENSOR_SEQ_REGS(0x3625, 0x10),
+	SENSOR_SEQ_REGS(0x3630, 0x55, 0xf4, 0x00, 0x34, 0x02),
+	SENSOR_SEQ_REGS(0x364d, 0x0d),
+	SENSOR_SEQ_REGS(0x364f, 0xdd),
+	SENSOR_SEQ_REGS(0x3660, 0x04),
+	SENSOR_SEQ_REGS(0x3662, 0x10, 0xf1),
+	SENSOR_SEQ_REGS(0x3665, 0x00, 0x20, 0x00),
+	SENSOR_SEQ_REGS(0x366a, 0x80),
+	SENSOR_SEQ_REGS(0x3680, 0xe0, 0x00),
+	SENSOR_SEQ_REGS(0x3700, 0x42, 0x14, 0xa0, 0xd8, 0x78, 0x02),
+	SENSOR_SEQ_REGS(0x370a, 0x00, 0x20, 0x0c, 0x11, 0x00, 0x40, 0x00),
+	SENSOR_SEQ_REGS(0x371a, 0x1c, 0x05, 0x01),
+	SENSOR_SEQ_REGS(0x371e, 0xa1, 0x0c),
+	SENSOR_SEQ_REGS(0x3721, 0x00),
+	SENSOR_SEQ_REGS(0x3724, 0x10),
+	SENSOR_SEQ_REGS(0x3726, 0x00),
+	SENSOR_SEQ_REGS(0x372a, 0x01),
+	SENSOR_SEQ_REGS(0x3730, 0x10),
+	SENSOR_SEQ_REGS(0x3738, 0x22, 0xe5, 0x50, 0x02, 0x41),
+	SENSOR_SEQ_REGS(0x373f, 0x02, 0x42, 0x02, 0x18, 0x01, 0x02),
+	SENSOR_SEQ_REGS(0x3747, 0x10),
+	SENSOR_SEQ_REGS(0x374c, 0x04),
+	SENSOR_SEQ_REGS(0x3751, 0xf0, 0x00, 0x00, 0xc0, 0x00, 0x1a),
+	SENSOR_SEQ_REGS(0x3758, 0x00, 0x0f),
+	SENSOR_SEQ_REGS(0x376b, 0x44),
+	SENSOR_SEQ_REGS(0x375c, 0x04),
+	SENSOR_SEQ_REGS(0x3774, 0x10),
+	SENSOR_SEQ_REGS(0x3776, 0x00),
+	SENSOR_SEQ_REGS(0x377f, 0x08, 0x22, 0x0c),
+	SENSOR_SEQ_REGS(0x3784, 0x2c, 0x1e),
+	SENSOR_SEQ_REGS(0x378f, 0xf5),
+	SENSOR_SEQ_REGS(0x3791, 0xb0),
+	SENSOR_SEQ_REGS(0x3795, 0x00, 0x64, 0x11, 0x30, 0x41, 0x07, 0xb0, 0x0c),
+	SENSOR_SEQ_REGS(0x37c5, 0x00, 0x00, 0x00),
+	SENSOR_SEQ_REGS(0x37c9, 0x00, 0x00, 0x00),
+	SENSOR_SEQ_REGS(0x37de, 0x00, 0x00),
+	SENSOR_SEQ_REGS(0x3800, 0x00, 0x00, 0x00),
+	SENSOR_SEQ_REGS(0x3804, 0x0a, 0x3f),
+	SENSOR_SEQ_REGS(0x3810, 0x00),
+	SENSOR_SEQ_REGS(0x3812, 0x00),
+	SENSOR_SEQ_REGS(0x3823, 0x00, 0x00, 0x00, 0x00, 0x00),
+	SENSOR_SEQ_REGS(0x382a, 0x04),
+	SENSOR_SEQ_REGS(0x3a04, 0x06, 0x14, 0x00, 0xfe),
+	SENSOR_SEQ_REGS(0x3b00, 0x00),
+	SENSOR_SEQ_REGS(0x3b02, 0x00, 0x00, 0x00, 0x00),
+	SENSOR_SEQ_REGS(0x3e07, 0x20),
+	SENSOR_SEQ_REGS(0x4000, 0x08, 0x04, 0x45),
+	SENSOR_SEQ_REGS(0x4004, 0x08, 0x18, 0x20),
+	SENSOR_SEQ_REGS(0x4008, 0x24, 0x10),
+	SENSOR_SEQ_REGS(0x400c, 0x00, 0x00),
+	SENSOR_SEQ_REGS(0x4058, 0x00),
+	SENSOR_SEQ_REGS(0x404e, 0x37, 0x8f),
+	SENSOR_SEQ_REGS(0x4058, 0x00),
+	SENSOR_SEQ_REGS(0x4101, 0xb2),
+	SENSOR_SEQ_REGS(0x4303, 0x00, 0x08),
+	SENSOR_SEQ_REGS(0x4307, 0x31),
+	SENSOR_SEQ_REGS(0x4311, 0x04),
+	SENSOR_SEQ_REGS(0x4315, 0x01),
+	SENSOR_SEQ_REGS(0x4511, 0x05, 0x01),
+	SENSOR_SEQ_REGS(0x4806, 0x00),
+	SENSOR_SEQ_REGS(0x4816, 0x52),
+	SENSOR_SEQ_REGS(0x481f, 0x30),
+	SENSOR_SEQ_REGS(0x4826, 0x2c),
+	SENSOR_SEQ_REGS(0x4831, 0x64),
+	SENSOR_SEQ_REGS(0x4d00, 0x04, 0x71, 0xfd, 0xf5, 0x0c, 0xcc),
+	SENSOR_SEQ_REGS(0x4837, 0x0a),
+	SENSOR_SEQ_REGS(0x5000, 0x06, 0x01),
+	SENSOR_SEQ_REGS(0x5003, 0x20),
+	SENSOR_SEQ_REGS(0x5046, 0x0a),
+	SENSOR_SEQ_REGS(0x5013, 0x00),
+	SENSOR_SEQ_REGS(0x5046, 0x0a),
+	SENSOR_SEQ_REGS(0x5780, 0x1c),
+	SENSOR_SEQ_REGS(0x5786, 0x20, 0x10, 0x18),
+	SENSOR_SEQ_REGS(0x578a, 0x04, 0x02, 0x02),
+	SENSOR_SEQ_REGS(0x578e, 0x06, 0x02, 0x02, 0xff),
+	SENSOR_SEQ_REGS(0x5842, 0x01, 0x2b, 0x01, 0x92, 0x01, 0x8f, 0x01, 0x0c),
+	SENSOR_SEQ_REGS(0x5e00, 0x00),
+	SENSOR_SEQ_REGS(0x5e10, 0x0c),
+	SENSOR_SEQ_REGS(0x0100, 0x00),
 };
 
-struct ov5693_write_ctrl {
-	int index;
-	struct ov5693_write_buffer buffer;
-};
-
-static struct ov5693_reg const ov5693_global_setting[] = {
-	{OV5693_8BIT, 0x0103, 0x01},
-	{OV5693_8BIT, 0x3001, 0x0a},
-	{OV5693_8BIT, 0x3002, 0x80},
-	{OV5693_8BIT, 0x3006, 0x00},
-	{OV5693_8BIT, 0x3011, 0x21},
-	{OV5693_8BIT, 0x3012, 0x09},
-	{OV5693_8BIT, 0x3013, 0x10},
-	{OV5693_8BIT, 0x3014, 0x00},
-	{OV5693_8BIT, 0x3015, 0x08},
-	{OV5693_8BIT, 0x3016, 0xf0},
-	{OV5693_8BIT, 0x3017, 0xf0},
-	{OV5693_8BIT, 0x3018, 0xf0},
-	{OV5693_8BIT, 0x301b, 0xb4},
-	{OV5693_8BIT, 0x301d, 0x02},
-	{OV5693_8BIT, 0x3021, 0x00},
-	{OV5693_8BIT, 0x3022, 0x01},
-	{OV5693_8BIT, 0x3028, 0x44},
-	{OV5693_8BIT, 0x3098, 0x02},
-	{OV5693_8BIT, 0x3099, 0x19},
-	{OV5693_8BIT, 0x309a, 0x02},
-	{OV5693_8BIT, 0x309b, 0x01},
-	{OV5693_8BIT, 0x309c, 0x00},
-	{OV5693_8BIT, 0x30a0, 0xd2},
-	{OV5693_8BIT, 0x30a2, 0x01},
-	{OV5693_8BIT, 0x30b2, 0x00},
-	{OV5693_8BIT, 0x30b3, 0x7d},
-	{OV5693_8BIT, 0x30b4, 0x03},
-	{OV5693_8BIT, 0x30b5, 0x04},
-	{OV5693_8BIT, 0x30b6, 0x01},
-	{OV5693_8BIT, 0x3104, 0x21},
-	{OV5693_8BIT, 0x3106, 0x00},
-	{OV5693_8BIT, 0x3400, 0x04},
-	{OV5693_8BIT, 0x3401, 0x00},
-	{OV5693_8BIT, 0x3402, 0x04},
-	{OV5693_8BIT, 0x3403, 0x00},
-	{OV5693_8BIT, 0x3404, 0x04},
-	{OV5693_8BIT, 0x3405, 0x00},
-	{OV5693_8BIT, 0x3406, 0x01},
-	{OV5693_8BIT, 0x3500, 0x00},
-	{OV5693_8BIT, 0x3503, 0x07},
-	{OV5693_8BIT, 0x3504, 0x00},
-	{OV5693_8BIT, 0x3505, 0x00},
-	{OV5693_8BIT, 0x3506, 0x00},
-	{OV5693_8BIT, 0x3507, 0x02},
-	{OV5693_8BIT, 0x3508, 0x00},
-	{OV5693_8BIT, 0x3509, 0x10},
-	{OV5693_8BIT, 0x350a, 0x00},
-	{OV5693_8BIT, 0x350b, 0x40},
-	{OV5693_8BIT, 0x3601, 0x0a},
-	{OV5693_8BIT, 0x3602, 0x38},
-	{OV5693_8BIT, 0x3612, 0x80},
-	{OV5693_8BIT, 0x3620, 0x54},
-	{OV5693_8BIT, 0x3621, 0xc7},
-	{OV5693_8BIT, 0x3622, 0x0f},
-	{OV5693_8BIT, 0x3625, 0x10},
-	{OV5693_8BIT, 0x3630, 0x55},
-	{OV5693_8BIT, 0x3631, 0xf4},
-	{OV5693_8BIT, 0x3632, 0x00},
-	{OV5693_8BIT, 0x3633, 0x34},
-	{OV5693_8BIT, 0x3634, 0x02},
-	{OV5693_8BIT, 0x364d, 0x0d},
-	{OV5693_8BIT, 0x364f, 0xdd},
-	{OV5693_8BIT, 0x3660, 0x04},
-	{OV5693_8BIT, 0x3662, 0x10},
-	{OV5693_8BIT, 0x3663, 0xf1},
-	{OV5693_8BIT, 0x3665, 0x00},
-	{OV5693_8BIT, 0x3666, 0x20},
-	{OV5693_8BIT, 0x3667, 0x00},
-	{OV5693_8BIT, 0x366a, 0x80},
-	{OV5693_8BIT, 0x3680, 0xe0},
-	{OV5693_8BIT, 0x3681, 0x00},
-	{OV5693_8BIT, 0x3700, 0x42},
-	{OV5693_8BIT, 0x3701, 0x14},
-	{OV5693_8BIT, 0x3702, 0xa0},
-	{OV5693_8BIT, 0x3703, 0xd8},
-	{OV5693_8BIT, 0x3704, 0x78},
-	{OV5693_8BIT, 0x3705, 0x02},
-	{OV5693_8BIT, 0x370a, 0x00},
-	{OV5693_8BIT, 0x370b, 0x20},
-	{OV5693_8BIT, 0x370c, 0x0c},
-	{OV5693_8BIT, 0x370d, 0x11},
-	{OV5693_8BIT, 0x370e, 0x00},
-	{OV5693_8BIT, 0x370f, 0x40},
-	{OV5693_8BIT, 0x3710, 0x00},
-	{OV5693_8BIT, 0x371a, 0x1c},
-	{OV5693_8BIT, 0x371b, 0x05},
-	{OV5693_8BIT, 0x371c, 0x01},
-	{OV5693_8BIT, 0x371e, 0xa1},
-	{OV5693_8BIT, 0x371f, 0x0c},
-	{OV5693_8BIT, 0x3721, 0x00},
-	{OV5693_8BIT, 0x3724, 0x10},
-	{OV5693_8BIT, 0x3726, 0x00},
-	{OV5693_8BIT, 0x372a, 0x01},
-	{OV5693_8BIT, 0x3730, 0x10},
-	{OV5693_8BIT, 0x3738, 0x22},
-	{OV5693_8BIT, 0x3739, 0xe5},
-	{OV5693_8BIT, 0x373a, 0x50},
-	{OV5693_8BIT, 0x373b, 0x02},
-	{OV5693_8BIT, 0x373c, 0x41},
-	{OV5693_8BIT, 0x373f, 0x02},
-	{OV5693_8BIT, 0x3740, 0x42},
-	{OV5693_8BIT, 0x3741, 0x02},
-	{OV5693_8BIT, 0x3742, 0x18},
-	{OV5693_8BIT, 0x3743, 0x01},
-	{OV5693_8BIT, 0x3744, 0x02},
-	{OV5693_8BIT, 0x3747, 0x10},
-	{OV5693_8BIT, 0x374c, 0x04},
-	{OV5693_8BIT, 0x3751, 0xf0},
-	{OV5693_8BIT, 0x3752, 0x00},
-	{OV5693_8BIT, 0x3753, 0x00},
-	{OV5693_8BIT, 0x3754, 0xc0},
-	{OV5693_8BIT, 0x3755, 0x00},
-	{OV5693_8BIT, 0x3756, 0x1a},
-	{OV5693_8BIT, 0x3758, 0x00},
-	{OV5693_8BIT, 0x3759, 0x0f},
-	{OV5693_8BIT, 0x376b, 0x44},
-	{OV5693_8BIT, 0x375c, 0x04},
-	{OV5693_8BIT, 0x3774, 0x10},
-	{OV5693_8BIT, 0x3776, 0x00},
-	{OV5693_8BIT, 0x377f, 0x08},
-	{OV5693_8BIT, 0x3780, 0x22},
-	{OV5693_8BIT, 0x3781, 0x0c},
-	{OV5693_8BIT, 0x3784, 0x2c},
-	{OV5693_8BIT, 0x3785, 0x1e},
-	{OV5693_8BIT, 0x378f, 0xf5},
-	{OV5693_8BIT, 0x3791, 0xb0},
-	{OV5693_8BIT, 0x3795, 0x00},
-	{OV5693_8BIT, 0x3796, 0x64},
-	{OV5693_8BIT, 0x3797, 0x11},
-	{OV5693_8BIT, 0x3798, 0x30},
-	{OV5693_8BIT, 0x3799, 0x41},
-	{OV5693_8BIT, 0x379a, 0x07},
-	{OV5693_8BIT, 0x379b, 0xb0},
-	{OV5693_8BIT, 0x379c, 0x0c},
-	{OV5693_8BIT, 0x37c5, 0x00},
-	{OV5693_8BIT, 0x37c6, 0x00},
-	{OV5693_8BIT, 0x37c7, 0x00},
-	{OV5693_8BIT, 0x37c9, 0x00},
-	{OV5693_8BIT, 0x37ca, 0x00},
-	{OV5693_8BIT, 0x37cb, 0x00},
-	{OV5693_8BIT, 0x37de, 0x00},
-	{OV5693_8BIT, 0x37df, 0x00},
-	{OV5693_8BIT, 0x3800, 0x00},
-	{OV5693_8BIT, 0x3801, 0x00},
-	{OV5693_8BIT, 0x3802, 0x00},
-	{OV5693_8BIT, 0x3804, 0x0a},
-	{OV5693_8BIT, 0x3805, 0x3f},
-	{OV5693_8BIT, 0x3810, 0x00},
-	{OV5693_8BIT, 0x3812, 0x00},
-	{OV5693_8BIT, 0x3823, 0x00},
-	{OV5693_8BIT, 0x3824, 0x00},
-	{OV5693_8BIT, 0x3825, 0x00},
-	{OV5693_8BIT, 0x3826, 0x00},
-	{OV5693_8BIT, 0x3827, 0x00},
-	{OV5693_8BIT, 0x382a, 0x04},
-	{OV5693_8BIT, 0x3a04, 0x06},
-	{OV5693_8BIT, 0x3a05, 0x14},
-	{OV5693_8BIT, 0x3a06, 0x00},
-	{OV5693_8BIT, 0x3a07, 0xfe},
-	{OV5693_8BIT, 0x3b00, 0x00},
-	{OV5693_8BIT, 0x3b02, 0x00},
-	{OV5693_8BIT, 0x3b03, 0x00},
-	{OV5693_8BIT, 0x3b04, 0x00},
-	{OV5693_8BIT, 0x3b05, 0x00},
-	{OV5693_8BIT, 0x3e07, 0x20},
-	{OV5693_8BIT, 0x4000, 0x08},
-	{OV5693_8BIT, 0x4001, 0x04},
-	{OV5693_8BIT, 0x4002, 0x45},
-	{OV5693_8BIT, 0x4004, 0x08},
-	{OV5693_8BIT, 0x4005, 0x18},
-	{OV5693_8BIT, 0x4006, 0x20},
-	{OV5693_8BIT, 0x4008, 0x24},
-	{OV5693_8BIT, 0x4009, 0x10},
-	{OV5693_8BIT, 0x400c, 0x00},
-	{OV5693_8BIT, 0x400d, 0x00},
-	{OV5693_8BIT, 0x4058, 0x00},
-	{OV5693_8BIT, 0x404e, 0x37},
-	{OV5693_8BIT, 0x404f, 0x8f},
-	{OV5693_8BIT, 0x4058, 0x00},
-	{OV5693_8BIT, 0x4101, 0xb2},
-	{OV5693_8BIT, 0x4303, 0x00},
-	{OV5693_8BIT, 0x4304, 0x08},
-	{OV5693_8BIT, 0x4307, 0x31},
-	{OV5693_8BIT, 0x4311, 0x04},
-	{OV5693_8BIT, 0x4315, 0x01},
-	{OV5693_8BIT, 0x4511, 0x05},
-	{OV5693_8BIT, 0x4512, 0x01},
-	{OV5693_8BIT, 0x4806, 0x00},
-	{OV5693_8BIT, 0x4816, 0x52},
-	{OV5693_8BIT, 0x481f, 0x30},
-	{OV5693_8BIT, 0x4826, 0x2c},
-	{OV5693_8BIT, 0x4831, 0x64},
-	{OV5693_8BIT, 0x4d00, 0x04},
-	{OV5693_8BIT, 0x4d01, 0x71},
-	{OV5693_8BIT, 0x4d02, 0xfd},
-	{OV5693_8BIT, 0x4d03, 0xf5},
-	{OV5693_8BIT, 0x4d04, 0x0c},
-	{OV5693_8BIT, 0x4d05, 0xcc},
-	{OV5693_8BIT, 0x4837, 0x0a},
-	{OV5693_8BIT, 0x5000, 0x06},
-	{OV5693_8BIT, 0x5001, 0x01},
-	{OV5693_8BIT, 0x5003, 0x20},
-	{OV5693_8BIT, 0x5046, 0x0a},
-	{OV5693_8BIT, 0x5013, 0x00},
-	{OV5693_8BIT, 0x5046, 0x0a},
-	{OV5693_8BIT, 0x5780, 0x1c},
-	{OV5693_8BIT, 0x5786, 0x20},
-	{OV5693_8BIT, 0x5787, 0x10},
-	{OV5693_8BIT, 0x5788, 0x18},
-	{OV5693_8BIT, 0x578a, 0x04},
-	{OV5693_8BIT, 0x578b, 0x02},
-	{OV5693_8BIT, 0x578c, 0x02},
-	{OV5693_8BIT, 0x578e, 0x06},
-	{OV5693_8BIT, 0x578f, 0x02},
-	{OV5693_8BIT, 0x5790, 0x02},
-	{OV5693_8BIT, 0x5791, 0xff},
-	{OV5693_8BIT, 0x5842, 0x01},
-	{OV5693_8BIT, 0x5843, 0x2b},
-	{OV5693_8BIT, 0x5844, 0x01},
-	{OV5693_8BIT, 0x5845, 0x92},
-	{OV5693_8BIT, 0x5846, 0x01},
-	{OV5693_8BIT, 0x5847, 0x8f},
-	{OV5693_8BIT, 0x5848, 0x01},
-	{OV5693_8BIT, 0x5849, 0x0c},
-	{OV5693_8BIT, 0x5e00, 0x00},
-	{OV5693_8BIT, 0x5e10, 0x0c},
-	{OV5693_8BIT, 0x0100, 0x00},
-	{OV5693_TOK_TERM, 0, 0}
-};
+static const struct sensor_seq ov5693_global_setting =
+	SENSOR_SEQ(ov5693_global_setting_data);
 
 #if ENABLE_NON_PREVIEW
 /*
  * 654x496 30fps 17ms VBlanking 2lane 10Bit (Scaling)
  */
-static struct ov5693_reg const ov5693_654x496[] = {
-	{OV5693_8BIT, 0x3501, 0x3d},
-	{OV5693_8BIT, 0x3502, 0x00},
-	{OV5693_8BIT, 0x3708, 0xe6},
-	{OV5693_8BIT, 0x3709, 0xc7},
-	{OV5693_8BIT, 0x3803, 0x00},
-	{OV5693_8BIT, 0x3806, 0x07},
-	{OV5693_8BIT, 0x3807, 0xa3},
-	{OV5693_8BIT, 0x3808, 0x02},
-	{OV5693_8BIT, 0x3809, 0x90},
-	{OV5693_8BIT, 0x380a, 0x01},
-	{OV5693_8BIT, 0x380b, 0xf0},
-	{OV5693_8BIT, 0x380c, 0x0a},
-	{OV5693_8BIT, 0x380d, 0x80},
-	{OV5693_8BIT, 0x380e, 0x07},
-	{OV5693_8BIT, 0x380f, 0xc0},
-	{OV5693_8BIT, 0x3811, 0x08},
-	{OV5693_8BIT, 0x3813, 0x02},
-	{OV5693_8BIT, 0x3814, 0x31},
-	{OV5693_8BIT, 0x3815, 0x31},
-	{OV5693_8BIT, 0x3820, 0x04},
-	{OV5693_8BIT, 0x3821, 0x1f},
-	{OV5693_8BIT, 0x5002, 0x80},
-	{OV5693_8BIT, 0x0100, 0x01},
-	{OV5693_TOK_TERM, 0, 0}
+static const u8 ov5693_654x496_data[] = {
+	SENSOR_SEQ_REGS(0x3501, 0x3d, 0x00),
+	SENSOR_SEQ_REGS(0x3708, 0xe6, 0xc7),
+	SENSOR_SEQ_REGS(0x3803, 0x00),
+	SENSOR_SEQ_REGS(0x3806,
+			0x07, 0xa3, 0x02, 0x90, 0x01, 0xf0, 0x0a, 0x80,
+			0x07, 0xc0),
+	SENSOR_SEQ_REGS(0x3811, 0x08),
+	SENSOR_SEQ_REGS(0x3813, 0x02, 0x31, 0x31),
+	SENSOR_SEQ_REGS(0x3820, 0x04, 0x1f),
+	SENSOR_SEQ_REGS(0x5002, 0x80),
+	SENSOR_SEQ_REGS(0x0100, 0x01),
 };
 
+static const struct sensor_seq ov5693_654x496 =
+	SENSOR_SEQ(ov5693_654x496_data);
+
 /*
  * 1296x976 30fps 17ms VBlanking 2lane 10Bit (Scaling)
 *DS from 2592x1952
 */
-static struct ov5693_reg const ov5693_1296x976[] = {
-	{OV5693_8BIT, 0x3501, 0x7b},
-	{OV5693_8BIT, 0x3502, 0x00},
-	{OV5693_8BIT, 0x3708, 0xe2},
-	{OV5693_8BIT, 0x3709, 0xc3},
-
-	{OV5693_8BIT, 0x3800, 0x00},
-	{OV5693_8BIT, 0x3801, 0x00},
-	{OV5693_8BIT, 0x3802, 0x00},
-	{OV5693_8BIT, 0x3803, 0x00},
-
-	{OV5693_8BIT, 0x3804, 0x0a},
-	{OV5693_8BIT, 0x3805, 0x3f},
-	{OV5693_8BIT, 0x3806, 0x07},
-	{OV5693_8BIT, 0x3807, 0xA3},
-
-	{OV5693_8BIT, 0x3808, 0x05},
-	{OV5693_8BIT, 0x3809, 0x10},
-	{OV5693_8BIT, 0x380a, 0x03},
-	{OV5693_8BIT, 0x380b, 0xD0},
-
-	{OV5693_8BIT, 0x380c, 0x0a},
-	{OV5693_8BIT, 0x380d, 0x80},
-	{OV5693_8BIT, 0x380e, 0x07},
-	{OV5693_8BIT, 0x380f, 0xc0},
-
-	{OV5693_8BIT, 0x3810, 0x00},
-	{OV5693_8BIT, 0x3811, 0x10},
-	{OV5693_8BIT, 0x3812, 0x00},
-	{OV5693_8BIT, 0x3813, 0x02},
-
-	{OV5693_8BIT, 0x3814, 0x11},	/*X subsample control*/
-	{OV5693_8BIT, 0x3815, 0x11},	/*Y subsample control*/
-	{OV5693_8BIT, 0x3820, 0x00},
-	{OV5693_8BIT, 0x3821, 0x1e},
-	{OV5693_8BIT, 0x5002, 0x00},
-	{OV5693_8BIT, 0x5041, 0x84}, /* scale is auto enabled */
-	{OV5693_8BIT, 0x0100, 0x01},
-	{OV5693_TOK_TERM, 0, 0}
-
+static const u8 ov5693_1296x976_data[] = {
+	SENSOR_SEQ_REGS(0x3501, 0x7b, 0x00),
+	SENSOR_SEQ_REGS(0x3708, 0xe2, 0xc3),
+	SENSOR_SEQ_REGS(0x3800,
+			0x00, 0x00, 0x00, 0x00, 0x0a, 0x3f, 0x07, 0xa3,
+			0x05, 0x10, 0x03, 0xd0, 0x0a, 0x80, 0x07, 0xc0,
+			0x00, 0x10, 0x00, 0x02,
+			0x11,	/*X subsample control*/
+			0x11),	/*Y subsample control*/
+	SENSOR_SEQ_REGS(0x3820, 0x00, 0x1e),
+	SENSOR_SEQ_REGS(0x5002, 0x00),
+	SENSOR_SEQ_REGS(0x5041,
+			0x84),	/* scale is auto enabled */
+	SENSOR_SEQ_REGS(0x0100, 0x01),
 };
 
+static const struct sensor_seq ov5693_1296x976 =
+	SENSOR_SEQ(ov5693_1296x976_data);
+
 /*
  * 336x256 30fps 17ms VBlanking 2lane 10Bit (Scaling)
  DS from 2564x1956
  */
-static struct ov5693_reg const ov5693_336x256[] = {
-	{OV5693_8BIT, 0x3501, 0x3d},
-	{OV5693_8BIT, 0x3502, 0x00},
-	{OV5693_8BIT, 0x3708, 0xe6},
-	{OV5693_8BIT, 0x3709, 0xc7},
-	{OV5693_8BIT, 0x3806, 0x07},
-	{OV5693_8BIT, 0x3807, 0xa3},
-	{OV5693_8BIT, 0x3808, 0x01},
-	{OV5693_8BIT, 0x3809, 0x50},
-	{OV5693_8BIT, 0x380a, 0x01},
-	{OV5693_8BIT, 0x380b, 0x00},
-	{OV5693_8BIT, 0x380c, 0x0a},
-	{OV5693_8BIT, 0x380d, 0x80},
-	{OV5693_8BIT, 0x380e, 0x07},
-	{OV5693_8BIT, 0x380f, 0xc0},
-	{OV5693_8BIT, 0x3811, 0x1E},
-	{OV5693_8BIT, 0x3814, 0x31},
-	{OV5693_8BIT, 0x3815, 0x31},
-	{OV5693_8BIT, 0x3820, 0x04},
-	{OV5693_8BIT, 0x3821, 0x1f},
-	{OV5693_8BIT, 0x5002, 0x80},
-	{OV5693_8BIT, 0x0100, 0x01},
-	{OV5693_TOK_TERM, 0, 0}
+static const u8 ov5693_336x256_data[] = {
+	SENSOR_SEQ_REGS(0x3501, 0x3d, 0x00),
+	SENSOR_SEQ_REGS(0x3708, 0xe6, 0xc7),
+	SENSOR_SEQ_REGS(0x3806,
+			0x07, 0xa3, 0x01, 0x50, 0x01, 0x00, 0x0a, 0x80,
+			0x07, 0xc0),
+	SENSOR_SEQ_REGS(0x3811, 0x1e),
+	SENSOR_SEQ_REGS(0x3814, 0x31, 0x31),
+	SENSOR_SEQ_REGS(0x3820, 0x04, 0x1f),
+	SENSOR_SEQ_REGS(0x5002, 0x80),
+	SENSOR_SEQ_REGS(0x0100, 0x01),
 };
 
+static const struct sensor_seq ov5693_336x256 =
+	SENSOR_SEQ(ov5693_336x256_data);
+
 /*
  * 336x256 30fps 17ms VBlanking 2lane 10Bit (Scaling)
  DS from 2368x1956
  */
-static struct ov5693_reg const ov5693_368x304[] = {
-	{OV5693_8BIT, 0x3501, 0x3d},
-	{OV5693_8BIT, 0x3502, 0x00},
-	{OV5693_8BIT, 0x3708, 0xe6},
-	{OV5693_8BIT, 0x3709, 0xc7},
-	{OV5693_8BIT, 0x3808, 0x01},
-	{OV5693_8BIT, 0x3809, 0x70},
-	{OV5693_8BIT, 0x380a, 0x01},
-	{OV5693_8BIT, 0x380b, 0x30},
-	{OV5693_8BIT, 0x380c, 0x0a},
-	{OV5693_8BIT, 0x380d, 0x80},
-	{OV5693_8BIT, 0x380e, 0x07},
-	{OV5693_8BIT, 0x380f, 0xc0},
-	{OV5693_8BIT, 0x3811, 0x80},
-	{OV5693_8BIT, 0x3814, 0x31},
-	{OV5693_8BIT, 0x3815, 0x31},
-	{OV5693_8BIT, 0x3820, 0x04},
-	{OV5693_8BIT, 0x3821, 0x1f},
-	{OV5693_8BIT, 0x5002, 0x80},
-	{OV5693_8BIT, 0x0100, 0x01},
-	{OV5693_TOK_TERM, 0, 0}
+static const u8 ov5693_368x304_data[] = {
+	SENSOR_SEQ_REGS(0x3501, 0x3d, 0x00),
+	SENSOR_SEQ_REGS(0x3708, 0xe6, 0xc7),
+	SENSOR_SEQ_REGS(0x3808, 0x01, 0x70, 0x01, 0x30, 0x0a, 0x80, 0x07, 0xc0),
+	SENSOR_SEQ_REGS(0x3811, 0x80),
+	SENSOR_SEQ_REGS(0x3814, 0x31, 0x31),
+	SENSOR_SEQ_REGS(0x3820, 0x04, 0x1f),
+	SENSOR_SEQ_REGS(0x5002, 0x80),
+	SENSOR_SEQ_REGS(0x0100, 0x01),
 };
 
+static const struct sensor_seq ov5693_368x304 =
+	SENSOR_SEQ(ov5693_368x304_data);
+
 /*
  * ov5693_192x160 30fps 17ms VBlanking 2lane 10Bit (Scaling)
  DS from 2460x1956
  */
-static struct ov5693_reg const ov5693_192x160[] = {
-	{OV5693_8BIT, 0x3501, 0x7b},
-	{OV5693_8BIT, 0x3502, 0x80},
-	{OV5693_8BIT, 0x3708, 0xe2},
-	{OV5693_8BIT, 0x3709, 0xc3},
-	{OV5693_8BIT, 0x3804, 0x0a},
-	{OV5693_8BIT, 0x3805, 0x3f},
-	{OV5693_8BIT, 0x3806, 0x07},
-	{OV5693_8BIT, 0x3807, 0xA3},
-	{OV5693_8BIT, 0x3808, 0x00},
-	{OV5693_8BIT, 0x3809, 0xC0},
-	{OV5693_8BIT, 0x380a, 0x00},
-	{OV5693_8BIT, 0x380b, 0xA0},
-	{OV5693_8BIT, 0x380c, 0x0a},
-	{OV5693_8BIT, 0x380d, 0x80},
-	{OV5693_8BIT, 0x380e, 0x07},
-	{OV5693_8BIT, 0x380f, 0xc0},
-	{OV5693_8BIT, 0x3811, 0x40},
-	{OV5693_8BIT, 0x3813, 0x00},
-	{OV5693_8BIT, 0x3814, 0x31},
-	{OV5693_8BIT, 0x3815, 0x31},
-	{OV5693_8BIT, 0x3820, 0x04},
-	{OV5693_8BIT, 0x3821, 0x1f},
-	{OV5693_8BIT, 0x5002, 0x80},
-	{OV5693_8BIT, 0x0100, 0x01},
-	{OV5693_TOK_TERM, 0, 0}
+static const u8 ov5693_192x160_data[] = {
+	SENSOR_SEQ_REGS(0x3501, 0x7b, 0x80),
+	SENSOR_SEQ_REGS(0x3708, 0xe2, 0xc3),
+	SENSOR_SEQ_REGS(0x3804,
+			0x0a, 0x3f, 0x07, 0xa3, 0x00, 0xc0, 0x00, 0xa0,
+			0x0a, 0x80, 0x07, 0xc0),
+	SENSOR_SEQ_REGS(0x3811, 0x40),
+	SENSOR_SEQ_REGS(0x3813, 0x00, 0x31, 0x31),
+	SENSOR_SEQ_REGS(0x3820, 0x04, 0x1f),
+	SENSOR_SEQ_REGS(0x5002, 0x80),
+	SENSOR_SEQ_REGS(0x0100, 0x01),
 };
 
-static struct ov5693_reg const ov5693_736x496[] = {
-	{OV5693_8BIT, 0x3501, 0x3d},
-	{OV5693_8BIT, 0x3502, 0x00},
-	{OV5693_8BIT, 0x3708, 0xe6},
-	{OV5693_8BIT, 0x3709, 0xc7},
-	{OV5693_8BIT, 0x3803, 0x68},
-	{OV5693_8BIT, 0x3806, 0x07},
-	{OV5693_8BIT, 0x3807, 0x3b},
-	{OV5693_8BIT, 0x3808, 0x02},
-	{OV5693_8BIT, 0x3809, 0xe0},
-	{OV5693_8BIT, 0x380a, 0x01},
-	{OV5693_8BIT, 0x380b, 0xf0},
-	{OV5693_8BIT, 0x380c, 0x0a}, /*hts*/
-	{OV5693_8BIT, 0x380d, 0x80},
-	{OV5693_8BIT, 0x380e, 0x07}, /*vts*/
-	{OV5693_8BIT, 0x380f, 0xc0},
-	{OV5693_8BIT, 0x3811, 0x08},
-	{OV5693_8BIT, 0x3813, 0x02},
-	{OV5693_8BIT, 0x3814, 0x31},
-	{OV5693_8BIT, 0x3815, 0x31},
-	{OV5693_8BIT, 0x3820, 0x04},
-	{OV5693_8BIT, 0x3821, 0x1f},
-	{OV5693_8BIT, 0x5002, 0x80},
-	{OV5693_8BIT, 0x0100, 0x01},
-	{OV5693_TOK_TERM, 0, 0}
+static const struct sensor_seq ov5693_192x160 =
+	SENSOR_SEQ(ov5693_192x160_data);
+
+static const u8 ov5693_736x496_data[] = {
+	SENSOR_SEQ_REGS(0x3501, 0x3d, 0x00),
+	SENSOR_SEQ_REGS(0x3708, 0xe6, 0xc7),
+	SENSOR_SEQ_REGS(0x3803, 0x68),
+	SENSOR_SEQ_REGS(0x3806,
+			0x07, 0x3b, 0x02, 0xe0, 0x01, 0xf0,
+			0x0a,	/*hts*/
+			0x80,
+			0x07,	/*vts*/
+			0xc0),
+	SENSOR_SEQ_REGS(0x3811, 0x08),
+	SENSOR_SEQ_REGS(0x3813, 0x02, 0x31, 0x31),
+	SENSOR_SEQ_REGS(0x3820, 0x04, 0x1f),
+	SENSOR_SEQ_REGS(0x5002, 0x80),
+	SENSOR_SEQ_REGS(0x0100, 0x01),
 };
+
+static const struct sensor_seq ov5693_736x496 =
+	SENSOR_SEQ(ov5693_736x496_data);
 #endif
 
 /*
@@ -752,259 +630,174 @@ static struct ov5693_reg const ov5693_736x496[] = {
  * 976x556 30fps 8.8ms VBlanking 2lane 10Bit (Scaling)
  */
 #if ENABLE_NON_PREVIEW
-static struct ov5693_reg const ov5693_976x556[] = {
-	{OV5693_8BIT, 0x3501, 0x7b},
-	{OV5693_8BIT, 0x3502, 0x00},
-	{OV5693_8BIT, 0x3708, 0xe2},
-	{OV5693_8BIT, 0x3709, 0xc3},
-	{OV5693_8BIT, 0x3803, 0xf0},
-	{OV5693_8BIT, 0x3806, 0x06},
-	{OV5693_8BIT, 0x3807, 0xa7},
-	{OV5693_8BIT, 0x3808, 0x03},
-	{OV5693_8BIT, 0x3809, 0xd0},
-	{OV5693_8BIT, 0x380a, 0x02},
-	{OV5693_8BIT, 0x380b, 0x2C},
-	{OV5693_8BIT, 0x380c, 0x0a},
-	{OV5693_8BIT, 0x380d, 0x80},
-	{OV5693_8BIT, 0x380e, 0x07},
-	{OV5693_8BIT, 0x380f, 0xc0},
-	{OV5693_8BIT, 0x3811, 0x10},
-	{OV5693_8BIT, 0x3813, 0x02},
-	{OV5693_8BIT, 0x3814, 0x11},
-	{OV5693_8BIT, 0x3815, 0x11},
-	{OV5693_8BIT, 0x3820, 0x00},
-	{OV5693_8BIT, 0x3821, 0x1e},
-	{OV5693_8BIT, 0x5002, 0x80},
-	{OV5693_8BIT, 0x0100, 0x01},
-	{OV5693_TOK_TERM, 0, 0}
+static const u8 ov5693_976x556_data[] = {
+	SENSOR_SEQ_REGS(0x3501, 0x7b, 0x00),
+	SENSOR_SEQ_REGS(0x3708, 0xe2, 0xc3),
+	SENSOR_SEQ_REGS(0x3803, 0xf0),
+	SENSOR_SEQ_REGS(0x3806,
+			0x06, 0xa7, 0x03, 0xd0, 0x02, 0x2c, 0x0a, 0x80,
+			0x07, 0xc0),
+	SENSOR_SEQ_REGS(0x3811, 0x10),
+	SENSOR_SEQ_REGS(0x3813, 0x02, 0x11, 0x11),
+	SENSOR_SEQ_REGS(0x3820, 0x00, 0x1e),
+	SENSOR_SEQ_REGS(0x5002, 0x80),
+	SENSOR_SEQ_REGS(0x0100, 0x01),
 };
 
-/*DS from 2624x1492*/
-static struct ov5693_reg const ov5693_1296x736[] = {
-	{OV5693_8BIT, 0x3501, 0x7b},
-	{OV5693_8BIT, 0x3502, 0x00},
-	{OV5693_8BIT, 0x3708, 0xe2},
-	{OV5693_8BIT, 0x3709, 0xc3},
-
-	{OV5693_8BIT, 0x3800, 0x00},
-	{OV5693_8BIT, 0x3801, 0x00},
-	{OV5693_8BIT, 0x3802, 0x00},
-	{OV5693_8BIT, 0x3803, 0x00},
-
-	{OV5693_8BIT, 0x3804, 0x0a},
-	{OV5693_8BIT, 0x3805, 0x3f},
-	{OV5693_8BIT, 0x3806, 0x07},
-	{OV5693_8BIT, 0x3807, 0xA3},
-
-	{OV5693_8BIT, 0x3808, 0x05},
-	{OV5693_8BIT, 0x3809, 0x10},
-	{OV5693_8BIT, 0x380a, 0x02},
-	{OV5693_8BIT, 0x380b, 0xe0},
+static const struct sensor_seq ov5693_976x556 =
+	SENSOR_SEQ(ov5693_976x556_data);
 
-	{OV5693_8BIT, 0x380c, 0x0a},
-	{OV5693_8BIT, 0x380d, 0x80},
-	{OV5693_8BIT, 0x380e, 0x07},
-	{OV5693_8BIT, 0x380f, 0xc0},
-
-	{OV5693_8BIT, 0x3813, 0xE8},
-
-	{OV5693_8BIT, 0x3814, 0x11},	/*X subsample control*/
-	{OV5693_8BIT, 0x3815, 0x11},	/*Y subsample control*/
-	{OV5693_8BIT, 0x3820, 0x00},
-	{OV5693_8BIT, 0x3821, 0x1e},
-	{OV5693_8BIT, 0x5002, 0x00},
-	{OV5693_8BIT, 0x5041, 0x84}, /* scale is auto enabled */
-	{OV5693_8BIT, 0x0100, 0x01},
-	{OV5693_TOK_TERM, 0, 0}
+/*DS from 2624x1492*/
+static const u8 ov5693_1296x736_data[] = {
+	SENSOR_SEQ_REGS(0x3501, 0x7b, 0x00),
+	SENSOR_SEQ_REGS(0x3708, 0xe2, 0xc3),
+	SENSOR_SEQ_REGS(0x3800,
+			0x00, 0x00, 0x00, 0x00, 0x0a, 0x3f, 0x07, 0xa3,
+			0x05, 0x10, 0x02, 0xe0, 0x0a, 0x80, 0x07, 0xc0),
+	SENSOR_SEQ_REGS(0x3813,
+			0xe8,
+			0x11,	/*X subsample control*/
+			0x11),	/*Y subsample control*/
+	SENSOR_SEQ_REGS(0x3820, 0x00, 0x1e),
+	SENSOR_SEQ_REGS(0x5002, 0x00),
+	SENSOR_SEQ_REGS(0x5041,
+			0x84),	/* scale is auto enabled */
+	SENSOR_SEQ_REGS(0x0100, 0x01),
 };
 
-static struct ov5693_reg const ov5693_1636p_30fps[] = {
-	{OV5693_8BIT, 0x3501, 0x7b},
-	{OV5693_8BIT, 0x3502, 0x00},
-	{OV5693_8BIT, 0x3708, 0xe2},
-	{OV5693_8BIT, 0x3709, 0xc3},
-	{OV5693_8BIT, 0x3803, 0xf0},
-	{OV5693_8BIT, 0x3806, 0x06},
-	{OV5693_8BIT, 0x3807, 0xa7},
-	{OV5693_8BIT, 0x3808, 0x06},
-	{OV5693_8BIT, 0x3809, 0x64},
-	{OV5693_8BIT, 0x380a, 0x04},
-	{OV5693_8BIT, 0x380b, 0x48},
-	{OV5693_8BIT, 0x380c, 0x0a}, /*hts*/
-	{OV5693_8BIT, 0x380d, 0x80},
-	{OV5693_8BIT, 0x380e, 0x07}, /*vts*/
-	{OV5693_8BIT, 0x380f, 0xc0},
-	{OV5693_8BIT, 0x3811, 0x02},
-	{OV5693_8BIT, 0x3813, 0x02},
-	{OV5693_8BIT, 0x3814, 0x11},
-	{OV5693_8BIT, 0x3815, 0x11},
-	{OV5693_8BIT, 0x3820, 0x00},
-	{OV5693_8BIT, 0x3821, 0x1e},
-	{OV5693_8BIT, 0x5002, 0x80},
-	{OV5693_8BIT, 0x0100, 0x01},
-	{OV5693_TOK_TERM, 0, 0}
+static const struct sensor_seq ov5693_1296x736 =
+	SENSOR_SEQ(ov5693_1296x736_data);
+
+static const u8 ov5693_1636p_30fps_data[] = {
+	SENSOR_SEQ_REGS(0x3501, 0x7b, 0x00),
+	SENSOR_SEQ_REGS(0x3708, 0xe2, 0xc3),
+	SENSOR_SEQ_REGS(0x3803, 0xf0),
+	SENSOR_SEQ_REGS(0x3806,
+			0x06, 0xa7, 0x06, 0x64, 0x04, 0x48,
+			0x0a,	/*hts*/
+			0x80,
+			0x07,	/*vts*/
+			0xc0),
+	SENSOR_SEQ_REGS(0x3811, 0x02),
+	SENSOR_SEQ_REGS(0x3813, 0x02, 0x11, 0x11),
+	SENSOR_SEQ_REGS(0x3820, 0x00, 0x1e),
+	SENSOR_SEQ_REGS(0x5002, 0x80),
+	SENSOR_SEQ_REGS(0x0100, 0x01),
 };
+
+static const struct sensor_seq ov5693_1636p_30fps =
+	SENSOR_SEQ(ov5693_1636p_30fps_data);
 #endif
 
-static struct ov5693_reg const ov5693_1616x1216_30fps[] = {
-	{OV5693_8BIT, 0x3501, 0x7b},
-	{OV5693_8BIT, 0x3502, 0x80},
-	{OV5693_8BIT, 0x3708, 0xe2},
-	{OV5693_8BIT, 0x3709, 0xc3},
-	{OV5693_8BIT, 0x3800, 0x00},	/*{3800,3801} Array X start*/
-	{OV5693_8BIT, 0x3801, 0x08},	/* 04 //{3800,3801} Array X start*/
-	{OV5693_8BIT, 0x3802, 0x00},	/*{3802,3803} Array Y start*/
-	{OV5693_8BIT, 0x3803, 0x04},	/* 00  //{3802,3803} Array Y start*/
-	{OV5693_8BIT, 0x3804, 0x0a},	/*{3804,3805} Array X end*/
-	{OV5693_8BIT, 0x3805, 0x37},	/* 3b  //{3804,3805} Array X end*/
-	{OV5693_8BIT, 0x3806, 0x07},	/*{3806,3807} Array Y end*/
-	{OV5693_8BIT, 0x3807, 0x9f},	/* a3  //{3806,3807} Array Y end*/
-	{OV5693_8BIT, 0x3808, 0x06},	/*{3808,3809} Final output H size*/
-	{OV5693_8BIT, 0x3809, 0x50},	/*{3808,3809} Final output H size*/
-	{OV5693_8BIT, 0x380a, 0x04},	/*{380a,380b} Final output V size*/
-	{OV5693_8BIT, 0x380b, 0xc0},	/*{380a,380b} Final output V size*/
-	{OV5693_8BIT, 0x380c, 0x0a},	/*{380c,380d} HTS*/
-	{OV5693_8BIT, 0x380d, 0x80},	/*{380c,380d} HTS*/
-	{OV5693_8BIT, 0x380e, 0x07},	/*{380e,380f} VTS*/
-	{OV5693_8BIT, 0x380f, 0xc0},	/* bc	//{380e,380f} VTS*/
-	{OV5693_8BIT, 0x3810, 0x00},	/*{3810,3811} windowing X offset*/
-	{OV5693_8BIT, 0x3811, 0x10},	/*{3810,3811} windowing X offset*/
-	{OV5693_8BIT, 0x3812, 0x00},	/*{3812,3813} windowing Y offset*/
-	{OV5693_8BIT, 0x3813, 0x06},	/*{3812,3813} windowing Y offset*/
-	{OV5693_8BIT, 0x3814, 0x11},	/*X subsample control*/
-	{OV5693_8BIT, 0x3815, 0x11},	/*Y subsample control*/
-	{OV5693_8BIT, 0x3820, 0x00},	/*FLIP/Binnning control*/
-	{OV5693_8BIT, 0x3821, 0x1e},	/*MIRROR control*/
-	{OV5693_8BIT, 0x5002, 0x00},
-	{OV5693_8BIT, 0x5041, 0x84},
-	{OV5693_8BIT, 0x0100, 0x01},
-	{OV5693_TOK_TERM, 0, 0}
+static const u8 ov5693_1616x1216_30fps_data[] = {
+	SENSOR_SEQ_REGS(0x3501, 0x7b, 0x80),
+	SENSOR_SEQ_REGS(0x3708, 0xe2, 0xc3),
+	SENSOR_SEQ_REGS(0x3800,
+			0x00,	/*{3800,3801} Array X start*/
+			0x08,	/* 04 //{3800,3801} Array X start*/
+			0x00,	/*{3802,3803} Array Y start*/
+			0x04,	/* 00  //{3802,3803} Array Y start*/
+			0x0a,	/*{3804,3805} Array X end*/
+			0x37,	/* 3b  //{3804,3805} Array X end*/
+			0x07,	/*{3806,3807} Array Y end*/
+			0x9f,	/* a3  //{3806,3807} Array Y end*/
+			0x06,	/*{3808,3809} Final output H size*/
+			0x50,	/*{3808,3809} Final output H size*/
+			0x04,	/*{380a,380b} Final output V size*/
+			0xc0,	/*{380a,380b} Final output V size*/
+			0x0a,	/*{380c,380d} HTS*/
+			0x80,	/*{380c,380d} HTS*/
+			0x07,	/*{380e,380f} VTS*/
+			0xc0,	/* bc	//{380e,380f} VTS*/
+			0x00,	/*{3810,3811} windowing X offset*/
+			0x10,	/*{3810,3811} windowing X offset*/
+			0x00,	/*{3812,3813} windowing Y offset*/
+			0x06,	/*{3812,3813} windowing Y offset*/
+			0x11,	/*X subsample control*/
+			0x11),	/*Y subsample control*/
+	SENSOR_SEQ_REGS(0x3820,
+			0x00,	/*FLIP/Binnning control*/
+			0x1e),	/*MIRROR control*/
+	SENSOR_SEQ_REGS(0x5002, 0x00),
+	SENSOR_SEQ_REGS(0x5041, 0x84),
+	SENSOR_SEQ_REGS(0x0100, 0x01),
 };
 
+static const struct sensor_seq ov5693_1616x1216_30fps =
+	SENSOR_SEQ(ov5693_1616x1216_30fps_data);
+
 /*
  * 1940x1096 30fps 8.8ms VBlanking 2lane 10bit (Scaling)
  */
 #if ENABLE_NON_PREVIEW
-static struct ov5693_reg const ov5693_1940x1096[] = {
-	{OV5693_8BIT, 0x3501, 0x7b},
-	{OV5693_8BIT, 0x3502, 0x00},
-	{OV5693_8BIT, 0x3708, 0xe2},
-	{OV5693_8BIT, 0x3709, 0xc3},
-	{OV5693_8BIT, 0x3803, 0xf0},
-	{OV5693_8BIT, 0x3806, 0x06},
-	{OV5693_8BIT, 0x3807, 0xa7},
-	{OV5693_8BIT, 0x3808, 0x07},
-	{OV5693_8BIT, 0x3809, 0x94},
-	{OV5693_8BIT, 0x380a, 0x04},
-	{OV5693_8BIT, 0x380b, 0x48},
-	{OV5693_8BIT, 0x380c, 0x0a},
-	{OV5693_8BIT, 0x380d, 0x80},
-	{OV5693_8BIT, 0x380e, 0x07},
-	{OV5693_8BIT, 0x380f, 0xc0},
-	{OV5693_8BIT, 0x3811, 0x02},
-	{OV5693_8BIT, 0x3813, 0x02},
-	{OV5693_8BIT, 0x3814, 0x11},
-	{OV5693_8BIT, 0x3815, 0x11},
-	{OV5693_8BIT, 0x3820, 0x00},
-	{OV5693_8BIT, 0x3821, 0x1e},
-	{OV5693_8BIT, 0x5002, 0x80},
-	{OV5693_8BIT, 0x0100, 0x01},
-	{OV5693_TOK_TERM, 0, 0}
+static const u8 ov5693_1940x1096_data[] = {
+	SENSOR_SEQ_REGS(0x3501, 0x7b, 0x00),
+	SENSOR_SEQ_REGS(0x3708, 0xe2, 0xc3),
+	SENSOR_SEQ_REGS(0x3803, 0xf0),
+	SENSOR_SEQ_REGS(0x3806,
+			0x06, 0xa7, 0x07, 0x94, 0x04, 0x48, 0x0a, 0x80,
+			0x07, 0xc0),
+	SENSOR_SEQ_REGS(0x3811, 0x02),
+	SENSOR_SEQ_REGS(0x3813, 0x02, 0x11, 0x11),
+	SENSOR_SEQ_REGS(0x3820, 0x00, 0x1e),
+	SENSOR_SEQ_REGS(0x5002, 0x80),
+	SENSOR_SEQ_REGS(0x0100, 0x01),
 };
 
-static struct ov5693_reg const ov5693_2592x1456_30fps[] = {
-	{OV5693_8BIT, 0x3501, 0x7b},
-	{OV5693_8BIT, 0x3502, 0x00},
-	{OV5693_8BIT, 0x3708, 0xe2},
-	{OV5693_8BIT, 0x3709, 0xc3},
-	{OV5693_8BIT, 0x3800, 0x00},
-	{OV5693_8BIT, 0x3801, 0x00},
-	{OV5693_8BIT, 0x3802, 0x00},
-	{OV5693_8BIT, 0x3803, 0xf0},
-	{OV5693_8BIT, 0x3804, 0x0a},
-	{OV5693_8BIT, 0x3805, 0x3f},
-	{OV5693_8BIT, 0x3806, 0x06},
-	{OV5693_8BIT, 0x3807, 0xa4},
-	{OV5693_8BIT, 0x3808, 0x0a},
-	{OV5693_8BIT, 0x3809, 0x20},
-	{OV5693_8BIT, 0x380a, 0x05},
-	{OV5693_8BIT, 0x380b, 0xb0},
-	{OV5693_8BIT, 0x380c, 0x0a},
-	{OV5693_8BIT, 0x380d, 0x80},
-	{OV5693_8BIT, 0x380e, 0x07},
-	{OV5693_8BIT, 0x380f, 0xc0},
-	{OV5693_8BIT, 0x3811, 0x10},
-	{OV5693_8BIT, 0x3813, 0x00},
-	{OV5693_8BIT, 0x3814, 0x11},
-	{OV5693_8BIT, 0x3815, 0x11},
-	{OV5693_8BIT, 0x3820, 0x00},
-	{OV5693_8BIT, 0x3821, 0x1e},
-	{OV5693_8BIT, 0x5002, 0x00},
-	{OV5693_TOK_TERM, 0, 0}
+static const struct sensor_seq ov5693_1940x1096 =
+	SENSOR_SEQ(ov5693_1940x1096_data);
+
+static const u8 ov5693_2592x1456_30fps_data[] = {
+	SENSOR_SEQ_REGS(0x3501, 0x7b, 0x00),
+	SENSOR_SEQ_REGS(0x3708, 0xe2, 0xc3),
+	SENSOR_SEQ_REGS(0x3800,
+			0x00, 0x00, 0x00, 0xf0, 0x0a, 0x3f, 0x06, 0xa4,
+			0x0a, 0x20, 0x05, 0xb0, 0x0a, 0x80, 0x07, 0xc0),
+	SENSOR_SEQ_REGS(0x3811, 0x10),
+	SENSOR_SEQ_REGS(0x3813, 0x00, 0x11, 0x11),
+	SENSOR_SEQ_REGS(0x3820, 0x00, 0x1e),
+	SENSOR_SEQ_REGS(0x5002, 0x00),
 };
+
+static const struct sensor_seq ov5693_2592x1456_30fps =
+	SENSOR_SEQ(ov5693_2592x1456_30fps_data);
 #endif
 
-static struct ov5693_reg const ov5693_2576x1456_30fps[] = {
-	{OV5693_8BIT, 0x3501, 0x7b},
-	{OV5693_8BIT, 0x3502, 0x00},
-	{OV5693_8BIT, 0x3708, 0xe2},
-	{OV5693_8BIT, 0x3709, 0xc3},
-	{OV5693_8BIT, 0x3800, 0x00},
-	{OV5693_8BIT, 0x3801, 0x00},
-	{OV5693_8BIT, 0x3802, 0x00},
-	{OV5693_8BIT, 0x3803, 0xf0},
-	{OV5693_8BIT, 0x3804, 0x0a},
-	{OV5693_8BIT, 0x3805, 0x3f},
-	{OV5693_8BIT, 0x3806, 0x06},
-	{OV5693_8BIT, 0x3807, 0xa4},
-	{OV5693_8BIT, 0x3808, 0x0a},
-	{OV5693_8BIT, 0x3809, 0x10},
-	{OV5693_8BIT, 0x380a, 0x05},
-	{OV5693_8BIT, 0x380b, 0xb0},
-	{OV5693_8BIT, 0x380c, 0x0a},
-	{OV5693_8BIT, 0x380d, 0x80},
-	{OV5693_8BIT, 0x380e, 0x07},
-	{OV5693_8BIT, 0x380f, 0xc0},
-	{OV5693_8BIT, 0x3811, 0x18},
-	{OV5693_8BIT, 0x3813, 0x00},
-	{OV5693_8BIT, 0x3814, 0x11},
-	{OV5693_8BIT, 0x3815, 0x11},
-	{OV5693_8BIT, 0x3820, 0x00},
-	{OV5693_8BIT, 0x3821, 0x1e},
-	{OV5693_8BIT, 0x5002, 0x00},
-	{OV5693_TOK_TERM, 0, 0}
+static const u8 ov5693_2576x1456_30fps_data[] = {
+	SENSOR_SEQ_REGS(0x3501, 0x7b, 0x00),
+	SENSOR_SEQ_REGS(0x3708, 0xe2, 0xc3),
+	SENSOR_SEQ_REGS(0x3800,
+			0x00, 0x00, 0x00, 0xf0, 0x0a, 0x3f, 0x06, 0xa4,
+			0x0a, 0x10, 0x05, 0xb0, 0x0a, 0x80, 0x07, 0xc0),
+	SENSOR_SEQ_REGS(0x3811, 0x18),
+	SENSOR_SEQ_REGS(0x3813, 0x00, 0x11, 0x11),
+	SENSOR_SEQ_REGS(0x3820, 0x00, 0x1e),
+	SENSOR_SEQ_REGS(0x5002, 0x00),
 };
 
+static const struct sensor_seq ov5693_2576x1456_30fps =
+	SENSOR_SEQ(ov5693_2576x1456_30fps_data);
+
 /*
  * 2592x1944 30fps 0.6ms VBlanking 2lane 10Bit
  */
 #if ENABLE_NON_PREVIEW
-static struct ov5693_reg const ov5693_2592x1944_30fps[] = {
-	{OV5693_8BIT, 0x3501, 0x7b},
-	{OV5693_8BIT, 0x3502, 0x00},
-	{OV5693_8BIT, 0x3708, 0xe2},
-	{OV5693_8BIT, 0x3709, 0xc3},
-	{OV5693_8BIT, 0x3803, 0x00},
-	{OV5693_8BIT, 0x3806, 0x07},
-	{OV5693_8BIT, 0x3807, 0xa3},
-	{OV5693_8BIT, 0x3808, 0x0a},
-	{OV5693_8BIT, 0x3809, 0x20},
-	{OV5693_8BIT, 0x380a, 0x07},
-	{OV5693_8BIT, 0x380b, 0x98},
-	{OV5693_8BIT, 0x380c, 0x0a},
-	{OV5693_8BIT, 0x380d, 0x80},
-	{OV5693_8BIT, 0x380e, 0x07},
-	{OV5693_8BIT, 0x380f, 0xc0},
-	{OV5693_8BIT, 0x3811, 0x10},
-	{OV5693_8BIT, 0x3813, 0x00},
-	{OV5693_8BIT, 0x3814, 0x11},
-	{OV5693_8BIT, 0x3815, 0x11},
-	{OV5693_8BIT, 0x3820, 0x00},
-	{OV5693_8BIT, 0x3821, 0x1e},
-	{OV5693_8BIT, 0x5002, 0x00},
-	{OV5693_8BIT, 0x0100, 0x01},
-	{OV5693_TOK_TERM, 0, 0}
+static const u8 ov5693_2592x1944_30fps_data[] = {
+	SENSOR_SEQ_REGS(0x3501, 0x7b, 0x00),
+	SENSOR_SEQ_REGS(0x3708, 0xe2, 0xc3),
+	SENSOR_SEQ_REGS(0x3803, 0x00),
+	SENSOR_SEQ_REGS(0x3806,
+			0x07, 0xa3, 0x0a, 0x20, 0x07, 0x98, 0x0a, 0x80,
+			0x07, 0xc0),
+	SENSOR_SEQ_REGS(0x3811, 0x10),
+	SENSOR_SEQ_REGS(0x3813, 0x00, 0x11, 0x11),
+	SENSOR_SEQ_REGS(0x3820, 0x00, 0x1e),
+	SENSOR_SEQ_REGS(0x5002, 0x00),
+	SENSOR_SEQ_REGS(0x0100, 0x01),
 };
+
+static const struct sensor_seq ov5693_2592x1944_30fps =
+	SENSOR_SEQ(ov5693_2592x1944_30fps_data);
 #endif
 
 /*
@@ -1015,40 +808,43 @@ static struct ov5693_reg const ov5693_2592x1944_30fps[] = {
  * WA: Left Offset: 8, Hor scal: 64
  */
 #if ENABLE_NON_PREVIEW
-static struct ov5693_reg const ov5693_1424x1168_30fps[] = {
-	{OV5693_8BIT, 0x3501, 0x3b}, /* long exposure[15:8] */
-	{OV5693_8BIT, 0x3502, 0x80}, /* long exposure[7:0] */
-	{OV5693_8BIT, 0x3708, 0xe2},
-	{OV5693_8BIT, 0x3709, 0xc3},
-	{OV5693_8BIT, 0x3800, 0x00}, /* TIMING_X_ADDR_START */
-	{OV5693_8BIT, 0x3801, 0x50}, /* 80 */
-	{OV5693_8BIT, 0x3802, 0x00}, /* TIMING_Y_ADDR_START */
-	{OV5693_8BIT, 0x3803, 0x02}, /* 2 */
-	{OV5693_8BIT, 0x3804, 0x09}, /* TIMING_X_ADDR_END */
-	{OV5693_8BIT, 0x3805, 0xdd}, /* 2525 */
-	{OV5693_8BIT, 0x3806, 0x07}, /* TIMING_Y_ADDR_END */
-	{OV5693_8BIT, 0x3807, 0xa1}, /* 1953 */
-	{OV5693_8BIT, 0x3808, 0x05}, /* TIMING_X_OUTPUT_SIZE */
-	{OV5693_8BIT, 0x3809, 0x90}, /* 1424 */
-	{OV5693_8BIT, 0x380a, 0x04}, /* TIMING_Y_OUTPUT_SIZE */
-	{OV5693_8BIT, 0x380b, 0x90}, /* 1168 */
-	{OV5693_8BIT, 0x380c, 0x0a}, /* TIMING_HTS */
-	{OV5693_8BIT, 0x380d, 0x80},
-	{OV5693_8BIT, 0x380e, 0x07}, /* TIMING_VTS */
-	{OV5693_8BIT, 0x380f, 0xc0},
-	{OV5693_8BIT, 0x3810, 0x00}, /* TIMING_ISP_X_WIN */
-	{OV5693_8BIT, 0x3811, 0x02}, /* 2 */
-	{OV5693_8BIT, 0x3812, 0x00}, /* TIMING_ISP_Y_WIN */
-	{OV5693_8BIT, 0x3813, 0x00}, /* 0 */
-	{OV5693_8BIT, 0x3814, 0x11}, /* TIME_X_INC */
-	{OV5693_8BIT, 0x3815, 0x11}, /* TIME_Y_INC */
-	{OV5693_8BIT, 0x3820, 0x00},
-	{OV5693_8BIT, 0x3821, 0x1e},
-	{OV5693_8BIT, 0x5002, 0x00},
-	{OV5693_8BIT, 0x5041, 0x84}, /* scale is auto enabled */
-	{OV5693_8BIT, 0x0100, 0x01},
-	{OV5693_TOK_TERM, 0, 0}
+static const u8 ov5693_1424x1168_30fps_data[] = {
+	SENSOR_SEQ_REGS(0x3501,
+			0x3b,	/* long exposure[15:8] */
+			0x80),	/* long exposure[7:0] */
+	SENSOR_SEQ_REGS(0x3708, 0xe2, 0xc3),
+	SENSOR_SEQ_REGS(0x3800,
+			0x00,	/* TIMING_X_ADDR_START */
+			0x50,	/* 80 */
+			0x00,	/* TIMING_Y_ADDR_START */
+			0x02,	/* 2 */
+			0x09,	/* TIMING_X_ADDR_END */
+			0xdd,	/* 2525 */
+			0x07,	/* TIMING_Y_ADDR_END */
+			0xa1,	/* 1953 */
+			0x05,	/* TIMING_X_OUTPUT_SIZE */
+			0x90,	/* 1424 */
+			0x04,	/* TIMING_Y_OUTPUT_SIZE */
+			0x90,	/* 1168 */
+			0x0a,	/* TIMING_HTS */
+			0x80,
+			0x07,	/* TIMING_VTS */
+			0xc0,
+			0x00,	/* TIMING_ISP_X_WIN */
+			0x02,	/* 2 */
+			0x00,	/* TIMING_ISP_Y_WIN */
+			0x00,	/* 0 */
+			0x11,	/* TIME_X_INC */
+			0x11),	/* TIME_Y_INC */
+	SENSOR_SEQ_REGS(0x3820, 0x00, 0x1e),
+	SENSOR_SEQ_REGS(0x5002, 0x00),
+	SENSOR_SEQ_REGS(0x5041,
+			0x84),	/* scale is auto enabled */
+	SENSOR_SEQ_REGS(0x0100, 0x01),
 };
+
+static const struct sensor_seq ov5693_1424x1168_30fps =
+	SENSOR_SEQ(ov5693_1424x1168_30fps_data);
 #endif
 
 /*
@@ -1056,68 +852,218 @@ static struct ov5693_reg const ov5693_1424x1168_30fps[] = {
  * ISP Effect Res: 720x480
  * Sensor out: 736x496, DS From 2616x1764
  */
-static struct ov5693_reg const ov5693_736x496_30fps[] = {
-	{OV5693_8BIT, 0x3501, 0x3b}, /* long exposure[15:8] */
-	{OV5693_8BIT, 0x3502, 0x80}, /* long exposure[7:0] */
-	{OV5693_8BIT, 0x3708, 0xe2},
-	{OV5693_8BIT, 0x3709, 0xc3},
-	{OV5693_8BIT, 0x3800, 0x00}, /* TIMING_X_ADDR_START */
-	{OV5693_8BIT, 0x3801, 0x02}, /* 2 */
-	{OV5693_8BIT, 0x3802, 0x00}, /* TIMING_Y_ADDR_START */
-	{OV5693_8BIT, 0x3803, 0x62}, /* 98 */
-	{OV5693_8BIT, 0x3804, 0x0a}, /* TIMING_X_ADDR_END */
-	{OV5693_8BIT, 0x3805, 0x3b}, /* 2619 */
-	{OV5693_8BIT, 0x3806, 0x07}, /* TIMING_Y_ADDR_END */
-	{OV5693_8BIT, 0x3807, 0x43}, /* 1859 */
-	{OV5693_8BIT, 0x3808, 0x02}, /* TIMING_X_OUTPUT_SIZE */
-	{OV5693_8BIT, 0x3809, 0xe0}, /* 736 */
-	{OV5693_8BIT, 0x380a, 0x01}, /* TIMING_Y_OUTPUT_SIZE */
-	{OV5693_8BIT, 0x380b, 0xf0}, /* 496 */
-	{OV5693_8BIT, 0x380c, 0x0a}, /* TIMING_HTS */
-	{OV5693_8BIT, 0x380d, 0x80},
-	{OV5693_8BIT, 0x380e, 0x07}, /* TIMING_VTS */
-	{OV5693_8BIT, 0x380f, 0xc0},
-	{OV5693_8BIT, 0x3810, 0x00}, /* TIMING_ISP_X_WIN */
-	{OV5693_8BIT, 0x3811, 0x02}, /* 2 */
-	{OV5693_8BIT, 0x3812, 0x00}, /* TIMING_ISP_Y_WIN */
-	{OV5693_8BIT, 0x3813, 0x00}, /* 0 */
-	{OV5693_8BIT, 0x3814, 0x11}, /* TIME_X_INC */
-	{OV5693_8BIT, 0x3815, 0x11}, /* TIME_Y_INC */
-	{OV5693_8BIT, 0x3820, 0x00},
-	{OV5693_8BIT, 0x3821, 0x1e},
-	{OV5693_8BIT, 0x5002, 0x00},
-	{OV5693_8BIT, 0x5041, 0x84}, /* scale is auto enabled */
-	{OV5693_8BIT, 0x0100, 0x01},
-	{OV5693_TOK_TERM, 0, 0}
+static const u8 ov5693_736x496_30fps_data[] = {
+	SENSOR_SEQ_REGS(0x3501,
+			0x3b,	/* long exposure[15:8] */
+			0x80),	/* long exposure[7:0] */
+	SENSOR_SEQ_REGS(0x3708, 0xe2, 0xc3),
+	SENSOR_SEQ_REGS(0x3800,
+			0x00,	/* TIMING_X_ADDR_START */
+			0x02,	/* 2 */
+			0x00,	/* TIMING_Y_ADDR_START */
+			0x62,	/* 98 */
+			0x0a,	/* TIMING_X_ADDR_END */
+			0x3b,	/* 2619 */
+			0x07,	/* TIMING_Y_ADDR_END */
+			0x43,	/* 1859 */
+			0x02,	/* TIMING_X_OUTPUT_SIZE */
+			0xe0,	/* 736 */
+			0x01,	/* TIMING_Y_OUTPUT_SIZE */
+			0xf0,	/* 496 */
+			0x0a,	/* TIMING_HTS */
+			0x80,
+			0x07,	/* TIMING_VTS */
+			0xc0,
+			0x00,	/* TIMING_ISP_X_WIN */
+			0x02,	/* 2 */
+			0x00,	/* TIMING_ISP_Y_WIN */
+			0x00,	/* 0 */
+			0x11,	/* TIME_X_INC */
+			0x11),	/* TIME_Y_INC */
+	SENSOR_SEQ_REGS(0x3820, 0x00, 0x1e),
+	SENSOR_SEQ_REGS(0x5002, 0x00),
+	SENSOR_SEQ_REGS(0x5041,
+			0x84),	/* scale is auto enabled */
+	SENSOR_SEQ_REGS(0x0100, 0x01),
 };
 
-static struct ov5693_reg const ov5693_2576x1936_30fps[] = {
-	{OV5693_8BIT, 0x3501, 0x7b},
-	{OV5693_8BIT, 0x3502, 0x00},
-	{OV5693_8BIT, 0x3708, 0xe2},
-	{OV5693_8BIT, 0x3709, 0xc3},
-	{OV5693_8BIT, 0x3803, 0x00},
-	{OV5693_8BIT, 0x3806, 0x07},
-	{OV5693_8BIT, 0x3807, 0xa3},
-	{OV5693_8BIT, 0x3808, 0x0a},
-	{OV5693_8BIT, 0x3809, 0x10},
-	{OV5693_8BIT, 0x380a, 0x07},
-	{OV5693_8BIT, 0x380b, 0x90},
-	{OV5693_8BIT, 0x380c, 0x0a},
-	{OV5693_8BIT, 0x380d, 0x80},
-	{OV5693_8BIT, 0x380e, 0x07},
-	{OV5693_8BIT, 0x380f, 0xc0},
-	{OV5693_8BIT, 0x3811, 0x18},
-	{OV5693_8BIT, 0x3813, 0x00},
-	{OV5693_8BIT, 0x3814, 0x11},
-	{OV5693_8BIT, 0x3815, 0x11},
-	{OV5693_8BIT, 0x3820, 0x00},
-	{OV5693_8BIT, 0x3821, 0x1e},
-	{OV5693_8BIT, 0x5002, 0x00},
-	{OV5693_8BIT, 0x0100, 0x01},
-	{OV5693_TOK_TERM, 0, 0}
+static const struct sensor_seq ov5693_736x496_30fps =
+	SENSOR_SEQ(ov5693_736x496_30fps_data);
+
+static const u8 ov5693_2576x1936_30fps_data[] = {
+	SENSOR_SEQ_REGS(0x3501, 0x7b, 0x00),
+	SENSOR_SEQ_REGS(0x3708, 0xe2, 0xc3),
+	SENSOR_SEQ_REGS(0x3803, 0x00),
+	SENSOR_SEQ_REGS(0x3806,
+			0x07, 0xa3, 0x0a, 0x10, 0x07, 0x90, 0x0a, 0x80,
+			0x07, 0xc0),
+	SENSOR_SEQ_REGS(0x3811, 0x18),
+	SENSOR_SEQ_REGS(0x3813, 0x00, 0x11, 0x11),
+	SENSOR_SEQ_REGS(0x3820, 0x00, 0x1e),
+	SENSOR_SEQ_REGS(0x5002, 0x00),
+	SENSOR_SEQ_REGS(0x0100, 0x01),
+};
+
+static const struct sensor_seq ov5693_2576x1936_30fps =
+	SENSOR_SEQ(ov5693_2576x1936_30fps_data);
+
+/*
+ * 2x2 binned modes, 30fps 2lane 10Bit: horizontal binning and vertical
+ * sub-sampling of a window of twice the output plus 16x4, the ISP window
+ * takes the middle of it. No scaling, the 640 wide modes are a crop of
+ * the middle of the array. The faster frame rates are the 30fps table
+ * with a shorter VTS, see the patches below.
+ */
+static const u8 ov5693_1296x972_30fps_data[] = {
+	SENSOR_SEQ_REGS(0x3501, 0x7b, 0x00),
+	SENSOR_SEQ_REGS(0x3708, 0xe6, 0xc7),
+	SENSOR_SEQ_REGS(0x3800,
+			0x00, 0x00,	/* TIMING_X_ADDR_START 0 */
+			0x00, 0x02,	/* TIMING_Y_ADDR_START 2 */
+			0x0a, 0x3f,	/* TIMING_X_ADDR_END 2623 */
+			0x07, 0xa1,	/* TIMING_Y_ADDR_END 1953 */
+			0x05, 0x10,	/* TIMING_X_OUTPUT_SIZE 1296 */
+			0x03, 0xcc,	/* TIMING_Y_OUTPUT_SIZE 972 */
+			0x0a, 0x80,	/* TIMING_HTS */
+			0x07, 0xc0,	/* TIMING_VTS */
+			0x00, 0x08,	/* TIMING_ISP_X_WIN */
+			0x00, 0x02,	/* TIMING_ISP_Y_WIN */
+			0x31,	/* X subsample control */
+			0x31),	/* Y subsample control */
+	SENSOR_SEQ_REGS(0x3820, 0x04, 0x1f),
+	SENSOR_SEQ_REGS(0x5002, 0x00),
+};
+
+static const u8 ov5693_1280x720_30fps_data[] = {
+	SENSOR_SEQ_REGS(0x3501, 0x7b, 0x00),
+	SENSOR_SEQ_REGS(0x3708, 0xe6, 0xc7),
+	SENSOR_SEQ_REGS(0x3800,
+			0x00, 0x10,	/* TIMING_X_ADDR_START 16 */
+			0x00, 0xfe,	/* TIMING_Y_ADDR_START 254 */
+			0x0a, 0x2f,	/* TIMING_X_ADDR_END 2607 */
+			0x06, 0xa5,	/* TIMING_Y_ADDR_END 1701 */
+			0x05, 0x00,	/* TIMING_X_OUTPUT_SIZE 1280 */
+			0x02, 0xd0,	/* TIMING_Y_OUTPUT_SIZE 720 */
+			0x0a, 0x80,	/* TIMING_HTS */
+			0x07, 0xc0,	/* TIMING_VTS */
+			0x00, 0x08,	/* TIMING_ISP_X_WIN */
+			0x00, 0x02,	/* TIMING_ISP_Y_WIN */
+			0x31,	/* X subsample control */
+			0x31),	/* Y subsample control */
+	SENSOR_SEQ_REGS(0x3820, 0x04, 0x1f),
+	SENSOR_SEQ_REGS(0x5002, 0x00),
+};
+
+static const u8 ov5693_640x480_30fps_data[] = {
+	SENSOR_SEQ_REGS(0x3501, 0x7b, 0x00),
+	SENSOR_SEQ_REGS(0x3708, 0xe6, 0xc7),
+	SENSOR_SEQ_REGS(0x3800,
+			0x02, 0x90,	/* TIMING_X_ADDR_START 656 */
+			0x01, 0xee,	/* TIMING_Y_ADDR_START 494 */
+			0x07, 0xaf,	/* TIMING_X_ADDR_END 1967 */
+			0x05, 0xb5,	/* TIMING_Y_ADDR_END 1461 */
+			0x02, 0x80,	/* TIMING_X_OUTPUT_SIZE 640 */
+			0x01, 0xe0,	/* TIMING_Y_OUTPUT_SIZE 480 */
+			0x0a, 0x80,	/* TIMING_HTS */
+			0x07, 0xc0,	/* TIMING_VTS */
+			0x00, 0x08,	/* TIMING_ISP_X_WIN */
+			0x00, 0x02,	/* TIMING_ISP_Y_WIN */
+			0x31,	/* X subsample control */
+			0x31),	/* Y subsample control */
+	SENSOR_SEQ_REGS(0x3820, 0x04, 0x1f),
+	SENSOR_SEQ_REGS(0x5002, 0x00),
+};
+
+static const u8 ov5693_640x360_30fps_data[] = {
+	SENSOR_SEQ_REGS(0x3501, 0x7b, 0x00),
+	SENSOR_SEQ_REGS(0x3708, 0xe6, 0xc7),
+	SENSOR_SEQ_REGS(0x3800,
+			0x02, 0x90,	/* TIMING_X_ADDR_START 656 */
+			0x02, 0x66,	/* TIMING_Y_ADDR_START 614 */
+			0x07, 0xaf,	/* TIMING_X_ADDR_END 1967 */
+			0x05, 0x3d,	/* TIMING_Y_ADDR_END 1341 */
+			0x02, 0x80,	/* TIMING_X_OUTPUT_SIZE 640 */
+			0x01, 0x68,	/* TIMING_Y_OUTPUT_SIZE 360 */
+			0x0a, 0x80,	/* TIMING_HTS */
+			0x07, 0xc0,	/* TIMING_VTS */
+			0x00, 0x08,	/* TIMING_ISP_X_WIN */
+			0x00, 0x02,	/* TIMING_ISP_Y_WIN */
+			0x31,	/* X subsample control */
+			0x31),	/* Y subsample control */
+	SENSOR_SEQ_REGS(0x3820, 0x04, 0x1f),
+	SENSOR_SEQ_REGS(0x5002, 0x00),
+};
+
+/* VTS 160MHz / (2688 * fps), and the exposure at VTS - 8 */
+static const struct sensor_seq_patch ov5693_60fps_patch[] = {
+	SENSOR_SEQ_SET(0x3501, 0x3d), SENSOR_SEQ_SET(0x3502, 0x80),
+	SENSOR_SEQ_SET(0x380e, 0x03), SENSOR_SEQ_SET(0x380f, 0xe0),	/* 992 */
+};
+
+static const struct sensor_seq_patch ov5693_90fps_patch[] = {
+	SENSOR_SEQ_SET(0x3501, 0x28), SENSOR_SEQ_SET(0x3502, 0xd0),
+	SENSOR_SEQ_SET(0x380e, 0x02), SENSOR_SEQ_SET(0x380f, 0x95),	/* 661 */
+};
+
+static const struct sensor_seq_patch ov5693_120fps_patch[] = {
+	SENSOR_SEQ_SET(0x3501, 0x1e), SENSOR_SEQ_SET(0x3502, 0x80),
+	SENSOR_SEQ_SET(0x380e, 0x01), SENSOR_SEQ_SET(0x380f, 0xf0),	/* 496 */
 };
 
+static const struct sensor_seq ov5693_1296x972_30fps =
+	SENSOR_SEQ(ov5693_1296x972_30fps_data);
+static const struct sensor_seq ov5693_1296x972_60fps =
+	SENSOR_SEQ_PATCHED(ov5693_1296x972_30fps_data,
+			   ov5693_60fps_patch);
+static const struct sensor_seq ov5693_1280x720_30fps =
+	SENSOR_SEQ(ov5693_1280x720_30fps_data);
+static const struct sensor_seq ov5693_1280x720_60fps =
+	SENSOR_SEQ_PATCHED(ov5693_1280x720_30fps_data,
+			   ov5693_60fps_patch);
+static const struct sensor_seq ov5693_640x480_30fps =
+	SENSOR_SEQ(ov5693_640x480_30fps_data);
+static const struct sensor_seq ov5693_640x480_60fps =
+	SENSOR_SEQ_PATCHED(ov5693_640x480_30fps_data,
+			   ov5693_60fps_patch);
+static const struct sensor_seq ov5693_640x480_90fps =
+	SENSOR_SEQ_PATCHED(ov5693_640x480_30fps_data,
+			   ov5693_90fps_patch);
+static const struct sensor_seq ov5693_640x480_120fps =
+	SENSOR_SEQ_PATCHED(ov5693_640x480_30fps_data,
+			   ov5693_120fps_patch);
+static const struct sensor_seq ov5693_640x360_30fps =
+	SENSOR_SEQ(ov5693_640x360_30fps_data);
+static const struct sensor_seq ov5693_640x360_60fps =
+	SENSOR_SEQ_PATCHED(ov5693_640x360_30fps_data,
+			   ov5693_60fps_patch);
+static const struct sensor_seq ov5693_640x360_90fps =
+	SENSOR_SEQ_PATCHED(ov5693_640x360_30fps_data,
+			   ov5693_90fps_patch);
+static const struct sensor_seq ov5693_640x360_120fps =
+	SENSOR_SEQ_PATCHED(ov5693_640x360_30fps_data,
+			   ov5693_120fps_patch);
+
+/* Entry of a binned mode, lines_per_frame as in the patch of @_fps */
+#define OV5693_BINNED_RES(_w, _h, _fps)					\
+	{								\
+		.desc = "ov5693_" #_w "x" #_h "_" #_fps "fps",		\
+		.width = _w,						\
+		.height = _h,						\
+		.pix_clk_freq = 160,					\
+		.fps = _fps,						\
+		.used = 0,						\
+		.pixels_per_line = 2688,				\
+		.lines_per_frame = 160000000 / (2688 * _fps),		\
+		.bin_factor_x = 2,					\
+		.bin_factor_y = 2,					\
+		.bin_mode = 1,						\
+		.regs = &ov5693_##_w##x##_h##_##_fps##fps,		\
+	}
+
+/*
+ * The first entry is the default and the last the largest. The entries
+ * of a size are next to each other, from 30fps.
+ */
 static struct ov5693_resolution ov5693_res_preview[] = {
 	{
 		.desc = "ov5693_736x496_30fps",
@@ -1131,8 +1077,20 @@ static struct ov5693_resolution ov5693_res_preview[] = {
 		.bin_factor_x = 1,
 		.bin_factor_y = 1,
 		.bin_mode = 0,
-		.regs = ov5693_736x496_30fps,
+		.regs = &ov5693_736x496_30fps,
 	},
+	OV5693_BINNED_RES(640, 360, 30),
+	OV5693_BINNED_RES(640, 360, 60),
+	OV5693_BINNED_RES(640, 360, 90),
+	OV5693_BINNED_RES(640, 360, 120),
+	OV5693_BINNED_RES(640, 480, 30),
+	OV5693_BINNED_RES(640, 480, 60),
+	OV5693_BINNED_RES(640, 480, 90),
+	OV5693_BINNED_RES(640, 480, 120),
+	OV5693_BINNED_RES(1280, 720, 30),
+	OV5693_BINNED_RES(1280, 720, 60),
+	OV5693_BINNED_RES(1296, 972, 30),
+	OV5693_BINNED_RES(1296, 972, 60),
 	{
 		.desc = "ov5693_1616x1216_30fps",
 		.width = 1616,
@@ -1145,7 +1103,7 @@ static struct ov5693_resolution ov5693_res_preview[] = {
 		.bin_factor_x = 1,
 		.bin_factor_y = 1,
 		.bin_mode = 0,
-		.regs = ov5693_1616x1216_30fps,
+		.regs = &ov5693_1616x1216_30fps,
 	},
 	{
 		.desc = "ov5693_5M_30fps",
@@ -1159,7 +1117,7 @@ static struct ov5693_resolution ov5693_res_preview[] = {
 		.bin_factor_x = 1,
 		.bin_factor_y = 1,
 		.bin_mode = 0,
-		.regs = ov5693_2576x1456_30fps,
+		.regs = &ov5693_2576x1456_30fps,
 	},
 	{
 		.desc = "ov5693_5M_30fps",
@@ -1173,7 +1131,7 @@ static struct ov5693_resolution ov5693_res_preview[] = {
 		.bin_factor_x = 1,
 		.bin_factor_y = 1,
 		.bin_mode = 0,
-		.regs = ov5693_2576x1936_30fps,
+		.regs = &ov5693_2576x1936_30fps,
 	},
 };
 
@@ -1197,7 +1155,7 @@ struct ov5693_resolution ov5693_res_still[] = {
 		.bin_factor_x = 1,
 		.bin_factor_y = 1,
 		.bin_mode = 0,
-		.regs = ov5693_736x496_30fps,
+		.regs = &ov5693_736x496_30fps,
 	},
 	{
 		.desc = "ov5693_1424x1168_30fps",
@@ -1211,7 +1169,7 @@ struct ov5693_resolution ov5693_res_still[] = {
 		.bin_factor_x = 1,
 		.bin_factor_y = 1,
 		.bin_mode = 0,
-		.regs = ov5693_1424x1168_30fps,
+		.regs = &ov5693_1424x1168_30fps,
 	},
 	{
 		.desc = "ov5693_1616x1216_30fps",
@@ -1225,7 +1183,7 @@ struct ov5693_resolution ov5693_res_still[] = {
 		.bin_factor_x = 1,
 		.bin_factor_y = 1,
 		.bin_mode = 0,
-		.regs = ov5693_1616x1216_30fps,
+		.regs = &ov5693_1616x1216_30fps,
 	},
 	{
 		.desc = "ov5693_5M_30fps",
@@ -1239,7 +1197,7 @@ struct ov5693_resolution ov5693_res_still[] = {
 		.bin_factor_x = 1,
 		.bin_factor_y = 1,
 		.bin_mode = 0,
-		.regs = ov5693_2592x1456_30fps,
+		.regs = &ov5693_2592x1456_30fps,
 	},
 	{
 		.desc = "ov5693_5M_30fps",
@@ -1253,7 +1211,7 @@ struct ov5693_resolution ov5693_res_still[] = {
 		.bin_factor_x = 1,
 		.bin_factor_y = 1,
 		.bin_mode = 0,
-		.regs = ov5693_2592x1944_30fps,
+		.regs = &ov5693_2592x1944_30fps,
 	},
 };
 
@@ -1272,7 +1230,7 @@ struct ov5693_resolution ov5693_res_video[] = {
 		.bin_factor_x = 2,
 		.bin_factor_y = 2,
 		.bin_mode = 1,
-		.regs = ov5693_736x496,
+		.regs = &ov5693_736x496,
 	},
 	{
 		.desc = "ov5693_336x256_30fps",
@@ -1286,7 +1244,7 @@ struct ov5693_resolution ov5693_res_video[] = {
 		.bin_factor_x = 2,
 		.bin_factor_y = 2,
 		.bin_mode = 1,
-		.regs = ov5693_336x256,
+		.regs = &ov5693_336x256,
 	},
 	{
 		.desc = "ov5693_368x304_30fps",
@@ -1300,7 +1258,7 @@ struct ov5693_resolution ov5693_res_video[] = {
 		.bin_factor_x = 2,
 		.bin_factor_y = 2,
 		.bin_mode = 1,
-		.regs = ov5693_368x304,
+		.regs = &ov5693_368x304,
 	},
 	{
 		.desc = "ov5693_192x160_30fps",
@@ -1314,7 +1272,7 @@ struct ov5693_resolution ov5693_res_video[] = {
 		.bin_factor_x = 2,
 		.bin_factor_y = 2,
 		.bin_mode = 1,
-		.regs = ov5693_192x160,
+		.regs = &ov5693_192x160,
 	},
 	{
 		.desc = "ov5693_1296x736_30fps",
@@ -1328,7 +1286,7 @@ struct ov5693_resolution ov5693_res_video[] = {
 		.bin_factor_x = 2,
 		.bin_factor_y = 2,
 		.bin_mode = 0,
-		.regs = ov5693_1296x736,
+		.regs = &ov5693_1296x736,
 	},
 	{
 		.desc = "ov5693_1296x976_30fps",
@@ -1342,7 +1300,7 @@ struct ov5693_resolution ov5693_res_video[] = {
 		.bin_factor_x = 2,
 		.bin_factor_y = 2,
 		.bin_mode = 0,
-		.regs = ov5693_1296x976,
+		.regs = &ov5693_1296x976,
 	},
 	{
 		.desc = "ov5693_1636P_30fps",
@@ -1356,7 +1314,7 @@ struct ov5693_resolution ov5693_res_video[] = {
 		.bin_factor_x = 1,
 		.bin_factor_y = 1,
 		.bin_mode = 0,
-		.regs = ov5693_1636p_30fps,
+		.regs = &ov5693_1636p_30fps,
 	},
 	{
 		.desc = "ov5693_1080P_30fps",
@@ -1370,7 +1328,7 @@ struct ov5693_resolution ov5693_res_video[] = {
 		.bin_factor_x = 1,
 		.bin_factor_y = 1,
 		.bin_mode = 0,
-		.regs = ov5693_1940x1096,
+		.regs = &ov5693_1940x1096,
 	},
 	{
 		.desc = "ov5693_5M_30fps",
@@ -1384,7 +1342,7 @@ struct ov5693_resolution ov5693_res_video[] = {
 		.bin_factor_x = 1,
 		.bin_factor_y = 1,
 		.bin_mode = 0,
-		.regs = ov5693_2592x1456_30fps,
+		.regs = &ov5693_2592x1456_30fps,
 	},
 	{
 		.desc = "ov5693_5M_30fps",
@@ -1398,13 +1356,31 @@ struct ov5693_resolution ov5693_res_video[] = {
 		.bin_factor_x = 1,
 		.bin_factor_y = 1,
 		.bin_mode = 0,
-		.regs = ov5693_2592x1944_30fps,
+		.regs = &ov5693_2592x1944_30fps,
 	},
 };
 
 #define N_RES_VIDEO (ARRAY_SIZE(ov5693_res_video))
 #endif
 
-static struct ov5693_resolution *ov5693_res = ov5693_res_preview;
-static unsigned long N_RES = N_RES_PREVIEW;
+struct ov5693_res_table {
+	struct ov5693_resolution *res;
+	unsigned int n_res;
+};
+
+static const struct ov5693_res_table ov5693_res_tables[] = {
+	[OV5693_RUN_MODE_PREVIEW] = { ov5693_res_preview, N_RES_PREVIEW },
+#if ENABLE_NON_PREVIEW
+	[OV5693_RUN_MODE_VIDEO] = { ov5693_res_video, N_RES_VIDEO },
+	[OV5693_RUN_MODE_STILL] = { ov5693_res_still, N_RES_STILL },
+#endif
+};
+
+static const char * const ov5693_run_mode_menu[] = {
+	[OV5693_RUN_MODE_PREVIEW] = "preview",
+#if ENABLE_NON_PREVIEW
+	[OV5693_RUN_MODE_VIDEO] = "video",
+	[OV5693_RUN_MODE_STILL] = "still",
+#endif
+};
 #endif
@@ -9,24 +9,50 @@
 #include <linux/acpi.h>
 #include <linux/bitops.h>
 #include <linux/clk.h>
+#include <linux/debugfs.h>
 #include <linux/delay.h>
 #include <linux/device.h>
 #include <linux/gpio/consumer.h>
 #include <linux/i2c.h>
 #include <linux/init.h>
+#include <linux/math64.h>
 #include <linux/module.h>
+#include <linux/pm_runtime.h>
 #include <linux/regulator/consumer.h>
 #include <linux/slab.h>
 #include <linux/types.h>
+#include <linux/workqueue.h>
 #include <media/v4l2-ctrls.h>
+#include <media/v4l2-event.h>
 #include <media/v4l2-fwnode.h>
 #include <media/v4l2-subdev.h>
 
+#include "sensor_burst.h"
+#include "sensor_dep.h"
+#include "sensor_link.h"
+#include "sensor_meta.h"
+#include "sensor_power.h"
+#include "sensor_reg.h"
+#include "sensor_selftest.h"
+#include "sensor_seq.h"
+
+/*
+ * After a stream stops, the sensor is left powered in software standby
+ * with its registers kept for this long, so that a restart only has to
+ * write MODE_SELECT. Can be changed per device in
+ * power/autosuspend_delay_ms.
+ */
+static int autosuspend_delay_ms = 2000;
+module_param(autosuspend_delay_ms, int, 0644);
+MODULE_PARM_DESC(autosuspend_delay_ms,
+		 "Delay before powering the sensor off after stream stop");
+
 #define OV7251_ACPI_HID "INT347E"
 
 #define OV7251_SC_MODE_SELECT		0x0100
 #define OV7251_SC_MODE_SELECT_SW_STANDBY	0x0
 #define OV7251_SC_MODE_SELECT_STREAMING		0x1
+#define OV7251_SC_SOFTWARE_RESET	0x0103
 
 #define OV7251_CHIP_ID_HIGH		0x300a
 #define OV7251_CHIP_ID_HIGH_BYTE	0x77
@@ -38,6 +64,12 @@
 #define OV7251_AEC_EXPO_2		0x3502
 #define OV7251_AEC_AGC_ADJ_0		0x350a
 #define OV7251_AEC_AGC_ADJ_1		0x350b
+/* Exposure and gain writes apply from the second frame after */
+#define OV7251_CTRL_DELAY_FRAMES	2
+#define OV7251_TIMING_HTS		928
+#define OV7251_TIMING_VTS		0x380e
+#define OV7251_TIMING_VTS_MAX		0xffff
+#define OV7251_EXPOSURE_MARGIN		20
 #define OV7251_TIMING_FORMAT1		0x3820
 #define OV7251_TIMING_FORMAT1_VFLIP	BIT(2)
 #define OV7251_TIMING_FORMAT2		0x3821
@@ -45,19 +77,12 @@
 #define OV7251_PRE_ISP_00		0x5e00
 #define OV7251_PRE_ISP_00_TEST_PATTERN	BIT(7)
 
-struct reg_value {
-	u16 reg;
-	u8 val;
-};
-
 struct ov7251_mode_info {
 	u32 width;
 	u32 height;
-	const struct reg_value *data;
-	u32 data_size;
+	const struct sensor_seq *data;
 	u32 pixel_clock;
-	u32 link_freq;
-	u16 exposure_max;
+	u16 vts;	/* VTS the mode table sets */
 	u16 exposure_def;
 	struct v4l2_fract timeperframe;
 };
@@ -81,10 +106,15 @@ struct ov7251 {
 	const struct ov7251_mode_info *current_mode;
 
 	struct v4l2_ctrl_handler ctrls;
+	/* Exposure and gain, under ae_lock, see ov7251_s_ae_ctrl() */
+	struct v4l2_ctrl_handler ae_ctrls;
 	struct v4l2_ctrl *pixel_clock;
 	struct v4l2_ctrl *link_freq;
 	struct v4l2_ctrl *exposure;
 	struct v4l2_ctrl *gain;
+	struct v4l2_ctrl *vblank;
+	/* Frame interval of current_mode at the current VBLANK */
+	struct v4l2_fract frame_interval;
 
 	/* Cached register values */
 	u8 aec_pk_manual;
@@ -93,7 +123,15 @@ struct ov7251 {
 	u8 timing_format2;
 
 	struct mutex lock; /* lock to protect power state, ctrls and mode */
+	/*
+	 * Taken by exposure and gain instead of lock, so they can be set while
+	 * a mode loads. Nested inside lock.
+	 */
+	struct mutex ae_lock;
+	/* Exposure and gain are written as they are set, under ae_lock */
+	bool ae_live;
 	bool power_on;
+	bool streaming;
 
 	/* For DT-based systems */
 	struct gpio_desc *enable_gpio;
@@ -102,9 +140,38 @@ struct ov7251 {
 	struct device *dep_dev;
 
 	/* GPIOs defined in dep_dev _CRS */
-	struct gpio_descs *dep_gpios;
+	struct sensor_gpios dep_gpios;
 
 	bool is_acpi_based;
+
+	/* Register tables precompiled at probe, see ov7251_build_progs() */
+	struct sensor_prog global_prog;
+	struct sensor_prog *mode_progs;
+
+	/* Register values written since power on */
+	struct sensor_shadow shadow;
+	/* i2c traffic counters, see sensor_stats.h */
+	struct sensor_stats stats;
+	/* Register access through the above, see sensor_reg.h */
+	struct sensor_i2c i2c;
+	/* Frame sync events and per-frame values, see sensor_meta.h */
+	struct sensor_meta meta;
+	/* Stream timing the capture side checks, see sensor_selftest.h */
+	struct sensor_selftest selftest;
+	/* Mode loaded in the sensor, NULL if none */
+	const struct ov7251_mode_info *loaded_mode;
+	/* Link frequencies and data lanes, see sensor_link.h */
+	struct sensor_link link;
+	/* Stream on together with the other sensors, see sensor_dep.h */
+	struct sensor_sync sync;
+
+	struct dentry *debugfs;
+
+	/* Identifies the sensor and registers the subdev after probe */
+	struct delayed_work identify_work;
+	unsigned int identify_tries;
+	/* Set once identify_work has registered the subdev */
+	bool registered;
 };
 
 static inline struct ov7251 *to_ov7251(struct v4l2_subdev *sd)
@@ -112,425 +179,134 @@ static inline struct ov7251 *to_ov7251(struct v4l2_subdev *sd)
 	return container_of(sd, struct ov7251, sd);
 }
 
-static const struct reg_value ov7251_global_init_setting[] = {
-	{ 0x0103, 0x01 },
-	{ 0x303b, 0x02 },
+static const u8 ov7251_global_init_setting_data[] = {
+	SENSOR_SEQ_REGS(OV7251_SC_SOFTWARE_RESET, 0x01),
+	SENSOR_SEQ_REGS(0x303b, 0x02),
 };
 
-static const struct reg_value ov7251_setting_vga_30fps[] = {
-	{ 0x3005, 0x00 },
-	{ 0x3012, 0xc0 },
-	{ 0x3013, 0xd2 },
-	{ 0x3014, 0x04 },
-	{ 0x3016, 0xf0 },
-	{ 0x3017, 0xf0 },
-	{ 0x3018, 0xf0 },
-	{ 0x301a, 0xf0 },
-	{ 0x301b, 0xf0 },
-	{ 0x301c, 0xf0 },
-	{ 0x3023, 0x05 },
-	{ 0x3037, 0xf0 },
-	{ 0x3098, 0x04 }, /* pll2 pre divider */
-	{ 0x3099, 0x28 }, /* pll2 multiplier */
-	{ 0x309a, 0x05 }, /* pll2 sys divider */
-	{ 0x309b, 0x04 }, /* pll2 adc divider */
-	{ 0x309d, 0x00 }, /* pll2 divider */
-	{ 0x30b0, 0x0a }, /* pll1 pix divider */
-	{ 0x30b1, 0x01 }, /* pll1 divider */
-	{ 0x30b3, 0x64 }, /* pll1 multiplier */
-	{ 0x30b4, 0x03 }, /* pll1 pre divider */
-	{ 0x30b5, 0x05 }, /* pll1 mipi divider */
-	{ 0x3106, 0xda },
-	{ 0x3503, 0x07 },
-	{ 0x3509, 0x10 },
-	{ 0x3600, 0x1c },
-	{ 0x3602, 0x62 },
-	{ 0x3620, 0xb7 },
-	{ 0x3622, 0x04 },
-	{ 0x3626, 0x21 },
-	{ 0x3627, 0x30 },
-	{ 0x3630, 0x44 },
-	{ 0x3631, 0x35 },
-	{ 0x3634, 0x60 },
-	{ 0x3636, 0x00 },
-	{ 0x3662, 0x01 },
-	{ 0x3663, 0x70 },
-	{ 0x3664, 0x50 },
-	{ 0x3666, 0x0a },
-	{ 0x3669, 0x1a },
-	{ 0x366a, 0x00 },
-	{ 0x366b, 0x50 },
-	{ 0x3673, 0x01 },
-	{ 0x3674, 0xff },
-	{ 0x3675, 0x03 },
-	{ 0x3705, 0xc1 },
-	{ 0x3709, 0x40 },
-	{ 0x373c, 0x08 },
-	{ 0x3742, 0x00 },
-	{ 0x3757, 0xb3 },
-	{ 0x3788, 0x00 },
-	{ 0x37a8, 0x01 },
-	{ 0x37a9, 0xc0 },
-	{ 0x3800, 0x00 },
-	{ 0x3801, 0x04 },
-	{ 0x3802, 0x00 },
-	{ 0x3803, 0x04 },
-	{ 0x3804, 0x02 },
-	{ 0x3805, 0x8b },
-	{ 0x3806, 0x01 },
-	{ 0x3807, 0xeb },
-	{ 0x3808, 0x02 }, /* width high */
-	{ 0x3809, 0x80 }, /* width low */
-	{ 0x380a, 0x01 }, /* height high */
-	{ 0x380b, 0xe0 }, /* height low */
-	{ 0x380c, 0x03 }, /* total horiz timing high */
-	{ 0x380d, 0xa0 }, /* total horiz timing low */
-	{ 0x380e, 0x06 }, /* total vertical timing high */
-	{ 0x380f, 0xbc }, /* total vertical timing low */
-	{ 0x3810, 0x00 },
-	{ 0x3811, 0x04 },
-	{ 0x3812, 0x00 },
-	{ 0x3813, 0x05 },
-	{ 0x3814, 0x11 },
-	{ 0x3815, 0x11 },
-	{ 0x3820, 0x40 },
-	{ 0x3821, 0x00 },
-	{ 0x382f, 0x0e },
-	{ 0x3832, 0x00 },
-	{ 0x3833, 0x05 },
-	{ 0x3834, 0x00 },
-	{ 0x3835, 0x0c },
-	{ 0x3837, 0x00 },
-	{ 0x3b80, 0x00 },
-	{ 0x3b81, 0xa5 },
-	{ 0x3b82, 0x10 },
-	{ 0x3b83, 0x00 },
-	{ 0x3b84, 0x08 },
-	{ 0x3b85, 0x00 },
-	{ 0x3b86, 0x01 },
-	{ 0x3b87, 0x00 },
-	{ 0x3b88, 0x00 },
-	{ 0x3b89, 0x00 },
-	{ 0x3b8a, 0x00 },
-	{ 0x3b8b, 0x05 },
-	{ 0x3b8c, 0x00 },
-	{ 0x3b8d, 0x00 },
-	{ 0x3b8e, 0x00 },
-	{ 0x3b8f, 0x1a },
-	{ 0x3b94, 0x05 },
-	{ 0x3b95, 0xf2 },
-	{ 0x3b96, 0x40 },
-	{ 0x3c00, 0x89 },
-	{ 0x3c01, 0x63 },
-	{ 0x3c02, 0x01 },
-	{ 0x3c03, 0x00 },
-	{ 0x3c04, 0x00 },
-	{ 0x3c05, 0x03 },
-	{ 0x3c06, 0x00 },
-	{ 0x3c07, 0x06 },
-	{ 0x3c0c, 0x01 },
-	{ 0x3c0d, 0xd0 },
-	{ 0x3c0e, 0x02 },
-	{ 0x3c0f, 0x0a },
-	{ 0x4001, 0x42 },
-	{ 0x4004, 0x04 },
-	{ 0x4005, 0x00 },
-	{ 0x404e, 0x01 },
-	{ 0x4300, 0xff },
-	{ 0x4301, 0x00 },
-	{ 0x4315, 0x00 },
-	{ 0x4501, 0x48 },
-	{ 0x4600, 0x00 },
-	{ 0x4601, 0x4e },
-	{ 0x4801, 0x0f },
-	{ 0x4806, 0x0f },
-	{ 0x4819, 0xaa },
-	{ 0x4823, 0x3e },
-	{ 0x4837, 0x19 },
-	{ 0x4a0d, 0x00 },
-	{ 0x4a47, 0x7f },
-	{ 0x4a49, 0xf0 },
-	{ 0x4a4b, 0x30 },
-	{ 0x5000, 0x85 },
-	{ 0x5001, 0x80 },
+static const struct sensor_seq ov7251_global_init_setting =
+	SENSOR_SEQ(ov7251_global_init_setting_data);
+
+static const u8 ov7251_setting_vga_30fps_data[] = {
+	SENSOR_SEQ_REGS(0x3005, 0x00),
+	SENSOR_SEQ_REGS(0x3012, 0xc0, 0xd2, 0x04),
+	SENSOR_SEQ_REGS(0x3016, 0xf0, 0xf0, 0xf0),
+	SENSOR_SEQ_REGS(0x301a, 0xf0, 0xf0, 0xf0),
+	SENSOR_SEQ_REGS(0x3023, 0x05),
+	SENSOR_SEQ_REGS(0x3037, 0xf0),
+	SENSOR_SEQ_REGS(0x3098,
+			0x04,	/* pll2 pre divider */
+			0x28,	/* pll2 multiplier */
+			0x05,	/* pll2 sys divider */
+			0x04),	/* pll2 adc divider */
+	SENSOR_SEQ_REGS(0x309d,
+			0x00),	/* pll2 divider */
+	SENSOR_SEQ_REGS(0x30b0,
+			0x0a,	/* pll1 pix divider */
+			0x01),	/* pll1 divider */
+	SENSOR_SEQ_REGS(0x30b3,
+			0x64,	/* pll1 multiplier */
+			0x03,	/* pll1 pre divider */
+			0x05),	/* pll1 mipi divider */
+	SENSOR_SEQ_REGS(0x3106, 0xda),
+	SENSOR_SEQ_REGS(0x3503, 0x07),
+	SENSOR_SEQ_REGS(0x3509, 0x10),
+	SENSOR_SEQ_REGS(0x3600, 0x1c),
+	SENSOR_SEQ_REGS(0x3602, 0x62),
+	SENSOR_SEQ_REGS(0x3620, 0xb7),
+	SENSOR_SEQ_REGS(0x3622, 0x04),
+	SENSOR_SEQ_REGS(0x3626, 0x21, 0x30),
+	SENSOR_SEQ_REGS(0x3630, 0x44, 0x35),
+	SENSOR_SEQ_REGS(0x3634, 0x60),
+	SENSOR_SEQ_REGS(0x3636, 0x00),
+	SENSOR_SEQ_REGS(0x3662, 0x01, 0x70, 0x50),
+	SENSOR_SEQ_REGS(0x3666, 0x0a),
+	SENSOR_SEQ_REGS(0x3669, 0x1a, 0x00, 0x50),
+	SENSOR_SEQ_REGS(0x3673, 0x01, 0xff, 0x03),
+	SENSOR_SEQ_REGS(0x3705, 0xc1),
+	SENSOR_SEQ_REGS(0x3709, 0x40),
+	SENSOR_SEQ_REGS(0x373c, 0x08),
+	SENSOR_SEQ_REGS(0x3742, 0x00),
+	SENSOR_SEQ_REGS(0x3757, 0xb3),
+	SENSOR_SEQ_REGS(0x3788, 0x00),
+	SENSOR_SEQ_REGS(0x37a8, 0x01, 0xc0),
+	SENSOR_SEQ_REGS(0x3800,
+			0x00, 0x04, 0x00, 0x04, 0x02, 0x8b, 0x01, 0xeb,
+			0x02,	/* width high */
+			0x80,	/* width low */
+			0x01,	/* height high */
+			0xe0,	/* height low */
+			0x03,	/* total horiz timing high */
+			0xa0,	/* total horiz timing low */
+			0x06,	/* total vertical timing high */
+			0xbc,	/* total vertical timing low */
+			0x00, 0x04, 0x00, 0x05, 0x11, 0x11),
+	SENSOR_SEQ_REGS(0x3820, 0x40, 0x00),
+	SENSOR_SEQ_REGS(0x382f, 0x0e),
+	SENSOR_SEQ_REGS(0x3832, 0x00, 0x05, 0x00, 0x0c),
+	SENSOR_SEQ_REGS(0x3837, 0x00),
+	SENSOR_SEQ_REGS(0x3b80,
+			0x00, 0xa5, 0x10, 0x00, 0x08, 0x00, 0x01, 0x00,
+			0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x1a),
+	SENSOR_SEQ_REGS(0x3b94, 0x05, 0xf2, 0x40),
+	SENSOR_SEQ_REGS(0x3c00, 0x89, 0x63, 0x01, 0x00, 0x00, 0x03, 0x00, 0x06),
+	SENSOR_SEQ_REGS(0x3c0c, 0x01, 0xd0, 0x02, 0x0a),
+	SENSOR_SEQ_REGS(0x4001, 0x42),
+	SENSOR_SEQ_REGS(0x4004, 0x04, 0x00),
+	SENSOR_SEQ_REGS(0x404e, 0x01),
+	SENSOR_SEQ_REGS(0x4300, 0xff, 0x00),
+	SENSOR_SEQ_REGS(0x4315, 0x00),
+	SENSOR_SEQ_REGS(0x4501, 0x48),
+	SENSOR_SEQ_REGS(0x4600, 0x00, 0x4e),
+	SENSOR_SEQ_REGS(0x4801, 0x0f),
+	SENSOR_SEQ_REGS(0x4806, 0x0f),
+	SENSOR_SEQ_REGS(0x4819, 0xaa),
+	SENSOR_SEQ_REGS(0x4823, 0x3e),
+	SENSOR_SEQ_REGS(0x4837, 0x19),
+	SENSOR_SEQ_REGS(0x4a0d, 0x00),
+	SENSOR_SEQ_REGS(0x4a47, 0x7f),
+	SENSOR_SEQ_REGS(0x4a49, 0xf0),
+	SENSOR_SEQ_REGS(0x4a4b, 0x30),
+	SENSOR_SEQ_REGS(0x5000, 0x85, 0x80),
 };
 
-static const struct reg_value ov7251_setting_vga_60fps[] = {
-	{ 0x3005, 0x00 },
-	{ 0x3012, 0xc0 },
-	{ 0x3013, 0xd2 },
-	{ 0x3014, 0x04 },
-	{ 0x3016, 0x10 },
-	{ 0x3017, 0x00 },
-	{ 0x3018, 0x00 },
-	{ 0x301a, 0x00 },
-	{ 0x301b, 0x00 },
-	{ 0x301c, 0x00 },
-	{ 0x3023, 0x05 },
-	{ 0x3037, 0xf0 },
-	{ 0x3098, 0x04 }, /* pll2 pre divider */
-	{ 0x3099, 0x28 }, /* pll2 multiplier */
-	{ 0x309a, 0x05 }, /* pll2 sys divider */
-	{ 0x309b, 0x04 }, /* pll2 adc divider */
-	{ 0x309d, 0x00 }, /* pll2 divider */
-	{ 0x30b0, 0x0a }, /* pll1 pix divider */
-	{ 0x30b1, 0x01 }, /* pll1 divider */
-	{ 0x30b3, 0x64 }, /* pll1 multiplier */
-	{ 0x30b4, 0x03 }, /* pll1 pre divider */
-	{ 0x30b5, 0x05 }, /* pll1 mipi divider */
-	{ 0x3106, 0xda },
-	{ 0x3503, 0x07 },
-	{ 0x3509, 0x10 },
-	{ 0x3600, 0x1c },
-	{ 0x3602, 0x62 },
-	{ 0x3620, 0xb7 },
-	{ 0x3622, 0x04 },
-	{ 0x3626, 0x21 },
-	{ 0x3627, 0x30 },
-	{ 0x3630, 0x44 },
-	{ 0x3631, 0x35 },
-	{ 0x3634, 0x60 },
-	{ 0x3636, 0x00 },
-	{ 0x3662, 0x01 },
-	{ 0x3663, 0x70 },
-	{ 0x3664, 0x50 },
-	{ 0x3666, 0x0a },
-	{ 0x3669, 0x1a },
-	{ 0x366a, 0x00 },
-	{ 0x366b, 0x50 },
-	{ 0x3673, 0x01 },
-	{ 0x3674, 0xff },
-	{ 0x3675, 0x03 },
-	{ 0x3705, 0xc1 },
-	{ 0x3709, 0x40 },
-	{ 0x373c, 0x08 },
-	{ 0x3742, 0x00 },
-	{ 0x3757, 0xb3 },
-	{ 0x3788, 0x00 },
-	{ 0x37a8, 0x01 },
-	{ 0x37a9, 0xc0 },
-	{ 0x3800, 0x00 },
-	{ 0x3801, 0x04 },
-	{ 0x3802, 0x00 },
-	{ 0x3803, 0x04 },
-	{ 0x3804, 0x02 },
-	{ 0x3805, 0x8b },
-	{ 0x3806, 0x01 },
-	{ 0x3807, 0xeb },
-	{ 0x3808, 0x02 }, /* width high */
-	{ 0x3809, 0x80 }, /* width low */
-	{ 0x380a, 0x01 }, /* height high */
-	{ 0x380b, 0xe0 }, /* height low */
-	{ 0x380c, 0x03 }, /* total horiz timing high */
-	{ 0x380d, 0xa0 }, /* total horiz timing low */
-	{ 0x380e, 0x03 }, /* total vertical timing high */
-	{ 0x380f, 0x5c }, /* total vertical timing low */
-	{ 0x3810, 0x00 },
-	{ 0x3811, 0x04 },
-	{ 0x3812, 0x00 },
-	{ 0x3813, 0x05 },
-	{ 0x3814, 0x11 },
-	{ 0x3815, 0x11 },
-	{ 0x3820, 0x40 },
-	{ 0x3821, 0x00 },
-	{ 0x382f, 0x0e },
-	{ 0x3832, 0x00 },
-	{ 0x3833, 0x05 },
-	{ 0x3834, 0x00 },
-	{ 0x3835, 0x0c },
-	{ 0x3837, 0x00 },
-	{ 0x3b80, 0x00 },
-	{ 0x3b81, 0xa5 },
-	{ 0x3b82, 0x10 },
-	{ 0x3b83, 0x00 },
-	{ 0x3b84, 0x08 },
-	{ 0x3b85, 0x00 },
-	{ 0x3b86, 0x01 },
-	{ 0x3b87, 0x00 },
-	{ 0x3b88, 0x00 },
-	{ 0x3b89, 0x00 },
-	{ 0x3b8a, 0x00 },
-	{ 0x3b8b, 0x05 },
-	{ 0x3b8c, 0x00 },
-	{ 0x3b8d, 0x00 },
-	{ 0x3b8e, 0x00 },
-	{ 0x3b8f, 0x1a },
-	{ 0x3b94, 0x05 },
-	{ 0x3b95, 0xf2 },
-	{ 0x3b96, 0x40 },
-	{ 0x3c00, 0x89 },
-	{ 0x3c01, 0x63 },
-	{ 0x3c02, 0x01 },
-	{ 0x3c03, 0x00 },
-	{ 0x3c04, 0x00 },
-	{ 0x3c05, 0x03 },
-	{ 0x3c06, 0x00 },
-	{ 0x3c07, 0x06 },
-	{ 0x3c0c, 0x01 },
-	{ 0x3c0d, 0xd0 },
-	{ 0x3c0e, 0x02 },
-	{ 0x3c0f, 0x0a },
-	{ 0x4001, 0x42 },
-	{ 0x4004, 0x04 },
-	{ 0x4005, 0x00 },
-	{ 0x404e, 0x01 },
-	{ 0x4300, 0xff },
-	{ 0x4301, 0x00 },
-	{ 0x4315, 0x00 },
-	{ 0x4501, 0x48 },
-	{ 0x4600, 0x00 },
-	{ 0x4601, 0x4e },
-	{ 0x4801, 0x0f },
-	{ 0x4806, 0x0f },
-	{ 0x4819, 0xaa },
-	{ 0x4823, 0x3e },
-	{ 0x4837, 0x19 },
-	{ 0x4a0d, 0x00 },
-	{ 0x4a47, 0x7f },
-	{ 0x4a49, 0xf0 },
-	{ 0x4a4b, 0x30 },
-	{ 0x5000, 0x85 },
-	{ 0x5001, 0x80 },
+static const struct sensor_seq ov7251_setting_vga_30fps =
+	SENSOR_SEQ(ov7251_setting_vga_30fps_data);
+
+static const struct sensor_seq_patch ov7251_setting_vga_60fps_patch[] = {
+	SENSOR_SEQ_SET(0x3016, 0x10),
+	SENSOR_SEQ_SET(0x3017, 0x00),
+	SENSOR_SEQ_SET(0x3018, 0x00),
+	SENSOR_SEQ_SET(0x301a, 0x00),
+	SENSOR_SEQ_SET(0x301b, 0x00),
+	SENSOR_SEQ_SET(0x301c, 0x00),
+	SENSOR_SEQ_SET(0x380e, 0x03),	/* total vertical timing high */
+	SENSOR_SEQ_SET(0x380f, 0x5c),	/* total vertical timing low */
 };
 
-static const struct reg_value ov7251_setting_vga_90fps[] = {
-	{ 0x3005, 0x00 },
-	{ 0x3012, 0xc0 },
-	{ 0x3013, 0xd2 },
-	{ 0x3014, 0x04 },
-	{ 0x3016, 0x10 },
-	{ 0x3017, 0x00 },
-	{ 0x3018, 0x00 },
-	{ 0x301a, 0x00 },
-	{ 0x301b, 0x00 },
-	{ 0x301c, 0x00 },
-	{ 0x3023, 0x05 },
-	{ 0x3037, 0xf0 },
-	{ 0x3098, 0x04 }, /* pll2 pre divider */
-	{ 0x3099, 0x28 }, /* pll2 multiplier */
-	{ 0x309a, 0x05 }, /* pll2 sys divider */
-	{ 0x309b, 0x04 }, /* pll2 adc divider */
-	{ 0x309d, 0x00 }, /* pll2 divider */
-	{ 0x30b0, 0x0a }, /* pll1 pix divider */
-	{ 0x30b1, 0x01 }, /* pll1 divider */
-	{ 0x30b3, 0x64 }, /* pll1 multiplier */
-	{ 0x30b4, 0x03 }, /* pll1 pre divider */
-	{ 0x30b5, 0x05 }, /* pll1 mipi divider */
-	{ 0x3106, 0xda },
-	{ 0x3503, 0x07 },
-	{ 0x3509, 0x10 },
-	{ 0x3600, 0x1c },
-	{ 0x3602, 0x62 },
-	{ 0x3620, 0xb7 },
-	{ 0x3622, 0x04 },
-	{ 0x3626, 0x21 },
-	{ 0x3627, 0x30 },
-	{ 0x3630, 0x44 },
-	{ 0x3631, 0x35 },
-	{ 0x3634, 0x60 },
-	{ 0x3636, 0x00 },
-	{ 0x3662, 0x01 },
-	{ 0x3663, 0x70 },
-	{ 0x3664, 0x50 },
-	{ 0x3666, 0x0a },
-	{ 0x3669, 0x1a },
-	{ 0x366a, 0x00 },
-	{ 0x366b, 0x50 },
-	{ 0x3673, 0x01 },
-	{ 0x3674, 0xff },
-	{ 0x3675, 0x03 },
-	{ 0x3705, 0xc1 },
-	{ 0x3709, 0x40 },
-	{ 0x373c, 0x08 },
-	{ 0x3742, 0x00 },
-	{ 0x3757, 0xb3 },
-	{ 0x3788, 0x00 },
-	{ 0x37a8, 0x01 },
-	{ 0x37a9, 0xc0 },
-	{ 0x3800, 0x00 },
-	{ 0x3801, 0x04 },
-	{ 0x3802, 0x00 },
-	{ 0x3803, 0x04 },
-	{ 0x3804, 0x02 },
-	{ 0x3805, 0x8b },
-	{ 0x3806, 0x01 },
-	{ 0x3807, 0xeb },
-	{ 0x3808, 0x02 }, /* width high */
-	{ 0x3809, 0x80 }, /* width low */
-	{ 0x380a, 0x01 }, /* height high */
-	{ 0x380b, 0xe0 }, /* height low */
-	{ 0x380c, 0x03 }, /* total horiz timing high */
-	{ 0x380d, 0xa0 }, /* total horiz timing low */
-	{ 0x380e, 0x02 }, /* total vertical timing high */
-	{ 0x380f, 0x3c }, /* total vertical timing low */
-	{ 0x3810, 0x00 },
-	{ 0x3811, 0x04 },
-	{ 0x3812, 0x00 },
-	{ 0x3813, 0x05 },
-	{ 0x3814, 0x11 },
-	{ 0x3815, 0x11 },
-	{ 0x3820, 0x40 },
-	{ 0x3821, 0x00 },
-	{ 0x382f, 0x0e },
-	{ 0x3832, 0x00 },
-	{ 0x3833, 0x05 },
-	{ 0x3834, 0x00 },
-	{ 0x3835, 0x0c },
-	{ 0x3837, 0x00 },
-	{ 0x3b80, 0x00 },
-	{ 0x3b81, 0xa5 },
-	{ 0x3b82, 0x10 },
-	{ 0x3b83, 0x00 },
-	{ 0x3b84, 0x08 },
-	{ 0x3b85, 0x00 },
-	{ 0x3b86, 0x01 },
-	{ 0x3b87, 0x00 },
-	{ 0x3b88, 0x00 },
-	{ 0x3b89, 0x00 },
-	{ 0x3b8a, 0x00 },
-	{ 0x3b8b, 0x05 },
-	{ 0x3b8c, 0x00 },
-	{ 0x3b8d, 0x00 },
-	{ 0x3b8e, 0x00 },
-	{ 0x3b8f, 0x1a },
-	{ 0x3b94, 0x05 },
-	{ 0x3b95, 0xf2 },
-	{ 0x3b96, 0x40 },
-	{ 0x3c00, 0x89 },
-	{ 0x3c01, 0x63 },
-	{ 0x3c02, 0x01 },
-	{ 0x3c03, 0x00 },
-	{ 0x3c04, 0x00 },
-	{ 0x3c05, 0x03 },
-	{ 0x3c06, 0x00 },
-	{ 0x3c07, 0x06 },
-	{ 0x3c0c, 0x01 },
-	{ 0x3c0d, 0xd0 },
-	{ 0x3c0e, 0x02 },
-	{ 0x3c0f, 0x0a },
-	{ 0x4001, 0x42 },
-	{ 0x4004, 0x04 },
-	{ 0x4005, 0x00 },
-	{ 0x404e, 0x01 },
-	{ 0x4300, 0xff },
-	{ 0x4301, 0x00 },
-	{ 0x4315, 0x00 },
-	{ 0x4501, 0x48 },
-	{ 0x4600, 0x00 },
-	{ 0x4601, 0x4e },
-	{ 0x4801, 0x0f },
-	{ 0x4806, 0x0f },
-	{ 0x4819, 0xaa },
-	{ 0x4823, 0x3e },
-	{ 0x4837, 0x19 },
-	{ 0x4a0d, 0x00 },
-	{ 0x4a47, 0x7f },
-	{ 0x4a49, 0xf0 },
-	{ 0x4a4b, 0x30 },
-	{ 0x5000, 0x85 },
-	{ 0x5001, 0x80 },
+static const struct sensor_seq ov7251_setting_vga_60fps =
+	SENSOR_SEQ_PATCHED(ov7251_setting_vga_30fps_data,
+			   ov7251_setting_vga_60fps_patch);
+
+static const struct sensor_seq_patch ov7251_setting_vga_90fps_patch[] = {
+	SENSOR_SEQ_SET(0x3016, 0x10),
+	SENSOR_SEQ_SET(0x3017, 0x00),
+	SENSOR_SEQ_SET(0x3018, 0x00),
+	SENSOR_SEQ_SET(0x301a, 0x00),
+	SENSOR_SEQ_SET(0x301b, 0x00),
+	SENSOR_SEQ_SET(0x301c, 0x00),
+	SENSOR_SEQ_SET(0x380e, 0x02),	/* total vertical timing high */
+	SENSOR_SEQ_SET(0x380f, 0x3c),	/* total vertical timing low */
 };
 
+static const struct sensor_seq ov7251_setting_vga_90fps =
+	SENSOR_SEQ_PATCHED(ov7251_setting_vga_30fps_data,
+			   ov7251_setting_vga_90fps_patch);
+
+/* Data lanes of the sensor */
+#define OV7251_DATA_LANES	1
+
+/* The lowest one that carries a mode is selected for it */
 static const s64 link_freq[] = {
 	240000000,
 };
@@ -539,11 +315,9 @@ static const struct ov7251_mode_info ov7251_mode_info_data[] = {
 	{
 		.width = 640,
 		.height = 480,
-		.data = ov7251_setting_vga_30fps,
-		.data_size = ARRAY_SIZE(ov7251_setting_vga_30fps),
+		.data = &ov7251_setting_vga_30fps,
 		.pixel_clock = 48000000,
-		.link_freq = 0, /* an index in link_freq[] */
-		.exposure_max = 1704,
+		.vts = 0x6bc,
 		.exposure_def = 504,
 		.timeperframe = {
 			.numerator = 100,
@@ -553,11 +327,9 @@ static const struct ov7251_mode_info ov7251_mode_info_data[] = {
 	{
 		.width = 640,
 		.height = 480,
-		.data = ov7251_setting_vga_60fps,
-		.data_size = ARRAY_SIZE(ov7251_setting_vga_60fps),
+		.data = &ov7251_setting_vga_60fps,
 		.pixel_clock = 48000000,
-		.link_freq = 0, /* an index in link_freq[] */
-		.exposure_max = 840,
+		.vts = 0x35c,
 		.exposure_def = 504,
 		.timeperframe = {
 			.numerator = 100,
@@ -567,11 +339,9 @@ static const struct ov7251_mode_info ov7251_mode_info_data[] = {
 	{
 		.width = 640,
 		.height = 480,
-		.data = ov7251_setting_vga_90fps,
-		.data_size = ARRAY_SIZE(ov7251_setting_vga_90fps),
+		.data = &ov7251_setting_vga_90fps,
 		.pixel_clock = 48000000,
-		.link_freq = 0, /* an index in link_freq[] */
-		.exposure_max = 552,
+		.vts = 0x23c,
 		.exposure_def = 504,
 		.timeperframe = {
 			.numerator = 100,
@@ -581,11 +351,9 @@ static const struct ov7251_mode_info ov7251_mode_info_data[] = {
 	{
 		.width = 720,
 		.height = 540,
-		.data = ov7251_setting_vga_90fps,
-		.data_size = ARRAY_SIZE(ov7251_setting_vga_90fps),
+		.data = &ov7251_setting_vga_90fps,
 		.pixel_clock = 48000000,
-		.link_freq = 0, /* an index in link_freq[] */
-		.exposure_max = 552,
+		.vts = 0x23c,
 		.exposure_def = 504,
 		.timeperframe = {
 			.numerator = 100,
@@ -648,172 +416,194 @@ static void ov7251_regulators_disable(struct ov7251 *ov7251)
 		dev_err(ov7251->dev, "io regulator disable failed\n");
 }
 
+/* i2c_master_send() and i2c_master_recv() counted in ov7251->stats */
 static int ov7251_write_reg(struct ov7251 *ov7251, u16 reg, u8 val)
 {
-	u8 regbuf[3];
-	int ret;
-
-	regbuf[0] = reg >> 8;
-	regbuf[1] = reg & 0xff;
-	regbuf[2] = val;
-
-	ret = i2c_master_send(ov7251->i2c_client, regbuf, 3);
-	if (ret < 0) {
-		dev_err(ov7251->dev, "%s: write reg error %d: reg=%x, val=%x\n",
-			__func__, ret, reg, val);
-		return ret;
-	}
-
-	return 0;
+	return sensor_reg_write8(&ov7251->i2c, reg, val);
 }
 
-static int ov7251_write_seq_regs(struct ov7251 *ov7251, u16 reg, u8 *val,
-				 u8 num)
+static int ov7251_read_reg(struct ov7251 *ov7251, u16 reg, u8 *val)
 {
-	u8 regbuf[5];
-	u8 nregbuf = sizeof(reg) + num * sizeof(*val);
-	int ret = 0;
-
-	if (nregbuf > sizeof(regbuf))
-		return -EINVAL;
-
-	regbuf[0] = reg >> 8;
-	regbuf[1] = reg & 0xff;
+	return sensor_reg_read8(&ov7251->i2c, reg, val);
+}
 
-	memcpy(regbuf + 2, val, num);
+static int ov7251_set_exposure(struct ov7251 *ov7251, s32 exposure)
+{
+	/* EXPO_0..2 hold exposure[15:12], [11:4] and [3:0] << 4 */
+	return sensor_reg_write24(&ov7251->i2c, OV7251_AEC_EXPO_0,
+				  (exposure & 0xffff) << 4);
+}
 
-	ret = i2c_master_send(ov7251->i2c_client, regbuf, nregbuf);
-	if (ret < 0) {
-		dev_err(ov7251->dev,
-			"%s: write seq regs error %d: first reg=%x\n",
-			__func__, ret, reg);
-		return ret;
-	}
+static int ov7251_set_gain(struct ov7251 *ov7251, s32 gain)
+{
+	/* AGC_ADJ_0..1 hold gain[9:8] and [7:0] */
+	return sensor_reg_write16(&ov7251->i2c, OV7251_AEC_AGC_ADJ_0,
+				  gain & 0x03ff);
+}
 
-	return 0;
+static int ov7251_set_vts(struct ov7251 *ov7251, u16 vts)
+{
+	return sensor_reg_write16(&ov7251->i2c, OV7251_TIMING_VTS, vts);
 }
 
-static int ov7251_read_reg(struct ov7251 *ov7251, u16 reg, u8 *val)
+static const struct sensor_prog *
+ov7251_register_array_prog(struct ov7251 *ov7251,
+			   const struct sensor_seq *settings)
 {
-	u8 regbuf[2];
-	int ret;
+	unsigned int i;
 
-	regbuf[0] = reg >> 8;
-	regbuf[1] = reg & 0xff;
+	if (settings == &ov7251_global_init_setting)
+		return &ov7251->global_prog;
 
-	ret = i2c_master_send(ov7251->i2c_client, regbuf, 2);
-	if (ret < 0) {
-		dev_err(ov7251->dev, "%s: write reg error %d: reg=%x\n",
-			__func__, ret, reg);
-		return ret;
-	}
+	if (!ov7251->mode_progs)
+		return NULL;
 
-	ret = i2c_master_recv(ov7251->i2c_client, val, 1);
-	if (ret < 0) {
-		dev_err(ov7251->dev, "%s: read reg error %d: reg=%x\n",
-			__func__, ret, reg);
-		return ret;
-	}
+	for (i = 0; i < ARRAY_SIZE(ov7251_mode_info_data); i++)
+		if (settings == ov7251_mode_info_data[i].data)
+			return &ov7251->mode_progs[i];
 
-	return 0;
+	return NULL;
 }
 
-static int ov7251_set_exposure(struct ov7251 *ov7251, s32 exposure)
+static int ov7251_set_register_array(struct ov7251 *ov7251,
+				     const struct sensor_seq *settings)
 {
-	u16 reg;
-	u8 val[3];
+	const struct sensor_prog *prog;
+	struct sensor_burst burst;
+	int ret;
 
-	reg = OV7251_AEC_EXPO_0;
-	val[0] = (exposure & 0xf000) >> 12; /* goes to OV7251_AEC_EXPO_0 */
-	val[1] = (exposure & 0x0ff0) >> 4;  /* goes to OV7251_AEC_EXPO_1 */
-	val[2] = (exposure & 0x000f) << 4;  /* goes to OV7251_AEC_EXPO_2 */
+	prog = ov7251_register_array_prog(ov7251, settings);
+	if (prog && prog->msgs)
+		return sensor_prog_load(ov7251->i2c_client, prog,
+					&ov7251->shadow, &ov7251->stats);
 
-	return ov7251_write_seq_regs(ov7251, reg, val, 3);
-}
+	trace_sensor_stage_begin(ov7251->dev, "load_regs");
 
-static int ov7251_set_gain(struct ov7251 *ov7251, s32 gain)
-{
-	u16 reg;
-	u8 val[2];
+	sensor_burst_init(&burst, ov7251->i2c_client);
+	burst.shadow = &ov7251->shadow;
+	burst.stats = &ov7251->stats;
+	ret = sensor_seq_walk(&burst, settings);
+	if (!ret)
+		ret = sensor_burst_flush(&burst);
 
-	reg = OV7251_AEC_AGC_ADJ_0;
-	val[0] = (gain & 0x0300) >> 8; /* goes to OV7251_AEC_AGC_ADJ_0 */
-	val[1] = gain & 0xff;          /* goes to OV7251_AEC_AGC_ADJ_1 */
+	trace_sensor_stage_end(ov7251->dev, "load_regs", burst.nr_regs,
+			       burst.nr_bytes, ret);
 
-	return ov7251_write_seq_regs(ov7251, reg, val, 2);
+	return ret;
 }
 
-static int ov7251_set_register_array(struct ov7251 *ov7251,
-				     const struct reg_value *settings,
-				     unsigned int num_settings)
+/*
+ * Precompile the init table and all the mode tables so that loading a
+ * mode is just a few i2c_transfer() calls.
+ */
+static int ov7251_build_progs(struct ov7251 *ov7251)
 {
+	struct i2c_client *client = ov7251->i2c_client;
 	unsigned int i;
 	int ret;
 
-	for (i = 0; i < num_settings; ++i, ++settings) {
-		ret = ov7251_write_reg(ov7251, settings->reg, settings->val);
-		if (ret < 0)
+	ret = sensor_prog_build(client, &ov7251->global_prog,
+				sensor_seq_walk, &ov7251_global_init_setting);
+	if (ret)
+		return ret;
+
+	ov7251->mode_progs = devm_kcalloc(ov7251->dev,
+					  ARRAY_SIZE(ov7251_mode_info_data),
+					  sizeof(*ov7251->mode_progs),
+					  GFP_KERNEL);
+	if (!ov7251->mode_progs)
+		return -ENOMEM;
+
+	for (i = 0; i < ARRAY_SIZE(ov7251_mode_info_data); i++) {
+		ret = sensor_prog_build(client, &ov7251->mode_progs[i],
+					sensor_seq_walk,
+					ov7251_mode_info_data[i].data);
+		if (ret)
 			return ret;
 	}
 
 	return 0;
 }
 
-/* Get GPIOs defined in dep_dev _CRS */
-static int gpio_crs_get(struct ov7251 *sensor, struct device *dep_dev)
+static int ov7251_modes_show(struct seq_file *m, void *data)
 {
-	sensor->dep_gpios = devm_gpiod_get_array(dep_dev, NULL, GPIOD_ASIS);
-	if (IS_ERR(sensor->dep_gpios)) {
-		dev_err(dep_dev, "Failed to get GPIOs\n");
-		return -ENODEV;
+	struct ov7251 *ov7251 = m->private;
+	const struct ov7251_mode_info *mode;
+	char name[24];
+	unsigned int i;
+
+	sensor_prog_seq_header(m);
+	sensor_prog_seq_show(m, "global", &ov7251->global_prog);
+	for (i = 0; i < ARRAY_SIZE(ov7251_mode_info_data); i++) {
+		mode = &ov7251_mode_info_data[i];
+		snprintf(name, sizeof(name), "%ux%u@%u", mode->width,
+			 mode->height, mode->timeperframe.denominator /
+			 mode->timeperframe.numerator);
+		sensor_prog_seq_show(m, name, &ov7251->mode_progs[i]);
 	}
 
 	return 0;
 }
+DEFINE_SHOW_ATTRIBUTE(ov7251_modes);
 
-/* Put GPIOs defined in dep_dev _CRS */
-static void gpio_crs_put(struct ov7251 *sensor)
-{
-	gpiod_put_array(sensor->dep_gpios);
-}
-
-/* Control GPIOs defined in dep_dev _CRS */
-static int gpio_crs_ctrl(struct ov7251 *sensor, bool flag)
+static void ov7251_set_power_off(struct ov7251 *ov7251)
 {
-	struct gpio_descs *d = sensor->dep_gpios;
-	unsigned long *values;
+	sensor_shadow_invalidate(&ov7251->shadow);
+	ov7251->loaded_mode = NULL;
 
-	values = bitmap_alloc(d->ndescs, GFP_KERNEL);
-	if (!values)
-		return -ENOMEM;
+	trace_sensor_stage_begin(ov7251->dev, "gpio");
 
-	if (flag)
-		bitmap_fill(values, d->ndescs);
-	else
-		bitmap_zero(values, d->ndescs);
+	/* For DT-based systems */
+	if (!ov7251->is_acpi_based) {
+		clk_disable_unprepare(ov7251->xclk);
+		gpiod_set_value_cansleep(ov7251->enable_gpio, 0);
+		ov7251_regulators_disable(ov7251);
+	}
 
-	gpiod_set_array_value_cansleep(d->ndescs, d->desc,
-				       d->info, values);
+	/* For ACPI-based systems */
+	if (ov7251->is_acpi_based)
+		sensor_gpios_set(&ov7251->dep_gpios, false);
 
-	return 0;
+	trace_sensor_stage_end(ov7251->dev, "gpio", 0, 0, 0);
 }
 
+/*
+ * The sensor answers on SCCB 65536 XVCLK cycles after power up, a settle
+ * time of 0 stands for that. The supplies behind the PMIC GPIOs may take
+ * longer to come up, the chip ID is polled for that.
+ */
+static struct sensor_power_timing ov7251_power_timing = {
+	.poll_us = SENSOR_POWER_POLL_US,
+	.timeout_us = 20000,
+};
+module_param_named(power_settle_us, ov7251_power_timing.settle_us, uint,
+		   0644);
+MODULE_PARM_DESC(power_settle_us,
+		 "Wait before the first access, 0 for 65536 XVCLK cycles");
+module_param_named(power_poll_us, ov7251_power_timing.poll_us, uint, 0644);
+MODULE_PARM_DESC(power_poll_us, "Interval of the chip ID reads at power on");
+module_param_named(power_timeout_us, ov7251_power_timing.timeout_us, uint,
+		   0644);
+MODULE_PARM_DESC(power_timeout_us, "Longest chip ID poll at power on");
+
 static int ov7251_set_power_on(struct ov7251 *ov7251)
 {
-	int ret;
-	u32 wait_us;
+	struct sensor_power_timing timing = ov7251_power_timing;
+	int ret = 0;
+
+	trace_sensor_stage_begin(ov7251->dev, "gpio");
 
 	/* For DT-based systems */
 	if (!ov7251->is_acpi_based) {
 		ret = ov7251_regulators_enable(ov7251);
 		if (ret < 0)
-			return ret;
+			goto out;
 
 		ret = clk_prepare_enable(ov7251->xclk);
 		if (ret < 0) {
 			dev_err(ov7251->dev, "clk prepare enable failed\n");
 			ov7251_regulators_disable(ov7251);
-			return ret;
+			goto out;
 		}
 
 		gpiod_set_value_cansleep(ov7251->enable_gpio, 1);
@@ -821,28 +611,26 @@ static int ov7251_set_power_on(struct ov7251 *ov7251)
 
 	/* For ACPI-based systems */
 	if (ov7251->is_acpi_based)
-		gpio_crs_ctrl(ov7251, true);
+		sensor_gpios_set(&ov7251->dep_gpios, true);
 
-	/* wait at least 65536 external clock cycles */
-	wait_us = DIV_ROUND_UP(65536 * 1000,
-			       DIV_ROUND_UP(ov7251->xclk_freq, 1000));
-	usleep_range(wait_us, wait_us + 1000);
+out:
+	trace_sensor_stage_end(ov7251->dev, "gpio", 0, 0, ret);
+	if (ret < 0)
+		return ret;
 
-	return 0;
-}
+	if (!timing.settle_us)
+		timing.settle_us = SENSOR_POWER_CYCLES_US(65536,
+							  ov7251->xclk_freq);
 
-static void ov7251_set_power_off(struct ov7251 *ov7251)
-{
-	/* For DT-based systems */
-	if (!ov7251->is_acpi_based) {
-		clk_disable_unprepare(ov7251->xclk);
-		gpiod_set_value_cansleep(ov7251->enable_gpio, 0);
-		ov7251_regulators_disable(ov7251);
-	}
+	trace_sensor_stage_begin(ov7251->dev, "power_delay");
+	ret = sensor_power_wait(&ov7251->i2c, &timing, OV7251_CHIP_ID_HIGH,
+				OV7251_CHIP_ID_HIGH_BYTE << 8 |
+				OV7251_CHIP_ID_LOW_BYTE, 2);
+	trace_sensor_stage_end(ov7251->dev, "power_delay", 0, 0, ret);
+	if (ret < 0)
+		ov7251_set_power_off(ov7251);
 
-	/* For ACPI-based systems */
-	if (ov7251->is_acpi_based)
-		gpio_crs_ctrl(ov7251, false);
+	return ret;
 }
 
 static int ov7251_s_power(struct v4l2_subdev *sd, int on)
@@ -862,8 +650,7 @@ static int ov7251_s_power(struct v4l2_subdev *sd, int on)
 			goto exit;
 
 		ret = ov7251_set_register_array(ov7251,
-					ov7251_global_init_setting,
-					ARRAY_SIZE(ov7251_global_init_setting));
+						&ov7251_global_init_setting);
 		if (ret < 0) {
 			dev_err(ov7251->dev, "could not set init registers\n");
 			ov7251_set_power_off(ov7251);
@@ -882,6 +669,20 @@ exit:
 	return ret;
 }
 
+static int ov7251_runtime_suspend(struct device *dev)
+{
+	struct v4l2_subdev *sd = dev_get_drvdata(dev);
+
+	return ov7251_s_power(sd, false);
+}
+
+static int ov7251_runtime_resume(struct device *dev)
+{
+	struct v4l2_subdev *sd = dev_get_drvdata(dev);
+
+	return ov7251_s_power(sd, true);
+}
+
 static int ov7251_set_hflip(struct ov7251 *ov7251, s32 value)
 {
 	u8 val = ov7251->timing_format2;
@@ -938,23 +739,92 @@ static const char * const ov7251_test_pattern_menu[] = {
 	"Vertical Pattern Bars",
 };
 
-static int ov7251_s_ctrl(struct v4l2_ctrl *ctrl)
+/*
+ * Frame interval and exposure limit of the current mode, extended by
+ * @vblank lines over its height. The line length is fixed at
+ * OV7251_TIMING_HTS pixel clocks in all mode tables.
+ */
+static int ov7251_update_vblank(struct ov7251 *ov7251, u32 vblank)
 {
-	struct ov7251 *ov7251 = container_of(ctrl->handler,
-					     struct ov7251, ctrls);
+	const struct ov7251_mode_info *mode = ov7251->current_mode;
+	u32 vts = mode->height + vblank;
+	u32 exposure_max = vts - OV7251_EXPOSURE_MARGIN;
+
 	int ret;
 
-	/* v4l2_ctrl_lock() locks our mutex */
+	ov7251->frame_interval.numerator = OV7251_TIMING_HTS * vts;
+	ov7251->frame_interval.denominator = mode->pixel_clock;
 
-	if (!ov7251->power_on)
+	mutex_lock(&ov7251->ae_lock);
+	ret = __v4l2_ctrl_modify_range(ov7251->exposure, 1, exposure_max, 1,
+				       min_t(u32, mode->exposure_def,
+					     exposure_max));
+	mutex_unlock(&ov7251->ae_lock);
+
+	return ret;
+}
+
+/*
+ * Exposure and gain, with ae_lock held. Before the stream is on, the value
+ * is only kept: the mode may be loading under ov7251->lock, and
+ * ov7251_stream_on() writes the latest exposure and gain together right
+ * before the stream on.
+ */
+static int ov7251_s_ae_ctrl(struct v4l2_ctrl *ctrl)
+{
+	struct ov7251 *ov7251 = container_of(ctrl->handler,
+					     struct ov7251, ae_ctrls);
+	int ret;
+
+	if (!ov7251->ae_live)
 		return 0;
 
 	switch (ctrl->id) {
 	case V4L2_CID_EXPOSURE:
 		ret = ov7251_set_exposure(ov7251, ctrl->val);
+		if (!ret)
+			sensor_meta_queue(&ov7251->meta, SENSOR_META_EXPOSURE,
+					  ctrl->val);
 		break;
 	case V4L2_CID_GAIN:
 		ret = ov7251_set_gain(ov7251, ctrl->val);
+		if (!ret)
+			sensor_meta_queue(&ov7251->meta, SENSOR_META_GAIN,
+					  ctrl->val);
+		break;
+	default:
+		ret = -EINVAL;
+		break;
+	}
+
+	return ret;
+}
+
+static int ov7251_s_ctrl(struct v4l2_ctrl *ctrl)
+{
+	struct ov7251 *ov7251 = container_of(ctrl->handler,
+					     struct ov7251, ctrls);
+	u16 vts;
+	int ret;
+
+	/* v4l2_ctrl_lock() locks our mutex */
+
+	/* The frame length bounds the exposure, with or without power */
+	if (ctrl->id == V4L2_CID_VBLANK) {
+		ret = ov7251_update_vblank(ov7251, ctrl->val);
+		if (ret < 0)
+			return ret;
+	}
+
+	if (!ov7251->power_on)
+		return 0;
+
+	switch (ctrl->id) {
+	case V4L2_CID_VBLANK:
+		vts = ov7251->current_mode->height + ctrl->val;
+		ret = ov7251_set_vts(ov7251, vts);
+		if (!ret)
+			sensor_meta_queue(&ov7251->meta, SENSOR_META_VTS, vts);
 		break;
 	case V4L2_CID_TEST_PATTERN:
 		ret = ov7251_set_test_pattern(ov7251, ctrl->val);
@@ -977,6 +847,10 @@ static const struct v4l2_ctrl_ops ov7251_ctrl_ops = {
 	.s_ctrl = ov7251_s_ctrl,
 };
 
+static const struct v4l2_ctrl_ops ov7251_ae_ctrl_ops = {
+	.s_ctrl = ov7251_s_ae_ctrl,
+};
+
 static int ov7251_enum_mbus_code(struct v4l2_subdev *sd,
 				 struct v4l2_subdev_pad_config *cfg,
 				 struct v4l2_subdev_mbus_code_enum *code)
@@ -989,34 +863,83 @@ static int ov7251_enum_mbus_code(struct v4l2_subdev *sd,
 	return 0;
 }
 
+/* Bits per second of @mode on the link, all modes have the same HTS */
+static u64 ov7251_mode_bps(const struct ov7251_mode_info *mode)
+{
+	return sensor_link_bps(mode->width, 10, mode->pixel_clock,
+			       OV7251_TIMING_HTS);
+}
+
+static bool ov7251_mode_fits(struct ov7251 *ov7251,
+			     const struct ov7251_mode_info *mode)
+{
+	return sensor_link_select(&ov7251->link, ov7251_mode_bps(mode),
+				  NULL) >= 0;
+}
+
+/* Mode nearest to @width x @height that the link carries, NULL if none */
+static const struct ov7251_mode_info *
+ov7251_find_mode(struct ov7251 *ov7251, u32 width, u32 height)
+{
+	const struct ov7251_mode_info *mode = NULL;
+	u32 dist, min_dist = U32_MAX;
+	unsigned int i;
+
+	for (i = 0; i < ARRAY_SIZE(ov7251_mode_info_data); i++) {
+		if (!ov7251_mode_fits(ov7251, &ov7251_mode_info_data[i]))
+			continue;
+
+		dist = abs((int)ov7251_mode_info_data[i].width - (int)width) +
+		       abs((int)ov7251_mode_info_data[i].height - (int)height);
+		if (dist < min_dist) {
+			mode = &ov7251_mode_info_data[i];
+			min_dist = dist;
+		}
+	}
+
+	return mode;
+}
+
 static int ov7251_enum_frame_size(struct v4l2_subdev *subdev,
 				  struct v4l2_subdev_pad_config *cfg,
 				  struct v4l2_subdev_frame_size_enum *fse)
 {
+	struct ov7251 *ov7251 = to_ov7251(subdev);
+	unsigned int index = fse->index;
+	unsigned int i;
+
 	if (fse->code != MEDIA_BUS_FMT_SGRBG10_1X10)
 		return -EINVAL;
 
-	if (fse->index >= ARRAY_SIZE(ov7251_mode_info_data))
-		return -EINVAL;
+	/* Only the modes the link carries */
+	for (i = 0; i < ARRAY_SIZE(ov7251_mode_info_data); i++) {
+		if (!ov7251_mode_fits(ov7251, &ov7251_mode_info_data[i]))
+			continue;
 
-	fse->min_width = ov7251_mode_info_data[fse->index].width;
-	fse->max_width = ov7251_mode_info_data[fse->index].width;
-	fse->min_height = ov7251_mode_info_data[fse->index].height;
-	fse->max_height = ov7251_mode_info_data[fse->index].height;
+		if (index-- == 0) {
+			fse->min_width = ov7251_mode_info_data[i].width;
+			fse->max_width = ov7251_mode_info_data[i].width;
+			fse->min_height = ov7251_mode_info_data[i].height;
+			fse->max_height = ov7251_mode_info_data[i].height;
+			return 0;
+		}
+	}
 
-	return 0;
+	return -EINVAL;
 }
 
 static int ov7251_enum_frame_ival(struct v4l2_subdev *subdev,
 				  struct v4l2_subdev_pad_config *cfg,
 				  struct v4l2_subdev_frame_interval_enum *fie)
 {
+	struct ov7251 *ov7251 = to_ov7251(subdev);
 	unsigned int index = fie->index;
 	unsigned int i;
 
 	for (i = 0; i < ARRAY_SIZE(ov7251_mode_info_data); i++) {
 		if (fie->width != ov7251_mode_info_data[i].width ||
-		    fie->height != ov7251_mode_info_data[i].height)
+		    fie->height != ov7251_mode_info_data[i].height ||
+		    !ov7251_mode_fits(ov7251, &ov7251_mode_info_data[i]))
 			continue;
 
 		if (index-- == 0) {
@@ -1090,7 +1013,8 @@ ov7251_find_mode_by_ival(struct ov7251 *ov7251, struct v4l2_fract *timeperframe)
 		unsigned int fps_tmp;
 
 		if (mode->width != ov7251_mode_info_data[i].width ||
-		    mode->height != ov7251_mode_info_data[i].height)
+		    mode->height != ov7251_mode_info_data[i].height ||
+		    !ov7251_mode_fits(ov7251, &ov7251_mode_info_data[i]))
 			continue;
 
 		fps_tmp = avg_fps(&ov7251_mode_info_data[i].timeperframe);
@@ -1106,6 +1030,68 @@ ov7251_find_mode_by_ival(struct ov7251 *ov7251, struct v4l2_fract *timeperframe)
 	return &ov7251_mode_info_data[n];
 }
 
+/*
+ * Make @mode the active one: its pixel rate, the VBLANK and exposure
+ * ranges of its frame size, and its default exposure, VBLANK and gain.
+ * current_mode goes first, the VBLANK control handler reads it.
+ */
+static int ov7251_apply_mode(struct ov7251 *ov7251,
+			     const struct ov7251_mode_info *mode)
+{
+	u32 vblank_def = mode->vts - mode->height;
+	int ret;
+
+	ov7251->current_mode = mode;
+
+	ret = __v4l2_ctrl_s_ctrl_int64(ov7251->pixel_clock, mode->pixel_clock);
+	if (ret < 0)
+		return ret;
+
+	ret = sensor_link_apply(&ov7251->link, ov7251->link_freq,
+				ov7251_mode_bps(mode));
+	if (ret < 0)
+		return ret;
+
+	ret = __v4l2_ctrl_modify_range(ov7251->vblank, vblank_def,
+				       OV7251_TIMING_VTS_MAX - mode->height,
+				       1, vblank_def);
+	if (ret < 0)
+		return ret;
+
+	ret = __v4l2_ctrl_s_ctrl(ov7251->vblank, vblank_def);
+	if (ret < 0)
+		return ret;
+
+	/* Not called above if VBLANK didn't change, but the mode did */
+	ret = ov7251_update_vblank(ov7251, vblank_def);
+	if (ret < 0)
+		return ret;
+
+	mutex_lock(&ov7251->ae_lock);
+	ret = __v4l2_ctrl_s_ctrl(ov7251->exposure, mode->exposure_def);
+	if (ret >= 0)
+		ret = __v4l2_ctrl_s_ctrl(ov7251->gain, 16);
+	mutex_unlock(&ov7251->ae_lock);
+
+	return ret;
+}
+
+/* VBLANK giving @interval in @mode, within the range of the control */
+static u32 ov7251_vblank_for_interval(const struct ov7251_mode_info *mode,
+				      const struct v4l2_fract *interval)
+{
+	u64 vts;
+
+	if (!interval->denominator)
+		return mode->vts - mode->height;
+
+	vts = div64_u64((u64)interval->numerator * mode->pixel_clock,
+			(u64)interval->denominator * OV7251_TIMING_HTS);
+	vts = clamp_t(u64, vts, mode->vts, OV7251_TIMING_VTS_MAX);
+
+	return vts - mode->height;
+}
+
 static int ov7251_set_format(struct v4l2_subdev *sd,
 			     struct v4l2_subdev_pad_config *cfg,
 			     struct v4l2_subdev_format *format)
@@ -1120,41 +1106,17 @@ static int ov7251_set_format(struct v4l2_subdev *sd,
 
 	__crop = __ov7251_get_pad_crop(ov7251, cfg, format->pad, format->which);
 
-	new_mode = v4l2_find_nearest_size(ov7251_mode_info_data,
-				ARRAY_SIZE(ov7251_mode_info_data),
-				width, height,
-				format->format.width, format->format.height);
+	/* Probe made sure the link carries a mode */
+	new_mode = ov7251_find_mode(ov7251, format->format.width,
+				    format->format.height);
 
 	__crop->width = new_mode->width;
 	__crop->height = new_mode->height;
 
 	if (format->which == V4L2_SUBDEV_FORMAT_ACTIVE) {
-		ret = __v4l2_ctrl_s_ctrl_int64(ov7251->pixel_clock,
-					       new_mode->pixel_clock);
+		ret = ov7251_apply_mode(ov7251, new_mode);
 		if (ret < 0)
 			goto exit;
-
-		ret = __v4l2_ctrl_s_ctrl(ov7251->link_freq,
-					 new_mode->link_freq);
-		if (ret < 0)
-			goto exit;
-
-		ret = __v4l2_ctrl_modify_range(ov7251->exposure,
-					       1, new_mode->exposure_max,
-					       1, new_mode->exposure_def);
-		if (ret < 0)
-			goto exit;
-
-		ret = __v4l2_ctrl_s_ctrl(ov7251->exposure,
-					 new_mode->exposure_def);
-		if (ret < 0)
-			goto exit;
-
-		ret = __v4l2_ctrl_s_ctrl(ov7251->gain, 16);
-		if (ret < 0)
-			goto exit;
-
-		ov7251->current_mode = new_mode;
 	}
 
 	__format = __ov7251_get_pad_format(ov7251, cfg, format->pad,
@@ -1211,55 +1173,176 @@ static int ov7251_get_selection(struct v4l2_subdev *sd,
 	return 0;
 }
 
+/*
+ * Load current_mode, with the lock held. The table is skipped if it is
+ * still loaded from the last stream, otherwise only the registers that
+ * differ from the previous mode are written. The controls are written to
+ * the sensor as they change while it is powered, so they only need to be
+ * restored over a freshly loaded mode. Exposure and gain aren't among
+ * them, ov7251_stream_on() writes those.
+ */
+static int ov7251_load_mode(struct ov7251 *ov7251)
+{
+	int ret;
+
+	if (ov7251->loaded_mode == ov7251->current_mode)
+		return 0;
+
+	ret = ov7251_set_register_array(ov7251, ov7251->current_mode->data);
+	if (ret < 0) {
+		dev_err(ov7251->dev, "could not set mode %dx%d\n",
+			ov7251->current_mode->width,
+			ov7251->current_mode->height);
+		ov7251->loaded_mode = NULL;
+		return ret;
+	}
+	ov7251->loaded_mode = ov7251->current_mode;
+
+	trace_sensor_stage_begin(ov7251->dev, "ctrl_setup");
+	ret = __v4l2_ctrl_handler_setup(&ov7251->ctrls);
+	trace_sensor_stage_end(ov7251->dev, "ctrl_setup", 0, 0, ret);
+	if (ret < 0)
+		dev_err(ov7251->dev, "could not sync v4l2 controls\n");
+
+	return ret;
+}
+
+/*
+ * Leave software standby, with the lock held. The exposure and gain last
+ * set are written first, under ae_lock, so none set in between is lost.
+ */
+static int ov7251_stream_on(struct ov7251 *ov7251)
+{
+	int ret;
+
+	mutex_lock(&ov7251->ae_lock);
+
+	ret = ov7251_set_exposure(ov7251, ov7251->exposure->val);
+	if (!ret)
+		ret = ov7251_set_gain(ov7251, ov7251->gain->val);
+	if (ret < 0)
+		goto out;
+
+	trace_sensor_stage_begin(ov7251->dev, "stream_on");
+	ret = ov7251_write_reg(ov7251, OV7251_SC_MODE_SELECT,
+			       OV7251_SC_MODE_SELECT_STREAMING);
+	trace_sensor_stage_end(ov7251->dev, "stream_on", 1, 3, ret);
+	if (ret < 0)
+		goto out;
+
+	sensor_meta_start(&ov7251->meta, ov7251->exposure->val,
+			  ov7251->gain->val,
+			  ov7251->current_mode->height + ov7251->vblank->val);
+	sensor_selftest_start(&ov7251->selftest, ov7251->current_mode->width,
+			      ov7251->current_mode->height,
+			      &ov7251->frame_interval);
+	ov7251->ae_live = true;
+
+out:
+	mutex_unlock(&ov7251->ae_lock);
+
+	return ret;
+}
+
+/* Power up and load the mode while another sensor starts, see s_stream */
+static int ov7251_sync_prepare(struct sensor_sync *sync)
+{
+	struct ov7251 *ov7251 = container_of(sync, struct ov7251, sync);
+	int ret;
+
+	ret = sensor_pm_get(&ov7251->sd);
+	if (ret < 0)
+		return ret;
+
+	mutex_lock(&ov7251->lock);
+	ret = ov7251_load_mode(ov7251);
+	mutex_unlock(&ov7251->lock);
+
+	/* Stays powered for the autosuspend delay */
+	sensor_pm_put(&ov7251->sd);
+
+	return ret;
+}
+
+/* Deferred stream on, if the stream wasn't stopped in the meantime */
+static void ov7251_sync_start(struct sensor_sync *sync)
+{
+	struct ov7251 *ov7251 = container_of(sync, struct ov7251, sync);
+
+	mutex_lock(&ov7251->lock);
+	if (ov7251->streaming && ov7251_stream_on(ov7251) < 0)
+		dev_err(ov7251->dev, "could not start streaming\n");
+	mutex_unlock(&ov7251->lock);
+}
+
+static const struct sensor_sync_ops ov7251_sync_ops = {
+	.prepare = ov7251_sync_prepare,
+	.start = ov7251_sync_start,
+};
+
 static int ov7251_s_stream(struct v4l2_subdev *subdev, int enable)
 {
 	struct ov7251 *ov7251 = to_ov7251(subdev);
 	int ret;
 
-	/* call s_power() ourselves for regular PCs. s_power() handles
-	 * mutex, so call it here.
+	mutex_lock(&ov7251->lock);
+	if (ov7251->streaming == !!enable) {
+		mutex_unlock(&ov7251->lock);
+		return 0;
+	}
+	mutex_unlock(&ov7251->lock);
+
+	/*
+	 * Power up ourselves for regular PCs. This takes the mutex, so call
+	 * it here. If the sensor is still in warm standby from the last
+	 * stream, it is already powered with the mode loaded.
 	 */
 	if (enable) {
-		ret = ov7251_s_power(&ov7251->sd, true);
+		ret = sensor_pm_get(&ov7251->sd);
 		if (ret < 0) {
 			dev_err(ov7251->dev, "could not power up OV7251\n");
-			ov7251_s_power(&ov7251->sd, false);
-			goto exit;
+			return ret;
 		}
 	}
 
 	mutex_lock(&ov7251->lock);
 
 	if (enable) {
-		ret = ov7251_set_register_array(ov7251,
-					ov7251->current_mode->data,
-					ov7251->current_mode->data_size);
-		if (ret < 0) {
-			dev_err(ov7251->dev, "could not set mode %dx%d\n",
-				ov7251->current_mode->width,
-				ov7251->current_mode->height);
+		ret = ov7251_load_mode(ov7251);
+		if (ret < 0)
 			goto exit;
-		}
-		ret = __v4l2_ctrl_handler_setup(&ov7251->ctrls);
-		if (ret < 0) {
-			dev_err(ov7251->dev, "could not sync v4l2 controls\n");
+
+		/* Streaming from here on, the group writes the stream on */
+		if (sensor_sync_arm(&ov7251->sync)) {
+			ov7251->streaming = true;
 			goto exit;
 		}
-		ret = ov7251_write_reg(ov7251, OV7251_SC_MODE_SELECT,
-				       OV7251_SC_MODE_SELECT_STREAMING);
+
+		ret = ov7251_stream_on(ov7251);
 	} else {
+		sensor_sync_disarm(&ov7251->sync);
+
+		mutex_lock(&ov7251->ae_lock);
+		ov7251->ae_live = false;
+		mutex_unlock(&ov7251->ae_lock);
+
+		sensor_meta_stop(&ov7251->meta);
+
+		trace_sensor_stage_begin(ov7251->dev, "stream_off");
 		ret = ov7251_write_reg(ov7251, OV7251_SC_MODE_SELECT,
 				       OV7251_SC_MODE_SELECT_SW_STANDBY);
+		trace_sensor_stage_end(ov7251->dev, "stream_off", 1, 3, ret);
 	}
 
+	if (!ret)
+		ov7251->streaming = enable;
+
 exit:
 	mutex_unlock(&ov7251->lock);
 
-	/* call s_power() ourselves for regular PCs. s_power() handles
-	 * mutex, so call it here.
-	 */
-	if (!enable)
-		ov7251_s_power(&ov7251->sd, false);
+	/* Drop the power on stream stop, or if starting the stream failed */
+	if (!enable || ret < 0)
+		sensor_pm_put(&ov7251->sd);
 
 	return ret;
 }
@@ -1270,7 +1353,7 @@ static int ov7251_get_frame_interval(struct v4l2_subdev *subdev,
 	struct ov7251 *ov7251 = to_ov7251(subdev);
 
 	mutex_lock(&ov7251->lock);
-	fi->interval = ov7251->current_mode->timeperframe;
+	fi->interval = ov7251->frame_interval;
 	mutex_unlock(&ov7251->lock);
 
 	return 0;
@@ -1280,42 +1363,40 @@ static int ov7251_set_frame_interval(struct v4l2_subdev *subdev,
 				     struct v4l2_subdev_frame_interval *fi)
 {
 	struct ov7251 *ov7251 = to_ov7251(subdev);
-	const struct ov7251_mode_info *new_mode;
+	const struct ov7251_mode_info *mode, *new_mode;
 	int ret = 0;
 
 	mutex_lock(&ov7251->lock);
-	new_mode = ov7251_find_mode_by_ival(ov7251, &fi->interval);
-
-	if (new_mode != ov7251->current_mode) {
-		ret = __v4l2_ctrl_s_ctrl_int64(ov7251->pixel_clock,
-					       new_mode->pixel_clock);
-		if (ret < 0)
-			goto exit;
-
-		ret = __v4l2_ctrl_s_ctrl(ov7251->link_freq,
-					 new_mode->link_freq);
-		if (ret < 0)
-			goto exit;
+	mode = ov7251->current_mode;
 
-		ret = __v4l2_ctrl_modify_range(ov7251->exposure,
-					       1, new_mode->exposure_max,
-					       1, new_mode->exposure_def);
-		if (ret < 0)
-			goto exit;
-
-		ret = __v4l2_ctrl_s_ctrl(ov7251->exposure,
-					 new_mode->exposure_def);
-		if (ret < 0)
-			goto exit;
-
-		ret = __v4l2_ctrl_s_ctrl(ov7251->gain, 16);
-		if (ret < 0)
-			goto exit;
-
-		ov7251->current_mode = new_mode;
+	/*
+	 * Slower than the current mode: stretch its frames with VBLANK, which
+	 * the sensor takes while streaming. Faster needs the mode table with
+	 * the closest rate, which is only loaded at the next stream on.
+	 */
+	if (!fi->interval.denominator ||
+	    (u64)fi->interval.numerator * mode->timeperframe.denominator <
+	    (u64)mode->timeperframe.numerator * fi->interval.denominator) {
+		new_mode = ov7251_find_mode_by_ival(ov7251, &fi->interval);
+		if (new_mode != mode) {
+			if (ov7251->streaming) {
+				ret = -EBUSY;
+				goto exit;
+			}
+			ret = ov7251_apply_mode(ov7251, new_mode);
+			if (ret < 0)
+				goto exit;
+			mode = new_mode;
+		}
 	}
 
-	fi->interval = ov7251->current_mode->timeperframe;
+	ret = __v4l2_ctrl_s_ctrl(ov7251->vblank,
+				 ov7251_vblank_for_interval(mode,
+							    &fi->interval));
+	if (ret < 0)
+		goto exit;
+
+	fi->interval = ov7251->frame_interval;
 
 exit:
 	mutex_unlock(&ov7251->lock);
@@ -1325,6 +1406,8 @@ exit:
 
 static const struct v4l2_subdev_core_ops ov7251_core_ops = {
 	.s_power = ov7251_s_power,
+	.subscribe_event = v4l2_ctrl_subdev_subscribe_event,
+	.unsubscribe_event = v4l2_event_subdev_unsubscribe,
 };
 
 static const struct v4l2_subdev_video_ops ov7251_video_ops = {
@@ -1349,113 +1432,211 @@ static const struct v4l2_subdev_ops ov7251_subdev_ops = {
 	.pad = &ov7251_subdev_pad_ops,
 };
 
-/* Get acpi_device of dependent INT3472 device */
-static struct acpi_device *get_dep_adev(struct device *dev)
+static int ov7251_init_controls(struct ov7251 *ov7251)
 {
-	struct acpi_handle *dev_handle;
-	struct acpi_device *sensor_adev;
-	struct acpi_handle_list dep_devices;
-	struct acpi_device *dep_adev;
-	acpi_status status;
-	const char *dep_hid = "INT3472";
-	int i;
-
-	sensor_adev = acpi_dev_get_first_match_dev(OV7251_ACPI_HID, NULL, -1);
-	if (!sensor_adev) {
-		dev_err(dev, "Couldn't get sensor ACPI device\n");
-		return ERR_PTR(-ENODEV);
-	}
-	dev_handle = sensor_adev->handle;
-	acpi_dev_put(sensor_adev);
+	int ret;
 
-	if (!acpi_has_method(dev_handle, "_DEP")) {
-		dev_err(dev, "No _DEP entry found\n");
-		return ERR_PTR(-ENODEV);
-	}
+	v4l2_ctrl_handler_init(&ov7251->ctrls, 8);
+	ov7251->ctrls.lock = &ov7251->lock;
+	v4l2_ctrl_handler_init(&ov7251->ae_ctrls, 2);
+	ov7251->ae_ctrls.lock = &ov7251->ae_lock;
 
-	status = acpi_evaluate_reference(dev_handle, "_DEP", NULL, &dep_devices);
-	if (ACPI_FAILURE(status)) {
-		dev_err(dev, "Failed to evaluate _DEP.\n");
-		return ERR_PTR(-ENODEV);
-	}
+	v4l2_ctrl_new_std(&ov7251->ctrls, &ov7251_ctrl_ops,
+			  V4L2_CID_HFLIP, 0, 1, 1, 0);
+	v4l2_ctrl_new_std(&ov7251->ctrls, &ov7251_ctrl_ops,
+			  V4L2_CID_VFLIP, 0, 1, 1, 0);
+	ov7251->exposure = v4l2_ctrl_new_std(&ov7251->ae_ctrls,
+					     &ov7251_ae_ctrl_ops,
+					     V4L2_CID_EXPOSURE, 1, 32, 1, 32);
+	ov7251->gain = v4l2_ctrl_new_std(&ov7251->ae_ctrls,
+					 &ov7251_ae_ctrl_ops,
+					 V4L2_CID_GAIN, 16, 1023, 1, 16);
+	/* Ranged for the active mode by ov7251_apply_mode() */
+	ov7251->vblank = v4l2_ctrl_new_std(&ov7251->ctrls, &ov7251_ctrl_ops,
+					   V4L2_CID_VBLANK, 0,
+					   OV7251_TIMING_VTS_MAX, 1, 0);
+	v4l2_ctrl_new_std_menu_items(&ov7251->ctrls, &ov7251_ctrl_ops,
+				     V4L2_CID_TEST_PATTERN,
+				     ARRAY_SIZE(ov7251_test_pattern_menu) - 1,
+				     0, 0, ov7251_test_pattern_menu);
+	ov7251->pixel_clock = v4l2_ctrl_new_std(&ov7251->ctrls,
+						&ov7251_ctrl_ops,
+						V4L2_CID_PIXEL_RATE,
+						1, INT_MAX, 1, 1);
+	ov7251->link_freq = v4l2_ctrl_new_int_menu(&ov7251->ctrls,
+						   &ov7251_ctrl_ops,
+						   V4L2_CID_LINK_FREQ,
+						   ARRAY_SIZE(link_freq) - 1,
+						   0, link_freq);
+	if (ov7251->link_freq)
+		ov7251->link_freq->flags |= V4L2_CTRL_FLAG_READ_ONLY;
 
-	for (i = 0; i < dep_devices.count; i++) {
-		struct acpi_device_info *info;
-		int match;
+	/* Exposure and gain keep their own handler's lock */
+	v4l2_ctrl_add_handler(&ov7251->ctrls, &ov7251->ae_ctrls, NULL, false);
 
-		status = acpi_get_object_info(dep_devices.handles[i], &info);
-		if (ACPI_FAILURE(status)) {
-			dev_dbg(dev,
-				"Error reading _DEP device info, continue next\n");
-			continue;
-		}
+	ov7251->sd.ctrl_handler = &ov7251->ctrls;
+
+	ret = ov7251->ae_ctrls.error ?: ov7251->ctrls.error;
+	if (ret) {
+		dev_err(ov7251->dev, "%s: control initialization error %d\n",
+			__func__, ret);
+		v4l2_ctrl_handler_free(&ov7251->ctrls);
+		v4l2_ctrl_handler_free(&ov7251->ae_ctrls);
+		return ret;
+	}
+
+	return 0;
+}
 
-		match = info->valid & ACPI_VALID_HID &&
-			!strcmp(info->hardware_id.string, dep_hid);
+/* From the chip ID to the revision, read in one transfer */
+#define OV7251_ID_REGS	(OV7251_SC_GP_IO_IN1 - OV7251_CHIP_ID_HIGH + 1)
 
-		kfree(info);
+/*
+ * Read the chip ID, the revision and the reset values of the registers
+ * the driver keeps a copy of, in @ident->data
+ */
+static int ov7251_read_ident(struct ov7251 *ov7251, struct sensor_ident *ident)
+{
+	u8 regs[OV7251_ID_REGS];
+	u8 timing[2];
+	int ret;
 
-		if (!match)
-			continue;
+	ret = sensor_reg_read(&ov7251->i2c, OV7251_CHIP_ID_HIGH, regs,
+			      sizeof(regs));
+	if (ret < 0) {
+		dev_err(ov7251->dev, "could not read ID\n");
+		return ret;
+	}
 
-		if (acpi_bus_get_device(dep_devices.handles[i], &dep_adev)) {
-			dev_err(dev, "Error getting dependent ACPI device\n");
-			return ERR_PTR(-ENODEV);
-		}
+	ident->chip_id = regs[0] << 8 | regs[1];
+	ident->revision = regs[OV7251_SC_GP_IO_IN1 - OV7251_CHIP_ID_HIGH] >> 4;
 
-		/* found acpi_device of dependent device */
-		break;
+	ret = ov7251_read_reg(ov7251, OV7251_PRE_ISP_00, &ov7251->pre_isp_00);
+	if (ret < 0) {
+		dev_err(ov7251->dev, "could not read test pattern value\n");
+		return ret;
 	}
 
-	if (!dep_adev) {
-		dev_err(dev, "Dependent ACPI device not found\n");
-		return ERR_PTR(-ENODEV);
+	/* TIMING_FORMAT1 and 2, vflip and hflip */
+	ret = sensor_reg_read(&ov7251->i2c, OV7251_TIMING_FORMAT1, timing,
+			      sizeof(timing));
+	if (ret < 0) {
+		dev_err(ov7251->dev, "could not read flip values\n");
+		return ret;
 	}
+	ov7251->timing_format1 = timing[0];
+	ov7251->timing_format2 = timing[1];
 
-	dev_info(dev, "Dependent ACPI device found: %s\n",
-		 dev_name(&dep_adev->dev));
+	ident->data = ov7251->pre_isp_00 | ov7251->timing_format1 << 8 |
+		      ov7251->timing_format2 << 16;
 
-	return dep_adev;
+	return 0;
 }
 
-/* Get dependent INT3472 device */
-static struct device *get_dep_dev(struct device *dev)
+/*
+ * Power up and identify the sensor, then set up the controls and register
+ * the subdev. This runs from a worker so that probe does not wait for the
+ * power up delays of the sensor and of the PMIC it depends on. A failed
+ * attempt is undone and made again SENSOR_IDENTIFY_RETRIES times, then
+ * the device stays bound without a subdev.
+ */
+static void ov7251_identify_work(struct work_struct *work)
 {
-	struct acpi_device *dep_adev;
-	struct acpi_device_physical_node *dep_phys;
+	struct ov7251 *ov7251 = container_of(to_delayed_work(work),
+					     struct ov7251, identify_work);
+	struct i2c_client *client = ov7251->i2c_client;
+	struct device *dev = ov7251->dev;
+	struct sensor_ident ident;
+	int ret;
 
-	dep_adev = get_dep_adev(dev);
-	if (!dep_adev) {
-		dev_err(dev, "get_dep_adev() failed\n");
-		return ERR_PTR(-ENODEV);
+	ret = ov7251_init_controls(ov7251);
+	if (ret < 0)
+		goto err;
+
+	ret = ov7251_s_power(&ov7251->sd, true);
+	if (ret < 0) {
+		dev_err(dev, "could not power up OV7251\n");
+		goto free_ctrl;
 	}
 
 	/*
-	 * HACK: We know that the PMIC is a "discrete" PMIC, an ACPI device
-	 * that just serves as a container to list system GPIOs.
-	 *
-	 * The ACPI device has no fwnode, nor does it have a platform device.
-	 * This prevents fetching GPIOs. It however seems to be backed by the
-	 * PCI root complex (pci0000:00/0000:00:00.0) as its physical device,
-	 * and that device has its fwnode set to \_SB.PCI0.DSC1. Whether this
-	 * is correct or not is unknown, let's just get the physical device and
-	 * move on for now.
-	 *
-	 * (@kitakar5525)This is observed on Microsoft Surface Go series
-	 * and Acer Switch Alpha 12.
+	 * The chip ID was checked by the power up wait. The revision and the
+	 * reset values of the registers cached below are read once per boot.
 	 */
-	dep_phys = list_first_entry_or_null(&dep_adev->physical_node_list,
-					    struct acpi_device_physical_node,
-					    node);
-	if (!dep_phys) {
+	if (sensor_ident_get(dev, &ident)) {
+		ov7251->pre_isp_00 = ident.data & 0xff;
+		ov7251->timing_format1 = (ident.data >> 8) & 0xff;
+		ov7251->timing_format2 = (ident.data >> 16) & 0xff;
+	} else {
+		ret = ov7251_read_ident(ov7251, &ident);
+		if (ret < 0) {
+			ret = -ENODEV;
+			goto power_down;
+		}
+
 		dev_info(dev,
-			 "Error getting physical node of dependent device\n");
-		return ERR_PTR(-ENODEV);
+			 "OV7251 revision %x (%s) detected at address 0x%02x\n",
+			 ident.revision,
+			 ident.revision == 0x4 ? "1A / 1B" :
+			 ident.revision == 0x5 ? "1C / 1D" :
+			 ident.revision == 0x6 ? "1E" :
+			 ident.revision == 0x7 ? "1F" : "unknown",
+			 client->addr);
+
+		sensor_ident_set(dev, &ident);
+	}
+
+	ov7251_s_power(&ov7251->sd, false);
+
+	/* The sensor was powered off after reading the chip ID */
+	pm_runtime_set_autosuspend_delay(dev, autosuspend_delay_ms);
+	pm_runtime_use_autosuspend(dev);
+	pm_runtime_enable(dev);
+
+	ov7251->sync.dev = dev;
+	ov7251->sync.ops = &ov7251_sync_ops;
+	if (sensor_sync_add(&ov7251->sync, ov7251->dep_dev))
+		dev_warn(dev, "streams on without the other sensors\n");
+
+	ov7251_entity_init_cfg(&ov7251->sd, NULL);
+
+	/* Last, the notifier may stream the subdev right away */
+	ret = v4l2_async_register_subdev(&ov7251->sd);
+	if (ret < 0) {
+		dev_err(dev, "could not register v4l2 device\n");
+		goto sync_remove;
 	}
 
-	dev_info(dev, "Dependent device found: %s\n", dev_name(dep_phys->dev));
+	ov7251->registered = true;
+
+	ov7251->debugfs = debugfs_create_dir(dev_name(dev), NULL);
+	debugfs_create_file("modes", 0444, ov7251->debugfs, ov7251,
+			    &ov7251_modes_fops);
+	sensor_stats_debugfs(&ov7251->stats, ov7251->debugfs);
+	sensor_meta_debugfs(&ov7251->meta, ov7251->debugfs);
+	sensor_selftest_debugfs(&ov7251->selftest, ov7251->debugfs);
+
+	return;
 
-	return dep_phys->dev;
+sync_remove:
+	sensor_sync_remove(&ov7251->sync);
+	pm_runtime_disable(dev);
+	pm_runtime_dont_use_autosuspend(dev);
+	goto free_ctrl;
+power_down:
+	ov7251_s_power(&ov7251->sd, false);
+free_ctrl:
+	v4l2_ctrl_handler_free(&ov7251->ctrls);
+	v4l2_ctrl_handler_free(&ov7251->ae_ctrls);
+	ov7251->sd.ctrl_handler = NULL;
+err:
+	if (sensor_identify_retry(&ov7251->identify_work,
+				  &ov7251->identify_tries))
+		dev_warn(dev, "%s: failed to set up sensor: %d, retrying\n",
+			 __func__, ret);
+	else
+		dev_err(dev, "%s: failed to set up sensor: %d, giving up\n",
+			__func__, ret);
 }
 
 static int ov7251_probe(struct i2c_client *client)
@@ -1464,7 +1645,6 @@ static int ov7251_probe(struct i2c_client *client)
 	struct fwnode_handle *endpoint;
 	struct ov7251 *ov7251;
 	struct device *dep_dev;
-	u8 chip_id_high, chip_id_low, chip_rev;
 	int ret;
 
 	dev_info(dev, "%s() called\n", __func__);
@@ -1474,9 +1654,12 @@ static int ov7251_probe(struct i2c_client *client)
 		return -ENOMEM;
 
 	ov7251->i2c_client = client;
+	sensor_i2c_init(&ov7251->i2c, client, &ov7251->stats, &ov7251->shadow);
 	ov7251->dev = dev;
 
-	if (acpi_dev_present(OV7251_ACPI_HID, NULL, -1)) {
+	/* The sensor_mock adapter simulates the ACPI setup */
+	if (acpi_dev_present(OV7251_ACPI_HID, NULL, -1) ||
+	    sensor_dep_is_mock(dev)) {
 		dev_info(dev, "system is acpi-based\n");
 		ov7251->is_acpi_based = true;
 	} else
@@ -1503,6 +1686,15 @@ static int ov7251_probe(struct i2c_client *client)
 		}
 	}
 
+	ov7251->link.freqs = link_freq;
+	ov7251->link.num_freqs = ARRAY_SIZE(link_freq);
+	ov7251->link.lanes = sensor_link_lanes(dev, &ov7251->ep,
+					       OV7251_DATA_LANES);
+	if (!ov7251_find_mode(ov7251, 640, 480)) {
+		dev_err(dev, "no mode fits the link\n");
+		return -ERANGE;
+	}
+
 	/* For DT-based systems */
 	if (!ov7251->is_acpi_based) {
 		/* get system clock (xclk) */
@@ -1570,7 +1762,7 @@ static int ov7251_probe(struct i2c_client *client)
 
 	/* For ACPI-based systems */
 	if (ov7251->is_acpi_based) {
-		ov7251->dep_dev = get_dep_dev(&client->dev);
+		ov7251->dep_dev = sensor_dep_get_dev(&client->dev, OV7251_ACPI_HID);
 		if (IS_ERR(ov7251->dep_dev)) {
 			ret = PTR_ERR(ov7251->dep_dev);
 			dev_err(&client->dev, "cannot get dep_dev: ret %d\n", ret);
@@ -1578,7 +1770,7 @@ static int ov7251_probe(struct i2c_client *client)
 		}
 		dep_dev = ov7251->dep_dev;
 
-		ret = gpio_crs_get(ov7251, dep_dev);
+		ret = sensor_gpios_get(&ov7251->dep_gpios, dep_dev, false);
 		if (ret) {
 			dev_err(dep_dev, "Failed to get _CRS GPIOs\n");
 			return ret;
@@ -1586,45 +1778,13 @@ static int ov7251_probe(struct i2c_client *client)
 	}
 
 	mutex_init(&ov7251->lock);
-
-	v4l2_ctrl_handler_init(&ov7251->ctrls, 7);
-	ov7251->ctrls.lock = &ov7251->lock;
-
-	v4l2_ctrl_new_std(&ov7251->ctrls, &ov7251_ctrl_ops,
-			  V4L2_CID_HFLIP, 0, 1, 1, 0);
-	v4l2_ctrl_new_std(&ov7251->ctrls, &ov7251_ctrl_ops,
-			  V4L2_CID_VFLIP, 0, 1, 1, 0);
-	ov7251->exposure = v4l2_ctrl_new_std(&ov7251->ctrls, &ov7251_ctrl_ops,
-					     V4L2_CID_EXPOSURE, 1, 32, 1, 32);
-	ov7251->gain = v4l2_ctrl_new_std(&ov7251->ctrls, &ov7251_ctrl_ops,
-					 V4L2_CID_GAIN, 16, 1023, 1, 16);
-	v4l2_ctrl_new_std_menu_items(&ov7251->ctrls, &ov7251_ctrl_ops,
-				     V4L2_CID_TEST_PATTERN,
-				     ARRAY_SIZE(ov7251_test_pattern_menu) - 1,
-				     0, 0, ov7251_test_pattern_menu);
-	ov7251->pixel_clock = v4l2_ctrl_new_std(&ov7251->ctrls,
-						&ov7251_ctrl_ops,
-						V4L2_CID_PIXEL_RATE,
-						1, INT_MAX, 1, 1);
-	ov7251->link_freq = v4l2_ctrl_new_int_menu(&ov7251->ctrls,
-						   &ov7251_ctrl_ops,
-						   V4L2_CID_LINK_FREQ,
-						   ARRAY_SIZE(link_freq) - 1,
-						   0, link_freq);
-	if (ov7251->link_freq)
-		ov7251->link_freq->flags |= V4L2_CTRL_FLAG_READ_ONLY;
-
-	ov7251->sd.ctrl_handler = &ov7251->ctrls;
-
-	if (ov7251->ctrls.error) {
-		dev_err(dev, "%s: control initialization error %d\n",
-			__func__, ov7251->ctrls.error);
-		ret = ov7251->ctrls.error;
-		goto free_ctrl;
-	}
+	mutex_init(&ov7251->ae_lock);
 
 	v4l2_i2c_subdev_init(&ov7251->sd, client, &ov7251_subdev_ops);
-	ov7251->sd.flags |= V4L2_SUBDEV_FL_HAS_DEVNODE;
+	sensor_meta_init(&ov7251->meta, OV7251_CTRL_DELAY_FRAMES);
+	sensor_selftest_init(&ov7251->selftest, 10);
+	ov7251->sd.flags |= V4L2_SUBDEV_FL_HAS_DEVNODE |
+			    V4L2_SUBDEV_FL_HAS_EVENTS;
 	ov7251->pad.flags = MEDIA_PAD_FL_SOURCE;
 	ov7251->sd.dev = &client->dev;
 	ov7251->sd.entity.function = MEDIA_ENT_F_CAM_SENSOR;
@@ -1632,87 +1792,37 @@ static int ov7251_probe(struct i2c_client *client)
 	ret = media_entity_pads_init(&ov7251->sd.entity, 1, &ov7251->pad);
 	if (ret < 0) {
 		dev_err(dev, "could not register media entity\n");
-		goto free_ctrl;
-	}
-
-	ret = ov7251_s_power(&ov7251->sd, true);
-	if (ret < 0) {
-		dev_err(dev, "could not power up OV7251\n");
 		goto free_entity;
 	}
 
-	ret = ov7251_read_reg(ov7251, OV7251_CHIP_ID_HIGH, &chip_id_high);
-	if (ret < 0 || chip_id_high != OV7251_CHIP_ID_HIGH_BYTE) {
-		dev_err(dev, "could not read ID high\n");
-		ret = -ENODEV;
-		goto power_down;
-	}
-	ret = ov7251_read_reg(ov7251, OV7251_CHIP_ID_LOW, &chip_id_low);
-	if (ret < 0 || chip_id_low != OV7251_CHIP_ID_LOW_BYTE) {
-		dev_err(dev, "could not read ID low\n");
-		ret = -ENODEV;
-		goto power_down;
-	}
-
-	ret = ov7251_read_reg(ov7251, OV7251_SC_GP_IO_IN1, &chip_rev);
-	if (ret < 0) {
-		dev_err(dev, "could not read revision\n");
-		ret = -ENODEV;
-		goto power_down;
-	}
-	chip_rev >>= 4;
-
-	dev_info(dev, "OV7251 revision %x (%s) detected at address 0x%02x\n",
-		 chip_rev,
-		 chip_rev == 0x4 ? "1A / 1B" :
-		 chip_rev == 0x5 ? "1C / 1D" :
-		 chip_rev == 0x6 ? "1E" :
-		 chip_rev == 0x7 ? "1F" : "unknown",
-		 client->addr);
-
-	ret = ov7251_read_reg(ov7251, OV7251_PRE_ISP_00,
-			      &ov7251->pre_isp_00);
-	if (ret < 0) {
-		dev_err(dev, "could not read test pattern value\n");
-		ret = -ENODEV;
-		goto power_down;
-	}
-
-	ret = ov7251_read_reg(ov7251, OV7251_TIMING_FORMAT1,
-			      &ov7251->timing_format1);
+	ret = ov7251_build_progs(ov7251);
 	if (ret < 0) {
-		dev_err(dev, "could not read vflip value\n");
-		ret = -ENODEV;
-		goto power_down;
-	}
-
-	ret = ov7251_read_reg(ov7251, OV7251_TIMING_FORMAT2,
-			      &ov7251->timing_format2);
-	if (ret < 0) {
-		dev_err(dev, "could not read hflip value\n");
-		ret = -ENODEV;
-		goto power_down;
+		dev_err(dev, "could not build register tables\n");
+		goto free_entity;
 	}
 
-	ov7251_s_power(&ov7251->sd, false);
+	ret = sensor_shadow_init(dev, &ov7251->shadow,
+				 OV7251_SC_SOFTWARE_RESET);
+	if (ret < 0)
+		goto free_entity;
 
-	ret = v4l2_async_register_subdev(&ov7251->sd);
-	if (ret < 0) {
-		dev_err(dev, "could not register v4l2 device\n");
+	ret = sensor_stats_init(dev, &ov7251->stats);
+	if (ret < 0)
 		goto free_entity;
-	}
 
-	ov7251_entity_init_cfg(&ov7251->sd, NULL);
+	/* The sensor is identified and registered by ov7251_identify_work() */
+	INIT_DELAYED_WORK(&ov7251->identify_work, ov7251_identify_work);
+	schedule_delayed_work(&ov7251->identify_work, 0);
 
 	return 0;
 
-power_down:
-	ov7251_s_power(&ov7251->sd, false);
 free_entity:
 	media_entity_cleanup(&ov7251->sd.entity);
-free_ctrl:
-	v4l2_ctrl_handler_free(&ov7251->ctrls);
+	mutex_destroy(&ov7251->ae_lock);
 	mutex_destroy(&ov7251->lock);
+	/* For ACPI-based systems */
+	if (ov7251->is_acpi_based)
+		sensor_gpios_put(&ov7251->dep_gpios);
 
 	return ret;
 }
@@ -1724,18 +1834,38 @@ static int ov7251_remove(struct i2c_client *client)
 
 	dev_info(&client->dev, "%s() called\n", __func__);
 
-	/* For ACPI-based systems */
+	cancel_delayed_work_sync(&ov7251->identify_work);
+
+	debugfs_remove_recursive(ov7251->debugfs);
+
+	if (ov7251->registered) {
+		v4l2_async_unregister_subdev(&ov7251->sd);
+		sensor_sync_remove(&ov7251->sync);
+		sensor_meta_stop(&ov7251->meta);
+		v4l2_ctrl_handler_free(&ov7251->ctrls);
+		v4l2_ctrl_handler_free(&ov7251->ae_ctrls);
+
+		pm_runtime_disable(&client->dev);
+		ov7251_s_power(&ov7251->sd, false);
+		pm_runtime_set_suspended(&client->dev);
+		pm_runtime_dont_use_autosuspend(&client->dev);
+	}
+
+	/* For ACPI-based systems, after the power off above */
 	if (ov7251->is_acpi_based)
-		gpio_crs_put(ov7251);
+		sensor_gpios_put(&ov7251->dep_gpios);
 
-	v4l2_async_unregister_subdev(&ov7251->sd);
 	media_entity_cleanup(&ov7251->sd.entity);
-	v4l2_ctrl_handler_free(&ov7251->ctrls);
+	mutex_destroy(&ov7251->ae_lock);
 	mutex_destroy(&ov7251->lock);
 
 	return 0;
 }
 
+static const struct dev_pm_ops ov7251_pm_ops = {
+	SET_RUNTIME_PM_OPS(ov7251_runtime_suspend, ov7251_runtime_resume, NULL)
+};
+
 static const struct of_device_id ov7251_of_match[] = {
 	{ .compatible = "ovti,ov7251" },
 	{ /* sentinel */ }
@@ -1750,12 +1880,21 @@ static const struct acpi_device_id ov7251_acpi_ids[] = {
 MODULE_DEVICE_TABLE(acpi, ov7251_acpi_ids);
 #endif
 
+static const struct i2c_device_id ov7251_id[] = {
+	{ "ov7251", 0 },
+	{ }
+};
+MODULE_DEVICE_TABLE(i2c, ov7251_id);
+
 static struct i2c_driver ov7251_i2c_driver = {
 	.driver = {
 		.of_match_table = ov7251_of_match,
 		.acpi_match_table = ACPI_PTR(ov7251_acpi_ids),
 		.name  = "ov7251",
+		.pm = &ov7251_pm_ops,
+		.probe_type = PROBE_PREFER_ASYNCHRONOUS,
 	},
+	.id_table = ov7251_id,
 	.probe_new  = ov7251_probe,
 	.remove = ov7251_remove,
 };
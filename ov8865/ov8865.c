@@ -7,12 +7,15 @@
 
 #include <linux/acpi.h>
 #include <linux/clk.h>
+#include <linux/debugfs.h>
 #include <linux/delay.h>
 #include <linux/gpio/consumer.h>
 #include <linux/i2c.h>
 #include <linux/init.h>
 #include <linux/module.h>
+#include <linux/pm_runtime.h>
 #include <linux/regulator/consumer.h>
+#include <linux/workqueue.h>
 #include <media/v4l2-async.h>
 #include <media/v4l2-ctrls.h>
 #include <media/v4l2-device.h>
@@ -20,6 +23,26 @@
 #include <media/v4l2-fwnode.h>
 #include <media/v4l2-subdev.h>
 
+#include "sensor_burst.h"
+#include "sensor_calib.h"
+#include "sensor_dep.h"
+#include "sensor_link.h"
+#include "sensor_meta.h"
+#include "sensor_power.h"
+#include "sensor_reg.h"
+#include "sensor_selftest.h"
+#include "sensor_seq.h"
+
+/*
+ * After a stream stops, the sensor is left powered in software standby
+ * with its registers kept for this long, so that a restart only has to
+ * leave standby. Can be changed per device in power/autosuspend_delay_ms.
+ */
+static int autosuspend_delay_ms = 2000;
+module_param(autosuspend_delay_ms, int, 0644);
+MODULE_PARM_DESC(autosuspend_delay_ms,
+		 "Delay before powering the sensor off after stream stop");
+
 #define OV8865_ACPI_HID "INT347A"
 
 #define OV8865_XCLK_FREQ		24000000
@@ -45,6 +68,9 @@
 #define OV8865_PUMP_CLK_DIV_REG		0x3015
 
 #define OV8865_MIPI_CTRL_REG		0x3018
+#define OV8865_MIPI_CTRL_LANES(n)	(((n) - 1) << 5)
+#define OV8865_MIPI_CTRL_ON		0x12
+#define OV8865_MIPI_CTRL_OFF		0x02
 #define OV8865_CLOCK_SEL_REG		0x3020
 #define OV8865_MIPI_SC_CTRL_REG		0X3022
 
@@ -60,6 +86,9 @@
 #define OV8865_GAIN_CTRL_H_REG		0x3508
 #define OV8865_GAIN_CTRL_L_REG		0x3509
 
+/* Exposure and gain writes apply from the second frame after */
+#define OV8865_CTRL_DELAY_FRAMES	2
+
 #define OV8865_ASP_CTRL41_REG		0x3641
 #define OV8865_ASP_CTRL46_REG		0x3646
 #define OV8865_ASP_CTRL47_REG		0x3647
@@ -78,6 +107,15 @@
 #define OV8865_Y_OUTPUT_SIZE_REG	0x380a
 #define OV8865_HTS_REG			0x380c
 #define OV8865_VTS_REG			0x380e
+#define OV8865_VTS_MAX			0x7fff
+
+/* Pixel array, and the active 3264x2448 in it */
+#define OV8865_NATIVE_WIDTH		3296
+#define OV8865_NATIVE_HEIGHT		2528
+#define OV8865_ACTIVE_LEFT		16
+#define OV8865_ACTIVE_TOP		16
+#define OV8865_ACTIVE_WIDTH		3264
+#define OV8865_ACTIVE_HEIGHT		2448
 #define OV8865_ISP_X_WIN_H_REG		0x3810
 #define OV8865_ISP_X_WIN_L_REG		0x3811
 #define OV8865_ISP_Y_WIN_L_REG		0x3813
@@ -99,9 +137,22 @@
 
 /* OTP */
 
+#define OV8865_OTP_LOAD_CTRL_REG	0x3d81
+#define OV8865_OTP_LOAD_CTRL_ENABLE	BIT(0)
+#define OV8865_OTP_MODE_CTRL_REG	0x3d84
+#define OV8865_OTP_MODE_CTRL_MANUAL	0xc0
 #define OV8865_OTP_REG			0x3d85
+#define OV8865_OTP_START_ADDR_REG	0x3d88
+#define OV8865_OTP_END_ADDR_REG		0x3d8a
 #define OV8865_OTP_SETT_STT_ADDR_H_REG	0x3d8c
 #define OV8865_OTP_SETT_STT_ADDR_L_REG	0x3d8d
+#define OV8865_OTP_SRAM_START_REG	0x7000
+#define OV8865_OTP_SRAM_END_REG		0x73ff
+/* Module data: ID, AWB and lens shading */
+#define OV8865_OTP_USER_START_REG	0x7010
+#define OV8865_OTP_USER_END_REG		0x720f
+#define OV8865_OTP_USER_SIZE		(OV8865_OTP_USER_END_REG - \
+					 OV8865_OTP_USER_START_REG + 1)
 
 /* Black Level */
 
@@ -247,19 +298,30 @@ enum ov8865_mode_id {
 	OV8865_MODE_UXGA_1600_1200,
 	OV8865_MODE_SVGA_800_600,
 	OV8865_MODE_VGA_640_480,
+	OV8865_MODE_360P_640_360,
 	OV8865_NUM_MODES,
 };
 
+/* How a mode reads the array out, see ov8865_set_timings() */
+enum ov8865_readout {
+	OV8865_READOUT_FULL,		/* every pixel */
+	OV8865_READOUT_HALF,		/* 2x2 binned and sub-sampled */
+	OV8865_READOUT_QUARTER,		/* 2x2 binned, sub-sampled to 4x4 */
+};
 
 enum ov8865_frame_rate {
 	OV8865_30_FPS = 0,
+	OV8865_60_FPS,
 	OV8865_90_FPS,
+	OV8865_120_FPS,
 	OV8865_NUM_FRAMERATES,
 };
 
 static const int ov8865_framerates[] = {
 	[OV8865_30_FPS] = 30,
+	[OV8865_60_FPS] = 60,
 	[OV8865_90_FPS] = 90,
+	[OV8865_120_FPS] = 120,
 };
 
 struct ov8865_pixfmt {
@@ -281,31 +343,43 @@ static const char * const ov8865_supply_names[] = {
 
 #define OV8865_NUM_SUPPLIES ARRAY_SIZE(ov8865_supply_names)
 
-struct reg_value {
-	u16 reg_addr;
-	u8 val;
-	u32 delay_ms;
-};
+/* Most data lanes of the sensor */
+#define OV8865_MAX_LANES			4
 
 #define OV8865_LINK_FREQ_422MHZ			422400000
 
+/* The lowest one that carries a mode is selected for it */
 static const s64 link_freq_menu_items[] = {
 	OV8865_LINK_FREQ_422MHZ
 };
 
+/*
+ * @vtot is the shortest VTS of the mode, at @max_fps: the pixel rate is
+ * htot * vtot * max_fps, and slower frame rates take a longer VTS. @crop
+ * is the array window read out.
+ */
 struct ov8865_mode_info {
 	enum ov8865_mode_id id;
+	enum ov8865_readout readout;
 	u32 hact;
 	u32 htot;
 	u32 vact;
 	u32 vtot;
-	const struct reg_value *reg_data;
-	u32 reg_data_size;
+	u32 max_fps;
+	struct v4l2_rect crop;
+	const struct sensor_seq *reg_data;
 };
 
+/* Window of the modes that read out the whole array */
+#define OV8865_CROP_FULL	{ .left = 12, .top = 12, \
+				  .width = 3272, .height = 2456 }
+
 struct ov8865_ctrls {
 	struct v4l2_ctrl_handler handler;
+	/* Exposure and gain, under ae_lock, see ov8865_s_ae_ctrl() */
+	struct v4l2_ctrl_handler ae_handler;
 	struct v4l2_ctrl *pixel_rate;
+	struct v4l2_ctrl *vblank;
 	struct v4l2_ctrl *exposure;
 	struct v4l2_ctrl *gain;
 	struct v4l2_ctrl *hflip;
@@ -328,6 +402,13 @@ struct ov8865_dev {
 	bool upside_down;
 
 	struct mutex lock;
+	/*
+	 * Taken by exposure and gain instead of lock, so they can be set while
+	 * a mode loads. Nested inside lock.
+	 */
+	struct mutex ae_lock;
+	/* Exposure and gain are written as they are set, under ae_lock */
+	bool ae_live;
 
 	int power_count;
 
@@ -345,9 +426,40 @@ struct ov8865_dev {
 	struct device *dep_dev;
 
 	/* GPIOs defined in dep_dev _CRS */
-	struct gpio_descs *dep_gpios;
+	struct sensor_gpios dep_gpios;
 
 	bool is_acpi_based;
+
+	/* Mode tables precompiled at probe, see ov8865_build_progs() */
+	struct sensor_prog init_prog;
+	struct sensor_prog mode_progs[OV8865_NUM_MODES];
+
+	/* Register values written or read since power on */
+	struct sensor_shadow shadow;
+	/* i2c traffic counters, see sensor_stats.h */
+	struct sensor_stats stats;
+	/* Register access through the above, see sensor_reg.h */
+	struct sensor_i2c i2c;
+	/* Frame sync events and per-frame values, see sensor_meta.h */
+	struct sensor_meta meta;
+	/* Stream timing the capture side checks, see sensor_selftest.h */
+	struct sensor_selftest selftest;
+	/* HTS / pclk of the loaded mode, 0 if not known yet */
+	int line_time;
+	/* Link frequencies and data lanes, see sensor_link.h */
+	struct sensor_link link;
+	/* Stream on together with the other sensors, see sensor_dep.h */
+	struct sensor_sync sync;
+	/* OTP module data, exported to userspace */
+	struct sensor_calib calib;
+
+	struct dentry *debugfs;
+
+	/* Identifies the sensor and registers the subdev after probe */
+	struct delayed_work identify_work;
+	unsigned int identify_tries;
+	/* Set once identify_work has registered the subdev */
+	bool registered;
 };
 
 static inline struct ov8865_dev *to_ov8865_dev(struct v4l2_subdev *sd)
@@ -361,737 +473,395 @@ static inline struct v4l2_subdev *ctrl_to_sd(struct v4l2_ctrl *ctrl)
 			     ctrls.handler)->sd;
 }
 
-static const struct reg_value ov8865_init_setting_QUXGA[] = {
-	{ OV8865_SW_RESET_REG, 0x01, 16 },
-	{ OV8865_SW_STANDBY_REG, 0x00 },
-	{ OV8865_SW_STANDBY_REG, 0x00 },
-	{ OV8865_SW_STANDBY_REG, 0x00 },
-	{ OV8865_SW_STANDBY_REG, 0x00 },
-	{ 0x3638, 0xff },
-	{ OV8865_PUMP_CLK_DIV_REG, 0x01 },
-	{ OV8865_MIPI_SC_CTRL_REG, 0x01 },
-	{ 0x3031, 0x0a },
-	{ 0x3305, 0xf1 },
-	{ 0x3308, 0x00 },
-	{ 0x3309, 0x28 },
-	{ 0x330a, 0x00 },
-	{ 0x330b, 0x20 },
-	{ 0x330c, 0x00 },
-	{ 0x330d, 0x00 },
-	{ 0x330e, 0x00 },
-	{ 0x330f, 0x40 },
-	{ 0x3307, 0x04 },
-	{ 0x3604, 0x04 },
-	{ 0x3602, 0x30 },
-	{ 0x3605, 0x00 },
-	{ 0x3607, 0x20 },
-	{ 0x3608, 0x11 },
-	{ 0x3609, 0x68 },
-	{ 0x360a, 0x40 },
-	{ 0x360c, 0xdd },
-	{ 0x360e, 0x0c },
-	{ 0x3610, 0x07 },
-	{ 0x3612, 0x86 },
-	{ 0x3613, 0x58 },
-	{ 0x3614, 0x28 },
-	{ 0x3617, 0x40 },
-	{ 0x3618, 0x5a },
-	{ 0x3619, 0x9b },
-	{ 0x361c, 0x00 },
-	{ 0x361d, 0x60 },
-	{ 0x3631, 0x60 },
-	{ 0x3633, 0x10 },
-	{ 0x3634, 0x10 },
-	{ 0x3635, 0x10 },
-	{ 0x3636, 0x10 },
-	{ OV8865_ASP_CTRL41_REG, 0x55 },
-	{ OV8865_ASP_CTRL46_REG, 0x86 },
-	{ OV8865_ASP_CTRL47_REG, 0x27 },
-	{ OV8865_ASP_CTRL50_REG, 0x1b },
-	{ OV8865_EXPOSURE_CTRL_HH_REG, 0x00 },
-	{ OV8865_EXPOSURE_CTRL_H_REG, 0x4c },
-	{ OV8865_EXPOSURE_CTRL_L_REG, 0x00 },
-	{ OV8865_MANUAL_CTRL_REG, 0x00 },
-	{ OV8865_GAIN_CTRL_H_REG, 0x02 },
-	{ OV8865_GAIN_CTRL_L_REG, 0x00 },
-	{ 0x3700, 0x24 },
-	{ 0x3701, 0x0c },
-	{ 0x3702, 0x28 },
-	{ 0x3703, 0x19 },
-	{ 0x3704, 0x14 },
-	{ 0x3705, 0x00 },
-	{ 0x3706, 0x38 },
-	{ 0x3707, 0x04 },
-	{ 0x3708, 0x24 },
-	{ 0x3709, 0x40 },
-	{ 0x370a, 0x00 },
-	{ 0x370b, 0xb8 },
-	{ 0x370c, 0x04 },
-	{ 0x3718, 0x12 },
-	{ 0x3719, 0x31 },
-	{ 0x3712, 0x42 },
-	{ 0x3714, 0x12 },
-	{ 0x371e, 0x19 },
-	{ 0x371f, 0x40 },
-	{ 0x3720, 0x05 },
-	{ 0x3721, 0x05 },
-	{ 0x3724, 0x02 },
-	{ 0x3725, 0x02 },
-	{ 0x3726, 0x06 },
-	{ 0x3728, 0x05 },
-	{ 0x3729, 0x02 },
-	{ 0x372a, 0x03 },
-	{ 0x372b, 0x53 },
-	{ 0x372c, 0xa3 },
-	{ 0x372d, 0x53 },
-	{ 0x372e, 0x06 },
-	{ 0x372f, 0x10 },
-	{ 0x3730, 0x01 },
-	{ 0x3731, 0x06 },
-	{ 0x3732, 0x14 },
-	{ 0x3733, 0x10 },
-	{ 0x3734, 0x40 },
-	{ 0x3736, 0x20 },
-	{ 0x373a, 0x02 },
-	{ 0x373b, 0x0c },
-	{ 0x373c, 0x0a },
-	{ 0x373e, 0x03 },
-	{ 0x3755, 0x40 },
-	{ 0x3758, 0x00 },
-	{ 0x3759, 0x4c },
-	{ 0x375a, 0x06 },
-	{ 0x375b, 0x13 },
-	{ 0x375c, 0x40 },
-	{ 0x375d, 0x02 },
-	{ 0x375e, 0x00 },
-	{ 0x375f, 0x14 },
-	{ 0x3767, 0x1c },
-	{ 0x3768, 0x04 },
-	{ 0x3769, 0x20 },
-	{ 0x376c, 0xc0 },
-	{ 0x376d, 0xc0 },
-	{ 0x376a, 0x08 },
-	{ 0x3761, 0x00 },
-	{ 0x3762, 0x00 },
-	{ 0x3763, 0x00 },
-	{ 0x3766, 0xff },
-	{ 0x376b, 0x42 },
-	{ 0x3772, 0x23 },
-	{ 0x3773, 0x02 },
-	{ 0x3774, 0x16 },
-	{ 0x3775, 0x12 },
-	{ 0x3776, 0x08 },
-	{ 0x37a0, 0x44 },
-	{ 0x37a1, 0x3d },
-	{ 0x37a2, 0x3d },
-	{ 0x37a3, 0x01 },
-	{ 0x37a4, 0x00 },
-	{ 0x37a5, 0x08 },
-	{ 0x37a6, 0x00 },
-	{ 0x37a7, 0x44 },
-	{ 0x37a8, 0x58 },
-	{ 0x37a9, 0x58 },
-	{ 0x3760, 0x00 },
-	{ 0x376f, 0x01 },
-	{ 0x37aa, 0x44 },
-	{ 0x37ab, 0x2e },
-	{ 0x37ac, 0x2e },
-	{ 0x37ad, 0x33 },
-	{ 0x37ae, 0x0d },
-	{ 0x37af, 0x0d },
-	{ 0x37b0, 0x00 },
-	{ 0x37b1, 0x00 },
-	{ 0x37b2, 0x00 },
-	{ 0x37b3, 0x42 },
-	{ 0x37b4, 0x42 },
-	{ 0x37b5, 0x33 },
-	{ 0x37b6, 0x00 },
-	{ 0x37b7, 0x00 },
-	{ 0x37b8, 0x00 },
-	{ 0x37b9, 0xff },
-	{ OV8865_OTP_REG, 0x06 },
-	{ OV8865_OTP_SETT_STT_ADDR_H_REG, 0x75 },
-	{ OV8865_OTP_SETT_STT_ADDR_L_REG, 0xef },
-	{ 0x3f08, 0x0b },
-	{ OV8865_CLIP_MAX_HI_REG, 0xff },
-	{ OV8865_CLIP_MIN_HI_REG, 0x00 },
-	{ OV8865_CLIP_LO_REG, 0x0f },
-	{ 0x4500, 0x40 },
-	{ 0x4503, 0x10 },
-	{ OV8865_R_VFIFO_READ_START_REG, 0x74 },
-	{ OV8865_CLK_PREPARE_MIN_REG, 0x32 },
-	{ OV8865_PCLK_PERIOD_REG, 0x16 },
-	{ OV8865_LANE_SEL01_REG, 0x10 },
-	{ OV8865_LANE_SEL23_REG, 0x32 },
-	{ OV8865_LVDS_R0_REG, 0x2a },
-	{ OV8865_LVDS_BLK_TIMES_L_REG, 0x00 },
-	{ 0x4d00, 0x04 },
-	{ 0x4d01, 0x18 },
-	{ 0x4d02, 0xc3 },
-	{ 0x4d03, 0xff },
-	{ 0x4d04, 0xff },
-	{ 0x4d05, 0xff },
-	{ OV8865_ISP_CTRL0_REG, 0x96 },
-	{ OV8865_ISP_CTRL1_REG, 0x01 },
-	{ OV8865_ISP_CTRL2_REG, 0x08 },
-	{ 0x5901, 0x00 },
-	{ OV8865_PRE_CTRL0, 0x00 },
-	{ OV8865_PRE_CTRL1, 0x41 },
-	{ OV8865_SW_STANDBY_REG, OV8865_SW_STANDBY_STANDBY_N },
-	{ OV8865_OTP_CTRL0, 0x02 },
-	{ OV8865_OTP_CTRL1, 0xd0 },
-	{ OV8865_OTP_CTRL2, 0x03 },
-	{ OV8865_OTP_CTRL3, 0xff },
-	{ OV8865_OTP_CTRL5, 0x6c },
-	{ 0x5780, 0xfc },
-	{ 0x5781, 0xdf },
-	{ 0x5782, 0x3f },
-	{ 0x5783, 0x08 },
-	{ 0x5784, 0x0c },
-	{ 0x5786, 0x20 },
-	{ 0x5787, 0x40 },
-	{ 0x5788, 0x08 },
-	{ 0x5789, 0x08 },
-	{ 0x578a, 0x02 },
-	{ 0x578b, 0x01 },
-	{ 0x578c, 0x01 },
-	{ 0x578d, 0x0c },
-	{ 0x578e, 0x02 },
-	{ 0x578f, 0x01 },
-	{ 0x5790, 0x01 },
-	{ OV8865_LENC_G0_REG, 0x1d },
-	{ OV8865_LENC_G1_REG, 0x0e },
-	{ OV8865_LENC_G2_REG, 0x0c },
-	{ OV8865_LENC_G3_REG, 0x0c },
-	{ OV8865_LENC_G4_REG, 0x0f },
-	{ OV8865_LENC_G5_REG, 0x22 },
-	{ OV8865_LENC_G10_REG, 0x0a },
-	{ OV8865_LENC_G11_REG, 0x06 },
-	{ OV8865_LENC_G12_REG, 0x05 },
-	{ OV8865_LENC_G13_REG, 0x05 },
-	{ OV8865_LENC_G14_REG, 0x07 },
-	{ OV8865_LENC_G15_REG, 0x0a },
-	{ OV8865_LENC_G20_REG, 0x06 },
-	{ OV8865_LENC_G21_REG, 0x02 },
-	{ OV8865_LENC_G22_REG, 0x00 },
-	{ OV8865_LENC_G23_REG, 0x00 },
-	{ OV8865_LENC_G24_REG, 0x03 },
-	{ OV8865_LENC_G25_REG, 0x07 },
-	{ OV8865_LENC_G30_REG, 0x06 },
-	{ OV8865_LENC_G31_REG, 0x02 },
-	{ OV8865_LENC_G32_REG, 0x00 },
-	{ OV8865_LENC_G33_REG, 0x00 },
-	{ OV8865_LENC_G34_REG, 0x03 },
-	{ OV8865_LENC_G35_REG, 0x07 },
-	{ OV8865_LENC_G40_REG, 0x09 },
-	{ OV8865_LENC_G41_REG, 0x06 },
-	{ OV8865_LENC_G42_REG, 0x04 },
-	{ OV8865_LENC_G43_REG, 0x04 },
-	{ OV8865_LENC_G44_REG, 0x06 },
-	{ OV8865_LENC_G45_REG, 0x0a },
-	{ OV8865_LENC_G50_REG, 0x19 },
-	{ OV8865_LENC_G51_REG, 0x0d },
-	{ OV8865_LENC_G52_REG, 0x0b },
-	{ OV8865_LENC_G53_REG, 0x0b },
-	{ OV8865_LENC_G54_REG, 0x0e },
-	{ OV8865_LENC_G55_REG, 0x22 },
-	{ OV8865_LENC_BR0_REG, 0x23 },
-	{ OV8865_LENC_BR1_REG, 0x28 },
-	{ OV8865_LENC_BR2_REG, 0x29 },
-	{ OV8865_LENC_BR3_REG, 0x27 },
-	{ OV8865_LENC_BR4_REG, 0x13 },
-	{ OV8865_LENC_BR10_REG, 0x26 },
-	{ OV8865_LENC_BR11_REG, 0x33 },
-	{ OV8865_LENC_BR12_REG, 0x32 },
-	{ OV8865_LENC_BR13_REG, 0x33 },
-	{ OV8865_LENC_BR14_REG, 0x16 },
-	{ OV8865_LENC_BR20_REG, 0x14 },
-	{ OV8865_LENC_BR21_REG, 0x30 },
-	{ OV8865_LENC_BR22_REG, 0x31 },
-	{ OV8865_LENC_BR23_REG, 0x30 },
-	{ OV8865_LENC_BR24_REG, 0x15 },
-	{ OV8865_LENC_BR30_REG, 0x26 },
-	{ OV8865_LENC_BR31_REG, 0x23 },
-	{ OV8865_LENC_BR32_REG, 0x21 },
-	{ OV8865_LENC_BR33_REG, 0x23 },
-	{ OV8865_LENC_BR34_REG, 0x05 },
-	{ OV8865_LENC_BR40_REG, 0x36 },
-	{ OV8865_LENC_BR41_REG, 0x27 },
-	{ OV8865_LENC_BR42_REG, 0x28 },
-	{ OV8865_LENC_BR43_REG, 0x26 },
-	{ OV8865_LENC_BR44_REG, 0x24 },
-	{ OV8865_LENC_BROFFSET_REG, 0xdf },
-	{ OV8865_SW_STANDBY_REG, 0x00 },
-};
+static inline struct ov8865_dev *ae_ctrl_to_ov8865_dev(struct v4l2_ctrl *ctrl)
+{
+	return container_of(ctrl->handler, struct ov8865_dev,
+			    ctrls.ae_handler);
+}
 
-static const struct reg_value ov8865_setting_QUXGA[] = {
-	{ OV8865_SW_STANDBY_REG, 0x00, 5 },
-	{ 0x3501, 0x98 },
-	{ 0x3502, 0x60 },
-	{ 0x3700, 0x48 },
-	{ 0x3701, 0x18 },
-	{ 0x3702, 0x50 },
-	{ 0x3703, 0x32 },
-	{ 0x3704, 0x28 },
-	{ 0x3706, 0x70 },
-	{ 0x3707, 0x08 },
-	{ 0x3708, 0x48 },
-	{ 0x3709, 0x80 },
-	{ 0x370a, 0x01 },
-	{ 0x370b, 0x70 },
-	{ 0x370c, 0x07 },
-	{ 0x3718, 0x14 },
-	{ 0x3712, 0x44 },
-	{ 0x371e, 0x31 },
-	{ 0x371f, 0x7f },
-	{ 0x3720, 0x0a },
-	{ 0x3721, 0x0a },
-	{ 0x3724, 0x04 },
-	{ 0x3725, 0x04 },
-	{ 0x3726, 0x0c },
-	{ 0x3728, 0x0a },
-	{ 0x3729, 0x03 },
-	{ 0x372a, 0x06 },
-	{ 0x372b, 0xa6 },
-	{ 0x372c, 0xa6 },
-	{ 0x372d, 0xa6 },
-	{ 0x372e, 0x0c },
-	{ 0x372f, 0x20 },
-	{ 0x3730, 0x02 },
-	{ 0x3731, 0x0c },
-	{ 0x3732, 0x28 },
-	{ 0x3736, 0x30 },
-	{ 0x373a, 0x04 },
-	{ 0x373b, 0x18 },
-	{ 0x373c, 0x14 },
-	{ 0x373e, 0x06 },
-	{ 0x375a, 0x0c },
-	{ 0x375b, 0x26 },
-	{ 0x375d, 0x04 },
-	{ 0x375f, 0x28 },
-	{ 0x3767, 0x1e },
-	{ 0x3772, 0x46 },
-	{ 0x3773, 0x04 },
-	{ 0x3774, 0x2c },
-	{ 0x3775, 0x13 },
-	{ 0x3776, 0x10 },
-	{ 0x37a0, 0x88 },
-	{ 0x37a1, 0x7a },
-	{ 0x37a2, 0x7a },
-	{ 0x37a3, 0x02 },
-	{ 0x37a5, 0x09 },
-	{ 0x37a7, 0x88 },
-	{ 0x37a8, 0xb0 },
-	{ 0x37a9, 0xb0 },
-	{ 0x37aa, 0x88 },
-	{ 0x37ab, 0x5c },
-	{ 0x37ac, 0x5c },
-	{ 0x37ad, 0x55 },
-	{ 0x37ae, 0x19 },
-	{ 0x37af, 0x19 },
-	{ 0x37b3, 0x84 },
-	{ 0x37b4, 0x84 },
-	{ 0x37b5, 0x66 },
-	{ 0x3f08, 0x16 },
-	{ 0x4500, 0x68 },
-	{ OV8865_R_VFIFO_READ_START_REG, 0x10 },
-	{ OV8865_ISP_CTRL2_REG, 0x08 },
-	{ 0x5901, 0x00 },
-	{ OV8865_SW_STANDBY_REG, 0x00 },
+static const u8 ov8865_init_setting_QUXGA_data[] = {
+	SENSOR_SEQ_REGS(OV8865_SW_RESET_REG, 0x01),
+	SENSOR_SEQ_DELAY(16),
+	SENSOR_SEQ_REGS(OV8865_SW_STANDBY_REG, 0x00),
+	SENSOR_SEQ_REGS(OV8865_SW_STANDBY_REG, 0x00),
+	SENSOR_SEQ_REGS(OV8865_SW_STANDBY_REG, 0x00),
+	SENSOR_SEQ_REGS(OV8865_SW_STANDBY_REG, 0x00),
+	SENSOR_SEQ_REGS(0x3638, 0xff),
+	SENSOR_SEQ_REGS(OV8865_PUMP_CLK_DIV_REG, 0x01),
+	SENSOR_SEQ_REGS(OV8865_MIPI_SC_CTRL_REG, 0x01),
+	SENSOR_SEQ_REGS(0x3031, 0x0a),
+	SENSOR_SEQ_REGS(0x3305, 0xf1),
+	SENSOR_SEQ_REGS(0x3308, 0x00, 0x28, 0x00, 0x20, 0x00, 0x00, 0x00, 0x40),
+	SENSOR_SEQ_REGS(0x3307, 0x04),
+	SENSOR_SEQ_REGS(0x3604, 0x04),
+	SENSOR_SEQ_REGS(0x3602, 0x30),
+	SENSOR_SEQ_REGS(0x3605, 0x00),
+	SENSOR_SEQ_REGS(0x3607, 0x20, 0x11, 0x68, 0x40),
+	SENSOR_SEQ_REGS(0x360c, 0xdd),
+	SENSOR_SEQ_REGS(0x360e, 0x0c),
+	SENSOR_SEQ_REGS(0x3610, 0x07),
+	SENSOR_SEQ_REGS(0x3612, 0x86, 0x58, 0x28),
+	SENSOR_SEQ_REGS(0x3617, 0x40, 0x5a, 0x9b),
+	SENSOR_SEQ_REGS(0x361c, 0x00, 0x60),
+	SENSOR_SEQ_REGS(0x3631, 0x60),
+	SENSOR_SEQ_REGS(0x3633, 0x10, 0x10, 0x10, 0x10),
+	SENSOR_SEQ_REGS(OV8865_ASP_CTRL41_REG, 0x55),
+	SENSOR_SEQ_REGS(OV8865_ASP_CTRL46_REG, 0x86, 0x27),
+	SENSOR_SEQ_REGS(OV8865_ASP_CTRL50_REG, 0x1b),
+	SENSOR_SEQ_REGS(OV8865_EXPOSURE_CTRL_HH_REG, 0x00, 0x4c, 0x00, 0x00),
+	SENSOR_SEQ_REGS(OV8865_GAIN_CTRL_H_REG, 0x02, 0x00),
+	SENSOR_SEQ_REGS(0x3700,
+			0x24, 0x0c, 0x28, 0x19, 0x14, 0x00, 0x38, 0x04,
+			0x24, 0x40, 0x00, 0xb8, 0x04),
+	SENSOR_SEQ_REGS(0x3718, 0x12, 0x31),
+	SENSOR_SEQ_REGS(0x3712, 0x42),
+	SENSOR_SEQ_REGS(0x3714, 0x12),
+	SENSOR_SEQ_REGS(0x371e, 0x19, 0x40, 0x05, 0x05),
+	SENSOR_SEQ_REGS(0x3724, 0x02, 0x02, 0x06),
+	SENSOR_SEQ_REGS(0x3728,
+			0x05, 0x02, 0x03, 0x53, 0xa3, 0x53, 0x06, 0x10,
+			0x01, 0x06, 0x14, 0x10, 0x40),
+	SENSOR_SEQ_REGS(0x3736, 0x20),
+	SENSOR_SEQ_REGS(0x373a, 0x02, 0x0c, 0x0a),
+	SENSOR_SEQ_REGS(0x373e, 0x03),
+	SENSOR_SEQ_REGS(0x3755, 0x40),
+	SENSOR_SEQ_REGS(0x3758, 0x00, 0x4c, 0x06, 0x13, 0x40, 0x02, 0x00, 0x14),
+	SENSOR_SEQ_REGS(0x3767, 0x1c, 0x04, 0x20),
+	SENSOR_SEQ_REGS(0x376c, 0xc0, 0xc0),
+	SENSOR_SEQ_REGS(0x376a, 0x08),
+	SENSOR_SEQ_REGS(0x3761, 0x00, 0x00, 0x00),
+	SENSOR_SEQ_REGS(0x3766, 0xff),
+	SENSOR_SEQ_REGS(0x376b, 0x42),
+	SENSOR_SEQ_REGS(0x3772, 0x23, 0x02, 0x16, 0x12, 0x08),
+	SENSOR_SEQ_REGS(0x37a0,
+			0x44, 0x3d, 0x3d, 0x01, 0x00, 0x08, 0x00, 0x44,
+			0x58, 0x58),
+	SENSOR_SEQ_REGS(0x3760, 0x00),
+	SENSOR_SEQ_REGS(0x376f, 0x01),
+	SENSOR_SEQ_REGS(0x37aa,
+			0x44, 0x2e, 0x2e, 0x33, 0x0d, 0x0d, 0x00, 0x00,
+			0x00, 0x42, 0x42, 0x33, 0x00, 0x00, 0x00, 0xff),
+	SENSOR_SEQ_REGS(OV8865_OTP_REG, 0x06),
+	SENSOR_SEQ_REGS(OV8865_OTP_SETT_STT_ADDR_H_REG, 0x75, 0xef),
+	SENSOR_SEQ_REGS(0x3f08, 0x0b),
+	SENSOR_SEQ_REGS(OV8865_CLIP_MAX_HI_REG, 0xff, 0x00, 0x0f),
+	SENSOR_SEQ_REGS(0x4500, 0x40),
+	SENSOR_SEQ_REGS(0x4503, 0x10),
+	SENSOR_SEQ_REGS(OV8865_R_VFIFO_READ_START_REG, 0x74),
+	SENSOR_SEQ_REGS(OV8865_CLK_PREPARE_MIN_REG, 0x32),
+	SENSOR_SEQ_REGS(OV8865_PCLK_PERIOD_REG, 0x16),
+	SENSOR_SEQ_REGS(OV8865_LANE_SEL01_REG, 0x10, 0x32),
+	SENSOR_SEQ_REGS(OV8865_LVDS_R0_REG, 0x2a),
+	SENSOR_SEQ_REGS(OV8865_LVDS_BLK_TIMES_L_REG, 0x00),
+	SENSOR_SEQ_REGS(0x4d00, 0x04, 0x18, 0xc3, 0xff, 0xff, 0xff),
+	SENSOR_SEQ_REGS(OV8865_ISP_CTRL0_REG, 0x96, 0x01, 0x08),
+	SENSOR_SEQ_REGS(0x5901, 0x00),
+	SENSOR_SEQ_REGS(OV8865_PRE_CTRL0, 0x00, 0x41),
+	SENSOR_SEQ_REGS(OV8865_SW_STANDBY_REG, OV8865_SW_STANDBY_STANDBY_N),
+	SENSOR_SEQ_REGS(OV8865_OTP_CTRL0, 0x02, 0xd0, 0x03, 0xff),
+	SENSOR_SEQ_REGS(OV8865_OTP_CTRL5, 0x6c),
+	SENSOR_SEQ_REGS(0x5780, 0xfc, 0xdf, 0x3f, 0x08, 0x0c),
+	SENSOR_SEQ_REGS(0x5786,
+			0x20, 0x40, 0x08, 0x08, 0x02, 0x01, 0x01, 0x0c,
+			0x02, 0x01, 0x01),
+	SENSOR_SEQ_REGS(OV8865_LENC_G0_REG,
+			0x1d, 0x0e, 0x0c, 0x0c, 0x0f, 0x22, 0x0a, 0x06,
+			0x05, 0x05, 0x07, 0x0a, 0x06, 0x02, 0x00, 0x00,
+			0x03, 0x07, 0x06, 0x02, 0x00, 0x00, 0x03, 0x07,
+			0x09, 0x06, 0x04, 0x04, 0x06, 0x0a, 0x19, 0x0d,
+			0x0b, 0x0b, 0x0e, 0x22, 0x23, 0x28, 0x29, 0x27,
+			0x13, 0x26, 0x33, 0x32, 0x33, 0x16, 0x14, 0x30,
+			0x31, 0x30, 0x15, 0x26, 0x23, 0x21, 0x23, 0x05,
+			0x36, 0x27, 0x28, 0x26, 0x24, 0xdf),
+	SENSOR_SEQ_REGS(OV8865_SW_STANDBY_REG, 0x00),
 };
 
-static const struct reg_value ov8865_setting_6M[] = {
-	{ OV8865_SW_STANDBY_REG, 0x00, 5 },
-	{ 0x3501, 0x72 },
-	{ 0x3502, 0x20 },
-	{ 0x3700, 0x48 },
-	{ 0x3701, 0x18 },
-	{ 0x3702, 0x50 },
-	{ 0x3703, 0x32 },
-	{ 0x3704, 0x28 },
-	{ 0x3706, 0x70 },
-	{ 0x3707, 0x08 },
-	{ 0x3708, 0x48 },
-	{ 0x3709, 0x80 },
-	{ 0x370a, 0x01 },
-	{ 0x370b, 0x70 },
-	{ 0x370c, 0x07 },
-	{ 0x3718, 0x14 },
-	{ 0x3712, 0x44 },
-	{ 0x371e, 0x31 },
-	{ 0x371f, 0x7f },
-	{ 0x3720, 0x0a },
-	{ 0x3721, 0x0a },
-	{ 0x3724, 0x04 },
-	{ 0x3725, 0x04 },
-	{ 0x3726, 0x0c },
-	{ 0x3728, 0x0a },
-	{ 0x3729, 0x03 },
-	{ 0x372a, 0x06 },
-	{ 0x372b, 0xa6 },
-	{ 0x372c, 0xa6 },
-	{ 0x372d, 0xa6 },
-	{ 0x372e, 0x0c },
-	{ 0x372f, 0x20 },
-	{ 0x3730, 0x02 },
-	{ 0x3731, 0x0c },
-	{ 0x3732, 0x28 },
-	{ 0x3736, 0x30 },
-	{ 0x373a, 0x04 },
-	{ 0x373b, 0x18 },
-	{ 0x373c, 0x14 },
-	{ 0x373e, 0x06 },
-	{ 0x375a, 0x0c },
-	{ 0x375b, 0x26 },
-	{ 0x375d, 0x04 },
-	{ 0x375f, 0x28 },
-	{ 0x3767, 0x1e },
-	{ 0x3772, 0x46 },
-	{ 0x3773, 0x04 },
-	{ 0x3774, 0x2c },
-	{ 0x3775, 0x13 },
-	{ 0x3776, 0x10 },
-	{ 0x37a0, 0x88 },
-	{ 0x37a1, 0x7a },
-	{ 0x37a2, 0x7a },
-	{ 0x37a3, 0x02 },
-	{ 0x37a5, 0x09 },
-	{ 0x37a7, 0x88 },
-	{ 0x37a8, 0xb0 },
-	{ 0x37a9, 0xb0 },
-	{ 0x37aa, 0x88 },
-	{ 0x37ab, 0x5c },
-	{ 0x37ac, 0x5c },
-	{ 0x37ad, 0x55 },
-	{ 0x37ae, 0x19 },
-	{ 0x37af, 0x19 },
-	{ 0x37b3, 0x84 },
-	{ 0x37b4, 0x84 },
-	{ 0x37b5, 0x66 },
-	{ 0x3f08, 0x16 },
-	{ 0x4500, 0x68 },
-	{ OV8865_R_VFIFO_READ_START_REG, 0x10 },
-	{ OV8865_ISP_CTRL2_REG, 0x08 },
-	{ 0x5901, 0x00 },
-	{ OV8865_SW_STANDBY_REG, 0x00 },
+static const struct sensor_seq ov8865_init_setting_QUXGA =
+	SENSOR_SEQ(ov8865_init_setting_QUXGA_data);
+
+static const u8 ov8865_setting_QUXGA_data[] = {
+	SENSOR_SEQ_REGS(OV8865_SW_STANDBY_REG, 0x00),
+	SENSOR_SEQ_DELAY(5),
+	SENSOR_SEQ_REGS(0x3501, 0x98, 0x60),
+	SENSOR_SEQ_REGS(0x3700, 0x48, 0x18, 0x50, 0x32, 0x28),
+	SENSOR_SEQ_REGS(0x3706, 0x70, 0x08, 0x48, 0x80, 0x01, 0x70, 0x07),
+	SENSOR_SEQ_REGS(0x3718, 0x14),
+	SENSOR_SEQ_REGS(0x3712, 0x44),
+	SENSOR_SEQ_REGS(0x371e, 0x31, 0x7f, 0x0a, 0x0a),
+	SENSOR_SEQ_REGS(0x3724, 0x04, 0x04, 0x0c),
+	SENSOR_SEQ_REGS(0x3728,
+			0x0a, 0x03, 0x06, 0xa6, 0xa6, 0xa6, 0x0c, 0x20,
+			0x02, 0x0c, 0x28),
+	SENSOR_SEQ_REGS(0x3736, 0x30),
+	SENSOR_SEQ_REGS(0x373a, 0x04, 0x18, 0x14),
+	SENSOR_SEQ_REGS(0x373e, 0x06),
+	SENSOR_SEQ_REGS(0x375a, 0x0c, 0x26),
+	SENSOR_SEQ_REGS(0x375d, 0x04),
+	SENSOR_SEQ_REGS(0x375f, 0x28),
+	SENSOR_SEQ_REGS(0x3767, 0x1e),
+	SENSOR_SEQ_REGS(0x3772, 0x46, 0x04, 0x2c, 0x13, 0x10),
+	SENSOR_SEQ_REGS(0x37a0, 0x88, 0x7a, 0x7a, 0x02),
+	SENSOR_SEQ_REGS(0x37a5, 0x09),
+	SENSOR_SEQ_REGS(0x37a7,
+			0x88, 0xb0, 0xb0, 0x88, 0x5c, 0x5c, 0x55, 0x19,
+			0x19),
+	SENSOR_SEQ_REGS(0x37b3, 0x84, 0x84, 0x66),
+	SENSOR_SEQ_REGS(0x3f08, 0x16),
+	SENSOR_SEQ_REGS(0x4500, 0x68),
+	SENSOR_SEQ_REGS(OV8865_R_VFIFO_READ_START_REG, 0x10),
+	SENSOR_SEQ_REGS(OV8865_ISP_CTRL2_REG, 0x08),
+	SENSOR_SEQ_REGS(0x5901, 0x00),
+	SENSOR_SEQ_REGS(OV8865_SW_STANDBY_REG, 0x00),
 };
 
+static const struct sensor_seq ov8865_setting_QUXGA =
+	SENSOR_SEQ(ov8865_setting_QUXGA_data);
+
+static const struct sensor_seq_patch ov8865_setting_6M_patch[] = {
+	SENSOR_SEQ_SET(0x3501, 0x72),
+	SENSOR_SEQ_SET(0x3502, 0x20),
+};
 
-static const struct reg_value ov8865_setting_UXGA[] = {
-	{ OV8865_SW_STANDBY_REG, 0x00, 5 },
-	{ 0x3501, 0x4c },
-	{ 0x3502, 0x00 },
-	{ 0x3700, 0x24 },
-	{ 0x3701, 0x0c },
-	{ 0x3702, 0x28 },
-	{ 0x3703, 0x19 },
-	{ 0x3704, 0x14 },
-	{ 0x3706, 0x38 },
-	{ 0x3707, 0x04 },
-	{ 0x3708, 0x24 },
-	{ 0x3709, 0x40 },
-	{ 0x370a, 0x00 },
-	{ 0x370b, 0xb8 },
-	{ 0x370c, 0x04 },
-	{ 0x3718, 0x12 },
-	{ 0x3712, 0x42 },
-	{ 0x371e, 0x19 },
-	{ 0x371f, 0x40 },
-	{ 0x3720, 0x05 },
-	{ 0x3721, 0x05 },
-	{ 0x3724, 0x02 },
-	{ 0x3725, 0x02 },
-	{ 0x3726, 0x06 },
-	{ 0x3728, 0x05 },
-	{ 0x3729, 0x02 },
-	{ 0x372a, 0x03 },
-	{ 0x372b, 0x53 },
-	{ 0x372c, 0xa3 },
-	{ 0x372d, 0x53 },
-	{ 0x372e, 0x06 },
-	{ 0x372f, 0x10 },
-	{ 0x3730, 0x01 },
-	{ 0x3731, 0x06 },
-	{ 0x3732, 0x14 },
-	{ 0x3736, 0x20 },
-	{ 0x373a, 0x02 },
-	{ 0x373b, 0x0c },
-	{ 0x373c, 0x0a },
-	{ 0x373e, 0x03 },
-	{ 0x375a, 0x06 },
-	{ 0x375b, 0x13 },
-	{ 0x375d, 0x02 },
-	{ 0x375f, 0x14 },
-	{ 0x3767, 0x1c },
-	{ 0x3772, 0x23 },
-	{ 0x3773, 0x02 },
-	{ 0x3774, 0x16 },
-	{ 0x3775, 0x12 },
-	{ 0x3776, 0x08 },
-	{ 0x37a0, 0x44 },
-	{ 0x37a1, 0x3d },
-	{ 0x37a2, 0x3d },
-	{ 0x37a3, 0x01 },
-	{ 0x37a5, 0x08 },
-	{ 0x37a7, 0x44 },
-	{ 0x37a8, 0x58 },
-	{ 0x37a9, 0x58 },
-	{ 0x37aa, 0x44 },
-	{ 0x37ab, 0x2e },
-	{ 0x37ac, 0x2e },
-	{ 0x37ad, 0x33 },
-	{ 0x37ae, 0x0d },
-	{ 0x37af, 0x0d },
-	{ 0x37b3, 0x42 },
-	{ 0x37b4, 0x42 },
-	{ 0x37b5, 0x33 },
-	{ 0x3f08, 0x0b },
-	{ 0x4500, 0x40 },
-	{ OV8865_R_VFIFO_READ_START_REG, 0x74 },
-	{ OV8865_ISP_CTRL2_REG, 0x08 },
-	{ 0x5901, 0x00 },
-	{ OV8865_SW_STANDBY_REG, 0x00 },
+static const struct sensor_seq ov8865_setting_6M =
+	SENSOR_SEQ_PATCHED(ov8865_setting_QUXGA_data, ov8865_setting_6M_patch);
+
+
+static const u8 ov8865_setting_UXGA_data[] = {
+	SENSOR_SEQ_REGS(OV8865_SW_STANDBY_REG, 0x00),
+	SENSOR_SEQ_DELAY(5),
+	SENSOR_SEQ_REGS(0x3501, 0x4c, 0x00),
+	SENSOR_SEQ_REGS(0x3700, 0x24, 0x0c, 0x28, 0x19, 0x14),
+	SENSOR_SEQ_REGS(0x3706, 0x38, 0x04, 0x24, 0x40, 0x00, 0xb8, 0x04),
+	SENSOR_SEQ_REGS(0x3718, 0x12),
+	SENSOR_SEQ_REGS(0x3712, 0x42),
+	SENSOR_SEQ_REGS(0x371e, 0x19, 0x40, 0x05, 0x05),
+	SENSOR_SEQ_REGS(0x3724, 0x02, 0x02, 0x06),
+	SENSOR_SEQ_REGS(0x3728,
+			0x05, 0x02, 0x03, 0x53, 0xa3, 0x53, 0x06, 0x10,
+			0x01, 0x06, 0x14),
+	SENSOR_SEQ_REGS(0x3736, 0x20),
+	SENSOR_SEQ_REGS(0x373a, 0x02, 0x0c, 0x0a),
+	SENSOR_SEQ_REGS(0x373e, 0x03),
+	SENSOR_SEQ_REGS(0x375a, 0x06, 0x13),
+	SENSOR_SEQ_REGS(0x375d, 0x02),
+	SENSOR_SEQ_REGS(0x375f, 0x14),
+	SENSOR_SEQ_REGS(0x3767, 0x1c),
+	SENSOR_SEQ_REGS(0x3772, 0x23, 0x02, 0x16, 0x12, 0x08),
+	SENSOR_SEQ_REGS(0x37a0, 0x44, 0x3d, 0x3d, 0x01),
+	SENSOR_SEQ_REGS(0x37a5, 0x08),
+	SENSOR_SEQ_REGS(0x37a7,
+			0x44, 0x58, 0x58, 0x44, 0x2e, 0x2e, 0x33, 0x0d,
+			0x0d),
+	SENSOR_SEQ_REGS(0x37b3, 0x42, 0x42, 0x33),
+	SENSOR_SEQ_REGS(0x3f08, 0x0b),
+	SENSOR_SEQ_REGS(0x4500, 0x40),
+	SENSOR_SEQ_REGS(OV8865_R_VFIFO_READ_START_REG, 0x74),
+	SENSOR_SEQ_REGS(OV8865_ISP_CTRL2_REG, 0x08),
+	SENSOR_SEQ_REGS(0x5901, 0x00),
+	SENSOR_SEQ_REGS(OV8865_SW_STANDBY_REG, 0x00),
 };
 
-static const struct reg_value ov8865_setting_SVGA[] = {
-	{ OV8865_SW_STANDBY_REG, 0x00, 5 },
-	{ 0x3501, 0x26 },
-	{ 0x3502, 0x00 },
-	{ 0x3700, 0x24 },
-	{ 0x3701, 0x0c },
-	{ 0x3702, 0x28 },
-	{ 0x3703, 0x19 },
-	{ 0x3704, 0x14 },
-	{ 0x3706, 0x38 },
-	{ 0x3707, 0x04 },
-	{ 0x3708, 0x24 },
-	{ 0x3709, 0x40 },
-	{ 0x370a, 0x00 },
-	{ 0x370b, 0xb8 },
-	{ 0x370c, 0x04 },
-	{ 0x3718, 0x12 },
-	{ 0x3712, 0x42 },
-	{ 0x371e, 0x19 },
-	{ 0x371f, 0x40 },
-	{ 0x3720, 0x05 },
-	{ 0x3721, 0x05 },
-	{ 0x3724, 0x02 },
-	{ 0x3725, 0x02 },
-	{ 0x3726, 0x06 },
-	{ 0x3728, 0x05 },
-	{ 0x3729, 0x02 },
-	{ 0x372a, 0x03 },
-	{ 0x372b, 0x53 },
-	{ 0x372c, 0xa3 },
-	{ 0x372d, 0x53 },
-	{ 0x372e, 0x06 },
-	{ 0x372f, 0x10 },
-	{ 0x3730, 0x01 },
-	{ 0x3731, 0x06 },
-	{ 0x3732, 0x14 },
-	{ 0x3736, 0x20 },
-	{ 0x373a, 0x02 },
-	{ 0x373b, 0x0c },
-	{ 0x373c, 0x0a },
-	{ 0x373e, 0x03 },
-	{ 0x375a, 0x06 },
-	{ 0x375b, 0x13 },
-	{ 0x375d, 0x02 },
-	{ 0x375f, 0x14 },
-	{ 0x3767, 0x18 },
-	{ 0x3772, 0x23 },
-	{ 0x3773, 0x02 },
-	{ 0x3774, 0x16 },
-	{ 0x3775, 0x12 },
-	{ 0x3776, 0x08 },
-	{ 0x37a0, 0x44 },
-	{ 0x37a1, 0x3d },
-	{ 0x37a2, 0x3d },
-	{ 0x37a3, 0x01 },
-	{ 0x37a5, 0x08 },
-	{ 0x37a7, 0x44 },
-	{ 0x37a8, 0x58 },
-	{ 0x37a9, 0x58 },
-	{ 0x37aa, 0x44 },
-	{ 0x37ab, 0x2e },
-	{ 0x37ac, 0x2e },
-	{ 0x37ad, 0x33 },
-	{ 0x37ae, 0x0d },
-	{ 0x37af, 0x0d },
-	{ 0x37b3, 0x42 },
-	{ 0x37b4, 0x42 },
-	{ 0x37b5, 0x33 },
-	{ 0x3f08, 0x0b },
-	{ 0x4500, 0x40 },
-	{ OV8865_R_VFIFO_READ_START_REG, 0x50 },
-	{ OV8865_ISP_CTRL2_REG, 0x0c },
-	{ 0x5901, 0x04 },
-	{ OV8865_SW_STANDBY_REG, 0x00 },
+static const struct sensor_seq ov8865_setting_UXGA =
+	SENSOR_SEQ(ov8865_setting_UXGA_data);
+
+static const struct sensor_seq_patch ov8865_setting_SVGA_patch[] = {
+	SENSOR_SEQ_SET(0x3501, 0x26),
+	SENSOR_SEQ_SET(0x3767, 0x18),
+	SENSOR_SEQ_SET(OV8865_R_VFIFO_READ_START_REG, 0x50),
+	SENSOR_SEQ_SET(OV8865_ISP_CTRL2_REG, 0x0c),
+	SENSOR_SEQ_SET(0x5901, 0x04),
 };
 
+static const struct sensor_seq ov8865_setting_SVGA =
+	SENSOR_SEQ_PATCHED(ov8865_setting_UXGA_data, ov8865_setting_SVGA_patch);
+
 static const struct ov8865_mode_info ov8865_mode_init_data = {
 	.id = 0,
 	.hact = 3264,
 	.htot = 1944,
 	.vact = 2448,
 	.vtot = 2470,
-	.reg_data = ov8865_init_setting_QUXGA,
-	.reg_data_size = ARRAY_SIZE(ov8865_init_setting_QUXGA),
+	.max_fps = 30,
+	.crop = OV8865_CROP_FULL,
+	.reg_data = &ov8865_init_setting_QUXGA,
 };
 
 static const struct ov8865_mode_info ov8865_mode_data[OV8865_NUM_MODES] = {
 	{
 		.id = OV8865_MODE_QUXGA_3264_2448,
+		.readout = OV8865_READOUT_FULL,
 		.hact = 3264,
 		.htot = 1944,
 		.vact = 2448,
 		.vtot = 2470,
-		.reg_data = ov8865_setting_QUXGA,
-		.reg_data_size = ARRAY_SIZE(ov8865_setting_QUXGA)
+		.max_fps = 30,
+		.crop = OV8865_CROP_FULL,
+		.reg_data = &ov8865_setting_QUXGA,
 	},
 	{
 		.id = OV8865_MODE_6M_3264_1836,
+		.readout = OV8865_READOUT_FULL,
 		.hact = 3264,
 		.htot = 2582,
 		.vact = 1836,
 		.vtot = 1858,
-		.reg_data = ov8865_setting_6M,
-		.reg_data_size = ARRAY_SIZE(ov8865_setting_6M)
+		.max_fps = 30,
+		.crop = OV8865_CROP_FULL,
+		.reg_data = &ov8865_setting_6M,
 	},
 	{
 		.id = OV8865_MODE_1080P_1920_1080,
+		.readout = OV8865_READOUT_FULL,
 		.hact = 1920,
 		.htot = 2582,
 		.vact = 1080,
 		.vtot = 1858,
-		.reg_data = ov8865_setting_6M,
-		.reg_data_size = ARRAY_SIZE(ov8865_setting_6M)
+		.max_fps = 30,
+		.crop = OV8865_CROP_FULL,
+		.reg_data = &ov8865_setting_6M,
 	},
 	{
 		.id = OV8865_MODE_720P_1280_720,
+		.readout = OV8865_READOUT_HALF,
 		.hact = 1280,
 		.htot = 1923,
 		.vact = 720,
 		.vtot = 1248,
-		.reg_data = ov8865_setting_UXGA,
-		.reg_data_size = ARRAY_SIZE(ov8865_setting_UXGA)
+		.max_fps = 30,
+		.crop = OV8865_CROP_FULL,
+		.reg_data = &ov8865_setting_UXGA,
 	},
 	{
 		.id = OV8865_MODE_UXGA_1600_1200,
+		.readout = OV8865_READOUT_HALF,
 		.hact = 1600,
 		.htot = 1923,
 		.vact = 1200,
 		.vtot = 1248,
-		.reg_data = ov8865_setting_UXGA,
-		.reg_data_size = ARRAY_SIZE(ov8865_setting_UXGA)
+		.max_fps = 30,
+		.crop = OV8865_CROP_FULL,
+		.reg_data = &ov8865_setting_UXGA,
 	},
 	{
 		.id = OV8865_MODE_SVGA_800_600,
+		.readout = OV8865_READOUT_QUARTER,
 		.hact = 800,
 		.htot = 1250,
 		.vact = 600,
 		.vtot = 640,
-		.reg_data = ov8865_setting_SVGA,
-		.reg_data_size = ARRAY_SIZE(ov8865_setting_SVGA)
+		.max_fps = 90,
+		.crop = OV8865_CROP_FULL,
+		.reg_data = &ov8865_setting_SVGA,
 	},
 	{
 		.id = OV8865_MODE_VGA_640_480,
+		.readout = OV8865_READOUT_FULL,
 		.hact = 640,
 		.htot = 2582,
 		.vact = 480,
 		.vtot = 1858,
-		.reg_data = ov8865_setting_6M,
-		.reg_data_size = ARRAY_SIZE(ov8865_setting_6M)
+		.max_fps = 30,
+		.crop = OV8865_CROP_FULL,
+		.reg_data = &ov8865_setting_6M,
+	},
+	{
+		/* SVGA readout of a 16:9 window in the middle of the array */
+		.id = OV8865_MODE_360P_640_360,
+		.readout = OV8865_READOUT_QUARTER,
+		.hact = 640,
+		.htot = 1250,
+		.vact = 360,
+		.vtot = 400,
+		.max_fps = 144,
+		.crop = { .left = 332, .top = 492,
+			  .width = 2632, .height = 1496 },
+		.reg_data = &ov8865_setting_SVGA,
 	},
 };
 
 static int ov8865_write_reg(struct ov8865_dev *sensor, u16 reg, u8 val)
 {
-	struct i2c_client *client = sensor->i2c_client;
-	struct i2c_msg msg = { 0 };
-	u8 buf[3];
-	int ret;
+	return sensor_reg_write8(&sensor->i2c, reg, val);
+}
 
-	buf[0] = reg >> 8;
-	buf[1] = reg & 0xff;
-	buf[2] = val;
+static int ov8865_write_reg16(struct ov8865_dev *sensor, u16 reg, u16 val)
+{
+	return sensor_reg_write16(&sensor->i2c, reg, val);
+}
 
-	msg.addr = client->addr;
-	msg.flags = client->flags;
-	msg.buf = buf;
-	msg.len = sizeof(buf);
+static int ov8865_write_reg24(struct ov8865_dev *sensor, u16 reg, u32 val)
+{
+	return sensor_reg_write24(&sensor->i2c, reg, val);
+}
 
-	ret = i2c_transfer(client->adapter, &msg, 1);
-	if (ret < 0) {
-		dev_err(&client->dev, "%s: error: reg=%x, val=%x\n",
-			__func__, reg, val);
-		return ret;
-	}
+/* Registers the sensor updates by itself, never read from the shadow */
+static bool ov8865_volatile_reg(u16 reg)
+{
+	if (reg == OV8865_SW_RESET_REG || reg == OV8865_OTP_LOAD_CTRL_REG)
+		return true;
 
-	return 0;
+	return reg >= OV8865_OTP_SRAM_START_REG &&
+	       reg <= OV8865_OTP_SRAM_END_REG;
 }
 
-static int ov8865_write_reg16(struct ov8865_dev *sensor, u16 reg, u16 val)
+/*
+ * Read @n consecutive registers in one transfer, or from the shadow if
+ * they are all known
+ */
+static int ov8865_read_regs(struct ov8865_dev *sensor, u16 reg, u8 *val,
+			    unsigned int n)
 {
+	struct sensor_shadow *shadow = &sensor->shadow;
+	unsigned int i;
 	int ret;
 
-	ret = ov8865_write_reg(sensor, reg, val >> 8);
-	if (ret)
-		return ret;
+	if (!ov8865_volatile_reg(reg)) {
+		for (i = 0; i < n; i++)
+			if (!sensor_shadow_get(shadow, reg + i, &val[i]))
+				break;
+		if (i == n)
+			return 0;
+	}
 
-	ret = ov8865_write_reg(sensor, reg + 1, val & 0xff);
+	ret = sensor_reg_read(&sensor->i2c, reg, val, n);
 	if (ret)
 		return ret;
 
+	if (!ov8865_volatile_reg(reg))
+		sensor_shadow_set(shadow, reg, val, n);
+
 	return 0;
 }
 
 static int ov8865_read_reg(struct ov8865_dev *sensor, u16 reg, u8 *val)
 {
-	struct i2c_client *client = sensor->i2c_client;
-	struct i2c_msg msg[2]  = { 0 };
-	u8 buf[2];
-	int ret = 0;
-
-	buf[0] = reg >> 8;
-	buf[1] = reg & 0xff;
-
-	msg[0].addr = client->addr;
-	msg[0].flags = client->flags;
-	msg[0].buf = buf;
-	msg[0].len = sizeof(buf);
+	return ov8865_read_regs(sensor, reg, val, 1);
+}
 
-	msg[1].addr = client->addr;
-	/* Read data from the sensor to the controller */
-	msg[1].flags =  I2C_M_RD;
-	msg[1].buf = buf;
-	msg[1].len = 1;
+static int ov8865_read_reg16(struct ov8865_dev *sensor, u16 reg, u16 *val)
+{
+	u8 buf[2];
+	int ret;
 
-	ret = i2c_transfer(client->adapter, msg, 2);
-	if (ret < 0) {
-		dev_err(&client->dev, "%s: error: reg=%x\n", __func__, reg);
+	ret = ov8865_read_regs(sensor, reg, buf, sizeof(buf));
+	if (ret)
 		return ret;
-	}
 
-	*val = buf[0];
+	*val = ((u16)buf[0] << 8) | buf[1];
 
 	return 0;
 }
 
-static int ov8865_read_reg16(struct ov8865_dev *sensor, u16 reg, u16 *val)
+static int ov8865_read_reg24(struct ov8865_dev *sensor, u16 reg, u32 *val)
 {
-	u8 hi, lo;
+	u8 buf[3];
 	int ret;
 
-	ret = ov8865_read_reg(sensor, reg, &hi);
-	if (ret)
-		return ret;
-
-	ret = ov8865_read_reg(sensor, reg + 1, &lo);
+	ret = ov8865_read_regs(sensor, reg, buf, sizeof(buf));
 	if (ret)
 		return ret;
 
-	*val = ((u16)hi << 8) | (u16)lo;
+	*val = ((u32)buf[0] << 16) | ((u32)buf[1] << 8) | buf[2];
 
 	return 0;
 }
@@ -1124,35 +894,23 @@ static int ov8865_set_timings(struct ov8865_dev *sensor,
 	   y_inc_even, blc_num_option, zline_num_option,
 	   boundary_pix_num;
 
-	ret = ov8865_write_reg(sensor, OV8865_X_ADDR_START_H_REG, 0x00);
+	ret = ov8865_write_reg16(sensor, OV8865_X_ADDR_START_H_REG,
+				 mode->crop.left);
 	if (ret)
 		return ret;
 
-	ret = ov8865_write_reg(sensor, OV8865_X_ADDR_START_L_REG, 0x0c);
+	ret = ov8865_write_reg16(sensor, OV8865_Y_ADDR_START_H_REG,
+				 mode->crop.top);
 	if (ret)
 		return ret;
 
-	ret = ov8865_write_reg(sensor, OV8865_Y_ADDR_START_H_REG, 0x00);
+	ret = ov8865_write_reg16(sensor, OV8865_X_ADDR_END_H_REG,
+				 mode->crop.left + mode->crop.width - 1);
 	if (ret)
 		return ret;
 
-	ret = ov8865_write_reg(sensor, OV8865_Y_ADDR_START_L_REG, 0x0c);
-	if (ret)
-		return ret;
-
-	ret = ov8865_write_reg(sensor, OV8865_X_ADDR_END_H_REG, 0x0c);
-	if (ret)
-		return ret;
-
-	ret = ov8865_write_reg(sensor, OV8865_X_ADDR_END_L_REG, 0xd3);
-	if (ret)
-		return ret;
-
-	ret = ov8865_write_reg(sensor, OV8865_Y_ADDR_END_H_REG, 0x09);
-	if (ret)
-		return ret;
-
-	ret = ov8865_write_reg(sensor, OV8865_Y_ADDR_END_L_REG, 0xa3);
+	ret = ov8865_write_reg16(sensor, OV8865_Y_ADDR_END_H_REG,
+				 mode->crop.top + mode->crop.height - 1);
 	if (ret)
 		return ret;
 
@@ -1168,7 +926,9 @@ static int ov8865_set_timings(struct ov8865_dev *sensor,
 	if (ret)
 		return ret;
 
-	ret = ov8865_write_reg16(sensor, OV8865_VTS_REG, mode->vtot);
+	/* The frame length set through V4L2_CID_VBLANK */
+	ret = ov8865_write_reg16(sensor, OV8865_VTS_REG,
+				 mode->vact + sensor->ctrls.vblank->val);
 	if (ret)
 		return ret;
 
@@ -1180,9 +940,7 @@ static int ov8865_set_timings(struct ov8865_dev *sensor,
 	if (ret)
 		return ret;
 
-	if ((mode->id == OV8865_MODE_720P_1280_720) ||
-	    (mode->id == OV8865_MODE_UXGA_1600_1200) ||
-	    (mode->id == OV8865_MODE_SVGA_800_600)) {
+	if (mode->readout != OV8865_READOUT_FULL) {
 		isp_y_win_l = 0x04;
 		x_inc_odd = 0x03;
 		blc_num_option = 0x08;
@@ -1213,11 +971,10 @@ static int ov8865_set_timings(struct ov8865_dev *sensor,
 	if (ret)
 		return ret;
 
-	if ((mode->id == OV8865_MODE_720P_1280_720) ||
-	    (mode->id == OV8865_MODE_UXGA_1600_1200)) {
+	if (mode->readout == OV8865_READOUT_HALF) {
 		format2 = 0x67;
 		y_inc_odd = 0x03;
-	} else if (mode->id == OV8865_MODE_SVGA_800_600) {
+	} else if (mode->readout == OV8865_READOUT_QUARTER) {
 		format2 = 0x6f;
 		y_inc_odd = 0x05;
 	} else {
@@ -1233,7 +990,7 @@ static int ov8865_set_timings(struct ov8865_dev *sensor,
 	if (ret)
 		return ret;
 
-	if (mode->id == OV8865_MODE_SVGA_800_600)
+	if (mode->readout == OV8865_READOUT_QUARTER)
 		y_inc_even = 0x03;
 	else
 		y_inc_even = 0x01;
@@ -1277,61 +1034,226 @@ static int ov8865_get_hts(struct ov8865_dev *sensor)
 	return hts;
 }
 
+static struct sensor_prog *ov8865_mode_prog(struct ov8865_dev *sensor,
+					    const struct ov8865_mode_info *mode)
+{
+	if (mode == &ov8865_mode_init_data)
+		return &sensor->init_prog;
+
+	return &sensor->mode_progs[mode->id];
+}
+
 static int ov8865_load_regs(struct ov8865_dev *sensor,
 			     const struct ov8865_mode_info *mode)
 {
-	const struct reg_value *regs = mode->reg_data;
-	unsigned int i;
-	u32 delay_ms = 0;
-	u16 reg_addr;
-	u8 val;
-	int ret = 0;
+	const struct sensor_prog *prog = ov8865_mode_prog(sensor, mode);
+	struct device *dev = &sensor->i2c_client->dev;
+	struct sensor_burst burst;
+	int ret;
+
+	if (prog->msgs)
+		return sensor_prog_load(sensor->i2c_client, prog,
+					&sensor->shadow, &sensor->stats);
+
+	trace_sensor_stage_begin(dev, "load_regs");
+
+	sensor_burst_init(&burst, sensor->i2c_client);
+	burst.shadow = &sensor->shadow;
+	burst.stats = &sensor->stats;
+	ret = sensor_seq_walk(&burst, mode->reg_data);
+	if (!ret)
+		ret = sensor_burst_flush(&burst);
+
+	trace_sensor_stage_end(dev, "load_regs", burst.nr_regs,
+			       burst.nr_bytes, ret);
+
+	return ret;
+}
+
+/*
+ * Precompile the init table and all the mode tables so that loading a
+ * mode is just a few i2c_transfer() calls. Modes sharing the same table
+ * share the compiled sequence, too.
+ */
+static int ov8865_build_progs(struct ov8865_dev *sensor)
+{
+	struct i2c_client *client = sensor->i2c_client;
+	unsigned int i, j;
+	int ret;
+
+	ret = sensor_prog_build(client, &sensor->init_prog, sensor_seq_walk,
+				ov8865_mode_init_data.reg_data);
+	if (ret)
+		return ret;
 
-	for (i = 0; i < mode->reg_data_size; i++, regs++) {
-		delay_ms = regs->delay_ms;
-		reg_addr = regs->reg_addr;
-		val = regs->val;
+	for (i = 0; i < OV8865_NUM_MODES; i++) {
+		for (j = 0; j < i; j++) {
+			if (ov8865_mode_data[j].reg_data ==
+			    ov8865_mode_data[i].reg_data)
+				break;
+		}
+		if (j < i) {
+			sensor->mode_progs[i] = sensor->mode_progs[j];
+			continue;
+		}
 
-		ret = ov8865_write_reg(sensor, reg_addr, val);
+		ret = sensor_prog_build(client, &sensor->mode_progs[i],
+					sensor_seq_walk,
+					ov8865_mode_data[i].reg_data);
 		if (ret)
 			return ret;
+	}
+
+	return 0;
+}
 
-		if (delay_ms)
-			usleep_range(1000 * delay_ms, 1000 * delay_ms + 100);
+static int ov8865_modes_show(struct seq_file *m, void *data)
+{
+	struct ov8865_dev *sensor = m->private;
+	char name[16];
+	unsigned int i;
+
+	sensor_prog_seq_header(m);
+	sensor_prog_seq_show(m, "init", &sensor->init_prog);
+	for (i = 0; i < OV8865_NUM_MODES; i++) {
+		snprintf(name, sizeof(name), "%ux%u", ov8865_mode_data[i].hact,
+			 ov8865_mode_data[i].vact);
+		sensor_prog_seq_show(m, name, &sensor->mode_progs[i]);
 	}
 
 	return 0;
 }
+DEFINE_SHOW_ATTRIBUTE(ov8865_modes);
+
+static u64 ov8865_mode_pixel_rate(const struct ov8865_mode_info *mode)
+{
+	return (u64)mode->vtot * mode->htot * mode->max_fps;
+}
+
+/* Bits per second of @mode on the link, the same at every frame rate */
+static u64 ov8865_mode_bps(const struct ov8865_mode_info *mode)
+{
+	return sensor_link_bps(mode->hact, 10, ov8865_mode_pixel_rate(mode),
+			       mode->htot);
+}
+
+/* VTS of @mode at @fr, the line time is that of the mode */
+static u32 ov8865_mode_vts(const struct ov8865_mode_info *mode,
+			   enum ov8865_frame_rate fr)
+{
+	return mode->vtot * mode->max_fps / ov8865_framerates[fr];
+}
+
+static bool ov8865_mode_fits(struct ov8865_dev *sensor,
+			     const struct ov8865_mode_info *mode,
+			     enum ov8865_frame_rate fr)
+{
+	if (ov8865_framerates[fr] > mode->max_fps)
+		return false;
+
+	return sensor_link_select(&sensor->link, ov8865_mode_bps(mode),
+				  NULL) >= 0;
+}
 
 static const struct ov8865_mode_info *
 ov8865_find_mode(struct ov8865_dev *sensor, enum ov8865_frame_rate fr,
 		 int width, int height, bool nearest)
 {
-	const struct ov8865_mode_info *mode;
+	const struct ov8865_mode_info *mode = NULL;
+	u32 dist, min_dist = U32_MAX;
+	unsigned int i;
+
+	/* Nearest frame size the link carries at @fr */
+	for (i = 0; i < ARRAY_SIZE(ov8865_mode_data); i++) {
+		if (!ov8865_mode_fits(sensor, &ov8865_mode_data[i], fr))
+			continue;
 
-	mode = v4l2_find_nearest_size(ov8865_mode_data,
-				      ARRAY_SIZE(ov8865_mode_data),
-				      hact, vact, width, height);
+		dist = abs((int)ov8865_mode_data[i].hact - width) +
+		       abs((int)ov8865_mode_data[i].vact - height);
+		if (dist < min_dist) {
+			mode = &ov8865_mode_data[i];
+			min_dist = dist;
+		}
+	}
 
 	if (!mode || (!nearest && (mode->hact != width || mode->vact !=
 				   height)))
 		return NULL;
 
-	/* Only SVGA can operate 90 fps. */
-	if (fr == OV8865_90_FPS && !(mode->hact == 800 && mode->vact == 600))
-		return NULL;
-
 	return mode;
 }
 
 static u64 ov8865_calc_pixel_rate(struct ov8865_dev *sensor)
 {
-	u64 rate;
+	return ov8865_mode_pixel_rate(sensor->current_mode);
+}
 
-	rate = sensor->current_mode->vtot * sensor->current_mode->htot;
-	rate *= ov8865_framerates[sensor->current_fr];
+/* Select the link frequency of the current mode and frame rate */
+static int ov8865_update_link_freq(struct ov8865_dev *sensor)
+{
+	int ret;
 
-	return rate;
+	ret = sensor_link_apply(&sensor->link, sensor->ctrls.link_freq,
+				ov8865_mode_bps(sensor->current_mode));
+
+	return ret < 0 ? ret : 0;
+}
+
+/*
+ * The line time of a mode doesn't change with VTS: the frame interval is
+ * VTS / (vtot * max_fps).
+ */
+static void ov8865_update_frame_interval(struct ov8865_dev *sensor,
+					 u32 vblank)
+{
+	const struct ov8865_mode_info *mode = sensor->current_mode;
+
+	sensor->frame_interval.numerator = mode->vact + vblank;
+	sensor->frame_interval.denominator = mode->vtot * mode->max_fps;
+}
+
+/* VBLANK giving the frame interval closest to @fi, within the range */
+static s32 ov8865_vblank_for_interval(struct ov8865_dev *sensor,
+				      const struct v4l2_fract *fi)
+{
+	const struct ov8865_mode_info *mode = sensor->current_mode;
+	struct v4l2_ctrl *vblank = sensor->ctrls.vblank;
+	u64 vts;
+
+	if (!fi->numerator || !fi->denominator)
+		return vblank->default_value;
+
+	vts = (u64)fi->numerator * mode->vtot * mode->max_fps;
+	vts = DIV_ROUND_CLOSEST_ULL(vts, fi->denominator);
+
+	return clamp_t(s64, (s64)vts - mode->vact, vblank->minimum,
+		       vblank->maximum);
+}
+
+/*
+ * On a mode change, VBLANK goes back to the VTS of current_fr. It can't
+ * be made shorter than vtot, at the mode's max_fps.
+ */
+static int ov8865_update_vblank_range(struct ov8865_dev *sensor)
+{
+	const struct ov8865_mode_info *mode = sensor->current_mode;
+	s32 def = ov8865_mode_vts(mode, sensor->current_fr) - mode->vact;
+	int ret;
+
+	ret = __v4l2_ctrl_modify_range(sensor->ctrls.vblank,
+				       mode->vtot - mode->vact,
+				       OV8865_VTS_MAX - mode->vact, 1, def);
+	if (ret)
+		return ret;
+
+	ret = __v4l2_ctrl_s_ctrl(sensor->ctrls.vblank, def);
+	if (ret)
+		return ret;
+
+	/* s_ctrl isn't called if VBLANK didn't change, but the mode did */
+	ov8865_update_frame_interval(sensor, def);
+
+	return 0;
 }
 
 static int ov8865_set_mode_direct(struct ov8865_dev *sensor,
@@ -1363,10 +1285,7 @@ static int ov8865_set_black_level(struct ov8865_dev *sensor)
 	if (ret)
 		return ret;
 
-	if ((mode->id == OV8865_MODE_QUXGA_3264_2448) ||
-	    (mode->id == OV8865_MODE_6M_3264_1836) ||
-	    (mode->id == OV8865_MODE_1080P_1920_1080) ||
-	    (mode->id == OV8865_MODE_VGA_640_480))
+	if (mode->readout == OV8865_READOUT_FULL)
 		blc_ctrl1 = 0x04;
 	else
 		blc_ctrl1 = 0x14;
@@ -1395,10 +1314,7 @@ static int ov8865_set_black_level(struct ov8865_dev *sensor)
 	if (ret)
 		return ret;
 
-	if ((mode->id  == OV8865_MODE_QUXGA_3264_2448) ||
-	    (mode->id  == OV8865_MODE_6M_3264_1836) ||
-	    (mode->id == OV8865_MODE_1080P_1920_1080) ||
-	    (mode->id == OV8865_MODE_VGA_640_480)) {
+	if (mode->readout == OV8865_READOUT_FULL) {
 		left_start_h = 0x02;
 		left_start_l = 0x40;
 		left_end_h = 0x03;
@@ -1466,7 +1382,7 @@ static int ov8865_set_black_level(struct ov8865_dev *sensor)
 	if (ret)
 		return ret;
 
-	if (mode->id == OV8865_MODE_SVGA_800_600) {
+	if (mode->readout == OV8865_READOUT_QUARTER) {
 		bkline_st = 0x02;
 		bkline_num = 0x02;
 		zline_st = 0x00;
@@ -1585,15 +1501,39 @@ static int ov8865_get_pclk(struct ov8865_dev *sensor)
 	return ref_clk * pll1_mult / (1 + m_div) / mipi_div / pclk_div;
 }
 
+/*
+ * Cache the line time of the loaded mode, so that the exposure controls
+ * don't have to read the PLL and HTS registers again.
+ */
+static int ov8865_update_line_time(struct ov8865_dev *sensor)
+{
+	int pclk, hts;
+
+	sensor->line_time = 0;
+
+	pclk = ov8865_get_pclk(sensor);
+	if (pclk <= 0)
+		return pclk ? pclk : -EINVAL;
+
+	hts = ov8865_get_hts(sensor);
+	if (hts < 0)
+		return hts;
+
+	if (hts < pclk)
+		return -EINVAL;
+
+	sensor->line_time = hts / pclk;
+
+	return 0;
+}
+
 static int ov8865_set_sclk(struct ov8865_dev *sensor)
 {
 	const struct ov8865_mode_info *mode = sensor->current_mode;
 	int ret;
 	u8 val;
 
-	if ((mode->id  == OV8865_MODE_UXGA_1600_1200) ||
-	    (mode->id == OV8865_MODE_720P_1280_720) ||
-	    (mode->id == OV8865_MODE_SVGA_800_600))
+	if (mode->readout != OV8865_READOUT_FULL)
 		val = 0x09;
 	else
 		val = 0x04;
@@ -1663,6 +1603,10 @@ static int ov8865_set_mode(struct ov8865_dev *sensor)
 	if (ret < 0)
 		return ret;
 
+	ret = ov8865_update_line_time(sensor);
+	if (ret < 0)
+		return ret;
+
 	sensor->last_mode = mode;
 	return 0;
 }
@@ -1694,50 +1638,54 @@ static void ov8865_reset(struct ov8865_dev *sensor, bool enable)
 	gpiod_set_value_cansleep(sensor->reset_gpio, enable ? 0 : 1);
 }
 
-/* Get GPIOs defined in dep_dev _CRS */
-static int gpio_crs_get(struct ov8865_dev *sensor, struct device *dep_dev)
-{
-	sensor->dep_gpios = devm_gpiod_get_array(dep_dev, NULL, GPIOD_ASIS);
-	if (IS_ERR(sensor->dep_gpios)) {
-		dev_err(dep_dev, "Failed to get GPIOs\n");
-		return -ENODEV;
-	}
-
-	return 0;
-}
-
-/* Put GPIOs defined in dep_dev _CRS */
-static void gpio_crs_put(struct ov8865_dev *sensor)
-{
-	gpiod_put_array(sensor->dep_gpios);
-}
-
-/* Control GPIOs defined in dep_dev _CRS */
-static int gpio_crs_ctrl(struct ov8865_dev *sensor, bool flag)
+static void ov8865_set_power_off(struct ov8865_dev *sensor)
 {
-	struct gpio_descs *d = sensor->dep_gpios;
-	unsigned long *values;
+	sensor_shadow_invalidate(&sensor->shadow);
+	sensor->last_mode = NULL;
+	sensor->line_time = 0;
 
-	values = bitmap_alloc(d->ndescs, GFP_KERNEL);
-	if (!values)
-		return -ENOMEM;
+	trace_sensor_stage_begin(&sensor->i2c_client->dev, "gpio");
 
-	if (flag)
-		bitmap_fill(values, d->ndescs);
-	else
-		bitmap_zero(values, d->ndescs);
+	/* For DT-based systems */
+	if (!sensor->is_acpi_based) {
+		ov8865_power(sensor, false);
+		regulator_bulk_disable(OV8865_NUM_SUPPLIES, sensor->supplies);
+		clk_disable_unprepare(sensor->xclk);
+	}
 
-	gpiod_set_array_value_cansleep(d->ndescs, d->desc,
-				       d->info, values);
+	/* For ACPI-based systems */
+	if (sensor->is_acpi_based)
+		sensor_gpios_set(&sensor->dep_gpios, false);
 
-	return 0;
+	trace_sensor_stage_end(&sensor->i2c_client->dev, "gpio", 0, 0, 0);
 }
 
+/*
+ * The sensor answers on SCCB 8192 XVCLK cycles after reset. Through the
+ * PMIC GPIOs the supplies take longer to come up, how much longer isn't
+ * known, the chip ID is polled for that.
+ */
+static struct sensor_power_timing ov8865_power_timing = {
+	.settle_us = SENSOR_POWER_CYCLES_US(8192, OV8865_XCLK_FREQ),
+	.poll_us = SENSOR_POWER_POLL_US,
+	.timeout_us = 20000,
+};
+module_param_named(power_settle_us, ov8865_power_timing.settle_us, uint,
+		   0644);
+MODULE_PARM_DESC(power_settle_us, "Wait before the first access at power on");
+module_param_named(power_poll_us, ov8865_power_timing.poll_us, uint, 0644);
+MODULE_PARM_DESC(power_poll_us, "Interval of the chip ID reads at power on");
+module_param_named(power_timeout_us, ov8865_power_timing.timeout_us, uint,
+		   0644);
+MODULE_PARM_DESC(power_timeout_us, "Longest chip ID poll at power on");
+
 static int ov8865_set_power_on(struct ov8865_dev *sensor)
 {
 	struct i2c_client *client = sensor->i2c_client;
 	int ret = 0;
 
+	trace_sensor_stage_begin(&client->dev, "gpio");
+
 	/* For DT-based systems */
 	if (!sensor->is_acpi_based) {
 		ov8865_power(sensor, false);
@@ -1747,6 +1695,7 @@ static int ov8865_set_power_on(struct ov8865_dev *sensor)
 		if (ret) {
 			dev_err(&client->dev, "%s: failed to enable clock\n",
 				__func__);
+			trace_sensor_stage_end(&client->dev, "gpio", 0, 0, ret);
 			return ret;
 		}
 
@@ -1760,20 +1709,28 @@ static int ov8865_set_power_on(struct ov8865_dev *sensor)
 		}
 
 		ov8865_reset(sensor, true);
-		usleep_range(10000, 12000);
 	}
 
 	/* For ACPI-based systems */
-	if (sensor->is_acpi_based) {
-		gpio_crs_ctrl(sensor, true);
+	if (sensor->is_acpi_based)
+		sensor_gpios_set(&sensor->dep_gpios, true);
+
+	trace_sensor_stage_end(&client->dev, "gpio", 0, 0, 0);
 
-		/* Add some delay. This is required or check_chip_id() will fail. */
-		usleep_range(10000, 12000);
+	/* Wait for the sensor to come out of reset, DT-based systems too */
+	trace_sensor_stage_begin(&client->dev, "power_delay");
+	ret = sensor_power_wait(&sensor->i2c, &ov8865_power_timing,
+				OV8865_CHIP_ID_REG, OV8865_CHIP_ID, 3);
+	trace_sensor_stage_end(&client->dev, "power_delay", 0, 0, ret);
+	if (ret) {
+		ov8865_set_power_off(sensor);
+		return ret;
 	}
 
 	return 0;
 
 err_power_off:
+	trace_sensor_stage_end(&client->dev, "gpio", 0, 0, ret);
 	/* For DT-based systems */
 	if (!sensor->is_acpi_based) {
 		ov8865_power(sensor, false);
@@ -1782,20 +1739,6 @@ err_power_off:
 	return ret;
 }
 
-static void ov8865_set_power_off(struct ov8865_dev *sensor)
-{
-	/* For DT-based systems */
-	if (!sensor->is_acpi_based) {
-		ov8865_power(sensor, false);
-		regulator_bulk_disable(OV8865_NUM_SUPPLIES, sensor->supplies);
-		clk_disable_unprepare(sensor->xclk);
-	}
-
-	/* For ACPI-based systems */
-	if (sensor->is_acpi_based)
-		gpio_crs_ctrl(sensor, false);
-}
-
 static int ov8865_set_power(struct ov8865_dev *sensor, bool on)
 {
 	int ret = 0;
@@ -1839,51 +1782,58 @@ out:
 
 	if (on && !ret && sensor->power_count == 1) {
 		/* Initialize the hardware. */
+		trace_sensor_stage_begin(sd->dev, "ctrl_setup");
 		ret = v4l2_ctrl_handler_setup(&sensor->ctrls.handler);
+		trace_sensor_stage_end(sd->dev, "ctrl_setup", 0, 0, ret);
 	}
 
 	return ret;
 }
 
+static int ov8865_runtime_suspend(struct device *dev)
+{
+	struct v4l2_subdev *sd = dev_get_drvdata(dev);
+
+	return ov8865_s_power(sd, false);
+}
+
+static int ov8865_runtime_resume(struct device *dev)
+{
+	struct v4l2_subdev *sd = dev_get_drvdata(dev);
+
+	return ov8865_s_power(sd, true);
+}
+
+/* Frame rate closest to @fi that the @width x @height mode runs at */
 static int ov8865_try_frame_interval(struct ov8865_dev *sensor,
 				     struct v4l2_fract *fi,
 				     u32 width, u32 height)
 {
-	const struct ov8865_mode_info *mode;
-	enum ov8865_frame_rate rate = OV8865_30_FPS;
-	int minfps, maxfps, best_fps, fps;
+	int rate = -EINVAL;
+	int fps = 0;
 	int i;
 
-	minfps = ov8865_framerates[OV8865_30_FPS];
-	maxfps = ov8865_framerates[OV8865_90_FPS];
-
-	if (fi->numerator == 0) {
-		fi->denominator = maxfps;
-		fi->numerator = 1;
-		rate = OV8865_90_FPS;
-		goto find_mode;
-	}
-
-	fps = clamp_val(DIV_ROUND_CLOSEST(fi->denominator, fi->numerator),
-			minfps, maxfps);
+	/* No interval asks for the fastest */
+	if (fi->numerator && fi->denominator)
+		fps = DIV_ROUND_CLOSEST(fi->denominator, fi->numerator);
 
-	best_fps = minfps;
-	for (i = 0; i < ARRAY_SIZE(ov8865_framerates); i++) {
-		int curr_fps = ov8865_framerates[i];
+	for (i = 0; i < OV8865_NUM_FRAMERATES; i++) {
+		if (!ov8865_find_mode(sensor, i, width, height, false))
+			continue;
 
-		if (abs(curr_fps - fps) < abs(best_fps - fps)) {
-			best_fps = curr_fps;
+		if (rate < 0 || !fps ||
+		    abs(ov8865_framerates[i] - fps) <
+		    abs(ov8865_framerates[rate] - fps))
 			rate = i;
-		}
 	}
 
-	fi->numerator = 1;
-	fi->denominator = best_fps;
+	if (rate < 0)
+		return rate;
 
-find_mode:
-	mode = ov8865_find_mode(sensor, rate, width, height, false);
+	fi->numerator = 1;
+	fi->denominator = ov8865_framerates[rate];
 
-	return mode ? rate : -EINVAL;
+	return rate;
 }
 
 static int ov8865_try_fmt_internal(struct v4l2_subdev *sd,
@@ -1966,8 +1916,8 @@ static int ov8865_set_fmt(struct v4l2_subdev *sd,
 		goto out;
 	}
 
-	ret = ov8865_try_fmt_internal(sd, mbus_fmt, sensor->current_fr,
-				      &new_mode);
+	/* Every mode runs at 30 fps, the frame rate follows the mode */
+	ret = ov8865_try_fmt_internal(sd, mbus_fmt, OV8865_30_FPS, &new_mode);
 	if (ret)
 		goto out;
 
@@ -1981,11 +1931,19 @@ static int ov8865_set_fmt(struct v4l2_subdev *sd,
 	else
 		ret = -EINVAL;
 
-	if (new_mode != sensor->current_mode)
+	if (new_mode != sensor->current_mode) {
 		sensor->current_mode = new_mode;
+		if (!ov8865_mode_fits(sensor, new_mode, sensor->current_fr))
+			sensor->current_fr = OV8865_30_FPS;
+		ret = ov8865_update_vblank_range(sensor);
+		if (ret)
+			goto out;
+	}
 
 	__v4l2_ctrl_s_ctrl_int64(sensor->ctrls.pixel_rate,
 				 ov8865_calc_pixel_rate(sensor));
+	if (!ret)
+		ret = ov8865_update_link_freq(sensor);
 
 out:
 	mutex_unlock(&sensor->lock);
@@ -2014,44 +1972,27 @@ static int ov8865_set_ctrl_vflip(struct ov8865_dev *sensor, int value)
 
 static int ov8865_get_exposure(struct ov8865_dev *sensor)
 {
-	int exp, ret, pclk, hts, line_time;
-	u8 temp;
+	u32 exp;
+	int ret;
 
-	ret = ov8865_read_reg(sensor, OV8865_EXPOSURE_CTRL_HH_REG, &temp);
-	if (ret)
-		return ret;
-	exp = ((int)temp & 0x0f) << 16;
+	if (!sensor->line_time) {
+		ret = ov8865_update_line_time(sensor);
+		if (ret)
+			return ret;
+	}
 
-	ret = ov8865_read_reg(sensor, OV8865_EXPOSURE_CTRL_H_REG, &temp);
+	/* HH, H and L in one read */
+	ret = ov8865_read_reg24(sensor, OV8865_EXPOSURE_CTRL_HH_REG, &exp);
 	if (ret)
 		return ret;
-	exp |= ((int)temp << 8);
-
-	ret = ov8865_read_reg(sensor, OV8865_EXPOSURE_CTRL_L_REG, &temp);
-	if (ret)
-		return ret;
-	exp |= (int)temp;
-
-	ret = ov8865_get_pclk(sensor);
-	if (ret <= 0)
-		return ret;
-
-	pclk = ret;
-
-	ret = ov8865_get_hts(sensor);
-	if (ret <= 0)
-		return ret;
-
-	hts = ret;
-
-	line_time = hts / pclk;
+	exp &= 0x0fffff;
 
 	/* The low 4 bits of exposure are the fractional part. And the unit is
 	 * 1/16 of a line lecture time. The pclk and HTS are used to calculate
 	 * this time. For V4L2, the value 1 of exposure stands for 100us of
 	 * capture.
 	 */
-	return (exp >> 4) * line_time / 16 / 100;
+	return (exp >> 4) * sensor->line_time / 16 / 100;
 }
 
 static int ov8865_get_gain(struct ov8865_dev *sensor)
@@ -2070,7 +2011,7 @@ static int ov8865_get_gain(struct ov8865_dev *sensor)
 static int ov8865_set_ctrl_exp(struct ov8865_dev *sensor)
 {
 	struct ov8865_ctrls *ctrls = &sensor->ctrls;
-	int ret = 0, hts, pclk, line_time;
+	int ret = 0;
 	int exposure = ctrls->exposure->val;
 	/* The low 4 bits of exposure are the fractional part. And the unit is
 	 * 1/16 of a line lecture time. The pclk and HTS are used to calculate
@@ -2078,56 +2019,32 @@ static int ov8865_set_ctrl_exp(struct ov8865_dev *sensor)
 	 * capture.
 	 */
 
-	ret = ov8865_get_pclk(sensor);
-	if (ret <= 0)
-		return ret;
-	pclk = ret;
-
-	ret = ov8865_get_hts(sensor);
-	if (ret <= 0)
-		return ret;
-	hts = ret;
-
-	line_time = hts / pclk;
-
-	exposure = ctrls->exposure->val * 16 / line_time * 100;
-	exposure = (exposure << 4);
-
-	if (ctrls->exposure->is_new) {
-		ret = ov8865_write_reg(sensor, OV8865_EXPOSURE_CTRL_L_REG,
-				       exposure & 0xff);
-		if (ret)
-			return ret;
-
-		ret = ov8865_write_reg(sensor, OV8865_EXPOSURE_CTRL_H_REG,
-				       (exposure >> 8) & 0xff);
+	if (!sensor->line_time) {
+		ret = ov8865_update_line_time(sensor);
 		if (ret)
 			return ret;
-
-		ret = ov8865_write_reg(sensor, OV8865_EXPOSURE_CTRL_HH_REG,
-				       (exposure >> 16) & 0x0f);
 	}
 
-	return ret;
+	exposure = ctrls->exposure->val * 16 / sensor->line_time * 100;
+	exposure = (exposure << 4);
+
+	/* HH, H and L in one write */
+	return ov8865_write_reg24(sensor, OV8865_EXPOSURE_CTRL_HH_REG,
+				  exposure & 0x0fffff);
 }
 
 static int ov8865_set_ctrl_gain(struct ov8865_dev *sensor)
 {
-	struct ov8865_ctrls *ctrls = &sensor->ctrls;
-	int ret = 0;
-	int val = ctrls->gain->val;
+	int val = sensor->ctrls.gain->val;
 
 	/* Linear gain. */
-	if (ctrls->gain->is_new)
-		ret = ov8865_write_reg16(sensor, OV8865_GAIN_CTRL_H_REG,
-					 (u16)val & 0x1fff);
-	return ret;
+	return ov8865_write_reg16(sensor, OV8865_GAIN_CTRL_H_REG,
+				  (u16)val & 0x1fff);
 }
 
 static int ov8865_g_volatile_ctrl(struct v4l2_ctrl *ctrl)
 {
-	struct v4l2_subdev *sd = ctrl_to_sd(ctrl);
-	struct ov8865_dev *sensor = to_ov8865_dev(sd);
+	struct ov8865_dev *sensor = ae_ctrl_to_ov8865_dev(ctrl);
 	int val;
 
 	switch (ctrl->id) {
@@ -2150,21 +2067,62 @@ static int ov8865_g_volatile_ctrl(struct v4l2_ctrl *ctrl)
 	return 0;
 }
 
-static int ov8865_s_ctrl(struct v4l2_ctrl *ctrl)
+/*
+ * Exposure and gain, with ae_lock held. Before the stream is on, the value
+ * is only kept: the mode may be loading under sensor->lock, and
+ * ov8865_stream_on() writes the latest exposure and gain together right
+ * before the stream on.
+ */
+static int ov8865_s_ae_ctrl(struct v4l2_ctrl *ctrl)
 {
-	struct v4l2_subdev *sd = ctrl_to_sd(ctrl);
-	struct ov8865_dev *sensor = to_ov8865_dev(sd);
+	struct ov8865_dev *sensor = ae_ctrl_to_ov8865_dev(ctrl);
 	int ret;
 
-	if (sensor->power_count == 0)
+	if (!sensor->ae_live)
 		return 0;
 
 	switch (ctrl->id) {
 	case V4L2_CID_GAIN:
 		ret = ov8865_set_ctrl_gain(sensor);
+		if (!ret)
+			sensor_meta_queue(&sensor->meta, SENSOR_META_GAIN,
+					  ctrl->val);
 		break;
 	case V4L2_CID_EXPOSURE:
 		ret = ov8865_set_ctrl_exp(sensor);
+		if (!ret)
+			sensor_meta_queue(&sensor->meta, SENSOR_META_EXPOSURE,
+					  ctrl->val);
+		break;
+	default:
+		ret = -EINVAL;
+		break;
+	}
+
+	return ret;
+}
+
+static int ov8865_s_ctrl(struct v4l2_ctrl *ctrl)
+{
+	struct v4l2_subdev *sd = ctrl_to_sd(ctrl);
+	struct ov8865_dev *sensor = to_ov8865_dev(sd);
+	int ret;
+
+	if (ctrl->id == V4L2_CID_VBLANK)
+		ov8865_update_frame_interval(sensor, ctrl->val);
+
+	if (sensor->power_count == 0)
+		return 0;
+
+	switch (ctrl->id) {
+	case V4L2_CID_VBLANK:
+		/* Latched at the next frame start, fine while streaming */
+		ret = ov8865_write_reg16(sensor, OV8865_VTS_REG,
+					 sensor->current_mode->vact + ctrl->val);
+		if (!ret)
+			sensor_meta_queue(&sensor->meta, SENSOR_META_VTS,
+					  sensor->current_mode->vact +
+					  ctrl->val);
 		break;
 	case V4L2_CID_HFLIP:
 		ret = ov8865_set_ctrl_hflip(sensor, ctrl->val);
@@ -2181,34 +2139,58 @@ static int ov8865_s_ctrl(struct v4l2_ctrl *ctrl)
 }
 
 static const struct v4l2_ctrl_ops ov8865_ctrl_ops = {
-	.g_volatile_ctrl = ov8865_g_volatile_ctrl,
 	.s_ctrl = ov8865_s_ctrl,
 };
 
+static const struct v4l2_ctrl_ops ov8865_ae_ctrl_ops = {
+	.g_volatile_ctrl = ov8865_g_volatile_ctrl,
+	.s_ctrl = ov8865_s_ae_ctrl,
+};
+
 static int ov8865_init_controls(struct ov8865_dev *sensor)
 {
 	const struct v4l2_ctrl_ops *ops = &ov8865_ctrl_ops;
+	const struct v4l2_ctrl_ops *ae_ops = &ov8865_ae_ctrl_ops;
+	const struct ov8865_mode_info *mode = sensor->current_mode;
 	struct ov8865_ctrls *ctrls = &sensor->ctrls;
 	struct v4l2_ctrl_handler *hdl = &ctrls->handler;
+	struct v4l2_ctrl_handler *ae_hdl = &ctrls->ae_handler;
+	u32 vts = ov8865_mode_vts(mode, sensor->current_fr);
+	u64 link_freq_usable;
+	int link_freq;
 	int ret;
 
 	v4l2_ctrl_handler_init(hdl, 32);
 	hdl->lock = &sensor->lock;
+	v4l2_ctrl_handler_init(ae_hdl, 2);
+	ae_hdl->lock = &sensor->ae_lock;
+	link_freq = sensor_link_select(&sensor->link,
+				       ov8865_mode_bps(mode), &link_freq_usable);
 	ctrls->link_freq = v4l2_ctrl_new_int_menu(hdl, ops, V4L2_CID_LINK_FREQ,
-					  0, 0, link_freq_menu_items);
-	if (ctrls->link_freq)
-		ctrls->link_freq->flags |= V4L2_CTRL_FLAG_READ_ONLY;
+					  ARRAY_SIZE(link_freq_menu_items) - 1,
+					  link_freq, link_freq_menu_items);
+	if (ctrls->link_freq) {
+		ctrls->link_freq->menu_skip_mask = ~link_freq_usable;
+		if (sensor->link.num_freqs == 1)
+			ctrls->link_freq->flags |= V4L2_CTRL_FLAG_READ_ONLY;
+	}
 	ctrls->pixel_rate = v4l2_ctrl_new_std(hdl, ops, V4L2_CID_PIXEL_RATE,
 					      0, INT_MAX, 1,
 					      ov8865_calc_pixel_rate(sensor));
-	ctrls->exposure = v4l2_ctrl_new_std(hdl, ops, V4L2_CID_EXPOSURE, 1,
-					    2000, 1, 2000);
-	ctrls->gain = v4l2_ctrl_new_std(hdl, ops, V4L2_CID_GAIN, 1*16, 64*16 - 1,
-					1, 64*16 - 1);
+	ctrls->vblank = v4l2_ctrl_new_std(hdl, ops, V4L2_CID_VBLANK,
+					  mode->vtot - mode->vact,
+					  OV8865_VTS_MAX - mode->vact, 1,
+					  vts - mode->vact);
+	ctrls->exposure = v4l2_ctrl_new_std(ae_hdl, ae_ops, V4L2_CID_EXPOSURE,
+					    1, 2000, 1, 2000);
+	ctrls->gain = v4l2_ctrl_new_std(ae_hdl, ae_ops, V4L2_CID_GAIN,
+					1*16, 64*16 - 1, 1, 64*16 - 1);
 	ctrls->hflip = v4l2_ctrl_new_std(hdl, ops, V4L2_CID_HFLIP, 0, 1, 1, 0);
 	ctrls->vflip = v4l2_ctrl_new_std(hdl, ops, V4L2_CID_VFLIP, 0, 1, 1, 0);
-	if (hdl->error) {
-		ret = hdl->error;
+	/* Exposure and gain keep their own handler's lock */
+	v4l2_ctrl_add_handler(hdl, ae_hdl, NULL, false);
+	if (ae_hdl->error || hdl->error) {
+		ret = ae_hdl->error ?: hdl->error;
 		goto err_free_ctrls;
 	}
 
@@ -2220,6 +2202,7 @@ static int ov8865_init_controls(struct ov8865_dev *sensor)
 
 err_free_ctrls:
 	v4l2_ctrl_handler_free(hdl);
+	v4l2_ctrl_handler_free(ae_hdl);
 	return ret;
 }
 
@@ -2228,14 +2211,27 @@ static int ov8865_enum_frame_size(struct v4l2_subdev *sd,
 				  struct v4l2_subdev_pad_config *cfg,
 				  struct v4l2_subdev_frame_size_enum *fse)
 {
+	struct ov8865_dev *sensor = to_ov8865_dev(sd);
+	unsigned int i, index = 0;
 
-	if (fse->pad != 0 || fse->index >= OV8865_NUM_MODES)
+	if (fse->pad != 0)
+		return -EINVAL;
+
+	/* Only the modes the link carries at the lowest frame rate */
+	for (i = 0; i < OV8865_NUM_MODES; i++) {
+		if (!ov8865_mode_fits(sensor, &ov8865_mode_data[i],
+				      OV8865_30_FPS))
+			continue;
+		if (index++ == fse->index)
+			break;
+	}
+	if (i == OV8865_NUM_MODES)
 		return -EINVAL;
 
 	fse->code = MEDIA_BUS_FMT_SBGGR10_1X10;
-	fse->min_width = ov8865_mode_data[fse->index].hact;
+	fse->min_width = ov8865_mode_data[i].hact;
 	fse->max_width = fse->min_width;
-	fse->min_height = ov8865_mode_data[fse->index].vact;
+	fse->min_height = ov8865_mode_data[i].vact;
 	fse->max_height = fse->min_height;
 
 	return 0;
@@ -2258,7 +2254,8 @@ static int ov8865_enum_frame_interval(struct v4l2_subdev *sd,
 
 	ret = ov8865_try_frame_interval(sensor, &tpf,
 					fie->width, fie->height);
-	if (ret < 0)
+	/* The rates a mode runs at are the first ones of the list */
+	if (ret != fie->index)
 		return -EINVAL;
 
 	fie->interval = tpf;
@@ -2283,6 +2280,7 @@ static int ov8865_s_frame_interval(struct v4l2_subdev *sd,
 {
 	struct ov8865_dev *sensor = to_ov8865_dev(sd);
 	const struct ov8865_mode_info *mode;
+	struct v4l2_fract requested = fi->interval;
 	int frame_rate, ret = 0;
 
 	if (fi->pad != 0)
@@ -2290,11 +2288,6 @@ static int ov8865_s_frame_interval(struct v4l2_subdev *sd,
 
 	mutex_lock(&sensor->lock);
 
-	if (sensor->streaming) {
-		ret = -EBUSY;
-		goto out;
-	}
-
 	mode = sensor->current_mode;
 
 	frame_rate = ov8865_try_frame_interval(sensor, &fi->interval,
@@ -2311,16 +2304,38 @@ static int ov8865_s_frame_interval(struct v4l2_subdev *sd,
 		goto out;
 	}
 
-	if (mode != sensor->current_mode ||
-	    frame_rate != sensor->current_fr) {
-		sensor->current_fr = frame_rate;
-		sensor->frame_interval = fi->interval;
+	/*
+	 * Switching modes takes a reload. Within a mode, the frame rate is
+	 * only VTS, which changes live.
+	 */
+	if (mode != sensor->current_mode && sensor->streaming) {
+		ret = -EBUSY;
+		goto out;
+	}
+
+	sensor->current_fr = frame_rate;
+	if (mode != sensor->current_mode) {
 		sensor->current_mode = mode;
 
 		__v4l2_ctrl_s_ctrl_int64(sensor->ctrls.pixel_rate,
 					 ov8865_calc_pixel_rate(sensor));
+
+		ret = ov8865_update_link_freq(sensor);
+		if (ret)
+			goto out;
+
+		ret = ov8865_update_vblank_range(sensor);
+		if (ret)
+			goto out;
 	}
 
+	/* VTS of the interval asked, within the range of the mode */
+	if (!requested.numerator || !requested.denominator)
+		requested = fi->interval;
+	ret = __v4l2_ctrl_s_ctrl(sensor->ctrls.vblank,
+				 ov8865_vblank_for_interval(sensor, &requested));
+	fi->interval = sensor->frame_interval;
+
 out:
 	mutex_unlock(&sensor->lock);
 	return ret;
@@ -2338,49 +2353,209 @@ static int ov8865_enum_mbus_code(struct v4l2_subdev *sd,
 	return 0;
 }
 
+static int ov8865_get_selection(struct v4l2_subdev *sd,
+				struct v4l2_subdev_pad_config *cfg,
+				struct v4l2_subdev_selection *sel)
+{
+	struct ov8865_dev *sensor = to_ov8865_dev(sd);
+	const struct ov8865_mode_info *mode;
+	struct v4l2_mbus_framefmt *fmt;
+
+	if (sel->pad != 0)
+		return -EINVAL;
+
+	switch (sel->target) {
+	case V4L2_SEL_TGT_CROP:
+		/* The array window the mode reads out, before binning */
+		mutex_lock(&sensor->lock);
+		mode = sensor->current_mode;
+		if (sel->which == V4L2_SUBDEV_FORMAT_TRY) {
+			fmt = v4l2_subdev_get_try_format(sd, cfg, sel->pad);
+			mode = ov8865_find_mode(sensor, OV8865_30_FPS,
+						fmt->width, fmt->height, true);
+		}
+		if (mode)
+			sel->r = mode->crop;
+		mutex_unlock(&sensor->lock);
+
+		return mode ? 0 : -EINVAL;
+
+	case V4L2_SEL_TGT_NATIVE_SIZE:
+	case V4L2_SEL_TGT_CROP_BOUNDS:
+		sel->r.left = 0;
+		sel->r.top = 0;
+		sel->r.width = OV8865_NATIVE_WIDTH;
+		sel->r.height = OV8865_NATIVE_HEIGHT;
+		return 0;
+
+	case V4L2_SEL_TGT_CROP_DEFAULT:
+		sel->r.left = OV8865_ACTIVE_LEFT;
+		sel->r.top = OV8865_ACTIVE_TOP;
+		sel->r.width = OV8865_ACTIVE_WIDTH;
+		sel->r.height = OV8865_ACTIVE_HEIGHT;
+		return 0;
+	}
+
+	return -EINVAL;
+}
+
+/*
+ * Leave software standby, with the lock held. The exposure and gain last
+ * set are written first, under ae_lock, so none set in between is lost.
+ */
+static int ov8865_stream_on(struct ov8865_dev *sensor)
+{
+	struct i2c_client *client = sensor->i2c_client;
+	int ret;
+
+	mutex_lock(&sensor->ae_lock);
+
+	ret = ov8865_set_ctrl_exp(sensor);
+	if (!ret)
+		ret = ov8865_set_ctrl_gain(sensor);
+	if (ret)
+		goto out;
+
+	trace_sensor_stage_begin(&client->dev, "stream_on");
+
+	ret = ov8865_write_reg(sensor, OV8865_SW_STANDBY_REG,
+			       OV8865_SW_STANDBY_STANDBY_N);
+	if (!ret)
+		ret = ov8865_write_reg(sensor, OV8865_MIPI_CTRL_REG,
+			OV8865_MIPI_CTRL_LANES(sensor->link.lanes) |
+			OV8865_MIPI_CTRL_ON);
+
+	/* two single register writes, 3 bytes each */
+	trace_sensor_stage_end(&client->dev, "stream_on", 2, 2 * 3, ret);
+	if (ret)
+		goto out;
+
+	sensor_meta_start(&sensor->meta, sensor->ctrls.exposure->val,
+			  sensor->ctrls.gain->val,
+			  sensor->current_mode->vact +
+			  sensor->ctrls.vblank->val);
+	sensor_selftest_start(&sensor->selftest, sensor->current_mode->hact,
+			      sensor->current_mode->vact,
+			      &sensor->frame_interval);
+	sensor->ae_live = true;
+
+out:
+	mutex_unlock(&sensor->ae_lock);
+
+	return ret;
+}
+
+/* Power up and load the mode while another sensor starts, see s_stream */
+static int ov8865_sync_prepare(struct sensor_sync *sync)
+{
+	struct ov8865_dev *sensor = container_of(sync, struct ov8865_dev, sync);
+	int ret;
+
+	ret = sensor_pm_get(&sensor->sd);
+	if (ret)
+		return ret;
+
+	mutex_lock(&sensor->lock);
+	if (sensor->last_mode != sensor->current_mode)
+		ret = ov8865_set_mode(sensor);
+	mutex_unlock(&sensor->lock);
+
+	/* Stays powered for the autosuspend delay */
+	sensor_pm_put(&sensor->sd);
+
+	return ret;
+}
+
+/* Deferred stream on, if the stream wasn't stopped in the meantime */
+static void ov8865_sync_start(struct sensor_sync *sync)
+{
+	struct ov8865_dev *sensor = container_of(sync, struct ov8865_dev, sync);
+
+	mutex_lock(&sensor->lock);
+	if (sensor->streaming && ov8865_stream_on(sensor))
+		dev_err(&sensor->i2c_client->dev, "stream on failed\n");
+	mutex_unlock(&sensor->lock);
+}
+
+static const struct sensor_sync_ops ov8865_sync_ops = {
+	.prepare = ov8865_sync_prepare,
+	.start = ov8865_sync_start,
+};
+
 static int ov8865_s_stream(struct v4l2_subdev *sd, int enable)
 {
 	struct ov8865_dev *sensor = to_ov8865_dev(sd);
 	struct i2c_client *client = sensor->i2c_client;
 	int ret = 0;
 
-	/* call s_power() ourselves for regular PCs. s_power() handles
-	 * mutex, so call it here.
+	mutex_lock(&sensor->lock);
+	if (sensor->streaming == !!enable) {
+		mutex_unlock(&sensor->lock);
+		return 0;
+	}
+	mutex_unlock(&sensor->lock);
+
+	/*
+	 * Power up ourselves for regular PCs. This takes the mutex, so call
+	 * it here. If the sensor is still in warm standby from the last
+	 * stream, it is already powered with the mode loaded.
 	 */
 	if (enable) {
-		ret = ov8865_s_power(sd, true);
+		ret = sensor_pm_get(&sensor->sd);
 		if (ret) {
 			dev_err(&client->dev, "s_power failed\n");
-			ov8865_s_power(sd, false);
-			goto out;
+			return ret;
 		}
 	}
 
 	mutex_lock(&sensor->lock);
 
-	if (sensor->streaming == !enable) {
-		ret = ov8865_write_reg(sensor, OV8865_SW_STANDBY_REG, enable ?
-				     OV8865_SW_STANDBY_STANDBY_N : 0x00);
-		if (ret)
-			goto out;
+	if (enable) {
+		/*
+		 * The mode is loaded at power on. If the sensor stayed
+		 * powered since the last stream and the format changed,
+		 * switch to the new mode: only the registers that differ are
+		 * written.
+		 */
+		if (sensor->last_mode != sensor->current_mode) {
+			ret = ov8865_set_mode(sensor);
+			if (ret)
+				goto out;
+		}
 
-		ret = ov8865_write_reg(sensor, OV8865_MIPI_CTRL_REG,
-				       enable ? 0x72 : 0x62);
-		if (ret)
-			goto out;
+		/* Streaming from here on, the group writes the stream on */
+		if (!sensor_sync_arm(&sensor->sync))
+			ret = ov8865_stream_on(sensor);
+	} else {
+		sensor_sync_disarm(&sensor->sync);
+
+		mutex_lock(&sensor->ae_lock);
+		sensor->ae_live = false;
+		mutex_unlock(&sensor->ae_lock);
 
+		sensor_meta_stop(&sensor->meta);
+
+		trace_sensor_stage_begin(&client->dev, "stream_off");
+
+		ret = ov8865_write_reg(sensor, OV8865_SW_STANDBY_REG, 0x00);
 		if (!ret)
-			sensor->streaming = enable;
+			ret = ov8865_write_reg(sensor, OV8865_MIPI_CTRL_REG,
+				OV8865_MIPI_CTRL_LANES(sensor->link.lanes) |
+				OV8865_MIPI_CTRL_OFF);
+
+		trace_sensor_stage_end(&client->dev, "stream_off", 2, 2 * 3,
+				       ret);
 	}
 
+	if (!ret)
+		sensor->streaming = enable;
+
 out:
 	mutex_unlock(&sensor->lock);
 
-	/* call s_power() ourselves for regular PCs. s_power() handles
-	 * mutex, so call it here.
-	 */
-	if (!enable)
-		ov8865_s_power(sd, false);
+	/* Drop the power on stream stop, or if starting the stream failed */
+	if (!enable || ret)
+		sensor_pm_put(&sensor->sd);
 
 	return ret;
 }
@@ -2404,6 +2579,7 @@ static const struct v4l2_subdev_pad_ops ov8865_pad_ops = {
 	.set_fmt = ov8865_set_fmt,
 	.enum_frame_size = ov8865_enum_frame_size,
 	.enum_frame_interval = ov8865_enum_frame_interval,
+	.get_selection = ov8865_get_selection,
 };
 
 static const struct v4l2_subdev_ops ov8865_subdev_ops = {
@@ -2424,160 +2600,154 @@ static int ov8865_get_regulators(struct ov8865_dev *sensor)
 				       sensor->supplies);
 }
 
-static int ov8865_check_chip_id(struct ov8865_dev *sensor)
+/*
+ * Load the module data area of the OTP into the OTP SRAM and read it into
+ * the calibration blob, see sensor_calib.h. The load needs the sensor
+ * clocks running, so the sensor streams meanwhile. Called powered up.
+ */
+static int ov8865_otp_read(struct ov8865_dev *sensor)
 {
-	struct i2c_client *client = sensor->i2c_client;
-	int ret = 0;
-	u8 chip_id_0, chip_id_1, chip_id_2;
-	u32 chip_id = 0x000000;
+	struct device *dev = &sensor->i2c_client->dev;
+	u8 *data;
+	int ret, ret2;
 
-	ret = ov8865_set_power_on(sensor);
-	if (ret)
-		return ret;
+	data = sensor_calib_alloc(&sensor->calib, OV8865_OTP_USER_SIZE);
+	if (!data)
+		return -ENOMEM;
 
-	ret = ov8865_read_reg(sensor, OV8865_CHIP_ID_REG, &chip_id_0);
-	if (ret) {
-		dev_err(&client->dev, "%s: failed to reach chip identifier\n",
-			__func__);
-		goto power_off;
+	ret = ov8865_write_reg(sensor, OV8865_SW_STANDBY_REG,
+			       OV8865_SW_STANDBY_STANDBY_N);
+	if (!ret)
+		ret = ov8865_write_reg(sensor, OV8865_OTP_MODE_CTRL_REG,
+				       OV8865_OTP_MODE_CTRL_MANUAL);
+	if (!ret)
+		ret = ov8865_write_reg16(sensor, OV8865_OTP_START_ADDR_REG,
+					 OV8865_OTP_USER_START_REG);
+	if (!ret)
+		ret = ov8865_write_reg16(sensor, OV8865_OTP_END_ADDR_REG,
+					 OV8865_OTP_USER_END_REG);
+	if (!ret)
+		ret = ov8865_write_reg(sensor, OV8865_OTP_LOAD_CTRL_REG,
+				       OV8865_OTP_LOAD_CTRL_ENABLE);
+	if (!ret) {
+		usleep_range(10000, 11000);
+		ret = ov8865_read_regs(sensor, OV8865_OTP_USER_START_REG, data,
+				       OV8865_OTP_USER_SIZE);
 	}
 
-	ret = ov8865_read_reg(sensor, OV8865_CHIP_ID_REG + 1, &chip_id_1);
-	if (ret) {
-		dev_err(&client->dev, "%s: failed to reach chip identifier\n",
-			__func__);
-		goto power_off;
-	}
+	ret2 = ov8865_write_reg(sensor, OV8865_SW_STANDBY_REG, 0x00);
+	if (!ret)
+		ret = ret2;
+	if (!ret)
+		ret = sensor_calib_publish(&sensor->calib, dev,
+					   SENSOR_CALIB_FMT_RAW,
+					   OV8865_CHIP_ID,
+					   OV8865_OTP_USER_START_REG,
+					   OV8865_OTP_USER_SIZE);
+	if (ret)
+		sensor_calib_free(&sensor->calib, dev);
+
+	return ret;
+}
+
+/*
+ * The power up wait reads the chip ID, all three registers in one transfer,
+ * and fails unless it is the OV8865 one, so this only has to power on.
+ */
+static int ov8865_check_chip_id(struct ov8865_dev *sensor)
+{
+	struct i2c_client *client = sensor->i2c_client;
+	struct sensor_ident ident = { .chip_id = OV8865_CHIP_ID };
+	int ret;
 
-	ret = ov8865_read_reg(sensor, OV8865_CHIP_ID_REG + 2, &chip_id_2);
+	ret = ov8865_set_power_on(sensor);
 	if (ret) {
 		dev_err(&client->dev, "%s: failed to reach chip identifier\n",
 			__func__);
-		goto power_off;
+		return ret;
 	}
 
-	chip_id = ((u32)chip_id_0 << 16) | ((u32)chip_id_1 << 8) |
-		((u32)chip_id_2);
-
-	if (chip_id != OV8865_CHIP_ID) {
-		dev_err(&client->dev, "%s: wrong chip identifier, expected 0x008865, got 0x%x\n", __func__, chip_id);
-		ret = -ENXIO;
+	if (!sensor_ident_get(&client->dev, &ident)) {
+		sensor_ident_set(&client->dev, &ident);
+		dev_info(&client->dev, "ov8865 detected at address 0x%02x\n",
+			 client->addr);
 	}
 
-	dev_info(&client->dev, "ov8865 detected at address 0x%02x\n", client->addr);
+	/* Not fatal, the module may have no data programmed */
+	ret = ov8865_otp_read(sensor);
+	if (ret)
+		dev_warn(&client->dev, "could not read OTP data: %d\n", ret);
 
-power_off:
 	ov8865_set_power_off(sensor);
-	return ret;
+	return 0;
 }
 
-/* Get acpi_device of dependent INT3472 device */
-static struct acpi_device *get_dep_adev(struct device *dev)
+/*
+ * Identify the sensor, then set up the controls and register the subdev.
+ * This runs from a worker so that probe does not wait for the power up
+ * delays of the sensor and of the PMIC it depends on. A failed attempt is
+ * undone and made again SENSOR_IDENTIFY_RETRIES times, then the device
+ * stays bound without a subdev.
+ */
+static void ov8865_identify_work(struct work_struct *work)
 {
-	struct acpi_handle *dev_handle;
-	struct acpi_device *sensor_adev;
-	struct acpi_handle_list dep_devices;
-	struct acpi_device *dep_adev;
-	acpi_status status;
-	const char *dep_hid = "INT3472";
-	int i;
-
-	sensor_adev = acpi_dev_get_first_match_dev(OV8865_ACPI_HID, NULL, -1);
-	if (!sensor_adev) {
-		dev_err(dev, "Couldn't get sensor ACPI device\n");
-		return ERR_PTR(-ENODEV);
-	}
-	dev_handle = sensor_adev->handle;
-	acpi_dev_put(sensor_adev);
-
-	if (!acpi_has_method(dev_handle, "_DEP")) {
-		dev_err(dev, "No _DEP entry found\n");
-		return ERR_PTR(-ENODEV);
-	}
-
-	status = acpi_evaluate_reference(dev_handle, "_DEP", NULL, &dep_devices);
-	if (ACPI_FAILURE(status)) {
-		dev_err(dev, "Failed to evaluate _DEP.\n");
-		return ERR_PTR(-ENODEV);
-	}
-
-	for (i = 0; i < dep_devices.count; i++) {
-		struct acpi_device_info *info;
-		int match;
-
-		status = acpi_get_object_info(dep_devices.handles[i], &info);
-		if (ACPI_FAILURE(status)) {
-			dev_dbg(dev,
-				"Error reading _DEP device info, continue next\n");
-			continue;
-		}
-
-		match = info->valid & ACPI_VALID_HID &&
-			!strcmp(info->hardware_id.string, dep_hid);
-
-		kfree(info);
-
-		if (!match)
-			continue;
-
-		if (acpi_bus_get_device(dep_devices.handles[i], &dep_adev)) {
-			dev_err(dev, "Error getting dependent ACPI device\n");
-			return ERR_PTR(-ENODEV);
-		}
+	struct ov8865_dev *sensor = container_of(to_delayed_work(work),
+						 struct ov8865_dev,
+						 identify_work);
+	struct device *dev = &sensor->i2c_client->dev;
+	int ret;
 
-		/* found acpi_device of dependent device */
-		break;
-	}
+	ret = ov8865_check_chip_id(sensor);
+	if (ret)
+		goto err;
 
-	if (!dep_adev) {
-		dev_err(dev, "Dependent ACPI device not found\n");
-		return ERR_PTR(-ENODEV);
-	}
+	ret = ov8865_init_controls(sensor);
+	if (ret)
+		goto err_calib_free;
 
-	dev_info(dev, "Dependent ACPI device found: %s\n",
-		 dev_name(&dep_adev->dev));
+	/* The sensor was powered off after check_chip_id() */
+	pm_runtime_set_autosuspend_delay(dev, autosuspend_delay_ms);
+	pm_runtime_use_autosuspend(dev);
+	pm_runtime_enable(dev);
 
-	return dep_adev;
-}
+	sensor->sync.dev = dev;
+	sensor->sync.ops = &ov8865_sync_ops;
+	if (sensor_sync_add(&sensor->sync, sensor->dep_dev))
+		dev_warn(dev, "streams on without the other sensors\n");
 
-/* Get dependent INT3472 device */
-static struct device *get_dep_dev(struct device *dev)
-{
-	struct acpi_device *dep_adev;
-	struct acpi_device_physical_node *dep_phys;
+	/* Last, the notifier may stream the subdev right away */
+	ret = v4l2_async_register_subdev(&sensor->sd);
+	if (ret)
+		goto err_sync_remove;
 
-	dep_adev = get_dep_adev(dev);
-	if (!dep_adev) {
-		dev_err(dev, "get_dep_adev() failed\n");
-		return ERR_PTR(-ENODEV);
-	}
+	sensor->registered = true;
 
-	/*
-	 * HACK: We know that the PMIC is a "discrete" PMIC, an ACPI device
-	 * that just serves as a container to list system GPIOs.
-	 *
-	 * The ACPI device has no fwnode, nor does it have a platform device.
-	 * This prevents fetching GPIOs. It however seems to be backed by the
-	 * PCI root complex (pci0000:00/0000:00:00.0) as its physical device,
-	 * and that device has its fwnode set to \_SB.PCI0.DSC1. Whether this
-	 * is correct or not is unknown, let's just get the physical device and
-	 * move on for now.
-	 *
-	 * (@kitakar5525)This is observed on Microsoft Surface Go series
-	 * and Acer Switch Alpha 12.
-	 */
-	dep_phys = list_first_entry_or_null(&dep_adev->physical_node_list,
-					    struct acpi_device_physical_node,
-					    node);
-	if (!dep_phys) {
-		dev_info(dev,
-			 "Error getting physical node of dependent device\n");
-		return ERR_PTR(-ENODEV);
-	}
+	sensor->debugfs = debugfs_create_dir(dev_name(dev), NULL);
+	debugfs_create_file("modes", 0444, sensor->debugfs, sensor,
+			    &ov8865_modes_fops);
+	sensor_stats_debugfs(&sensor->stats, sensor->debugfs);
+	sensor_meta_debugfs(&sensor->meta, sensor->debugfs);
+	sensor_selftest_debugfs(&sensor->selftest, sensor->debugfs);
 
-	dev_info(dev, "Dependent device found: %s\n", dev_name(dep_phys->dev));
+	return;
 
-	return dep_phys->dev;
+err_sync_remove:
+	sensor_sync_remove(&sensor->sync);
+	pm_runtime_disable(dev);
+	pm_runtime_dont_use_autosuspend(dev);
+	v4l2_ctrl_handler_free(&sensor->ctrls.handler);
+	v4l2_ctrl_handler_free(&sensor->ctrls.ae_handler);
+err_calib_free:
+	/* check_chip_id() reads the OTP again */
+	sensor_calib_free(&sensor->calib, dev);
+err:
+	if (sensor_identify_retry(&sensor->identify_work,
+				  &sensor->identify_tries))
+		dev_warn(dev, "%s: failed to set up sensor: %d, retrying\n",
+			 __func__, ret);
+	else
+		dev_err(dev, "%s: failed to set up sensor: %d, giving up\n",
+			__func__, ret);
 }
 
 static int ov8865_probe(struct i2c_client *client)
@@ -2598,19 +2768,51 @@ static int ov8865_probe(struct i2c_client *client)
 		return -ENOMEM;
 
 	sensor->i2c_client = client;
+	sensor_i2c_init(&sensor->i2c, client, &sensor->stats, &sensor->shadow);
 
-	if (acpi_dev_present(OV8865_ACPI_HID, NULL, -1)) {
+	/* The sensor_mock adapter simulates the ACPI setup */
+	if (acpi_dev_present(OV8865_ACPI_HID, NULL, -1) ||
+	    sensor_dep_is_mock(dev)) {
 		dev_info(dev, "system is acpi-based\n");
 		sensor->is_acpi_based = true;
 	} else
 		dev_info(dev, "system is not acpi-based\n");
 
+	if (!sensor->is_acpi_based) {
+		endpoint = fwnode_graph_get_next_endpoint(dev_fwnode(&client->dev),
+							NULL);
+		if (!endpoint) {
+			dev_err(dev, "endpoint node not found\n");
+			return -EINVAL;
+		}
+
+		ret = v4l2_fwnode_endpoint_parse(endpoint, &sensor->ep);
+		fwnode_handle_put(endpoint);
+		if (ret) {
+			dev_err(dev, "Could not parse endpoint\n");
+			return ret;
+		}
+	}
+
+	sensor->link.freqs = link_freq_menu_items;
+	sensor->link.num_freqs = ARRAY_SIZE(link_freq_menu_items);
+	sensor->link.lanes = sensor_link_lanes(dev, &sensor->ep,
+					       OV8865_MAX_LANES);
+
 	/*
 	 * Default init sequence initialize sensor to
-	 * RAW SBGGR10 3264x1836@30fps.
+	 * RAW SBGGR10 3264x1836@30fps, or the largest mode the link carries.
 	 */
 
-	default_mode = &ov8865_mode_data[OV8865_MODE_QUXGA_3264_2448];
+	default_mode = ov8865_find_mode(sensor, OV8865_30_FPS,
+			ov8865_mode_data[OV8865_MODE_QUXGA_3264_2448].hact,
+			ov8865_mode_data[OV8865_MODE_QUXGA_3264_2448].vact,
+			true);
+	if (!default_mode) {
+		dev_err(dev, "no mode fits %u data lanes\n",
+			sensor->link.lanes);
+		return -ERANGE;
+	}
 
 	fmt = &sensor->fmt;
 	fmt->code = MEDIA_BUS_FMT_SBGGR10_1X10;
@@ -2649,22 +2851,6 @@ static int ov8865_probe(struct i2c_client *client)
 		sensor->upside_down = true;
 	}
 
-	if (!sensor->is_acpi_based) {
-		endpoint = fwnode_graph_get_next_endpoint(dev_fwnode(&client->dev),
-							NULL);
-		if (!endpoint) {
-			dev_err(dev, "endpoint node not found\n");
-			return -EINVAL;
-		}
-
-		ret = v4l2_fwnode_endpoint_parse(endpoint, &sensor->ep);
-		fwnode_handle_put(endpoint);
-		if (ret) {
-			dev_err(dev, "Could not parse endpoint\n");
-			return ret;
-		}
-	}
-
 	/* For DT-based systems */
 	if (!sensor->is_acpi_based) {
 		/* Get system clock (xclk). */
@@ -2699,7 +2885,7 @@ static int ov8865_probe(struct i2c_client *client)
 
 	/* For ACPI-based systems */
 	if (sensor->is_acpi_based) {
-		sensor->dep_dev = get_dep_dev(&client->dev);
+		sensor->dep_dev = sensor_dep_get_dev(&client->dev, OV8865_ACPI_HID);
 		if (IS_ERR(sensor->dep_dev)) {
 			ret = PTR_ERR(sensor->dep_dev);
 			dev_err(&client->dev, "cannot get dep_dev: ret %d\n", ret);
@@ -2707,7 +2893,7 @@ static int ov8865_probe(struct i2c_client *client)
 		}
 		dep_dev = sensor->dep_dev;
 
-		ret = gpio_crs_get(sensor, dep_dev);
+		ret = sensor_gpios_get(&sensor->dep_gpios, dep_dev, false);
 		if (ret) {
 			dev_err(dep_dev, "Failed to get _CRS GPIOs\n");
 			return ret;
@@ -2715,38 +2901,45 @@ static int ov8865_probe(struct i2c_client *client)
 	}
 
 	v4l2_i2c_subdev_init(&sensor->sd, client, &ov8865_subdev_ops);
+	sensor_meta_init(&sensor->meta, OV8865_CTRL_DELAY_FRAMES);
+	sensor_selftest_init(&sensor->selftest, 10);
 	sensor->sd.flags |= V4L2_SUBDEV_FL_HAS_DEVNODE |
 			    V4L2_SUBDEV_FL_HAS_EVENTS;
 	sensor->pad.flags = MEDIA_PAD_FL_SOURCE;
 	sensor->sd.entity.function = MEDIA_ENT_F_CAM_SENSOR;
 	ret = media_entity_pads_init(&sensor->sd.entity, 1, &sensor->pad);
 	if (ret)
-		return ret;
+		goto err_gpios_put;
 
 	mutex_init(&sensor->lock);
+	mutex_init(&sensor->ae_lock);
 
-	ret = ov8865_check_chip_id(sensor);
+	ret = ov8865_build_progs(sensor);
 	if (ret)
 		goto err_entity_cleanup;
 
-	ret = ov8865_init_controls(sensor);
+	ret = sensor_shadow_init(dev, &sensor->shadow, OV8865_SW_RESET_REG);
 	if (ret)
 		goto err_entity_cleanup;
 
-	ret = v4l2_async_register_subdev(&sensor->sd);
+	ret = sensor_stats_init(dev, &sensor->stats);
 	if (ret)
-		goto err_free_ctrls;
+		goto err_entity_cleanup;
+
+	/* The sensor is identified and registered by ov8865_identify_work() */
+	INIT_DELAYED_WORK(&sensor->identify_work, ov8865_identify_work);
+	schedule_delayed_work(&sensor->identify_work, 0);
 
 	return 0;
 
-err_free_ctrls:
-	v4l2_ctrl_handler_free(&sensor->ctrls.handler);
 err_entity_cleanup:
+	mutex_destroy(&sensor->ae_lock);
 	mutex_destroy(&sensor->lock);
 	media_entity_cleanup(&sensor->sd.entity);
+err_gpios_put:
 	/* For ACPI-based systems */
 	if (sensor->is_acpi_based)
-		gpio_crs_put(sensor);
+		sensor_gpios_put(&sensor->dep_gpios);
 	return ret;
 }
 
@@ -2758,18 +2951,40 @@ static int ov8865_remove(struct i2c_client *client)
 
 	dev_info(&client->dev, "%s() called", __func__);
 
-	/* For ACPI-based systems */
+	cancel_delayed_work_sync(&sensor->identify_work);
+
+	debugfs_remove_recursive(sensor->debugfs);
+	sensor_calib_free(&sensor->calib, &client->dev);
+
+	if (sensor->registered) {
+		v4l2_async_unregister_subdev(&sensor->sd);
+		sensor_sync_remove(&sensor->sync);
+		sensor_meta_stop(&sensor->meta);
+		v4l2_ctrl_handler_free(&sensor->ctrls.handler);
+		v4l2_ctrl_handler_free(&sensor->ctrls.ae_handler);
+
+		pm_runtime_disable(&client->dev);
+		if (!pm_runtime_status_suspended(&client->dev))
+			ov8865_s_power(&sensor->sd, false);
+		pm_runtime_set_suspended(&client->dev);
+		pm_runtime_dont_use_autosuspend(&client->dev);
+	}
+
+	/* For ACPI-based systems, after the power off above */
 	if (sensor->is_acpi_based)
-		gpio_crs_put(sensor);
+		sensor_gpios_put(&sensor->dep_gpios);
 
-	v4l2_async_unregister_subdev(&sensor->sd);
+	mutex_destroy(&sensor->ae_lock);
 	mutex_destroy(&sensor->lock);
 	media_entity_cleanup(&sensor->sd.entity);
-	v4l2_ctrl_handler_free(&sensor->ctrls.handler);
 
 	return 0;
 }
 
+static const struct dev_pm_ops ov8865_pm_ops = {
+	SET_RUNTIME_PM_OPS(ov8865_runtime_suspend, ov8865_runtime_resume, NULL)
+};
+
 static const struct i2c_device_id ov8865_id[] = {
 	{ "ov8865", 0 },
 	{ },
@@ -2794,7 +3009,9 @@ static struct i2c_driver ov8865_i2c_driver = {
 	.driver	= {
 		 .name = "ov8865",
 		 .of_match_table = ov8865_dt_ids,
+		 .pm = &ov8865_pm_ops,
 		 .acpi_match_table = ACPI_PTR(ov8865_acpi_ids),
+		 .probe_type = PROBE_PREFER_ASYNCHRONOUS,
 	 },
 	 .id_table     = ov8865_id,
 	 .probe_new    = ov8865_probe,
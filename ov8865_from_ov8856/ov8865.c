@@ -1,9 +1,9 @@
 // SPDX-License-Identifier: GPL-2.0
 // Copyright (c) 2019 Intel Corporation.
 
-#include <asm/unaligned.h>
 #include <linux/acpi.h>
 #include <linux/clk.h>
+#include <linux/debugfs.h>
 #include <linux/delay.h>
 #include <linux/gpio/consumer.h>
 #include <linux/i2c.h>
@@ -14,11 +14,11 @@
 #include <media/v4l2-device.h>
 #include <media/v4l2-fwnode.h>
 
-#define OV8865_ACPI_HID "INT347A"
+#include "sensor_burst.h"
+#include "sensor_dep.h"
+#include "sensor_reg.h"
 
-#define OV8865_REG_VALUE_08BIT		1
-#define OV8865_REG_VALUE_16BIT		2
-#define OV8865_REG_VALUE_24BIT		3
+#define OV8865_ACPI_HID "INT347A"
 
 #define OV8865_LINK_FREQ_360MHZ		360000000ULL
 #define OV8865_LINK_FREQ_180MHZ		180000000ULL
@@ -666,6 +666,7 @@ static const struct ov8865_mode supported_modes[] = {
 
 struct ov8865 {
 	struct v4l2_subdev sd;
+	struct sensor_i2c i2c;
 	struct media_pad pad;
 	struct v4l2_ctrl_handler ctrl_handler;
 
@@ -693,10 +694,17 @@ struct ov8865 {
 	struct device *dep_dev;
 
 	/* GPIOs defined in dep_dev _CRS */
-	struct gpio_descs *dep_gpios;
+	struct sensor_gpios dep_gpios;
 
 	bool is_acpi_based;
 	bool is_rpm_supported;
+
+	/* Register lists precompiled at probe, see ov8865_build_progs() */
+	struct sensor_prog global_prog;
+	struct sensor_prog link_freq_progs[ARRAY_SIZE(link_freq_configs)];
+	struct sensor_prog mode_progs[ARRAY_SIZE(supported_modes)];
+
+	struct dentry *debugfs;
 };
 
 static u64 to_pixel_rate(u32 f_index)
@@ -717,89 +725,152 @@ static u64 to_pixels_per_line(u32 hts, u32 f_index)
 	return ppl;
 }
 
-static int ov8865_read_reg(struct ov8865 *ov8865, u16 reg, u16 len, u32 *val)
+static int __ov8865_write_reg_list(struct ov8865 *ov8865,
+				 const struct ov8865_reg_list *r_list)
 {
 	struct i2c_client *client = v4l2_get_subdevdata(&ov8865->sd);
-	struct i2c_msg msgs[2];
-	u8 addr_buf[2];
-	u8 data_buf[4] = {0};
+	struct sensor_burst burst;
+	unsigned int i;
 	int ret;
 
-	if (len > 4)
-		return -EINVAL;
-
-	put_unaligned_be16(reg, addr_buf);
-	msgs[0].addr = client->addr;
-	msgs[0].flags = 0;
-	msgs[0].len = sizeof(addr_buf);
-	msgs[0].buf = addr_buf;
-	msgs[1].addr = client->addr;
-	msgs[1].flags = I2C_M_RD;
-	msgs[1].len = len;
-	msgs[1].buf = &data_buf[4 - len];
-
-	ret = i2c_transfer(client->adapter, msgs, ARRAY_SIZE(msgs));
-	if (ret != ARRAY_SIZE(msgs))
-		return -EIO;
+	sensor_burst_init(&burst, client);
+	for (i = 0; i < r_list->num_of_regs; i++) {
+		ret = sensor_burst_write8(&burst, r_list->regs[i].address,
+					  r_list->regs[i].val);
+		if (ret)
+			goto err;
+	}
 
-	*val = get_unaligned_be32(data_buf);
+	ret = sensor_burst_flush(&burst);
+	if (ret)
+		goto err;
 
 	return 0;
+
+err:
+	dev_err_ratelimited(&client->dev,
+			    "failed to write reg 0x%4.4x. error = %d",
+			    burst.addr, ret);
+	return ret;
 }
 
-static int ov8865_write_reg(struct ov8865 *ov8865, u16 reg, u16 len, u32 val)
+static const struct sensor_prog *
+ov8865_reg_list_prog(struct ov8865 *ov8865,
+		     const struct ov8865_reg_list *r_list)
 {
-	struct i2c_client *client = v4l2_get_subdevdata(&ov8865->sd);
-	u8 buf[6];
+	unsigned int i;
 
-	if (len > 4)
-		return -EINVAL;
+	if (r_list == &reg_list_global_regs)
+		return &ov8865->global_prog;
 
-	put_unaligned_be16(reg, buf);
-	put_unaligned_be32(val << 8 * (4 - len), buf + 2);
-	if (i2c_master_send(client, buf, len + 2) != len + 2)
-		return -EIO;
+	for (i = 0; i < ARRAY_SIZE(link_freq_configs); i++)
+		if (r_list == &link_freq_configs[i].reg_list)
+			return &ov8865->link_freq_progs[i];
 
-	return 0;
+	for (i = 0; i < ARRAY_SIZE(supported_modes); i++)
+		if (r_list == &supported_modes[i].reg_list)
+			return &ov8865->mode_progs[i];
+
+	return NULL;
 }
 
 static int ov8865_write_reg_list(struct ov8865 *ov8865,
 				 const struct ov8865_reg_list *r_list)
 {
 	struct i2c_client *client = v4l2_get_subdevdata(&ov8865->sd);
+	const struct sensor_prog *prog = ov8865_reg_list_prog(ov8865, r_list);
+
+	if (prog && prog->msgs)
+		return sensor_prog_run(client, prog, NULL);
+
+	return __ov8865_write_reg_list(ov8865, r_list);
+}
+
+static int ov8865_walk_reg_list(struct sensor_burst *burst, const void *table)
+{
+	const struct ov8865_reg_list *r_list = table;
 	unsigned int i;
 	int ret;
 
 	for (i = 0; i < r_list->num_of_regs; i++) {
-		ret = ov8865_write_reg(ov8865, r_list->regs[i].address, 1,
-				       r_list->regs[i].val);
-		if (ret) {
-			dev_err_ratelimited(&client->dev,
-				    "failed to write reg 0x%4.4x. error = %d",
-				    r_list->regs[i].address, ret);
+		ret = sensor_burst_write8(burst, r_list->regs[i].address,
+					  r_list->regs[i].val);
+		if (ret)
 			return ret;
-		}
 	}
 
 	return 0;
 }
 
+/*
+ * Precompile the global, PLL and mode register lists so that starting a
+ * stream is just a few i2c_transfer() calls.
+ */
+static int ov8865_build_progs(struct ov8865 *ov8865)
+{
+	struct i2c_client *client = v4l2_get_subdevdata(&ov8865->sd);
+	unsigned int i;
+	int ret;
+
+	ret = sensor_prog_build(client, &ov8865->global_prog,
+				ov8865_walk_reg_list, &reg_list_global_regs);
+	if (ret)
+		return ret;
+
+	for (i = 0; i < ARRAY_SIZE(link_freq_configs); i++) {
+		ret = sensor_prog_build(client, &ov8865->link_freq_progs[i],
+					ov8865_walk_reg_list,
+					&link_freq_configs[i].reg_list);
+		if (ret)
+			return ret;
+	}
+
+	for (i = 0; i < ARRAY_SIZE(supported_modes); i++) {
+		ret = sensor_prog_build(client, &ov8865->mode_progs[i],
+					ov8865_walk_reg_list,
+					&supported_modes[i].reg_list);
+		if (ret)
+			return ret;
+	}
+
+	return 0;
+}
+
+static int ov8865_modes_show(struct seq_file *m, void *data)
+{
+	struct ov8865 *ov8865 = m->private;
+	char name[24];
+	unsigned int i;
+
+	sensor_prog_seq_header(m);
+	sensor_prog_seq_show(m, "global", &ov8865->global_prog);
+	for (i = 0; i < ARRAY_SIZE(link_freq_configs); i++) {
+		snprintf(name, sizeof(name), "pll%u", i);
+		sensor_prog_seq_show(m, name, &ov8865->link_freq_progs[i]);
+	}
+	for (i = 0; i < ARRAY_SIZE(supported_modes); i++) {
+		snprintf(name, sizeof(name), "%ux%u", supported_modes[i].width,
+			 supported_modes[i].height);
+		sensor_prog_seq_show(m, name, &ov8865->mode_progs[i]);
+	}
+
+	return 0;
+}
+DEFINE_SHOW_ATTRIBUTE(ov8865_modes);
+
 static int ov8865_update_digital_gain(struct ov8865 *ov8865, u32 d_gain)
 {
 	int ret;
 
-	ret = ov8865_write_reg(ov8865, OV8865_REG_MWB_R_GAIN,
-			       OV8865_REG_VALUE_16BIT, d_gain);
+	ret = sensor_reg_write16(&ov8865->i2c, OV8865_REG_MWB_R_GAIN, d_gain);
 	if (ret)
 		return ret;
 
-	ret = ov8865_write_reg(ov8865, OV8865_REG_MWB_G_GAIN,
-			       OV8865_REG_VALUE_16BIT, d_gain);
+	ret = sensor_reg_write16(&ov8865->i2c, OV8865_REG_MWB_G_GAIN, d_gain);
 	if (ret)
 		return ret;
 
-	return ov8865_write_reg(ov8865, OV8865_REG_MWB_B_GAIN,
-				OV8865_REG_VALUE_16BIT, d_gain);
+	return sensor_reg_write16(&ov8865->i2c, OV8865_REG_MWB_B_GAIN, d_gain);
 }
 
 static int ov8865_test_pattern(struct ov8865 *ov8865, u32 pattern)
@@ -808,8 +879,8 @@ static int ov8865_test_pattern(struct ov8865 *ov8865, u32 pattern)
 		pattern = (pattern - 1) << OV8865_TEST_PATTERN_BAR_SHIFT |
 			  OV8865_TEST_PATTERN_ENABLE;
 
-	return ov8865_write_reg(ov8865, OV8865_REG_TEST_PATTERN,
-				OV8865_REG_VALUE_08BIT, pattern);
+	return sensor_reg_write8(&ov8865->i2c, OV8865_REG_TEST_PATTERN,
+				 pattern);
 }
 
 static int ov8865_set_ctrl(struct v4l2_ctrl *ctrl)
@@ -837,8 +908,8 @@ static int ov8865_set_ctrl(struct v4l2_ctrl *ctrl)
 
 	switch (ctrl->id) {
 	case V4L2_CID_ANALOGUE_GAIN:
-		ret = ov8865_write_reg(ov8865, OV8865_REG_ANALOG_GAIN,
-				       OV8865_REG_VALUE_16BIT, ctrl->val);
+		ret = sensor_reg_write16(&ov8865->i2c, OV8865_REG_ANALOG_GAIN,
+					 ctrl->val);
 		break;
 
 	case V4L2_CID_DIGITAL_GAIN:
@@ -847,14 +918,13 @@ static int ov8865_set_ctrl(struct v4l2_ctrl *ctrl)
 
 	case V4L2_CID_EXPOSURE:
 		/* 4 least significant bits of expsoure are fractional part */
-		ret = ov8865_write_reg(ov8865, OV8865_REG_EXPOSURE,
-				       OV8865_REG_VALUE_24BIT, ctrl->val << 4);
+		ret = sensor_reg_write24(&ov8865->i2c, OV8865_REG_EXPOSURE,
+					 ctrl->val << 4);
 		break;
 
 	case V4L2_CID_VBLANK:
-		ret = ov8865_write_reg(ov8865, OV8865_REG_VTS,
-				       OV8865_REG_VALUE_16BIT,
-				       ov8865->cur_mode->height + ctrl->val);
+		ret = sensor_reg_write16(&ov8865->i2c, OV8865_REG_VTS,
+					 ov8865->cur_mode->height + ctrl->val);
 		break;
 
 	case V4L2_CID_TEST_PATTERN:
@@ -945,52 +1015,13 @@ static void ov8865_update_pad_format(const struct ov8865_mode *mode,
 	fmt->field = V4L2_FIELD_NONE;
 }
 
-/* Get GPIOs defined in dep_dev _CRS */
-static int gpio_crs_get(struct ov8865 *sensor, struct device *dep_dev)
-{
-	sensor->dep_gpios = devm_gpiod_get_array(dep_dev, NULL, GPIOD_ASIS);
-	if (IS_ERR(sensor->dep_gpios)) {
-		dev_err(dep_dev, "Failed to get GPIOs\n");
-		return -ENODEV;
-	}
-
-	return 0;
-}
-
-/* Put GPIOs defined in dep_dev _CRS */
-static void gpio_crs_put(struct ov8865 *sensor)
-{
-	gpiod_put_array(sensor->dep_gpios);
-}
-
-/* Control GPIOs defined in dep_dev _CRS */
-static int gpio_crs_ctrl(struct ov8865 *sensor, bool flag)
-{
-	struct gpio_descs *d = sensor->dep_gpios;
-	unsigned long *values;
-
-	values = bitmap_alloc(d->ndescs, GFP_KERNEL);
-	if (!values)
-		return -ENOMEM;
-
-	if (flag)
-		bitmap_fill(values, d->ndescs);
-	else
-		bitmap_zero(values, d->ndescs);
-
-	gpiod_set_array_value_cansleep(d->ndescs, d->desc,
-				       d->info, values);
-
-	return 0;
-}
-
 static int __ov8865_power_on(struct ov8865 *ov8865)
 {
 	struct i2c_client *client = v4l2_get_subdevdata(&ov8865->sd);
 	int ret;
 
 	if (ov8865->is_acpi_based) {
-		ret = gpio_crs_ctrl(ov8865, true);
+		ret = sensor_gpios_set(&ov8865->dep_gpios, true);
 		if (ret)
 			goto fail_power;
 		usleep_range(1500, 1800);
@@ -1025,7 +1056,7 @@ disable_clk:
 	clk_disable_unprepare(ov8865->xvclk);
 fail_power:
 	if (ov8865->is_acpi_based)
-		gpio_crs_ctrl(ov8865, false);
+		sensor_gpios_set(&ov8865->dep_gpios, false);
 
 	return ret;
 }
@@ -1033,7 +1064,7 @@ fail_power:
 static void __ov8865_power_off(struct ov8865 *ov8865)
 {
 	if (ov8865->is_acpi_based) {
-		gpio_crs_ctrl(ov8865, false);
+		sensor_gpios_set(&ov8865->dep_gpios, false);
 		return;
 	}
 
@@ -1075,8 +1106,8 @@ static int ov8865_start_streaming(struct ov8865 *ov8865)
 	if (ret)
 		return ret;
 
-	ret = ov8865_write_reg(ov8865, OV8865_REG_MODE_SELECT,
-			       OV8865_REG_VALUE_08BIT, OV8865_MODE_STREAMING);
+	ret = sensor_reg_write8(&ov8865->i2c, OV8865_REG_MODE_SELECT,
+				OV8865_MODE_STREAMING);
 	if (ret) {
 		dev_err(&client->dev, "failed to set stream");
 		return ret;
@@ -1089,8 +1120,8 @@ static void ov8865_stop_streaming(struct ov8865 *ov8865)
 {
 	struct i2c_client *client = v4l2_get_subdevdata(&ov8865->sd);
 
-	if (ov8865_write_reg(ov8865, OV8865_REG_MODE_SELECT,
-			     OV8865_REG_VALUE_08BIT, OV8865_MODE_STANDBY))
+	if (sensor_reg_write8(&ov8865->i2c, OV8865_REG_MODE_SELECT,
+	    OV8865_MODE_STANDBY))
 		dev_err(&client->dev, "failed to set stream");
 }
 
@@ -1350,8 +1381,7 @@ static int ov8865_identify_module(struct ov8865 *ov8865)
 	int ret;
 	u32 val;
 
-	ret = ov8865_read_reg(ov8865, OV8865_REG_CHIP_ID,
-			      OV8865_REG_VALUE_24BIT, &val);
+	ret = sensor_reg_read24(&ov8865->i2c, OV8865_REG_CHIP_ID, &val);
 	if (ret)
 		return ret;
 
@@ -1361,28 +1391,27 @@ static int ov8865_identify_module(struct ov8865 *ov8865)
 		return -ENXIO;
 	}
 
-	ret = ov8865_write_reg(ov8865, OV8865_REG_MODE_SELECT,
-			       OV8865_REG_VALUE_08BIT, OV8865_MODE_STREAMING);
+	ret = sensor_reg_write8(&ov8865->i2c, OV8865_REG_MODE_SELECT,
+				OV8865_MODE_STREAMING);
 	if (ret)
 		return ret;
 
-	ret = ov8865_write_reg(ov8865, OV8865_OTP_MODE_CTRL,
-			       OV8865_REG_VALUE_08BIT, OV8865_OTP_MODE_AUTO);
+	ret = sensor_reg_write8(&ov8865->i2c, OV8865_OTP_MODE_CTRL,
+				OV8865_OTP_MODE_AUTO);
 	if (ret) {
 		dev_err(&client->dev, "failed to set otp mode");
 		return ret;
 	}
 
-	ret = ov8865_write_reg(ov8865, OV8865_OTP_LOAD_CTRL,
-			       OV8865_REG_VALUE_08BIT,
-			       OV8865_OTP_LOAD_CTRL_ENABLE);
+	ret = sensor_reg_write8(&ov8865->i2c, OV8865_OTP_LOAD_CTRL,
+				OV8865_OTP_LOAD_CTRL_ENABLE);
 	if (ret) {
 		dev_err(&client->dev, "failed to enable load control");
 		return ret;
 	}
 
-	ret = ov8865_write_reg(ov8865, OV8865_REG_MODE_SELECT,
-			       OV8865_REG_VALUE_08BIT, OV8865_MODE_STANDBY);
+	ret = sensor_reg_write8(&ov8865->i2c, OV8865_REG_MODE_SELECT,
+				OV8865_MODE_STANDBY);
 	if (ret) {
 		dev_err(&client->dev, "failed to exit streaming mode");
 		return ret;
@@ -1490,6 +1519,8 @@ static int ov8865_remove(struct i2c_client *client)
 	struct v4l2_subdev *sd = i2c_get_clientdata(client);
 	struct ov8865 *ov8865 = to_ov8865(sd);
 
+	debugfs_remove_recursive(ov8865->debugfs);
+
 	v4l2_async_unregister_subdev(sd);
 	media_entity_cleanup(&sd->entity);
 	v4l2_ctrl_handler_free(sd->ctrl_handler);
@@ -1499,120 +1530,11 @@ static int ov8865_remove(struct i2c_client *client)
 	__ov8865_power_off(ov8865);
 
 	if (ov8865->is_acpi_based)
-		gpio_crs_put(ov8865);
+		sensor_gpios_put(&ov8865->dep_gpios);
 
 	return 0;
 }
 
-/* Get acpi_device of dependent INT3472 device */
-static struct acpi_device *get_dep_adev(struct device *dev)
-{
-	struct acpi_handle *dev_handle;
-	struct acpi_device *sensor_adev;
-	struct acpi_handle_list dep_devices;
-	struct acpi_device *dep_adev;
-	acpi_status status;
-	const char *dep_hid = "INT3472";
-	int i;
-
-	sensor_adev = acpi_dev_get_first_match_dev(OV8865_ACPI_HID, NULL, -1);
-	if (!sensor_adev) {
-		dev_err(dev, "Couldn't get sensor ACPI device\n");
-		return ERR_PTR(-ENODEV);
-	}
-	dev_handle = sensor_adev->handle;
-	acpi_dev_put(sensor_adev);
-
-	if (!acpi_has_method(dev_handle, "_DEP")) {
-		dev_err(dev, "No _DEP entry found\n");
-		return ERR_PTR(-ENODEV);
-	}
-
-	status = acpi_evaluate_reference(dev_handle, "_DEP", NULL, &dep_devices);
-	if (ACPI_FAILURE(status)) {
-		dev_err(dev, "Failed to evaluate _DEP.\n");
-		return ERR_PTR(-ENODEV);
-	}
-
-	for (i = 0; i < dep_devices.count; i++) {
-		struct acpi_device_info *info;
-		int match;
-
-		status = acpi_get_object_info(dep_devices.handles[i], &info);
-		if (ACPI_FAILURE(status)) {
-			dev_dbg(dev,
-				"Error reading _DEP device info, continue next\n");
-			continue;
-		}
-
-		match = info->valid & ACPI_VALID_HID &&
-			!strcmp(info->hardware_id.string, dep_hid);
-
-		kfree(info);
-
-		if (!match)
-			continue;
-
-		if (acpi_bus_get_device(dep_devices.handles[i], &dep_adev)) {
-			dev_err(dev, "Error getting dependent ACPI device\n");
-			return ERR_PTR(-ENODEV);
-		}
-
-		/* found acpi_device of dependent device */
-		break;
-	}
-
-	if (!dep_adev) {
-		dev_err(dev, "Dependent ACPI device not found\n");
-		return ERR_PTR(-ENODEV);
-	}
-
-	dev_info(dev, "Dependent ACPI device found: %s\n",
-		 dev_name(&dep_adev->dev));
-
-	return dep_adev;
-}
-
-/* Get dependent INT3472 device */
-static struct device *get_dep_dev(struct device *dev)
-{
-	struct acpi_device *dep_adev;
-	struct acpi_device_physical_node *dep_phys;
-
-	dep_adev = get_dep_adev(dev);
-	if (!dep_adev) {
-		dev_err(dev, "get_dep_adev() failed\n");
-		return ERR_PTR(-ENODEV);
-	}
-
-	/*
-	 * HACK: We know that the PMIC is a "discrete" PMIC, an ACPI device
-	 * that just serves as a container to list system GPIOs.
-	 *
-	 * The ACPI device has no fwnode, nor does it have a platform device.
-	 * This prevents fetching GPIOs. It however seems to be backed by the
-	 * PCI root complex (pci0000:00/0000:00:00.0) as its physical device,
-	 * and that device has its fwnode set to \_SB.PCI0.DSC1. Whether this
-	 * is correct or not is unknown, let's just get the physical device and
-	 * move on for now.
-	 *
-	 * (@kitakar5525)This is observed on Microsoft Surface Go series
-	 * and Acer Switch Alpha 12.
-	 */
-	dep_phys = list_first_entry_or_null(&dep_adev->physical_node_list,
-					    struct acpi_device_physical_node,
-					    node);
-	if (!dep_phys) {
-		dev_info(dev,
-			 "Error getting physical node of dependent device\n");
-		return ERR_PTR(-ENODEV);
-	}
-
-	dev_info(dev, "Dependent device found: %s\n", dev_name(dep_phys->dev));
-
-	return dep_phys->dev;
-}
-
 static int ov8865_probe(struct i2c_client *client)
 {
 	struct ov8865 *ov8865;
@@ -1640,8 +1562,9 @@ static int ov8865_probe(struct i2c_client *client)
 #endif
 
 	v4l2_i2c_subdev_init(&ov8865->sd, client, &ov8865_subdev_ops);
+	sensor_i2c_init(&ov8865->i2c, client, NULL, NULL);
 
-	ov8865->dep_dev = get_dep_dev(&client->dev);
+	ov8865->dep_dev = sensor_dep_get_dev(&client->dev, OV8865_ACPI_HID);
 	if (IS_ERR(ov8865->dep_dev)) {
 		ret = PTR_ERR(ov8865->dep_dev);
 		dev_err(&client->dev, "cannot get dep_dev: ret %d\n", ret);
@@ -1649,7 +1572,7 @@ static int ov8865_probe(struct i2c_client *client)
 	}
 	dep_dev = ov8865->dep_dev;
 
-	ret = gpio_crs_get(ov8865, dep_dev);
+	ret = sensor_gpios_get(&ov8865->dep_gpios, dep_dev, false);
 	if (ret) {
 		dev_err(dep_dev, "Failed to get _CRS GPIOs\n");
 		return ret;
@@ -1658,7 +1581,7 @@ static int ov8865_probe(struct i2c_client *client)
 	ret = __ov8865_power_on(ov8865);
 	if (ret) {
 		dev_err(&client->dev, "failed to power on\n");
-		goto error_gpio_crs_put;
+		goto error_gpios_put;
 	}
 
 	ret = ov8865_identify_module(ov8865);
@@ -1669,6 +1592,13 @@ static int ov8865_probe(struct i2c_client *client)
 
 	mutex_init(&ov8865->mutex);
 	ov8865->cur_mode = &supported_modes[0];
+
+	ret = ov8865_build_progs(ov8865);
+	if (ret) {
+		dev_err(&client->dev, "failed to build reg lists: %d", ret);
+		goto probe_error_mutex_destroy;
+	}
+
 	ret = ov8865_init_controls(ov8865);
 	if (ret) {
 		dev_err(&client->dev, "failed to init controls: %d", ret);
@@ -1693,6 +1623,10 @@ static int ov8865_probe(struct i2c_client *client)
 		goto probe_error_media_entity_cleanup;
 	}
 
+	ov8865->debugfs = debugfs_create_dir(dev_name(&client->dev), NULL);
+	debugfs_create_file("modes", 0444, ov8865->debugfs, ov8865,
+			    &ov8865_modes_fops);
+
 	/*
 	 * Device is already turned on by i2c-core with ACPI domain PM.
 	 * Enable runtime PM and turn off the device.
@@ -1720,14 +1654,16 @@ probe_error_media_entity_cleanup:
 
 probe_error_v4l2_ctrl_handler_free:
 	v4l2_ctrl_handler_free(ov8865->sd.ctrl_handler);
+
+probe_error_mutex_destroy:
 	mutex_destroy(&ov8865->mutex);
 
 probe_power_off:
 	__ov8865_power_off(ov8865);
 
-error_gpio_crs_put:
+error_gpios_put:
 	if (ov8865->is_acpi_based)
-		gpio_crs_put(ov8865);
+		sensor_gpios_put(&ov8865->dep_gpios);
 
 	return ret;
 }